@@ -22,6 +22,7 @@
      dcAtomicField.h dcAtomicField.I dcClass.h dcClass.I \
      dcDeclaration.h \
      dcField.h dcField.I \
+     dcFieldProgram.h dcFieldProgram.I \
      dcFile.h dcFile.I \
      dcKeyword.h dcKeywordList.h \
      dcLexer.lxx  \
@@ -43,7 +44,7 @@
   #define INCLUDED_SOURCES \
      dcAtomicField.cxx dcClass.cxx \
      dcDeclaration.cxx \
-     dcField.cxx dcFile.cxx \
+     dcField.cxx dcFieldProgram.cxx dcFile.cxx \
      dcKeyword.cxx dcKeywordList.cxx \
      dcMolecularField.cxx dcSubatomicType.cxx \
      dcPackData.cxx \
@@ -62,3 +63,11 @@
 
   #define IGATESCAN all
 #end lib_target
+
+#begin test_bin_target
+  #define TARGET test_dcprogram
+  #define LOCAL_LIBS p3dcparser $[LOCAL_LIBS]
+
+  #define SOURCES \
+    test_dcprogram.cxx
+#end test_bin_target
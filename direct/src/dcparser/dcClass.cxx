@@ -52,6 +52,14 @@ ConfigVariableBool dc_sort_inheritance_by_file
           "rather than based on the order in which the references are made "
           "within the class."));
 
+ConfigVariableBool dc_compile_fields
+("dc-compile-fields", true,
+ PRC_DESC("Set this true to precompile each simple field of the dc file "
+          "into a flat program that packs and unpacks its updates "
+          "directly, instead of walking the field structure with a "
+          "DCPacker each time.  The results are the same either way; "
+          "this only exists so that the two can be compared."));
+
 
 #endif  // WITHIN_PANDA
 
@@ -511,6 +519,16 @@ receive_update(PyObject *distobj, DatagramIterator &di) const {
             return;
     }
 
+    // If the field has been precompiled, we can skip the DCPacker
+    // entirely.  If that fails, we go the long way around, which will
+    // report the error properly.
+    size_t p = packer.get_num_unpacked_bytes();
+    if (field->receive_update(data + di.get_current_index(),
+                              di.get_remaining_size(), p, distobj)) {
+      di.skip_bytes(p);
+      return;
+    }
+
     packer.begin_unpack(field);
     field->receive_update(packer, distobj);
     packer.end_unpack();
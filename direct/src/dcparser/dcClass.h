@@ -27,12 +27,14 @@
 extern ConfigVariableBool dc_multiple_inheritance;
 extern ConfigVariableBool dc_virtual_inheritance;
 extern ConfigVariableBool dc_sort_inheritance_by_file;
+extern ConfigVariableBool dc_compile_fields;
 
 #else  // WITHIN_PANDA
 
 static const bool dc_multiple_inheritance = true;
 static const bool dc_virtual_inheritance = true;
 static const bool dc_sort_inheritance_by_file = false;
+static const bool dc_compile_fields = true;
 
 #endif  // WITHIN_PANDA
 
@@ -13,6 +13,7 @@
 ////////////////////////////////////////////////////////////////////
 
 #include "dcField.h"
+#include "dcFieldProgram.h"
 #include "dcFile.h"
 #include "dcPacker.h"
 #include "dcClass.h"
@@ -41,6 +42,7 @@ DCField() :
   _has_default_value = false;
 
   _bogus_field = false;
+  _program = NULL;
 
   _has_nested_fields = true;
   _num_nested_fields = 0;
@@ -70,6 +72,7 @@ DCField(const string &name, DCClass *dclass) :
   _default_value_stale = true;
 
   _bogus_field = false;
+  _program = NULL;
 
   _has_nested_fields = true;
   _num_nested_fields = 0;
@@ -80,6 +83,31 @@ DCField(const string &name, DCClass *dclass) :
   _has_fixed_structure = true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: DCField::Copy Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+DCField::
+DCField(const DCField &copy) :
+  DCPackerInterface(copy),
+  DCKeywordList(copy),
+  _dclass(copy._dclass),
+  _number(copy._number),
+  _default_value_stale(copy._default_value_stale),
+  _has_default_value(copy._has_default_value),
+  _bogus_field(copy._bogus_field),
+  _default_value(copy._default_value),
+  _program(NULL)
+#ifdef WITHIN_PANDA
+  ,
+  _field_update_pcollector(copy._field_update_pcollector)
+#endif
+{
+  // The program refers to the parameters of the original field, so
+  // the copy must be compiled anew if it is wanted.
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: DCField::Destructor
 //       Access: Public, Virtual
@@ -87,6 +115,7 @@ DCField(const string &name, DCClass *dclass) :
 ////////////////////////////////////////////////////////////////////
 DCField::
 ~DCField() {
+  delete _program;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -409,18 +438,7 @@ receive_update(DCPacker &packer, PyObject *distobj) const {
       PyObject *args = unpack_args(packer);
 
       if (args != (PyObject *)NULL) {
-        PyObject *func = PyObject_GetAttrString(distobj, (char *)_name.c_str());
-        nassertv(func != (PyObject *)NULL);
-      
-        PyObject *result;
-        {
-#ifdef WITHIN_PANDA
-          PStatTimer timer(((DCField *)this)->_field_update_pcollector);
-#endif
-          result = PyObject_CallObject(func, args);
-        }
-        Py_XDECREF(result);
-        Py_DECREF(func);
+        apply_update(distobj, args);
         Py_DECREF(args);
       }
     }
@@ -428,6 +446,96 @@ receive_update(DCPacker &packer, PyObject *distobj) const {
 }
 #endif  // HAVE_PYTHON
 
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCField::receive_update
+//       Access: Public
+//  Description: Applies the update message beginning at p in the
+//               indicated data to the object, as above, using the
+//               field's precompiled program instead of a DCPacker.
+//
+//               Returns true on success, with p advanced past the
+//               message.  Returns false if the field has no program,
+//               or if the message could not be decoded, in which case
+//               nothing has been applied, p is unchanged, and the
+//               caller should fall back to the DCPacker version.
+////////////////////////////////////////////////////////////////////
+bool DCField::
+receive_update(const char *data, size_t length, size_t &p,
+               PyObject *distobj) const {
+  if (_program == (DCFieldProgram *)NULL) {
+    return false;
+  }
+
+  if (as_parameter() != (DCParameter *)NULL) {
+    PyObject *value = _program->unpack_args(data, length, p);
+    if (value == (PyObject *)NULL) {
+      return false;
+    }
+    PyObject_SetAttrString(distobj, (char *)_name.c_str(), value);
+    Py_DECREF(value);
+    return true;
+  }
+
+  if (!PyObject_HasAttrString(distobj, (char *)_name.c_str())) {
+    return _program->unpack_skip(data, length, p);
+  }
+
+  PyObject *args = _program->unpack_args(data, length, p);
+  if (args == (PyObject *)NULL) {
+    return false;
+  }
+  apply_update(distobj, args);
+  Py_DECREF(args);
+  return true;
+}
+#endif  // HAVE_PYTHON
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCField::receive_update
+//       Access: Public
+//  Description: Applies an update to the object from values that
+//               were already unpacked, perhaps in another thread, by
+//               the field's program with unpack_values().  Only the
+//               Python objects are built here.
+//
+//               Returns true on success, or false if the field has
+//               no program or the values could not be converted, in
+//               which case nothing has been applied and the caller
+//               should fall back to the DCPacker version.
+////////////////////////////////////////////////////////////////////
+bool DCField::
+receive_update(const DCFieldProgram::Values &values,
+               PyObject *distobj) const {
+  if (_program == (DCFieldProgram *)NULL) {
+    return false;
+  }
+
+  if (as_parameter() != (DCParameter *)NULL) {
+    PyObject *value = _program->make_args(values);
+    if (value == (PyObject *)NULL) {
+      return false;
+    }
+    PyObject_SetAttrString(distobj, (char *)_name.c_str(), value);
+    Py_DECREF(value);
+    return true;
+  }
+
+  if (!PyObject_HasAttrString(distobj, (char *)_name.c_str())) {
+    return true;
+  }
+
+  PyObject *args = _program->make_args(values);
+  if (args == (PyObject *)NULL) {
+    return false;
+  }
+  apply_update(distobj, args);
+  Py_DECREF(args);
+  return true;
+}
+#endif  // HAVE_PYTHON
+
 #ifdef HAVE_PYTHON
 ////////////////////////////////////////////////////////////////////
 //     Function: DCField::client_format_update
@@ -444,9 +552,7 @@ client_format_update(DOID_TYPE do_id, PyObject *args) const {
   packer.raw_pack_uint32(do_id);
   packer.raw_pack_uint16(_number);
 
-  packer.begin_pack(this);
-  pack_args(packer, args);
-  if (!packer.end_pack()) {
+  if (!pack_update_args(packer, args)) {
     return Datagram();
   }
 
@@ -473,9 +579,7 @@ ai_format_update(DOID_TYPE do_id, CHANNEL_TYPE to_id, CHANNEL_TYPE from_id, PyOb
   packer.raw_pack_uint32(do_id);
   packer.raw_pack_uint16(_number);
 
-  packer.begin_pack(this);
-  pack_args(packer, args);
-  if (!packer.end_pack()) {
+  if (!pack_update_args(packer, args)) {
     return Datagram();
   }
 
@@ -503,9 +607,7 @@ ai_format_update_msg_type(DOID_TYPE do_id, CHANNEL_TYPE to_id, CHANNEL_TYPE from
   packer.raw_pack_uint32(do_id);
   packer.raw_pack_uint16(_number);
 
-  packer.begin_pack(this);
-  pack_args(packer, args);
-  if (!packer.end_pack()) {
+  if (!pack_update_args(packer, args)) {
     return Datagram();
   }
 
@@ -570,6 +672,28 @@ set_name(const string &name) {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: DCField::compile_program
+//       Access: Public
+//  Description: Builds the precompiled program that is used in place
+//               of a DCPacker to pack and unpack updates for this
+//               field, if the field is simple enough to have one.
+//               Returns true if the field now has a program, false
+//               otherwise.  This is normally called by DCFile after
+//               the file has been read.
+////////////////////////////////////////////////////////////////////
+bool DCField::
+compile_program() {
+  if (_program == (DCFieldProgram *)NULL) {
+    _program = new DCFieldProgram;
+    if (!_program->compile(this)) {
+      delete _program;
+      _program = NULL;
+    }
+  }
+  return (_program != (DCFieldProgram *)NULL);
+}
+
 #ifdef HAVE_PYTHON
 ////////////////////////////////////////////////////////////////////
 //     Function: DCField::get_pystr
@@ -640,3 +764,56 @@ refresh_default_value() {
   }
   _default_value_stale = false;
 }
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCField::apply_update
+//       Access: Private
+//  Description: Calls the method of the indicated object that
+//               receives this field, with the indicated tuple of
+//               arguments.
+////////////////////////////////////////////////////////////////////
+void DCField::
+apply_update(PyObject *distobj, PyObject *args) const {
+  PyObject *func = PyObject_GetAttrString(distobj, (char *)_name.c_str());
+  nassertv(func != (PyObject *)NULL);
+
+  PyObject *result;
+  {
+#ifdef WITHIN_PANDA
+    PStatTimer timer(((DCField *)this)->_field_update_pcollector);
+#endif
+    result = PyObject_CallObject(func, args);
+  }
+  Py_XDECREF(result);
+  Py_DECREF(func);
+}
+#endif  // HAVE_PYTHON
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCField::pack_update_args
+//       Access: Private
+//  Description: Appends the packed arguments for this field to the
+//               packer, which should be between packing sessions,
+//               for one of the format_update methods.  Uses the
+//               precompiled program if there is one, falling back to
+//               the DCPacker otherwise, or if the arguments do not
+//               pack cleanly (so that the error is reported in the
+//               usual way).  Returns true on success.
+////////////////////////////////////////////////////////////////////
+bool DCField::
+pack_update_args(DCPacker &packer, PyObject *args) const {
+  if (_program != (DCFieldProgram *)NULL) {
+    DCPackData pack_data;
+    if (_program->pack_args(pack_data, args)) {
+      packer.append_data(pack_data.get_data(), pack_data.get_length());
+      return true;
+    }
+  }
+
+  packer.begin_pack(this);
+  pack_args(packer, args);
+  return packer.end_pack();
+}
+#endif  // HAVE_PYTHON
@@ -19,6 +19,7 @@
 #include "dcPackerInterface.h"
 #include "dcKeywordList.h"
 #include "dcPython.h"
+#include "dcFieldProgram.h"
 
 #ifdef WITHIN_PANDA
 #include "pStatCollector.h"
@@ -41,6 +42,7 @@ class EXPCL_DIRECT DCField : public DCPackerInterface, public DCKeywordList {
 public:
   DCField();
   DCField(const string &name, DCClass *dclass);
+  DCField(const DCField &copy);
   virtual ~DCField();
 
 PUBLISHED:
@@ -103,13 +105,26 @@ public:
   INLINE void set_class(DCClass *dclass);
   INLINE void set_default_value(const string &default_value);
 
+  INLINE const DCFieldProgram *get_program() const;
+  bool compile_program();
+
 #ifdef HAVE_PYTHON
+  bool receive_update(const char *data, size_t length, size_t &p,
+                      PyObject *distobj) const;
+  bool receive_update(const DCFieldProgram::Values &values,
+                      PyObject *distobj) const;
   static string get_pystr(PyObject *value);
 #endif
 
 protected:
   void refresh_default_value();
 
+private:
+#ifdef HAVE_PYTHON
+  void apply_update(PyObject *distobj, PyObject *args) const;
+  bool pack_update_args(DCPacker &packer, PyObject *args) const;
+#endif
+
 protected:
   DCClass *_dclass;
   int _number;
@@ -119,6 +134,7 @@ protected:
 
 private:
   string _default_value;
+  DCFieldProgram *_program;
 
 #ifdef WITHIN_PANDA
   PStatCollector _field_update_pcollector;
@@ -0,0 +1,774 @@
+// Filename: dcFieldProgram.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "dcFieldProgram.h"
+#include "dcField.h"
+#include "dcParameter.h"
+#include "dcSimpleParameter.h"
+#include "dcPackData.h"
+
+////////////////////////////////////////////////////////////////////
+//     Function: set_int_value
+//  Description: Stores the indicated signed value in the Value, as
+//               DCPacker::unpack_object() would have interpreted it
+//               for the Value's pack type.
+////////////////////////////////////////////////////////////////////
+static inline void
+set_int_value(DCFieldProgram::Value &value, unsigned int divisor,
+              PN_int64 ivalue) {
+  if (value._pack_type == PT_double) {
+    value._double_value = (double)ivalue;
+    if (divisor != 1) {
+      value._double_value = value._double_value / divisor;
+    }
+  } else {
+    value._int_value = ivalue;
+    value._uint_value = (PN_uint64)ivalue;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: set_uint_value
+//  Description: Stores the indicated unsigned value in the Value, as
+//               DCPacker::unpack_object() would have interpreted it
+//               for the Value's pack type.
+////////////////////////////////////////////////////////////////////
+static inline void
+set_uint_value(DCFieldProgram::Value &value, unsigned int divisor,
+               PN_uint64 uvalue) {
+  if (value._pack_type == PT_double) {
+    value._double_value = (double)uvalue;
+    if (divisor != 1) {
+      value._double_value = value._double_value / divisor;
+    }
+  } else {
+    value._int_value = (PN_int64)uvalue;
+    value._uint_value = uvalue;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::Constructor
+//       Access: Public
+//  Description: Creates an empty program.  Call compile() to fill it
+//               in.
+////////////////////////////////////////////////////////////////////
+DCFieldProgram::
+DCFieldProgram() :
+  _is_tuple(true),
+  _has_fixed_byte_size(true),
+  _fixed_byte_size(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::compile
+//       Access: Public
+//  Description: Builds the program for the indicated field.  Returns
+//               true on success, or false if the field contains
+//               anything other than simple parameters, in which case
+//               the program must not be used.
+////////////////////////////////////////////////////////////////////
+bool DCFieldProgram::
+compile(const DCField *field) {
+  _ops.clear();
+  _has_fixed_byte_size = field->has_fixed_byte_size();
+  _fixed_byte_size = field->get_fixed_byte_size();
+
+  if (field->as_parameter() != (DCParameter *)NULL) {
+    // A parameter field unpacks to just its value.
+    _is_tuple = false;
+    if (!add_op(field)) {
+      _ops.clear();
+      return false;
+    }
+    return true;
+  }
+
+  // An atomic or molecular field unpacks to a tuple of its
+  // parameters.  A molecular field presents the parameters of all of
+  // its atomic fields as one flat list.
+  _is_tuple = true;
+  int num_nested_fields = field->get_num_nested_fields();
+  for (int i = 0; i < num_nested_fields; ++i) {
+    if (!add_op(field->get_nested_field(i))) {
+      _ops.clear();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::unpack_skip
+//       Access: Public
+//  Description: Advances p past the field's data without unpacking
+//               it.  Returns true on success, or false if the data is
+//               too short, in which case p is unchanged.
+////////////////////////////////////////////////////////////////////
+bool DCFieldProgram::
+unpack_skip(const char *data, size_t length, size_t &p) const {
+  if (_has_fixed_byte_size) {
+    if (p + _fixed_byte_size > length) {
+      return false;
+    }
+    p += _fixed_byte_size;
+    return true;
+  }
+
+  size_t q = p;
+  Ops::const_iterator oi;
+  for (oi = _ops.begin(); oi != _ops.end(); ++oi) {
+    bool pack_error = false;
+    if (!(*oi)._param->unpack_skip(data, length, q, pack_error) || 
+        pack_error || q > length) {
+      return false;
+    }
+  }
+
+  p = q;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::unpack_validate
+//       Access: Public
+//  Description: Advances p past the field's data, checking each value
+//               against the range limits of its parameter, like
+//               DCPacker::unpack_validate().  Returns true if the
+//               data is well-formed and within range, or false
+//               otherwise, in which case p is unchanged.
+//
+//               Unlike a DCPacker, this does not touch the field's
+//               catalog, and so it is safe to call from any thread.
+////////////////////////////////////////////////////////////////////
+bool DCFieldProgram::
+unpack_validate(const char *data, size_t length, size_t &p) const {
+  if (_has_fixed_byte_size && p + _fixed_byte_size > length) {
+    return false;
+  }
+
+  size_t q = p;
+  Ops::const_iterator oi;
+  for (oi = _ops.begin(); oi != _ops.end(); ++oi) {
+    bool pack_error = false;
+    bool range_error = false;
+    if (!(*oi)._param->unpack_validate(data, length, q, pack_error, range_error) ||
+        pack_error || range_error || q > length) {
+      return false;
+    }
+  }
+
+  p = q;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::unpack_values
+//       Access: Public
+//  Description: Unpacks the field's data, beginning at p, into one
+//               Value per parameter, checking each against the range
+//               limits of its parameter.  Returns true on success,
+//               with p advanced past the data, or false if the data
+//               is malformed or out of range, in which case p is
+//               unchanged.
+//
+//               This does not touch Python or the field's catalog,
+//               and so it is safe to call from any thread; the
+//               values may later be turned into Python objects with
+//               make_args().
+////////////////////////////////////////////////////////////////////
+bool DCFieldProgram::
+unpack_values(const char *data, size_t length, size_t &p,
+              Values &values) const {
+  if (_has_fixed_byte_size && p + _fixed_byte_size > length) {
+    return false;
+  }
+
+  values.resize(_ops.size());
+  size_t q = p;
+  int num_ops = (int)_ops.size();
+  for (int i = 0; i < num_ops; ++i) {
+    const Op &op = _ops[i];
+    if (op._code != OC_generic && !_has_fixed_byte_size &&
+        q + op._fixed_byte_size > length) {
+      return false;
+    }
+    if (!unpack_op(op, data, length, q, values[i])) {
+      return false;
+    }
+  }
+
+  p = q;
+  return true;
+}
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::unpack_args
+//       Access: Public
+//  Description: Unpacks the field's data, beginning at p, into a new
+//               Python object, exactly as DCPacker::unpack_object()
+//               would: a tuple for an atomic or molecular field, or a
+//               single value for a parameter field.
+//
+//               On success, advances p past the data.  If the data
+//               is malformed or out of range, returns NULL without
+//               setting a Python exception and leaves p unchanged; in
+//               this case, the caller should repeat the unpack with
+//               a DCPacker to report the error.
+////////////////////////////////////////////////////////////////////
+PyObject *DCFieldProgram::
+unpack_args(const char *data, size_t length, size_t &p) const {
+  // If the field has a fixed size, we only need to check the length
+  // once; the inline ops don't check it again.
+  if (_has_fixed_byte_size && p + _fixed_byte_size > length) {
+    return NULL;
+  }
+
+  size_t q = p;
+  Value value;
+  if (!_is_tuple) {
+    nassertr(_ops.size() == 1, NULL);
+    const Op &op = _ops[0];
+    if (op._code != OC_generic && !_has_fixed_byte_size &&
+        q + op._fixed_byte_size > length) {
+      return NULL;
+    }
+    if (!unpack_op(op, data, length, q, value)) {
+      return NULL;
+    }
+    PyObject *object = make_object(value);
+    if (object != (PyObject *)NULL) {
+      p = q;
+    }
+    return object;
+  }
+
+  int num_ops = (int)_ops.size();
+  PyObject *tuple = PyTuple_New(num_ops);
+  for (int i = 0; i < num_ops; ++i) {
+    const Op &op = _ops[i];
+    if (op._code != OC_generic && !_has_fixed_byte_size &&
+        q + op._fixed_byte_size > length) {
+      Py_DECREF(tuple);
+      return NULL;
+    }
+    if (!unpack_op(op, data, length, q, value)) {
+      Py_DECREF(tuple);
+      return NULL;
+    }
+    PyObject *object = make_object(value);
+    if (object == (PyObject *)NULL) {
+      Py_DECREF(tuple);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(tuple, i, object);
+  }
+
+  p = q;
+  return tuple;
+}
+#endif  // HAVE_PYTHON
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::make_args
+//       Access: Public
+//  Description: Returns a new Python object for the values returned
+//               by a previous call to unpack_values(), exactly as
+//               unpack_args() would have returned it for the same
+//               data.  Returns NULL if the values cannot be
+//               represented in Python.
+////////////////////////////////////////////////////////////////////
+PyObject *DCFieldProgram::
+make_args(const Values &values) const {
+  nassertr(values.size() == _ops.size(), NULL);
+  if (!_is_tuple) {
+    return make_object(values[0]);
+  }
+
+  int num_values = (int)values.size();
+  PyObject *tuple = PyTuple_New(num_values);
+  for (int i = 0; i < num_values; ++i) {
+    PyObject *object = make_object(values[i]);
+    if (object == (PyObject *)NULL) {
+      Py_DECREF(tuple);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(tuple, i, object);
+  }
+
+  return tuple;
+}
+#endif  // HAVE_PYTHON
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::pack_args
+//       Access: Public
+//  Description: Packs the indicated Python object onto the end of
+//               pack_data, exactly as DCPacker::pack_object() would.
+//               For an atomic or molecular field, the object must be
+//               a tuple or list with one element per parameter.
+//
+//               Returns true on success.  If the object does not
+//               match the field, or a value is out of range, returns
+//               false with some or all of the data written; in this
+//               case, the caller should discard the data and repeat
+//               the pack with a DCPacker to report the error.
+////////////////////////////////////////////////////////////////////
+bool DCFieldProgram::
+pack_args(DCPackData &pack_data, PyObject *sequence) const {
+  if (!_is_tuple) {
+    nassertr(_ops.size() == 1, false);
+    return pack_op(_ops[0], pack_data, sequence);
+  }
+
+  if (!PyTuple_Check(sequence) && !PyList_Check(sequence)) {
+    return false;
+  }
+  if (PySequence_Fast_GET_SIZE(sequence) != (Py_ssize_t)_ops.size()) {
+    return false;
+  }
+
+  PyObject **items = PySequence_Fast_ITEMS(sequence);
+  int num_ops = (int)_ops.size();
+  for (int i = 0; i < num_ops; ++i) {
+    if (!pack_op(_ops[i], pack_data, items[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+#endif  // HAVE_PYTHON
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::add_op
+//       Access: Private
+//  Description: Appends the op for the indicated parameter to the
+//               program.  Returns false if it is not a simple
+//               parameter that can be handled here.
+////////////////////////////////////////////////////////////////////
+bool DCFieldProgram::
+add_op(const DCPackerInterface *field) {
+  if (field == (DCPackerInterface *)NULL || 
+      field->as_field() == (DCField *)NULL) {
+    return false;
+  }
+  const DCParameter *parameter = field->as_field()->as_parameter();
+  if (parameter == (DCParameter *)NULL) {
+    return false;
+  }
+  const DCSimpleParameter *simple = parameter->as_simple_parameter();
+  if (simple == (DCSimpleParameter *)NULL) {
+    return false;
+  }
+
+  Op op;
+  op._code = OC_generic;
+  op._pack_type = simple->get_pack_type();
+  op._param = simple;
+  op._divisor = (unsigned int)simple->get_divisor();
+  op._fixed_byte_size = simple->get_fixed_byte_size();
+
+  switch (op._pack_type) {
+  case PT_double:
+  case PT_int:
+  case PT_uint:
+  case PT_int64:
+  case PT_uint64:
+  case PT_string:
+  case PT_blob:
+    break;
+
+  default:
+    // Arrays and anything else with nested fields need the full
+    // DCPacker.
+    return false;
+  }
+
+  if (simple->has_fixed_byte_size() && !simple->has_range_limits()) {
+    // With no range to validate, we can decode the number ourselves.
+    switch (simple->get_type()) {
+    case ST_int8:
+      op._code = OC_int8;
+      break;
+    case ST_int16:
+      op._code = OC_int16;
+      break;
+    case ST_int32:
+      op._code = OC_int32;
+      break;
+    case ST_int64:
+      op._code = OC_int64;
+      break;
+    case ST_uint8:
+      op._code = OC_uint8;
+      break;
+    case ST_uint16:
+      op._code = OC_uint16;
+      break;
+    case ST_uint32:
+      op._code = OC_uint32;
+      break;
+    case ST_uint64:
+      op._code = OC_uint64;
+      break;
+    case ST_float64:
+      op._code = OC_float64;
+      break;
+    default:
+      break;
+    }
+  }
+
+  _ops.push_back(op);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::unpack_op
+//       Access: Private, Static
+//  Description: Unpacks the value for a single op into the indicated
+//               Value.  Returns false on error.  For the inline ops,
+//               the caller has already ensured that there is enough
+//               data.
+////////////////////////////////////////////////////////////////////
+bool DCFieldProgram::
+unpack_op(const Op &op, const char *data, size_t length, size_t &p,
+          Value &value) {
+  const char *ptr = data + p;
+  value._pack_type = op._pack_type;
+
+  switch (op._code) {
+  case OC_int8:
+    p += 1;
+    set_int_value(value, op._divisor,
+                  DCPackerInterface::do_unpack_int8(ptr));
+    return true;
+
+  case OC_int16:
+    p += 2;
+    set_int_value(value, op._divisor,
+                  DCPackerInterface::do_unpack_int16(ptr));
+    return true;
+
+  case OC_int32:
+    p += 4;
+    set_int_value(value, op._divisor,
+                  DCPackerInterface::do_unpack_int32(ptr));
+    return true;
+
+  case OC_int64:
+    p += 8;
+    set_int_value(value, op._divisor,
+                  DCPackerInterface::do_unpack_int64(ptr));
+    return true;
+
+  case OC_uint8:
+    p += 1;
+    set_uint_value(value, op._divisor,
+                   DCPackerInterface::do_unpack_uint8(ptr));
+    return true;
+
+  case OC_uint16:
+    p += 2;
+    set_uint_value(value, op._divisor,
+                   DCPackerInterface::do_unpack_uint16(ptr));
+    return true;
+
+  case OC_uint32:
+    p += 4;
+    set_uint_value(value, op._divisor,
+                   DCPackerInterface::do_unpack_uint32(ptr));
+    return true;
+
+  case OC_uint64:
+    p += 8;
+    set_uint_value(value, op._divisor,
+                   DCPackerInterface::do_unpack_uint64(ptr));
+    return true;
+
+  case OC_float64:
+    p += 8;
+    value._pack_type = PT_double;
+    value._double_value = DCPackerInterface::do_unpack_float64(ptr);
+    if (op._divisor != 1) {
+      value._double_value = value._double_value / op._divisor;
+    }
+    return true;
+
+  case OC_generic:
+    break;
+  }
+
+  return unpack_generic(op, data, length, p, value);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::unpack_generic
+//       Access: Private, Static
+//  Description: Unpacks the value for an op that the parameter must
+//               decode itself into the indicated Value.  Returns
+//               false on error.
+////////////////////////////////////////////////////////////////////
+bool DCFieldProgram::
+unpack_generic(const Op &op, const char *data, size_t length, size_t &p,
+               Value &value) {
+  const DCSimpleParameter *param = op._param;
+  bool pack_error = false;
+  bool range_error = false;
+
+  switch (op._pack_type) {
+  case PT_double:
+    param->unpack_double(data, length, p, value._double_value,
+                         pack_error, range_error);
+    break;
+
+  case PT_int:
+    {
+      int ivalue;
+      param->unpack_int(data, length, p, ivalue, pack_error, range_error);
+      value._int_value = ivalue;
+    }
+    break;
+
+  case PT_uint:
+    {
+      unsigned int uvalue;
+      param->unpack_uint(data, length, p, uvalue, pack_error, range_error);
+      value._uint_value = uvalue;
+    }
+    break;
+
+  case PT_int64:
+    param->unpack_int64(data, length, p, value._int_value,
+                        pack_error, range_error);
+    break;
+
+  case PT_uint64:
+    param->unpack_uint64(data, length, p, value._uint_value,
+                         pack_error, range_error);
+    break;
+
+  case PT_string:
+  case PT_blob:
+    param->unpack_string(data, length, p, value._string_value,
+                         pack_error, range_error);
+    break;
+
+  default:
+    return false;
+  }
+
+  return !pack_error && !range_error;
+}
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::make_object
+//       Access: Private, Static
+//  Description: Returns a new Python object for the indicated value,
+//               as DCPacker::unpack_object() would have created it
+//               for the value's pack type.
+////////////////////////////////////////////////////////////////////
+PyObject *DCFieldProgram::
+make_object(const Value &value) {
+  switch (value._pack_type) {
+  case PT_double:
+    return PyFloat_FromDouble(value._double_value);
+
+  case PT_int:
+#if PY_MAJOR_VERSION >= 3
+    return PyLong_FromLong((int)value._int_value);
+#else
+    return PyInt_FromLong((int)value._int_value);
+#endif
+
+  case PT_uint:
+    {
+      unsigned int uvalue = (unsigned int)value._uint_value;
+#if PY_MAJOR_VERSION >= 3
+      return PyLong_FromLong(uvalue);
+#else
+      if (uvalue & 0x80000000) {
+        return PyLong_FromUnsignedLong(uvalue);
+      }
+      return PyInt_FromLong(uvalue);
+#endif
+    }
+
+  case PT_int64:
+    return PyLong_FromLongLong(value._int_value);
+
+  case PT_uint64:
+    return PyLong_FromUnsignedLongLong(value._uint_value);
+
+  case PT_string:
+#if PY_MAJOR_VERSION >= 3
+    return PyUnicode_FromStringAndSize(value._string_value.data(),
+                                       value._string_value.size());
+#endif
+  case PT_blob:
+#if PY_MAJOR_VERSION >= 3
+    return PyBytes_FromStringAndSize(value._string_value.data(),
+                                     value._string_value.size());
+#else
+    return PyString_FromStringAndSize(value._string_value.data(),
+                                      value._string_value.size());
+#endif
+
+  default:
+    break;
+  }
+
+  return NULL;
+}
+#endif  // HAVE_PYTHON
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCFieldProgram::pack_op
+//       Access: Private, Static
+//  Description: Packs the indicated Python object for a single op.
+//               The choice of pack call for each kind of object
+//               mirrors DCPacker::pack_object().  Returns false on
+//               error, or if the object is not a number or string.
+////////////////////////////////////////////////////////////////////
+bool DCFieldProgram::
+pack_op(const Op &op, DCPackData &pack_data, PyObject *object) {
+  const DCSimpleParameter *param = op._param;
+  bool pack_error = false;
+  bool range_error = false;
+
+  switch (op._pack_type) {
+  case PT_int64:
+    if (PyLong_Check(object)) {
+      param->pack_int64(pack_data, PyLong_AsLongLong(object),
+                        pack_error, range_error);
+      return !pack_error && !range_error;
+    }
+#if PY_MAJOR_VERSION < 3
+    if (PyInt_Check(object)) {
+      param->pack_int64(pack_data, PyInt_AsLong(object),
+                        pack_error, range_error);
+      return !pack_error && !range_error;
+    }
+#endif
+    break;
+
+  case PT_uint64:
+    if (PyLong_Check(object)) {
+      param->pack_uint64(pack_data, PyLong_AsUnsignedLongLong(object),
+                         pack_error, range_error);
+      return !pack_error && !range_error;
+    }
+#if PY_MAJOR_VERSION < 3
+    if (PyInt_Check(object)) {
+      PyObject *obj1 = PyNumber_Long(object);
+      param->pack_int(pack_data, PyLong_AsUnsignedLongLong(obj1),
+                      pack_error, range_error);
+      Py_DECREF(obj1);
+      return !pack_error && !range_error;
+    }
+#endif
+    break;
+
+  case PT_int:
+    if (PyLong_Check(object)) {
+      param->pack_int(pack_data, PyLong_AsLong(object),
+                      pack_error, range_error);
+      return !pack_error && !range_error;
+    }
+#if PY_MAJOR_VERSION < 3
+    if (PyInt_Check(object)) {
+      param->pack_int(pack_data, PyInt_AsLong(object),
+                      pack_error, range_error);
+      return !pack_error && !range_error;
+    }
+#endif
+    break;
+
+  case PT_uint:
+    if (PyLong_Check(object)) {
+      param->pack_uint(pack_data, PyLong_AsUnsignedLong(object),
+                       pack_error, range_error);
+      return !pack_error && !range_error;
+    }
+#if PY_MAJOR_VERSION < 3
+    if (PyInt_Check(object)) {
+      PyObject *obj1 = PyNumber_Long(object);
+      param->pack_uint(pack_data, PyLong_AsUnsignedLong(obj1),
+                       pack_error, range_error);
+      Py_DECREF(obj1);
+      return !pack_error && !range_error;
+    }
+#endif
+    break;
+
+  default:
+    break;
+  }
+
+  if (PyLong_Check(object)) {
+    param->pack_int(pack_data, PyLong_AsLong(object), pack_error, range_error);
+#if PY_MAJOR_VERSION < 3
+  } else if (PyInt_Check(object)) {
+    param->pack_int(pack_data, PyInt_AS_LONG(object), pack_error, range_error);
+#endif
+  } else if (PyFloat_Check(object)) {
+    param->pack_double(pack_data, PyFloat_AS_DOUBLE(object),
+                       pack_error, range_error);
+#if PY_MAJOR_VERSION >= 3
+  } else if (PyUnicode_Check(object)) {
+    const char *buffer;
+    Py_ssize_t length;
+    buffer = PyUnicode_AsUTF8AndSize(object, &length);
+    if (buffer == (char *)NULL) {
+      PyErr_Clear();
+      return false;
+    }
+    param->pack_string(pack_data, string(buffer, length),
+                       pack_error, range_error);
+  } else if (PyBytes_Check(object)) {
+    char *buffer;
+    Py_ssize_t length;
+    if (PyBytes_AsStringAndSize(object, &buffer, &length) < 0) {
+      PyErr_Clear();
+      return false;
+    }
+    param->pack_string(pack_data, string(buffer, length),
+                       pack_error, range_error);
+#else
+  } else if (PyString_Check(object) || PyUnicode_Check(object)) {
+    char *buffer;
+    Py_ssize_t length;
+    if (PyString_AsStringAndSize(object, &buffer, &length) < 0) {
+      PyErr_Clear();
+      return false;
+    }
+    param->pack_string(pack_data, string(buffer, length),
+                       pack_error, range_error);
+#endif
+  } else {
+    // A sequence or class object; let DCPacker sort it out.
+    return false;
+  }
+
+  return !pack_error && !range_error;
+}
+#endif  // HAVE_PYTHON
@@ -0,0 +1,142 @@
+// Filename: dcFieldProgram.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef DCFIELDPROGRAM_H
+#define DCFIELDPROGRAM_H
+
+#include "dcbase.h"
+#include "dcPackerInterface.h"
+#include "dcPython.h"
+
+class DCField;
+class DCSimpleParameter;
+class DCPackData;
+
+////////////////////////////////////////////////////////////////////
+//       Class : DCFieldProgram
+// Description : A flattened, precompiled form of a DCField whose
+//               value is a flat list of simple parameters: numbers,
+//               strings, and blobs, but no arrays, switches, or
+//               nested structs.  This is by far the most common kind
+//               of field, and for these we can pack and unpack
+//               without the general-purpose push() and pop() walk
+//               that DCPacker performs over the DCPackerInterface
+//               hierarchy.
+//
+//               Each parameter of the field becomes one op in a flat
+//               list.  Numeric parameters without range limits are
+//               decoded inline; everything else calls directly into
+//               the DCSimpleParameter, which still skips all of the
+//               DCPacker bookkeeping.  If the field has a fixed byte
+//               size, the length of the data is checked only once.
+//
+//               The results are identical to those of DCPacker.  On
+//               any error, the program simply reports failure, and
+//               the caller is expected to repeat the operation with
+//               a DCPacker in order to report the error properly.
+//
+//               Programs are built by DCFile after reading a dc file,
+//               when dc-compile-fields is true; see
+//               DCField::get_program().  Once built, a program is
+//               never modified, so it may be used from several
+//               threads at once (though the Python methods still
+//               require the GIL).
+////////////////////////////////////////////////////////////////////
+class EXPCL_DIRECT DCFieldProgram {
+public:
+  // One parameter value, unpacked into plain C++ form by
+  // unpack_values(), so that the decoding may be done without the
+  // Python interpreter.  Only the member appropriate to _pack_type is
+  // meaningful; a number with a divisor is always a PT_double.
+  class Value {
+  public:
+    DCPackType _pack_type;
+    PN_int64 _int_value;
+    PN_uint64 _uint_value;
+    double _double_value;
+    string _string_value;
+  };
+  typedef pvector<Value> Values;
+
+  DCFieldProgram();
+
+  bool compile(const DCField *field);
+
+  INLINE int get_num_ops() const;
+  INLINE bool has_fixed_byte_size() const;
+  INLINE size_t get_fixed_byte_size() const;
+
+  bool unpack_skip(const char *data, size_t length, size_t &p) const;
+  bool unpack_validate(const char *data, size_t length, size_t &p) const;
+  bool unpack_values(const char *data, size_t length, size_t &p,
+                     Values &values) const;
+
+#ifdef HAVE_PYTHON
+  PyObject *unpack_args(const char *data, size_t length, size_t &p) const;
+  PyObject *make_args(const Values &values) const;
+  bool pack_args(DCPackData &pack_data, PyObject *sequence) const;
+#endif
+
+private:
+  enum OpCode {
+    OC_int8,
+    OC_int16,
+    OC_int32,
+    OC_int64,
+    OC_uint8,
+    OC_uint16,
+    OC_uint32,
+    OC_uint64,
+    OC_float64,
+
+    // The parameter must be asked to unpack itself.
+    OC_generic,
+  };
+
+  class Op {
+  public:
+    OpCode _code;
+    DCPackType _pack_type;
+    const DCSimpleParameter *_param;
+    unsigned int _divisor;
+    size_t _fixed_byte_size;
+  };
+
+  bool add_op(const DCPackerInterface *field);
+
+  static bool unpack_op(const Op &op, const char *data, size_t length,
+                        size_t &p, Value &value);
+  static bool unpack_generic(const Op &op, const char *data,
+                             size_t length, size_t &p, Value &value);
+
+#ifdef HAVE_PYTHON
+  static PyObject *make_object(const Value &value);
+  static bool pack_op(const Op &op, DCPackData &pack_data, PyObject *object);
+#endif
+
+  typedef pvector<Op> Ops;
+  Ops _ops;
+
+  // True if the field unpacks to a tuple of values (an atomic or
+  // molecular field), false if it unpacks to a single value (a
+  // parameter field).
+  bool _is_tuple;
+
+  bool _has_fixed_byte_size;
+  size_t _fixed_byte_size;
+};
+
+#include "dcFieldProgram.I"
+
+#endif
@@ -189,7 +189,14 @@ read(istream &in, const string &filename) {
   dcyyparse();
   dc_cleanup_parser();
 
-  return (dc_error_count() == 0);
+  if (dc_error_count() != 0) {
+    return false;
+  }
+
+  if (dc_compile_fields) {
+    compile_field_programs();
+  }
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -688,6 +695,31 @@ set_new_index_number(DCField *field) {
   _fields_by_index.push_back(field);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: DCFile::compile_field_programs
+//       Access: Public
+//  Description: Precompiles each field read so far into a
+//               DCFieldProgram, where possible, so that its updates
+//               can be packed and unpacked without the general
+//               DCPacker.  Fields that were already compiled are left
+//               alone.  Returns the number of fields that have a
+//               program.
+//
+//               This is called automatically by read() when
+//               dc-compile-fields is true.
+////////////////////////////////////////////////////////////////////
+int DCFile::
+compile_field_programs() {
+  int num_compiled = 0;
+  FieldsByIndex::iterator fi;
+  for (fi = _fields_by_index.begin(); fi != _fields_by_index.end(); ++fi) {
+    if ((*fi)->compile_program()) {
+      ++num_compiled;
+    }
+  }
+  return num_compiled;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: DCFile::setup_default_keywords
 //       Access: Private
@@ -83,6 +83,7 @@ public:
   void add_thing_to_delete(DCDeclaration *decl);
 
   void set_new_index_number(DCField *field);
+  int compile_field_programs();
   INLINE void check_inherited_fields();
   INLINE void mark_inherited_fields_stale();
 
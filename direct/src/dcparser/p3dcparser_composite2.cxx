@@ -5,6 +5,7 @@
 #include "dcSimpleParameter.cxx"
 #include "dcSwitchParameter.cxx"
 #include "dcField.cxx"
+#include "dcFieldProgram.cxx"
 #include "dcFile.cxx"
 #include "dcMolecularField.cxx"
 #include "dcSubatomicType.cxx"
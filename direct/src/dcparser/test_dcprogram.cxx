@@ -0,0 +1,317 @@
+// Filename: test_dcprogram.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "dcbase.h"
+#include "dcFile.h"
+#include "dcClass.h"
+#include "dcField.h"
+#include "dcFieldProgram.h"
+#include "dcPacker.h"
+#include "dcPython.h"
+
+// This program checks the precompiled DCFieldProgram of each of a
+// handful of typical update fields against the general-purpose
+// DCPacker: that it skips, validates, and unpacks exactly the bytes
+// that DCPacker would, to the same values, and that it rejects data
+// that is truncated or out of range.  With Python, it also checks the
+// Python objects that the program unpacks, and the data it packs
+// from them.  A field with an array must not be compiled at all.
+
+static const char *dc_text =
+  "dclass Avatar {\n"
+  "  setSmPosHpr(int16 / 10, int16 / 10, int16 / 10, int16 / 10, "
+  "int16 / 10, int16 / 10, int16) broadcast ram;\n"
+  "  setXY(float64, float64) broadcast;\n"
+  "  setState(uint8, uint32, int32) broadcast ram;\n"
+  "  setChat(string, uint8, uint32) broadcast;\n"
+  "  setLevel(uint8(1-10), int64) broadcast;\n"
+  "  uint32 score broadcast ram;\n"
+  "  setFriends(uint32[]) broadcast;\n"
+  "};\n";
+
+class Sample {
+public:
+  const char *_field_name;
+  const char *_value;
+};
+
+static const Sample samples[] = {
+  { "setSmPosHpr", "(12.3, -45.6, 0.1, 90, 0, -180, 2345)" },
+  { "setXY", "(1.5, -2.25)" },
+  { "setState", "(3, 4000000000, -17)" },
+  { "setChat", "(\"Hello, world!\", 2, 123456)" },
+  { "setLevel", "(5, -123456789012)" },
+  { "score", "42" },
+  { NULL, NULL }
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_value
+//  Description: Unpacks the next value with the DCPacker, according
+//               to the type the program reported for it, and checks
+//               that the two agree.
+////////////////////////////////////////////////////////////////////
+static bool
+check_value(DCPacker &packer, const DCFieldProgram::Value &value, int n) {
+  bool same = false;
+  switch (value._pack_type) {
+  case PT_double:
+    same = (packer.unpack_double() == value._double_value);
+    break;
+
+  case PT_int:
+  case PT_int64:
+    same = (packer.unpack_int64() == value._int_value);
+    break;
+
+  case PT_uint:
+  case PT_uint64:
+    same = (packer.unpack_uint64() == value._uint_value);
+    break;
+
+  case PT_string:
+  case PT_blob:
+    same = (packer.unpack_string() == value._string_value);
+    break;
+
+  default:
+    nout << "  value " << n << " has unexpected type "
+         << (int)value._pack_type << "\n";
+    return false;
+  }
+
+  if (!same) {
+    nout << "  value " << n << " differs from DCPacker\n";
+  }
+  return same;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_values
+//  Description: Unpacks the data with the program's unpack_values(),
+//               and then with a DCPacker, and checks that both find
+//               the same values in the same bytes.
+////////////////////////////////////////////////////////////////////
+static bool
+check_values(const DCField *field, const DCFieldProgram *program,
+             const string &packed) {
+  DCFieldProgram::Values values;
+  size_t p = 0;
+  if (!program->unpack_values(packed.data(), packed.size(), p, values) ||
+      p != packed.size()) {
+    nout << "  unpack_values failed\n";
+    return false;
+  }
+
+  DCPacker packer;
+  packer.set_unpack_data(packed);
+  packer.begin_unpack(field);
+  bool ok = true;
+  if (field->as_parameter() != (DCParameter *)NULL) {
+    // A parameter field has just the one value.
+    ok = (values.size() == 1 && check_value(packer, values[0], 0));
+  } else {
+    packer.push();
+    size_t n = 0;
+    while (ok && packer.more_nested_fields()) {
+      ok = (n < values.size() && check_value(packer, values[n], n));
+      ++n;
+    }
+    packer.pop();
+    ok = ok && (n == values.size());
+  }
+  if (!packer.end_unpack() || !ok) {
+    nout << "  " << values.size() << " values do not match DCPacker\n";
+    return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_sample
+//  Description: Runs all of the checks on one field, with the
+//               indicated value.
+////////////////////////////////////////////////////////////////////
+static bool
+check_sample(DCClass *dclass, const Sample &sample) {
+  DCField *field = dclass->get_field_by_name(sample._field_name);
+  nassertr(field != (DCField *)NULL, false);
+  nout << field->get_name() << "\n";
+
+  const DCFieldProgram *program = field->get_program();
+  if (program == (DCFieldProgram *)NULL) {
+    nout << "  not compiled\n";
+    return false;
+  }
+
+  string packed = field->parse_string(sample._value);
+  nassertr(!packed.empty(), false);
+  const char *data = packed.data();
+  size_t length = packed.size();
+
+  if (program->has_fixed_byte_size() &&
+      program->get_fixed_byte_size() != length) {
+    nout << "  fixed size is " << program->get_fixed_byte_size()
+         << ", but the data is " << length << " bytes\n";
+    return false;
+  }
+
+  size_t p = 0;
+  if (!program->unpack_skip(data, length, p) || p != length) {
+    nout << "  unpack_skip did not consume the data\n";
+    return false;
+  }
+  p = 0;
+  if (!program->unpack_validate(data, length, p) || p != length) {
+    nout << "  unpack_validate rejected good data\n";
+    return false;
+  }
+  if (!check_values(field, program, packed)) {
+    return false;
+  }
+
+  // Every operation must fail on truncated data, without moving p.
+  DCFieldProgram::Values values;
+  p = 0;
+  if (program->unpack_skip(data, length - 1, p) ||
+      program->unpack_validate(data, length - 1, p) ||
+      program->unpack_values(data, length - 1, p, values) || p != 0) {
+    nout << "  truncated data was accepted\n";
+    return false;
+  }
+
+#ifdef HAVE_PYTHON
+  // Unpacking to a Python object, as in DCClass::receive_update().
+  DCPacker check_packer;
+  check_packer.set_unpack_data(data, length, false);
+  check_packer.begin_unpack(field);
+  PyObject *expected = field->unpack_args(check_packer);
+  check_packer.end_unpack();
+  nassertr(expected != (PyObject *)NULL, false);
+
+  bool ok = true;
+  p = 0;
+  PyObject *object = program->unpack_args(data, length, p);
+  if (object == (PyObject *)NULL || p != length ||
+      PyObject_RichCompareBool(object, expected, Py_EQ) != 1) {
+    nout << "  unpack_args got " << DCField::get_pystr(object)
+         << ", expected " << DCField::get_pystr(expected) << "\n";
+    ok = false;
+  }
+  Py_XDECREF(object);
+
+  // Building the Python object from the plain values, as a
+  // CConnectionRepository dispatch thread leaves them.
+  p = 0;
+  object = NULL;
+  if (program->unpack_values(data, length, p, values)) {
+    object = program->make_args(values);
+  }
+  if (object == (PyObject *)NULL ||
+      PyObject_RichCompareBool(object, expected, Py_EQ) != 1) {
+    nout << "  make_args got " << DCField::get_pystr(object)
+         << ", expected " << DCField::get_pystr(expected) << "\n";
+    ok = false;
+  }
+  Py_XDECREF(object);
+
+  // Packing from a Python object, as in the format_update methods.
+  DCPackData pack_data;
+  if (!program->pack_args(pack_data, expected) ||
+      string(pack_data.get_data(), pack_data.get_length()) != packed) {
+    nout << "  pack_args did not reproduce the data\n";
+    ok = false;
+  }
+
+  Py_DECREF(expected);
+  if (!ok) {
+    return false;
+  }
+#endif  // HAVE_PYTHON
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_range
+//  Description: Checks that a value outside of a parameter's range
+//               is skipped, but not validated or unpacked.
+////////////////////////////////////////////////////////////////////
+static bool
+check_range(DCClass *dclass) {
+  DCField *field = dclass->get_field_by_name("setLevel");
+  nassertr(field != (DCField *)NULL, false);
+  const DCFieldProgram *program = field->get_program();
+  nassertr(program != (DCFieldProgram *)NULL, false);
+  nout << field->get_name() << " out of range\n";
+
+  // The uint8 comes first; replace it with a value outside of 1-10.
+  string packed = field->parse_string("(5, 0)");
+  nassertr(!packed.empty(), false);
+  packed[0] = (char)20;
+
+  size_t p = 0;
+  if (!program->unpack_skip(packed.data(), packed.size(), p) ||
+      p != packed.size()) {
+    nout << "  unpack_skip failed\n";
+    return false;
+  }
+
+  DCFieldProgram::Values values;
+  p = 0;
+  if (program->unpack_validate(packed.data(), packed.size(), p) ||
+      program->unpack_values(packed.data(), packed.size(), p, values) ||
+      p != 0) {
+    nout << "  the value 20 was accepted\n";
+    return false;
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+#ifdef HAVE_PYTHON
+  Py_Initialize();
+#endif
+
+  DCFile dc_file;
+  istringstream in(dc_text);
+  if (!dc_file.read(in, "test_dcprogram.dc")) {
+    nout << "Unable to parse dc text.\n";
+    return 1;
+  }
+  dc_file.compile_field_programs();
+
+  DCClass *dclass = dc_file.get_class_by_name("Avatar");
+  nassertr(dclass != (DCClass *)NULL, 1);
+
+  bool all_ok = true;
+  for (int si = 0; samples[si]._field_name != NULL; ++si) {
+    all_ok = check_sample(dclass, samples[si]) && all_ok;
+  }
+  all_ok = check_range(dclass) && all_ok;
+
+  DCField *friends = dclass->get_field_by_name("setFriends");
+  nassertr(friends != (DCField *)NULL, 1);
+  if (friends->get_program() != (DCFieldProgram *)NULL) {
+    nout << "setFriends has an array, but was compiled anyway\n";
+    all_ok = false;
+  }
+
+  if (!all_ok) {
+    return 1;
+  }
+  nout << "All tests passed.\n";
+  return 0;
+}
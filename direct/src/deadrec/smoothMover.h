@@ -69,6 +69,16 @@ PUBLISHED:
   INLINE bool set_pos_hpr(const LVecBase3 &pos, const LVecBase3 &hpr);
   INLINE bool set_pos_hpr(PN_stdfloat x, PN_stdfloat y, PN_stdfloat z, PN_stdfloat h, PN_stdfloat p, PN_stdfloat r);
 
+  // These methods may be used instead of the corresponding set_*
+  // functions when the update gives the change from the previous
+  // position, rather than the new position itself.
+  INLINE bool add_x(PN_stdfloat dx);
+  INLINE bool add_y(PN_stdfloat dy);
+  INLINE bool add_z(PN_stdfloat dz);
+  INLINE bool add_h(PN_stdfloat dh);
+  INLINE bool add_p(PN_stdfloat dp);
+  INLINE bool add_r(PN_stdfloat dr);
+
   INLINE const LPoint3 &get_sample_pos() const;
   INLINE const LVecBase3 &get_sample_hpr() const;
 
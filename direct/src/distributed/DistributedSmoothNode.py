@@ -275,6 +275,40 @@ class DistributedSmoothNode(DistributedNode.DistributedNode,
         self.setComponentR(r)
         self.setComponentTLive(timestamp)
 
+    # These are sent in place of the above when only a small change
+    # in position has been made since the previous update.
+    def setSmDeltaH(self, dh, timestamp=None):
+        self._checkResume(timestamp)
+        self.setComponentDH(dh)
+        self.setComponentTLive(timestamp)
+    def setSmDeltaXY(self, dx, dy, timestamp=None):
+        self._checkResume(timestamp)
+        self.setComponentDX(dx)
+        self.setComponentDY(dy)
+        self.setComponentTLive(timestamp)
+    def setSmDeltaXYH(self, dx, dy, dh, timestamp=None):
+        self._checkResume(timestamp)
+        self.setComponentDX(dx)
+        self.setComponentDY(dy)
+        self.setComponentDH(dh)
+        self.setComponentTLive(timestamp)
+    def setSmDeltaXYZH(self, dx, dy, dz, dh, timestamp=None):
+        self._checkResume(timestamp)
+        self.setComponentDX(dx)
+        self.setComponentDY(dy)
+        self.setComponentDZ(dz)
+        self.setComponentDH(dh)
+        self.setComponentTLive(timestamp)
+    def setSmDeltaPosHpr(self, dx, dy, dz, dh, dp, dr, timestamp=None):
+        self._checkResume(timestamp)
+        self.setComponentDX(dx)
+        self.setComponentDY(dy)
+        self.setComponentDZ(dz)
+        self.setComponentDH(dh)
+        self.setComponentDP(dp)
+        self.setComponentDR(dr)
+        self.setComponentTLive(timestamp)
+
     ### component set pos and hpr functions ###
 
     ### These are the component functions that are invoked
@@ -299,6 +333,24 @@ class DistributedSmoothNode(DistributedNode.DistributedNode,
     def setComponentR(self, r):
         self.smoother.setR(r)
     @report(types = ['args'], dConfigParam = 'smoothnode')
+    def setComponentDX(self, dx):
+        self.smoother.addX(dx)
+    @report(types = ['args'], dConfigParam = 'smoothnode')
+    def setComponentDY(self, dy):
+        self.smoother.addY(dy)
+    @report(types = ['args'], dConfigParam = 'smoothnode')
+    def setComponentDZ(self, dz):
+        self.smoother.addZ(dz)
+    @report(types = ['args'], dConfigParam = 'smoothnode')
+    def setComponentDH(self, dh):
+        self.smoother.addH(dh)
+    @report(types = ['args'], dConfigParam = 'smoothnode')
+    def setComponentDP(self, dp):
+        self.smoother.addP(dp)
+    @report(types = ['args'], dConfigParam = 'smoothnode')
+    def setComponentDR(self, dr):
+        self.smoother.addR(dr)
+    @report(types = ['args'], dConfigParam = 'smoothnode')
     def setComponentL(self, l):
         if (l != self.zoneId):
             # only perform set location if location is different
@@ -63,6 +63,32 @@ class DistributedSmoothNodeAI(DistributedNodeAI.DistributedNodeAI,
     def setSmPosHprL(self, l, x, y, z, h, p, r, t=None):
         self.setPosHpr(x, y, z, h, p, r)
 
+    def setSmDeltaH(self, dh, t=None):
+        self.setComponentDH(dh)
+
+    def setSmDeltaXY(self, dx, dy, t=None):
+        self.setComponentDX(dx)
+        self.setComponentDY(dy)
+
+    def setSmDeltaXYH(self, dx, dy, dh, t=None):
+        self.setComponentDX(dx)
+        self.setComponentDY(dy)
+        self.setComponentDH(dh)
+
+    def setSmDeltaXYZH(self, dx, dy, dz, dh, t=None):
+        self.setComponentDX(dx)
+        self.setComponentDY(dy)
+        self.setComponentDZ(dz)
+        self.setComponentDH(dh)
+
+    def setSmDeltaPosHpr(self, dx, dy, dz, dh, dp, dr, t=None):
+        self.setComponentDX(dx)
+        self.setComponentDY(dy)
+        self.setComponentDZ(dz)
+        self.setComponentDH(dh)
+        self.setComponentDP(dp)
+        self.setComponentDR(dr)
+
     def clearSmoothing(self, bogus = None):
         pass
 
@@ -80,6 +106,18 @@ class DistributedSmoothNodeAI(DistributedNodeAI.DistributedNodeAI,
         self.setP(p)
     def setComponentR(self, r):
         self.setR(r)
+    def setComponentDX(self, dx):
+        self.setX(self.getX() + dx)
+    def setComponentDY(self, dy):
+        self.setY(self.getY() + dy)
+    def setComponentDZ(self, dz):
+        self.setZ(self.getZ() + dz)
+    def setComponentDH(self, dh):
+        self.setH(self.getH() + dh)
+    def setComponentDP(self, dp):
+        self.setP(self.getP() + dp)
+    def setComponentDR(self, dr):
+        self.setR(self.getR() + dr)
     def setComponentL(self, l):
         pass
     def setComponentT(self, t):
@@ -23,3 +23,39 @@
 
   #define IGATESCAN all
 #end lib_target
+
+#begin test_bin_target
+  #define BUILD_TARGET $[and $[HAVE_PYTHON],$[HAVE_NET]]
+  #define USE_PACKAGES openssl native_net net
+
+  #define TARGET test_smooth_delta
+  #define LOCAL_LIBS \
+    p3distributed p3deadrec p3directbase p3dcparser
+  #define OTHER_LIBS \
+    p3event:c p3downloader:c panda:m p3express:c pandaexpress:m \
+    p3interrogatedb:c p3dconfig:c p3dtoolconfig:m \
+    p3dtoolutil:c p3dtoolbase:c p3dtool:m \
+    p3prc:c p3pstatclient:c p3pandabase:c p3linmath:c p3putil:c \
+    p3pipeline:c $[if $[HAVE_NET],p3net:c] $[if $[WANT_NATIVE_NET],p3nativenet:c]
+
+  #define SOURCES \
+    test_smooth_delta.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define BUILD_TARGET $[and $[HAVE_PYTHON],$[HAVE_NET]]
+  #define USE_PACKAGES openssl native_net net
+
+  #define TARGET test_dispatch
+  #define LOCAL_LIBS \
+    p3distributed p3directbase p3dcparser
+  #define OTHER_LIBS \
+    p3event:c p3downloader:c panda:m p3express:c pandaexpress:m \
+    p3interrogatedb:c p3dconfig:c p3dtoolconfig:m \
+    p3dtoolutil:c p3dtoolbase:c p3dtool:m \
+    p3prc:c p3pstatclient:c p3pandabase:c p3linmath:c p3putil:c \
+    p3pipeline:c $[if $[HAVE_NET],p3net:c] $[if $[WANT_NATIVE_NET],p3nativenet:c]
+
+  #define SOURCES \
+    test_dispatch.cxx
+#end test_bin_target
@@ -16,6 +16,7 @@
 #include "dcmsgtypes.h"
 #include "dcClass.h"
 #include "dcPacker.h"
+#include "dcFieldProgram.h"
 
 #include "config_distributed.h"
 #include "config_downloader.h"
@@ -24,6 +25,8 @@
 #include "datagramIterator.h"
 #include "throw_event.h"
 #include "pStatTimer.h"
+#include "mutexHolder.h"
+#include "string_utils.h"
 
 #ifdef HAVE_PYTHON
 #ifndef CPPPARSER
@@ -56,7 +59,7 @@ CConnectionRepository(bool has_owner_view, bool threaded_net) :
 #endif
 #ifdef HAVE_NET
   _cw(&_qcm, threaded_net ? 1 : 0),
-  _qcr(&_qcm, threaded_net ? 1 : 0),
+  _qcr(this, &_qcm, threaded_net ? 1 : 0),
 #endif
 #ifdef WANT_NATIVE_NET
   _bdc(4096000,4096000,1400),
@@ -74,7 +77,19 @@ CConnectionRepository(bool has_owner_view, bool threaded_net) :
   _handle_c_updates(true),
   _want_message_bundling(true),
   _bundling_msgs(0),
-  _in_quiet_zone(0)
+  _in_quiet_zone(0),
+  _num_dispatch_threads(0),
+  _dispatched_field(NULL),
+  _dispatched_start(0),
+  _dispatched_end(0)
+#ifdef HAVE_NET
+  ,
+  _dispatch_mutex("CConnectionRepository::_dispatch_mutex"),
+  _dispatch_cvar(_dispatch_mutex),
+  _dispatch_shutdown(false),
+  _next_receive_seq(0),
+  _next_apply_seq(0)
+#endif
 {
 #if defined(HAVE_NET) && defined(SIMULATE_NETWORK_DELAY)
   if (min_lag != 0.0 || max_lag != 0.0) {
@@ -89,6 +104,9 @@ CConnectionRepository(bool has_owner_view, bool threaded_net) :
       _python_ai_datagramiterator = Py_BuildValue("(O)",PyDitterator);
 #endif
 
+  if (cr_num_dispatch_threads > 0) {
+    set_num_dispatch_threads(cr_num_dispatch_threads);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -98,7 +116,15 @@ CConnectionRepository(bool has_owner_view, bool threaded_net) :
 ////////////////////////////////////////////////////////////////////
 CConnectionRepository::
 ~CConnectionRepository() {
+#ifdef HAVE_NET
+  stop_dispatch_threads();
+#endif
   disconnect();
+#ifdef HAVE_NET
+  // Make sure the reader threads are gone before the members they
+  // notify are destructed.
+  _qcr.shutdown();
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -126,6 +152,41 @@ set_tcp_header_size(int tcp_header_size) {
 #endif
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::set_num_dispatch_threads
+//       Access: Published
+//  Description: Specifies the number of threads that should receive
+//               datagrams from the server, parse their headers, and
+//               find and check the field data of each update, so
+//               that check_datagram() has only to apply the results.
+//               Messages are still applied strictly in the order they
+//               were received.  Set this to 0 to do all of the work
+//               within check_datagram(), the default.
+//
+//               This is only useful with a connection made by
+//               try_connect_net(), preferably with threaded_net.  The
+//               threads are not started until the next call to
+//               check_datagram() on a connected repository, since
+//               they consult the dc file, which may not have been
+//               read yet.  The initial value comes from
+//               cr-num-dispatch-threads.
+////////////////////////////////////////////////////////////////////
+void CConnectionRepository::
+set_num_dispatch_threads(int num_threads) {
+  ReMutexHolder holder(_lock);
+
+#ifdef HAVE_NET
+  if (!Thread::is_threading_supported()) {
+    num_threads = 0;
+  }
+  num_threads = max(num_threads, 0);
+  if (num_threads != _num_dispatch_threads) {
+    stop_dispatch_threads();
+    _num_dispatch_threads = num_threads;
+  }
+#endif  // HAVE_NET
+}
+
 #ifdef HAVE_OPENSSL
 ////////////////////////////////////////////////////////////////////
 //     Function: CConnectionRepository::set_connection_http
@@ -298,24 +359,8 @@ check_datagram() {
     _bdc.Flush();
   #endif //WANT_NATIVE_NET
 
-  while (do_check_datagram()) {
-    if (get_verbose()) {
-      describe_message(nout, "RECV", _dg);
-    }
-
-    // Start breaking apart the datagram.
-    _di = DatagramIterator(_dg);
-
+  while (read_next_message()) {
     if (!_client_datagram) {
-      unsigned char  wc_cnt;
-      wc_cnt = _di.get_uint8();
-      _msg_channels.clear();
-      for (unsigned char lp1 = 0; lp1 < wc_cnt; lp1++) {
-        CHANNEL_TYPE  schan  = _di.get_uint64();
-        _msg_channels.push_back(schan);
-      }
-      _msg_sender = _di.get_uint64();
-      
 #ifdef HAVE_PYTHON
       // For now, we need to stuff this field onto the Python
       // structure, to support legacy code that expects to find it
@@ -335,7 +380,6 @@ check_datagram() {
 #endif  // HAVE_PYTHON
     }
 
-    _msg_type = _di.get_uint16();
     // Is this a message that we can process directly?
     if (!_handle_datagrams_internally) {
       return true;
@@ -661,6 +705,10 @@ disconnect() {
     _qcm.close_connection(_net_conn);
     _net_conn = NULL;
   }
+
+  // Discard whatever the dispatch threads had received from the old
+  // connection.
+  reset_dispatch();
   #endif  // HAVE_NET
 
   #ifdef HAVE_OPENSSL
@@ -682,6 +730,10 @@ disconnect() {
 ////////////////////////////////////////////////////////////////////
 void CConnectionRepository::
 shutdown() {
+  #ifdef HAVE_NET
+  stop_dispatch_threads();
+  #endif  // HAVE_NET
+
   disconnect();
 
   #ifdef HAVE_NET
@@ -725,6 +777,64 @@ do_check_datagram() {
   return false;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::read_next_message
+//       Access: Private
+//  Description: Gets the next datagram, if one is available, and
+//               parses its header into _msg_channels, _msg_sender,
+//               and _msg_type, leaving _di positioned just after the
+//               message type.  Returns true if there is a message,
+//               false if there is none.
+//
+//               If dispatch threads are running, the message comes
+//               already parsed from them; otherwise, it is read and
+//               parsed here.
+////////////////////////////////////////////////////////////////////
+bool CConnectionRepository::
+read_next_message() {
+  _dispatched_field = NULL;
+
+#ifdef HAVE_NET
+  if (_net_conn && _num_dispatch_threads > 0 && _dispatch_threads.empty()) {
+    // The dispatch threads are started here, rather than when they
+    // are requested, so that the dc file has been read by the time
+    // they look at it.
+    start_dispatch_threads();
+  }
+
+  // Once the threads have been stopped, we must still deliver
+  // whatever they had received before we read any more ourselves.
+  if (_net_conn && (!_dispatch_threads.empty() || !_ready.empty())) {
+    return check_dispatched_datagram();
+  }
+#endif  // HAVE_NET
+
+  if (!do_check_datagram()) {
+    return false;
+  }
+
+  if (get_verbose()) {
+    describe_message(nout, "RECV", _dg);
+  }
+
+  // Start breaking apart the datagram.
+  _di = DatagramIterator(_dg);
+
+  if (!_client_datagram) {
+    unsigned char  wc_cnt;
+    wc_cnt = _di.get_uint8();
+    _msg_channels.clear();
+    for (unsigned char lp1 = 0; lp1 < wc_cnt; lp1++) {
+      CHANNEL_TYPE  schan  = _di.get_uint64();
+      _msg_channels.push_back(schan);
+    }
+    _msg_sender = _di.get_uint64();
+  }
+
+  _msg_type = _di.get_uint16();
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: CConnectionRepository::handle_update_field
 //       Access: Private
@@ -794,7 +904,7 @@ handle_update_field() {
       // method might get into trouble if it tried to delete the
       // object from the doId2do map.
       Py_INCREF(distobj);
-      dclass->receive_update(distobj, _di); 
+      receive_update(dclass, distobj, _di);
       Py_DECREF(distobj);
       
       if (PyErr_Occurred()) {
@@ -880,7 +990,7 @@ handle_update_field_owner() {
         // make a copy of the datagram iterator so that we can use the main
         // iterator for the non-owner update
         DatagramIterator _odi(_di);
-        dclass->receive_update(distobjOV, _odi); 
+        receive_update(dclass, distobjOV, _odi);
         Py_DECREF(distobjOV);
       
         if (PyErr_Occurred()) {
@@ -919,7 +1029,7 @@ handle_update_field_owner() {
         // method might get into trouble if it tried to delete the
         // object from the doId2do map.
         Py_INCREF(distobj);
-        dclass->receive_update(distobj, _di); 
+        receive_update(dclass, distobj, _di);
         Py_DECREF(distobj);
       
         if (PyErr_Occurred()) {
@@ -940,6 +1050,369 @@ handle_update_field_owner() {
   return true;
 }
 
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::receive_update
+//       Access: Private
+//  Description: Applies the field update in the indicated iterator to
+//               the object, as DCClass::receive_update() does.  If a
+//               dispatch thread has already unpacked the field's
+//               values, this only has to build the Python objects
+//               from them.
+////////////////////////////////////////////////////////////////////
+void CConnectionRepository::
+receive_update(DCClass *dclass, PyObject *distobj, DatagramIterator &di) {
+  const DCField *field = _dispatched_field;
+  if (field != (DCField *)NULL &&
+      di.get_current_index() == _dispatched_start &&
+      dclass->get_field_by_index(field->get_number()) == field) {
+    if (field->receive_update(_dispatched_values, distobj)) {
+      di.skip_bytes(_dispatched_end - _dispatched_start);
+      return;
+    }
+  }
+
+  dclass->receive_update(distobj, di);
+}
+#endif  // HAVE_PYTHON
+
+#ifdef HAVE_NET
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::check_dispatched_datagram
+//       Access: Private
+//  Description: The dispatch-thread version of read_next_message():
+//               takes the next message in sequence from the dispatch
+//               threads, if it has arrived.  Returns true if there
+//               is a message, false if there is none yet.
+////////////////////////////////////////////////////////////////////
+bool CConnectionRepository::
+check_dispatched_datagram() {
+  _net_conn->consider_flush();
+  if (_qcr.get_overflow_flag()) {
+    throw_event(get_overflow_event_name());
+    _qcr.reset_overflow_flag();
+  }
+
+  if (!_dispatch_threads.empty() && _qcr.data_available()) {
+    // If the reader is polled instead of threaded, or is delaying
+    // datagrams, this is where they get queued up.  Wake up a
+    // dispatch thread to take them.
+    MutexHolder holder(_dispatch_mutex);
+    _dispatch_cvar.notify();
+  }
+
+  if (_ready.empty()) {
+    // Collect all of the messages that are ready, in order, in one go.
+    MutexHolder holder(_dispatch_mutex);
+    bool was_full = 
+      ((int)(_next_receive_seq - _next_apply_seq) >= cr_dispatch_queue_size);
+
+    Dispatched::iterator mi = _dispatched.find(_next_apply_seq);
+    while (mi != _dispatched.end()) {
+      _ready.push_back((*mi).second);
+      _dispatched.erase(mi);
+      ++_next_apply_seq;
+      mi = _dispatched.find(_next_apply_seq);
+    }
+
+    if (_ready.empty()) {
+      // Either nothing has been received, or the next message is
+      // still being parsed.
+      return false;
+    }
+    if (was_full) {
+      // The dispatch threads may be waiting for room.
+      _dispatch_cvar.notify_all();
+    }
+  }
+
+  DispatchedMessage &msg = _ready.front();
+  _dg = msg._dg;
+  if (get_verbose()) {
+    describe_message(nout, "RECV", _dg);
+  }
+
+  _di = DatagramIterator(_dg, msg._body_index);
+  if (!_client_datagram) {
+    _msg_channels.swap(msg._msg_channels);
+    _msg_sender = msg._msg_sender;
+  }
+  _msg_type = msg._msg_type;
+  _dispatched_field = msg._field;
+  if (_dispatched_field != (DCField *)NULL) {
+    _dispatched_values.swap(msg._values);
+    _dispatched_start = msg._field_start;
+    _dispatched_end = msg._field_end;
+  }
+  _ready.pop_front();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::start_dispatch_threads
+//       Access: Private
+//  Description: Starts the number of dispatch threads requested by
+//               set_num_dispatch_threads().  None may already be
+//               running.
+////////////////////////////////////////////////////////////////////
+void CConnectionRepository::
+start_dispatch_threads() {
+  nassertv(_dispatch_threads.empty());
+  int num_threads = _num_dispatch_threads;
+  if (num_threads == 0) {
+    return;
+  }
+
+  {
+    MutexHolder holder(_dispatch_mutex);
+    _dispatch_shutdown = false;
+  }
+
+  int i;
+  for (i = 0; i < num_threads; ++i) {
+    PT(DispatchThread) thread = new DispatchThread(this, i);
+    _dispatch_threads.push_back(thread);
+  }
+  for (i = 0; i < num_threads; ++i) {
+    _dispatch_threads[i]->start(TP_normal, true);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::stop_dispatch_threads
+//       Access: Private
+//  Description: Stops all of the dispatch threads and waits for them
+//               to finish.  Any messages they have already received
+//               remain to be returned by check_datagram().
+////////////////////////////////////////////////////////////////////
+void CConnectionRepository::
+stop_dispatch_threads() {
+  if (_dispatch_threads.empty()) {
+    return;
+  }
+
+  {
+    MutexHolder holder(_dispatch_mutex);
+    _dispatch_shutdown = true;
+    _dispatch_cvar.notify_all();
+  }
+
+  DispatchThreads::iterator ti;
+  for (ti = _dispatch_threads.begin(); ti != _dispatch_threads.end(); ++ti) {
+    (*ti)->join();
+  }
+  _dispatch_threads.clear();
+
+  // Every batch taken by the threads has now been parsed and stored,
+  // so the messages in _dispatched run without a gap from
+  // _next_apply_seq.  Move them all to _ready, where check_datagram()
+  // will find them.
+  MutexHolder holder(_dispatch_mutex);
+  Dispatched::iterator mi = _dispatched.find(_next_apply_seq);
+  while (mi != _dispatched.end()) {
+    _ready.push_back((*mi).second);
+    _dispatched.erase(mi);
+    ++_next_apply_seq;
+    mi = _dispatched.find(_next_apply_seq);
+  }
+  nassertv(_dispatched.empty() && _next_apply_seq == _next_receive_seq);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::reset_dispatch
+//       Access: Private
+//  Description: Called when the connection is closed to discard any
+//               messages the dispatch threads have received, or were
+//               about to receive, but check_datagram() has not yet
+//               returned.  The threads are stopped, and will be
+//               started again by the first check_datagram() on the
+//               next connection.
+////////////////////////////////////////////////////////////////////
+void CConnectionRepository::
+reset_dispatch() {
+  bool was_running = !_dispatch_threads.empty();
+  stop_dispatch_threads();
+
+  if (was_running) {
+    // The threads would have taken these next.
+    Datagram dg;
+    while (_qcr.get_data(dg)) {
+    }
+  }
+
+  _ready.clear();
+  _dispatched_field = NULL;
+  _dispatched_values.clear();
+  {
+    MutexHolder holder(_dispatch_mutex);
+    _dispatched.clear();
+    _next_receive_seq = 0;
+    _next_apply_seq = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::dispatch_thread_run
+//       Access: Private
+//  Description: The main loop of each dispatch thread.  Takes
+//               datagrams from the reader a batch at a time,
+//               numbering them in the order received, and parses
+//               each one into _dispatched for check_datagram() to
+//               apply.  Sleeps while there is nothing to take.
+////////////////////////////////////////////////////////////////////
+void CConnectionRepository::
+dispatch_thread_run() {
+  // Take no more than this many datagrams at once, so that a burst
+  // is still shared among the threads.
+  static const int max_batch_size = 16;
+
+  DispatchBatch batch(max_batch_size);
+  while (true) {
+    unsigned int first_seq;
+    int count = 0;
+    {
+      MutexHolder holder(_dispatch_mutex);
+      while (true) {
+        if (_dispatch_shutdown) {
+          return;
+        }
+
+        int room = cr_dispatch_queue_size - 
+          (int)(_next_receive_seq - _next_apply_seq);
+        int max_count = min(room, max_batch_size);
+        while (count < max_count && _qcr.get_data(batch[count]._dg)) {
+          ++count;
+        }
+        if (count != 0) {
+          break;
+        }
+
+        // Nothing has arrived yet, or the main thread has fallen
+        // behind.  Either way, we'll be woken up when that changes.
+        _dispatch_cvar.wait();
+      }
+
+      first_seq = _next_receive_seq;
+      _next_receive_seq += count;
+    }
+
+    int i;
+    for (i = 0; i < count; ++i) {
+      parse_dispatched_message(batch[i]);
+    }
+
+    MutexHolder holder(_dispatch_mutex);
+    for (i = 0; i < count; ++i) {
+      _dispatched[first_seq + i] = batch[i];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::parse_dispatched_message
+//       Access: Private
+//  Description: Called in a dispatch thread to parse the header of a
+//               newly-received datagram, as read_next_message()
+//               would.  If it is a field update, also finds the field
+//               and unpacks its values with the field's compiled
+//               program, so that the main thread has only to build
+//               the Python objects from them.
+//
+//               This must not touch Python, or anything else the
+//               main thread might be modifying.
+////////////////////////////////////////////////////////////////////
+void CConnectionRepository::
+parse_dispatched_message(DispatchedMessage &msg) const {
+  DatagramIterator di(msg._dg);
+
+  msg._msg_channels.clear();
+  msg._msg_sender = 0;
+  if (!_client_datagram) {
+    unsigned char wc_cnt = di.get_uint8();
+    for (unsigned char lp1 = 0; lp1 < wc_cnt; lp1++) {
+      msg._msg_channels.push_back(di.get_uint64());
+    }
+    msg._msg_sender = di.get_uint64();
+  }
+
+  msg._msg_type = di.get_uint16();
+  msg._body_index = di.get_current_index();
+  msg._field = NULL;
+
+  if ((msg._msg_type == CLIENT_OBJECT_UPDATE_FIELD ||
+       msg._msg_type == STATESERVER_OBJECT_UPDATE_FIELD) &&
+      di.get_remaining_size() >= 6) {
+    // Skip the doId; the object itself can only be looked up in
+    // Python.
+    di.skip_bytes(4);
+    size_t start = di.get_current_index();
+    int field_id = di.get_uint16();
+    const DCField *field = _dc_file.get_field_by_index(field_id);
+    if (field != (DCField *)NULL) {
+      const DCFieldProgram *program = field->get_program();
+      size_t p = di.get_current_index();
+      if (program != (DCFieldProgram *)NULL &&
+          program->unpack_values((const char *)msg._dg.get_data(),
+                                 msg._dg.get_length(), p, msg._values)) {
+        msg._field = field;
+        msg._field_start = start;
+        msg._field_end = p;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::DispatchReader::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+CConnectionRepository::DispatchReader::
+DispatchReader(CConnectionRepository *repository,
+               ConnectionManager *manager, int num_threads) :
+  QueuedConnectionReader(manager, num_threads),
+  _repository(repository)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::DispatchReader::receive_datagram
+//       Access: Protected, Virtual
+//  Description: Queues up the datagram as usual, and then wakes a
+//               dispatch thread, if any are waiting, to take it.
+////////////////////////////////////////////////////////////////////
+void CConnectionRepository::DispatchReader::
+receive_datagram(const NetDatagram &datagram) {
+  QueuedConnectionReader::receive_datagram(datagram);
+
+  MutexHolder holder(_repository->_dispatch_mutex);
+  _repository->_dispatch_cvar.notify();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::DispatchThread::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+CConnectionRepository::DispatchThread::
+DispatchThread(CConnectionRepository *repository, int thread_index) :
+  Thread("dispatch_" + format_string(thread_index),
+         "dispatch_" + format_string(thread_index)),
+  _repository(repository)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::DispatchThread::thread_main
+//       Access: Public, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+void CConnectionRepository::DispatchThread::
+thread_main() {
+  _repository->dispatch_thread_run();
+}
+#endif  // HAVE_NET
+
 ////////////////////////////////////////////////////////////////////
 //     Function: CConnectionRepository::describe_message
 //       Access: Private
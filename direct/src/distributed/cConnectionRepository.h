@@ -21,11 +21,18 @@
 #include "dcbase.h"
 #include "dcFile.h"
 #include "dcField.h"  // to pick up Python.h
+#include "dcFieldProgram.h"
 #include "pStatCollector.h"
 #include "datagramIterator.h"
 #include "clockObject.h"
 #include "reMutex.h"
 #include "reMutexHolder.h"
+#include "pmutex.h"
+#include "conditionVarFull.h"
+#include "thread.h"
+#include "pvector.h"
+#include "pdeque.h"
+#include "pmap.h"
 
 #ifdef HAVE_NET
 #include "queuedConnectionManager.h"
@@ -57,6 +64,11 @@ class SocketStream;
 //               handled entirely within the C++ layer, while server
 //               messages that are not understood by the C++ layer are
 //               returned up to the Python layer for processing.
+//
+//               Optionally, with set_num_dispatch_threads(), the
+//               datagrams may be received and picked apart by a pool
+//               of threads, leaving only the application of each
+//               message to the main thread.
 ////////////////////////////////////////////////////////////////////
 class EXPCL_DIRECT CConnectionRepository {
 PUBLISHED:
@@ -90,6 +102,9 @@ PUBLISHED:
   void set_tcp_header_size(int tcp_header_size);
   INLINE int get_tcp_header_size() const;
 
+  BLOCKING void set_num_dispatch_threads(int num_threads);
+  INLINE int get_num_dispatch_threads() const;
+
 #ifdef HAVE_PYTHON
   INLINE void set_python_repository(PyObject *python_repository);
 #endif
@@ -175,8 +190,24 @@ private:
 
 
   bool do_check_datagram();
+  bool read_next_message();
   bool handle_update_field();
   bool handle_update_field_owner();
+#ifdef HAVE_PYTHON
+  void receive_update(DCClass *dclass, PyObject *distobj,
+                      DatagramIterator &di);
+#endif
+
+#ifdef HAVE_NET
+  class DispatchedMessage;
+
+  bool check_dispatched_datagram();
+  void start_dispatch_threads();
+  void stop_dispatch_threads();
+  void reset_dispatch();
+  void dispatch_thread_run();
+  void parse_dispatched_message(DispatchedMessage &msg) const;
+#endif
 
   void describe_message(ostream &out, const string &prefix, 
                         const Datagram &dg) const;
@@ -194,9 +225,23 @@ private:
 #endif
 
 #ifdef HAVE_NET
+  // This reader also wakes the dispatch threads as each datagram
+  // arrives.
+  class DispatchReader : public QueuedConnectionReader {
+  public:
+    DispatchReader(CConnectionRepository *repository,
+                   ConnectionManager *manager, int num_threads);
+
+  protected:
+    virtual void receive_datagram(const NetDatagram &datagram);
+
+  private:
+    CConnectionRepository *_repository;
+  };
+
   QueuedConnectionManager _qcm;
   ConnectionWriter _cw;
-  QueuedConnectionReader _qcr;
+  DispatchReader _qcr;
   PT(Connection) _net_conn;
 #endif
 
@@ -231,6 +276,69 @@ private:
   BundledMsgVector _bundle_msgs;
 
   static PStatCollector _update_pcollector;
+
+  // The number of dispatch threads requested by
+  // set_num_dispatch_threads().  They are not started until the next
+  // check_datagram(); until then, _dispatch_threads is empty.
+  int _num_dispatch_threads;
+
+  // If the update in _di was already unpacked by a dispatch thread,
+  // this is the field it updates, and _dispatched_values holds its
+  // values, which were read from the bytes [_dispatched_start,
+  // _dispatched_end) of _dg; otherwise _dispatched_field is NULL.
+  const DCField *_dispatched_field;
+  DCFieldProgram::Values _dispatched_values;
+  size_t _dispatched_start;
+  size_t _dispatched_end;
+
+#ifdef HAVE_NET
+  // A datagram received by one of the dispatch threads, with its
+  // header already parsed, and for a field update, the field's values
+  // already unpacked.
+  class DispatchedMessage {
+  public:
+    Datagram _dg;
+    size_t _body_index;
+    unsigned int _msg_type;
+    CHANNEL_TYPE _msg_sender;
+    std::vector<CHANNEL_TYPE> _msg_channels;
+    const DCField *_field;
+    DCFieldProgram::Values _values;
+    size_t _field_start;
+    size_t _field_end;
+  };
+  typedef pvector<DispatchedMessage> DispatchBatch;
+
+  class DispatchThread : public Thread {
+  public:
+    DispatchThread(CConnectionRepository *repository, int thread_index);
+    virtual void thread_main();
+
+    CConnectionRepository *_repository;
+  };
+  typedef pvector< PT(DispatchThread) > DispatchThreads;
+  DispatchThreads _dispatch_threads;
+
+  // The dispatch threads take a batch of datagrams at a time from
+  // the reader under _dispatch_mutex, so that the batches are
+  // numbered in the order received, and sleep on _dispatch_cvar when
+  // there are none, or when _dispatched is full.  They then parse
+  // their batches in parallel, and store the results in _dispatched;
+  // the main thread moves them from there to _ready strictly in
+  // sequence order, and applies them one at a time from _ready.
+  Mutex _dispatch_mutex;
+  ConditionVarFull _dispatch_cvar;
+  bool _dispatch_shutdown;
+  unsigned int _next_receive_seq;
+  unsigned int _next_apply_seq;
+  typedef pmap<unsigned int, DispatchedMessage> Dispatched;
+  Dispatched _dispatched;
+  typedef pdeque<DispatchedMessage> Ready;
+  Ready _ready;
+
+  friend class DispatchThread;
+  friend class DispatchReader;
+#endif  // HAVE_NET
 };
 
 #include "cConnectionRepository.I"
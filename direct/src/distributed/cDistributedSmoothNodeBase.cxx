@@ -16,12 +16,30 @@
 #include "cConnectionRepository.h"
 #include "dcField.h"
 #include "dcClass.h"
+#include "dcMolecularField.h"
+#include "dcAtomicField.h"
 #include "dcmsgtypes.h"
 #include "config_distributed.h"
 
 static const PN_stdfloat smooth_node_epsilon = 0.01;
 static const double network_time_precision = 100.0;  // Matches ClockDelta.py
 
+// The setSmDelta* fields that try_send_delta() may choose from, in
+// increasing order of size, with the components each one carries.
+static const struct {
+  int _flags;
+  const char *_field_name;
+} delta_fields[] = {
+  { 0x08, "setSmDeltaH" },
+  { 0x03, "setSmDeltaXY" },
+  { 0x0b, "setSmDeltaXYH" },
+  { 0x0f, "setSmDeltaXYZH" },
+  { 0x3f, "setSmDeltaPosHpr" },
+};
+static const int num_delta_fields = sizeof(delta_fields) / sizeof(delta_fields[0]);
+
+size_t CDistributedSmoothNodeBase::_total_bytes_sent = 0;
+
 ////////////////////////////////////////////////////////////////////
 //     Function: CDistributedSmoothNodeBase::Constructor
 //       Access: Published
@@ -39,6 +57,9 @@ CDistributedSmoothNodeBase() {
 
   _currL[0] = 0;
   _currL[1] = 0;
+
+  _delta_known = 0;
+  _delta_count = 0;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -70,6 +91,12 @@ initialize(const NodePath &node_path, DCClass *dclass, CHANNEL_TYPE do_id) {
   _store_xyz = _node_path.get_pos();
   _store_hpr = _node_path.get_hpr();
   _store_stop = false;
+
+  // We don't know what the receivers have heard before now.
+  _sent_xyz = _store_xyz;
+  _sent_hpr = _store_hpr;
+  _delta_known = 0;
+  _delta_count = 0;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -144,6 +171,10 @@ broadcast_pos_hpr_full() {
       d_setSmStop();
     }
 
+  } else if (try_send_delta(flags)) {
+    // Sent as an offset from the previous position.
+    _store_stop = false;
+
   } else if (only_changed(flags, F_new_h)) {
     // Only change in H.
     _store_stop = false;
@@ -227,6 +258,10 @@ broadcast_pos_hpr_xyh() {
       d_setSmStop();
     }
 
+  } else if (try_send_delta(flags)) {
+    // Sent as an offset from the previous position.
+    _store_stop = false;
+
   } else if (only_changed(flags, F_new_h)) {
     // Only change in H.
     _store_stop = false;
@@ -273,6 +308,10 @@ broadcast_pos_hpr_xy() {
       d_setSmStop();
     }
 
+  } else if (try_send_delta(flags)) {
+    // Sent as an offset from the previous position.
+    _store_stop = false;
+
   } else {
     // Any other change.
     _store_stop = false;
@@ -280,6 +319,120 @@ broadcast_pos_hpr_xy() {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: CDistributedSmoothNodeBase::try_send_delta
+//       Access: Private
+//  Description: Attempts to broadcast the indicated changed
+//               components as offsets from the position last sent,
+//               using the smallest of the setSmDelta* fields that the
+//               dc class defines.  Returns true if the update was
+//               sent.
+//
+//               Returns false if the offsets can't be sent, for
+//               instance because an offset is out of range for the
+//               field, or it is time for an absolute refresh.  In
+//               this case the caller will send the components in
+//               full, and the d_setSm* function that does so records
+//               them as sent.
+////////////////////////////////////////////////////////////////////
+bool CDistributedSmoothNodeBase::
+try_send_delta(int flags) {
+  if (!smooth_node_delta_encoding || (flags & ~_delta_known) != 0 ||
+      _delta_count >= smooth_node_delta_refresh) {
+    return false;
+  }
+
+  const DCMolecularField *field = NULL;
+  int i = 0;
+  while (field == (DCMolecularField *)NULL && i < num_delta_fields) {
+    if ((flags & ~delta_fields[i]._flags) == 0) {
+      DCField *f = _dclass->get_field_by_name(delta_fields[i]._field_name);
+      if (f != (DCField *)NULL) {
+        field = f->as_molecular_field();
+      }
+    }
+    ++i;
+  }
+  if (field == (DCMolecularField *)NULL) {
+    return false;
+  }
+  int field_flags = delta_fields[i - 1]._flags;
+
+  DCPacker packer;
+  begin_send_update(packer, field->get_name());
+
+  // Each offset is rounded to the precision of its component in the
+  // dc file, and the receivers will add exactly that rounded value
+  // to what they had before.  We keep the same sum here, so the
+  // rounding errors don't accumulate from one offset to the next.
+  PN_stdfloat sent[6] = {
+    _sent_xyz[0], _sent_xyz[1], _sent_xyz[2],
+    _sent_hpr[0], _sent_hpr[1], _sent_hpr[2],
+  };
+  PN_stdfloat store[6] = {
+    _store_xyz[0], _store_xyz[1], _store_xyz[2],
+    _store_hpr[0], _store_hpr[1], _store_hpr[2],
+  };
+
+  int atomic_index = 0;
+  for (int c = 0; c < 6; ++c) {
+    if ((field_flags & (1 << c)) == 0) {
+      continue;
+    }
+    DCAtomicField *atomic = field->get_atomic(atomic_index);
+    ++atomic_index;
+    nassertr(atomic != (DCAtomicField *)NULL && atomic->get_num_elements() == 1, false);
+
+    double divisor = (double)atomic->get_element_divisor(0);
+    double delta = store[c] - sent[c];
+    if (c >= 3) {
+      // An angle changes by the shorter way around.
+      delta -= 360.0 * cfloor((delta + 180.0) / 360.0);
+    }
+    double offset = cfloor(delta * divisor + 0.5) / divisor;
+    packer.pack_double(offset);
+    sent[c] += (PN_stdfloat)offset;
+  }
+
+  if (packer.had_range_error()) {
+    // Too far to go in one step.
+    return false;
+  }
+
+  if (!finish_send_update(packer)) {
+    return false;
+  }
+
+  _sent_xyz.set(sent[0], sent[1], sent[2]);
+  _sent_hpr.set(sent[3], sent[4], sent[5]);
+  ++_delta_count;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CDistributedSmoothNodeBase::mark_sent
+//       Access: Private
+//  Description: Records that the indicated components of the stored
+//               position have been sent to the receivers in full, so
+//               that later offsets may be computed from them.  Each
+//               of the d_setSm* functions calls this with all of the
+//               components its field carries, whether they have
+//               changed or not.
+////////////////////////////////////////////////////////////////////
+void CDistributedSmoothNodeBase::
+mark_sent(int flags) {
+  for (int c = 0; c < 3; ++c) {
+    if (flags & (F_new_x << c)) {
+      _sent_xyz[c] = _store_xyz[c];
+    }
+    if (flags & (F_new_h << c)) {
+      _sent_hpr[c] = _store_hpr[c];
+    }
+  }
+  _delta_known |= flags;
+  _delta_count = 0;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: CDistributedSmoothNodeBase::begin_send_update
 //       Access: Private
@@ -315,14 +468,16 @@ begin_send_update(DCPacker &packer, const string &field_name) {
 ////////////////////////////////////////////////////////////////////
 //     Function: CDistributedSmoothNodeBase::finish_send_update
 //       Access: Private
-//  Description: Appends the timestamp and sends the update.
+//  Description: Appends the timestamp and sends the update.  Returns
+//               true if it was sent, or false if it could not be
+//               packed.
 ////////////////////////////////////////////////////////////////////
-void CDistributedSmoothNodeBase::
+bool CDistributedSmoothNodeBase::
 finish_send_update(DCPacker &packer) {
 #ifdef HAVE_PYTHON
-  nassertv(_clock_delta != NULL);
+  nassertr(_clock_delta != NULL, false);
   PyObject *clock_delta = PyObject_GetAttrString(_clock_delta, "delta");
-  nassertv(clock_delta != NULL);
+  nassertr(clock_delta != NULL, false);
   double delta = PyFloat_AsDouble(clock_delta);
   Py_DECREF(clock_delta);
 #else
@@ -341,7 +496,8 @@ finish_send_update(DCPacker &packer) {
   bool pack_ok = packer.end_pack();
   if (pack_ok) {
     Datagram dg(packer.get_data(), packer.get_length());
-    nassertv(_repository != NULL);
+    nassertr(_repository != NULL, false);
+    _total_bytes_sent += dg.get_length();
     _repository->send_datagram(dg);
 
   } else {
@@ -374,6 +530,8 @@ finish_send_update(DCPacker &packer) {
     }
 #endif
   }
+
+  return pack_ok;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -30,6 +30,14 @@ class CConnectionRepository;
 // Description : This class defines some basic methods of
 //               DistributedSmoothNodeBase which have been moved into
 //               C++ as a performance optimization.
+//
+//               If the dc class defines the setSmDelta* fields, and
+//               smooth-node-delta-encoding is true, small changes in
+//               position are broadcast as offsets from the previous
+//               position sent, which SmoothMover::add_x() and
+//               friends apply on the receiving end.  The absolute
+//               position is still sent whenever the offset won't fit,
+//               and every smooth-node-delta-refresh broadcasts.
 ////////////////////////////////////////////////////////////////////
 class EXPCL_DIRECT CDistributedSmoothNodeBase {
 PUBLISHED:
@@ -57,6 +65,9 @@ PUBLISHED:
   void set_curr_l(PN_uint64 l);
   void print_curr_l();
 
+  INLINE static size_t get_total_bytes_sent();
+  INLINE static void reset_total_bytes_sent();
+
 private:
   INLINE static bool only_changed(int flags, int compare);
 
@@ -72,8 +83,11 @@ private:
   INLINE void d_setSmPosHpr(PN_stdfloat x, PN_stdfloat y, PN_stdfloat z, PN_stdfloat h, PN_stdfloat p, PN_stdfloat r);
   INLINE void d_setSmPosHprL(PN_stdfloat x, PN_stdfloat y, PN_stdfloat z, PN_stdfloat h, PN_stdfloat p, PN_stdfloat r, PN_uint64 l);
 
+  bool try_send_delta(int flags);
+  void mark_sent(int flags);
+
   void begin_send_update(DCPacker &packer, const string &field_name);
-  void finish_send_update(DCPacker &packer);
+  bool finish_send_update(DCPacker &packer);
 
   enum Flags {
     F_new_x     = 0x01,
@@ -82,6 +96,7 @@ private:
     F_new_h     = 0x08,
     F_new_p     = 0x10,
     F_new_r     = 0x20,
+    F_all       = 0x3f,
   };
 
   NodePath _node_path;
@@ -101,6 +116,16 @@ private:
   // contains most recently sent location info as
   // index 0, index 1 contains most recently set location info
   PN_uint64 _currL[2];
+
+  // The position as the receivers last heard it, the set of F_new_*
+  // components they have heard at all, and the number of
+  // consecutive broadcasts sent as offsets from these.
+  LPoint3 _sent_xyz;
+  LVecBase3 _sent_hpr;
+  int _delta_known;
+  int _delta_count;
+
+  static size_t _total_bytes_sent;
 };
 
 #include "cDistributedSmoothNodeBase.I"
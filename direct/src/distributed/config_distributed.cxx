@@ -47,6 +47,38 @@ ConfigVariableBool handle_datagrams_internally
           "for performance reasons.  When it is false, all datagrams "
           "are handled by the Python implementation."));
 
+ConfigVariableInt cr_num_dispatch_threads
+("cr-num-dispatch-threads", 0,
+ PRC_DESC("The number of threads each CConnectionRepository should use to "
+          "receive datagrams, parse their headers, and check the field "
+          "data of updates, leaving only the application of each message "
+          "to the thread that calls check_datagram().  Set this to 0 to "
+          "do all of the work in check_datagram().  This only applies to "
+          "connections made with try_connect_net()."));
+
+ConfigVariableInt cr_dispatch_queue_size
+("cr-dispatch-queue-size", 1024,
+ PRC_DESC("The maximum number of datagrams the dispatch threads will "
+          "receive ahead of check_datagram(), when cr-num-dispatch-threads "
+          "is nonzero."));
+
+ConfigVariableBool smooth_node_delta_encoding
+("smooth-node-delta-encoding", false,
+ PRC_DESC("When this is true, CDistributedSmoothNodeBase will broadcast "
+          "small position changes as offsets from the previous position, "
+          "using the setSmDelta* fields, if the dc file defines them.  "
+          "Turn this on only when every client that may receive the "
+          "broadcasts knows how to apply these fields."));
+
+ConfigVariableInt smooth_node_delta_refresh
+("smooth-node-delta-refresh", 10,
+ PRC_DESC("The maximum number of consecutive position broadcasts that "
+          "CDistributedSmoothNodeBase will send as offsets, when "
+          "smooth-node-delta-encoding is in effect, before it sends the "
+          "absolute position again.  This bounds how long a client that "
+          "has missed an update, or has just arrived, may see the wrong "
+          "position."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libdistributed
 //  Description: Initializes the library.  This must be called at
@@ -28,6 +28,10 @@ extern ConfigVariableInt game_server_timeout_ms;
 extern ConfigVariableDouble min_lag;
 extern ConfigVariableDouble max_lag;
 extern ConfigVariableBool handle_datagrams_internally;
+extern ConfigVariableInt cr_num_dispatch_threads;
+extern ConfigVariableInt cr_dispatch_queue_size;
+extern ConfigVariableBool smooth_node_delta_encoding;
+extern ConfigVariableInt smooth_node_delta_refresh;
 
 extern EXPCL_DIRECT void init_libdistributed();
 
@@ -0,0 +1,242 @@
+// Filename: test_dispatch.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "directbase.h"
+#include "cConnectionRepository.h"
+#include "dcFile.h"
+#include "dcClass.h"
+#include "dcField.h"
+#include "dcmsgtypes.h"
+#include "queuedConnectionManager.h"
+#include "queuedConnectionListener.h"
+#include "connectionWriter.h"
+#include "urlSpec.h"
+#include "trueClock.h"
+#include "string_utils.h"
+
+// This program checks that the dispatch threads of a
+// CConnectionRepository deliver every datagram, unaltered and in the
+// order it was sent, whether the reader is threaded or polled; that
+// the threads may be stopped with messages outstanding; and that
+// disconnect() discards whatever was received on the old connection.
+
+static const char *dc_text =
+  "dclass Avatar {\n"
+  "  setXY(int16 / 10, int16 / 10) broadcast;\n"
+  "  setName(string) broadcast;\n"
+  "};\n";
+
+static int port = 14715;
+
+static int set_xy_number;
+static int set_name_number;
+
+// Returns the nth test message.  Two in three are field updates, which
+// the dispatch threads unpack; the rest are other messages, which
+// they only parse the header of.
+static Datagram
+make_message(int n) {
+  Datagram dg;
+  switch (n % 3) {
+  case 0:
+    dg.add_uint16(CLIENT_OBJECT_UPDATE_FIELD);
+    dg.add_uint32(1000 + n % 50);
+    dg.add_uint16(set_xy_number);
+    dg.add_int16(n % 3000);
+    dg.add_int16(-(n % 2000));
+    break;
+
+  case 1:
+    dg.add_uint16(CLIENT_OBJECT_UPDATE_FIELD);
+    dg.add_uint32(1000 + n % 50);
+    dg.add_uint16(set_name_number);
+    dg.add_string("avatar " + format_string(n));
+    break;
+
+  default:
+    dg.add_uint16(9000 + n % 7);
+    dg.add_uint32(n);
+    break;
+  }
+  return dg;
+}
+
+// Waits for the client to connect, and returns the server's end of
+// the connection.
+static PT(Connection)
+accept_connection(QueuedConnectionListener &listener) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double stop = clock->get_short_time() + 5.0;
+  while (clock->get_short_time() < stop) {
+    if (listener.new_connection_available()) {
+      PT(Connection) rendezvous;
+      NetAddress address;
+      PT(Connection) new_connection;
+      if (listener.get_new_connection(rendezvous, address, new_connection)) {
+        return new_connection;
+      }
+    }
+    Thread::sleep(0.001);
+  }
+  nout << "  no connection\n";
+  return NULL;
+}
+
+// Receives the messages [first, first + count) from the repository,
+// and checks that they arrive intact and in order.
+static bool
+receive_messages(CConnectionRepository &repository, int first, int count) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double stop = clock->get_short_time() + 10.0;
+  int n = first;
+  while (n < first + count) {
+    if (!repository.check_datagram()) {
+      if (clock->get_short_time() > stop) {
+        nout << "  timed out waiting for message " << n << "\n";
+        return false;
+      }
+      Thread::sleep(0.001);
+      continue;
+    }
+
+    Datagram dg;
+    repository.get_datagram(dg);
+    if (dg != make_message(n)) {
+      nout << "  message " << n << " is wrong:\n";
+      dg.dump_hex(nout, 4);
+      return false;
+    }
+    if (repository.get_msg_type() != DatagramIterator(dg).get_uint16()) {
+      nout << "  message " << n << " has the wrong type\n";
+      return false;
+    }
+    ++n;
+  }
+  return true;
+}
+
+// Sends the messages [first, first + count) to the client.
+static void
+send_messages(ConnectionWriter &writer, Connection *connection,
+              int first, int count) {
+  for (int n = first; n < first + count; ++n) {
+    writer.send(make_message(n), connection);
+  }
+}
+
+static bool
+run_test(bool threaded_net, int num_threads) {
+  nout << (threaded_net ? "threaded" : "polled") << " reader, "
+       << num_threads << " dispatch threads\n";
+
+  QueuedConnectionManager manager;
+  QueuedConnectionListener listener(&manager, 0);
+  ConnectionWriter writer(&manager, 0);
+  PT(Connection) rendezvous = manager.open_TCP_server_rendezvous(port, 5);
+  if (rendezvous == (Connection *)NULL) {
+    nout << "  unable to listen on port " << port << "\n";
+    return false;
+  }
+  listener.add_connection(rendezvous);
+
+  CConnectionRepository repository(false, threaded_net);
+  istringstream in(dc_text);
+  repository.get_dc_file().read(in, "test_dispatch");
+  repository.set_handle_c_updates(false);
+  repository.set_num_dispatch_threads(num_threads);
+
+  DCClass *dclass = repository.get_dc_file().get_class_by_name("Avatar");
+  set_xy_number = dclass->get_field_by_name("setXY")->get_number();
+  set_name_number = dclass->get_field_by_name("setName")->get_number();
+
+  URLSpec url("g://127.0.0.1:" + format_string(port));
+  if (!repository.try_connect_net(url)) {
+    nout << "  unable to connect\n";
+    return false;
+  }
+  PT(Connection) connection = accept_connection(listener);
+  if (connection == (Connection *)NULL) {
+    return false;
+  }
+
+  // A long stream, delivered in order.
+  send_messages(writer, connection, 0, 3000);
+  if (!receive_messages(repository, 0, 3000)) {
+    return false;
+  }
+
+  // Disconnect with messages still outstanding.  None of them may
+  // turn up on the new connection.
+  send_messages(writer, connection, 3000, 500);
+  if (!receive_messages(repository, 3000, 100)) {
+    return false;
+  }
+  Thread::sleep(0.1);
+  repository.disconnect();
+  manager.close_connection(connection);
+
+  if (!repository.try_connect_net(url)) {
+    nout << "  unable to reconnect\n";
+    return false;
+  }
+  connection = accept_connection(listener);
+  if (connection == (Connection *)NULL) {
+    return false;
+  }
+  send_messages(writer, connection, 10000, 1000);
+  if (!receive_messages(repository, 10000, 1000)) {
+    return false;
+  }
+
+  // Stop the threads with messages outstanding; they must still
+  // arrive in order.
+  send_messages(writer, connection, 20000, 1000);
+  if (!receive_messages(repository, 20000, 10)) {
+    return false;
+  }
+  Thread::sleep(0.1);
+  repository.set_num_dispatch_threads(0);
+  if (!receive_messages(repository, 20010, 990)) {
+    return false;
+  }
+
+  repository.disconnect();
+  manager.close_connection(connection);
+  manager.close_connection(rendezvous);
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc > 1) {
+    port = atoi(argv[1]);
+  }
+
+  if (!Thread::is_threading_supported()) {
+    nout << "Threading is not supported; nothing to test.\n";
+    return 0;
+  }
+
+  bool all_ok = true;
+  all_ok = run_test(true, 1) && all_ok;
+  all_ok = run_test(true, 4) && all_ok;
+  all_ok = run_test(false, 2) && all_ok;
+
+  if (!all_ok) {
+    nout << "Failed.\n";
+    return 1;
+  }
+  nout << "All tests passed.\n";
+  return 0;
+}
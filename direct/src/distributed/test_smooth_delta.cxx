@@ -0,0 +1,455 @@
+// Filename: test_smooth_delta.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "directbase.h"
+#include "cDistributedSmoothNodeBase.h"
+#include "cConnectionRepository.h"
+#include "dcFile.h"
+#include "dcClass.h"
+#include "dcMolecularField.h"
+#include "dcAtomicField.h"
+#include "dcPacker.h"
+#include "smoothMover.h"
+#include "queuedConnectionManager.h"
+#include "queuedConnectionListener.h"
+#include "queuedConnectionReader.h"
+#include "urlSpec.h"
+#include "trueClock.h"
+#include "nodePath.h"
+#include "pvector.h"
+#include "load_prc_file.h"
+#include "string_utils.h"
+
+// This program moves a crowd of avatars about a zone, broadcasting
+// their positions through a CConnectionRepository connected to a
+// server on the loopback interface, first with the absolute setSm*
+// fields only, and then with the setSmDelta* fields also available.
+// The server decodes each round of messages into a SmoothMover per
+// avatar, as a receiving client would, and checks the result against
+// the sender's position.  It also checks that the delta fields use
+// fewer bytes than the absolute ones.
+
+// These fields are the same as those of DistributedSmoothNode in
+// direct.dc.
+static const char *dc_text =
+  "keyword broadcast;\n"
+  "keyword ram;\n"
+  "dclass SmoothAbsolute {\n"
+  "  setComponentL(uint64) broadcast ram;\n"
+  "  setComponentX(int16 / 10) broadcast ram;\n"
+  "  setComponentY(int16 / 10) broadcast ram;\n"
+  "  setComponentZ(int16 / 10) broadcast ram;\n"
+  "  setComponentH(int16 % 360 / 10) broadcast ram;\n"
+  "  setComponentP(int16 % 360 / 10) broadcast ram;\n"
+  "  setComponentR(int16 % 360 / 10) broadcast ram;\n"
+  "  setComponentT(int16 timestamp) broadcast ram;\n"
+  "  setSmStop: setComponentT;\n"
+  "  setSmH: setComponentH, setComponentT;\n"
+  "  setSmZ: setComponentZ, setComponentT;\n"
+  "  setSmXY: setComponentX, setComponentY, setComponentT;\n"
+  "  setSmXZ: setComponentX, setComponentZ, setComponentT;\n"
+  "  setSmPos: setComponentX, setComponentY, setComponentZ, setComponentT;\n"
+  "  setSmHpr: setComponentH, setComponentP, setComponentR, setComponentT;\n"
+  "  setSmXYH: setComponentX, setComponentY, setComponentH, setComponentT;\n"
+  "  setSmXYZH: setComponentX, setComponentY, setComponentZ, setComponentH, setComponentT;\n"
+  "  setSmPosHpr: setComponentX, setComponentY, setComponentZ, setComponentH, setComponentP, setComponentR, setComponentT;\n"
+  "  setSmPosHprL: setComponentL, setComponentX, setComponentY, setComponentZ, setComponentH, setComponentP, setComponentR, setComponentT;\n"
+  "};\n"
+  "dclass SmoothDelta : SmoothAbsolute {\n"
+  "  setComponentDX(int8 / 10) broadcast;\n"
+  "  setComponentDY(int8 / 10) broadcast;\n"
+  "  setComponentDZ(int8 / 10) broadcast;\n"
+  "  setComponentDH(int8 / 10) broadcast;\n"
+  "  setComponentDP(int8 / 10) broadcast;\n"
+  "  setComponentDR(int8 / 10) broadcast;\n"
+  "  setSmDeltaH: setComponentDH, setComponentT;\n"
+  "  setSmDeltaXY: setComponentDX, setComponentDY, setComponentT;\n"
+  "  setSmDeltaXYH: setComponentDX, setComponentDY, setComponentDH, setComponentT;\n"
+  "  setSmDeltaXYZH: setComponentDX, setComponentDY, setComponentDZ, setComponentDH, setComponentT;\n"
+  "  setSmDeltaPosHpr: setComponentDX, setComponentDY, setComponentDZ, setComponentDH, setComponentDP, setComponentDR, setComponentT;\n"
+  "};\n";
+
+// The interval between broadcasts, as in
+// DistributedSmoothNodeBase.startPosHprBroadcast().
+static const double broadcast_period = 0.2;
+
+static const int num_avatars = 50;
+static const int num_broadcasts = 100;
+static const CHANNEL_TYPE first_do_id = 1000;
+
+// Sent by the client after each round of broadcasts, so that the
+// server knows when it has seen all of them.
+static const unsigned int end_of_round_type = 9999;
+
+static int port = 14716;
+
+// How far the receiver's idea of a component may be from the
+// sender's.  Each value is rounded to the divisor of its field, once
+// for the absolute value and once more for the offsets since then.
+// The sender also ignores changes smaller than its own epsilon.
+static const double divisor = 10.0;
+static const double max_error = 1.0 / divisor + 0.01 + 0.001;
+
+// A tiny random number generator, so that both runs see exactly the
+// same motion.
+static unsigned int
+next_random(unsigned int &seed) {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) & 0x7fff;
+}
+
+static double
+random_range(unsigned int &seed, double low, double high) {
+  return low + (high - low) * (double)next_random(seed) / 32767.0;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: apply_component
+//  Description: Applies one component of a position update to the
+//               SmoothMover, according to the name of its atomic
+//               field: setComponentX etc. for an absolute value, or
+//               setComponentDX etc. for an offset.
+////////////////////////////////////////////////////////////////////
+static bool
+apply_component(SmoothMover &mover, const string &name, double value) {
+  static const string prefix = "setComponent";
+  if (name.length() < prefix.length() + 1 ||
+      name.compare(0, prefix.length(), prefix) != 0) {
+    nout << "Unexpected field " << name << "\n";
+    return false;
+  }
+  bool delta = (name.length() == prefix.length() + 2 &&
+                name[prefix.length()] == 'D');
+  PN_stdfloat v = (PN_stdfloat)value;
+
+  switch (name[name.length() - 1]) {
+  case 'X':
+    delta ? mover.add_x(v) : mover.set_x(v);
+    return true;
+  case 'Y':
+    delta ? mover.add_y(v) : mover.set_y(v);
+    return true;
+  case 'Z':
+    delta ? mover.add_z(v) : mover.set_z(v);
+    return true;
+  case 'H':
+    delta ? mover.add_h(v) : mover.set_h(v);
+    return true;
+  case 'P':
+    delta ? mover.add_p(v) : mover.set_p(v);
+    return true;
+  case 'R':
+    delta ? mover.add_r(v) : mover.set_r(v);
+    return true;
+  }
+
+  nout << "Unexpected field " << name << "\n";
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: receive_update
+//  Description: Decodes one position update, as sent by
+//               CDistributedSmoothNodeBase, and applies it to the
+//               SmoothMover of the indicated avatar.
+////////////////////////////////////////////////////////////////////
+static bool
+receive_update(DCClass *dclass, const Datagram &dg,
+               pvector<SmoothMover> &movers, CHANNEL_TYPE first_do_id) {
+  DCPacker packer;
+  packer.set_unpack_data(dg.get_message());
+  packer.raw_unpack_uint16();  // the message type
+  CHANNEL_TYPE do_id = packer.raw_unpack_uint32();
+  int field_number = packer.raw_unpack_uint16();
+
+  DCField *field = dclass->get_dc_file()->get_field_by_index(field_number);
+  if (field == (DCField *)NULL || field->as_molecular_field() == NULL ||
+      do_id < first_do_id || do_id >= first_do_id + movers.size()) {
+    nout << "Unexpected message: field " << field_number << ", object "
+         << do_id << "\n";
+    return false;
+  }
+  SmoothMover &mover = movers[do_id - first_do_id];
+  DCMolecularField *molecular = field->as_molecular_field();
+
+  packer.begin_unpack(field);
+  packer.push();
+  bool ok = true;
+  int num_atomics = molecular->get_num_atomics();
+  for (int i = 0; i < num_atomics; ++i) {
+    const string &name = molecular->get_atomic(i)->get_name();
+    if (name == "setComponentL") {
+      packer.unpack_uint64();
+    } else if (name == "setComponentT") {
+      packer.unpack_int();
+    } else {
+      ok = apply_component(mover, name, packer.unpack_double()) && ok;
+    }
+  }
+  packer.pop();
+  if (!packer.end_unpack() || !ok) {
+    nout << "Unable to decode " << field->get_name() << "\n";
+    return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: accept_connection
+//  Description: Waits for the client to connect, and returns the
+//               server's end of the connection.
+////////////////////////////////////////////////////////////////////
+static PT(Connection)
+accept_connection(QueuedConnectionListener &listener) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double stop = clock->get_short_time() + 5.0;
+  while (clock->get_short_time() < stop) {
+    if (listener.new_connection_available()) {
+      PT(Connection) rendezvous;
+      NetAddress address;
+      PT(Connection) new_connection;
+      if (listener.get_new_connection(rendezvous, address, new_connection)) {
+        return new_connection;
+      }
+    }
+    Thread::sleep(0.001);
+  }
+  nout << "No connection\n";
+  return NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: receive_round
+//  Description: Ends the current round of broadcasts, and then
+//               receives and decodes all of its messages on the
+//               server.  The number of bytes received is added to
+//               num_bytes.
+////////////////////////////////////////////////////////////////////
+static bool
+receive_round(DCClass *dclass, CConnectionRepository *repository,
+              QueuedConnectionReader &reader,
+              pvector<SmoothMover> &movers, size_t &num_bytes) {
+  Datagram end_of_round;
+  end_of_round.add_uint16(end_of_round_type);
+  repository->send_datagram(end_of_round);
+  repository->flush();
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double stop = clock->get_short_time() + 10.0;
+  while (true) {
+    if (!reader.data_available()) {
+      if (clock->get_short_time() > stop) {
+        nout << "Timed out waiting for broadcasts\n";
+        return false;
+      }
+      Thread::sleep(0.001);
+      continue;
+    }
+
+    Datagram dg;
+    if (!reader.get_data(dg)) {
+      continue;
+    }
+    if (DatagramIterator(dg).get_uint16() == end_of_round_type) {
+      return true;
+    }
+    num_bytes += dg.get_length();
+    if (!receive_update(dclass, dg, movers, first_do_id)) {
+      return false;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_movers
+//  Description: Checks that each avatar's SmoothMover agrees with
+//               the sender.
+////////////////////////////////////////////////////////////////////
+static bool
+check_movers(DCClass *dclass, const pvector<NodePath> &avatars,
+             const pvector<SmoothMover> &movers) {
+  for (size_t i = 0; i < avatars.size(); ++i) {
+    LPoint3 pos = avatars[i].get_pos();
+    LVecBase3 hpr = avatars[i].get_hpr();
+    const LPoint3 &received_pos = movers[i].get_sample_pos();
+    const LVecBase3 &received_hpr = movers[i].get_sample_hpr();
+    for (int c = 0; c < 3; ++c) {
+      // The angles need only agree modulo 360.
+      double angle_error = cmod(received_hpr[c] - hpr[c] + 180.0, 360.0) - 180.0;
+      if (cabs(received_pos[c] - pos[c]) > max_error ||
+          cabs(angle_error) > max_error) {
+        nout << dclass->get_name() << " avatar " << i << " received as "
+             << received_pos << " " << received_hpr << ", sent as "
+             << pos << " " << hpr << "\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: run_crowd
+//  Description: Moves the avatars about, broadcasting the position
+//               of each as the indicated dclass, and checks each
+//               round as it is received.  Returns true if all was
+//               well; num_bytes is set to the number of bytes the
+//               server received.
+////////////////////////////////////////////////////////////////////
+static bool
+run_crowd(DCClass *dclass, CConnectionRepository *repository,
+          QueuedConnectionReader &reader, size_t &num_bytes) {
+  unsigned int seed = 1;
+  pvector<SmoothMover> movers(num_avatars);
+
+  pvector<NodePath> avatars;
+  pvector<CDistributedSmoothNodeBase *> cnodes;
+  pvector<double> speeds;
+  for (int i = 0; i < num_avatars; ++i) {
+    NodePath np("avatar");
+    np.set_pos(random_range(seed, -500.0, 500.0),
+               random_range(seed, -500.0, 500.0), 0.0);
+    np.set_h(random_range(seed, 0.0, 360.0));
+    avatars.push_back(np);
+    speeds.push_back(0.0);
+
+    CDistributedSmoothNodeBase *cnode = new CDistributedSmoothNodeBase;
+    cnode->set_repository(repository, false, 0);
+#ifdef HAVE_PYTHON
+    static PyObject *clock_delta = NULL;
+    if (clock_delta == (PyObject *)NULL) {
+      clock_delta = PyModule_New("clock_delta");
+      PyObject *delta = PyFloat_FromDouble(0.0);
+      PyObject_SetAttrString(clock_delta, "delta", delta);
+      Py_DECREF(delta);
+    }
+    cnode->set_clock_delta(clock_delta);
+#endif
+    cnode->initialize(np, dclass, first_do_id + i);
+    cnodes.push_back(cnode);
+  }
+
+  num_bytes = 0;
+  CDistributedSmoothNodeBase::reset_total_bytes_sent();
+  for (int i = 0; i < num_avatars; ++i) {
+    cnodes[i]->send_everything();
+  }
+  bool ok = receive_round(dclass, repository, reader, movers, num_bytes) &&
+    check_movers(dclass, avatars, movers);
+
+  for (int b = 0; b < num_broadcasts && ok; ++b) {
+    for (int i = 0; i < num_avatars; ++i) {
+      NodePath &np = avatars[i];
+
+      // Now and then, each avatar stops, or starts walking or
+      // running in a new direction; otherwise it keeps going,
+      // turning a little as it goes.
+      if (next_random(seed) % 20 == 0) {
+        int choice = next_random(seed) % 3;
+        speeds[i] = (choice == 0) ? 0.0 : (choice == 1) ? 8.0 : 24.0;
+        np.set_h(random_range(seed, 0.0, 360.0));
+      } else if (speeds[i] != 0.0) {
+        np.set_h(np.get_h() + random_range(seed, -10.0, 10.0));
+      }
+      if (speeds[i] != 0.0) {
+        LVector3 forward = np.get_quat().get_forward();
+        np.set_pos(np.get_pos() + forward * (speeds[i] * broadcast_period));
+      }
+
+      cnodes[i]->broadcast_pos_hpr_full();
+    }
+
+    ok = receive_round(dclass, repository, reader, movers, num_bytes) &&
+      check_movers(dclass, avatars, movers);
+  }
+
+  if (ok && num_bytes != CDistributedSmoothNodeBase::get_total_bytes_sent()) {
+    nout << dclass->get_name() << ": received " << num_bytes
+         << " bytes, but sent "
+         << CDistributedSmoothNodeBase::get_total_bytes_sent() << "\n";
+    ok = false;
+  }
+
+  for (int i = 0; i < num_avatars; ++i) {
+    delete cnodes[i];
+  }
+  return ok;
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc > 1) {
+    port = atoi(argv[1]);
+  }
+
+#ifdef HAVE_PYTHON
+  Py_Initialize();
+#endif
+
+  load_prc_file_data("test_smooth_delta", "smooth-node-delta-encoding 1");
+
+  DCFile dc_file;
+  istringstream in(dc_text);
+  if (!dc_file.read(in, "smooth.dc")) {
+    nout << "Unable to parse dc text.\n";
+    return 1;
+  }
+  DCClass *absolute_class = dc_file.get_class_by_name("SmoothAbsolute");
+  DCClass *delta_class = dc_file.get_class_by_name("SmoothDelta");
+  nassertr(absolute_class != (DCClass *)NULL && delta_class != (DCClass *)NULL, 1);
+
+  QueuedConnectionManager manager;
+  QueuedConnectionListener listener(&manager, 0);
+  QueuedConnectionReader reader(&manager, 0);
+  PT(Connection) rendezvous = manager.open_TCP_server_rendezvous(port, 5);
+  if (rendezvous == (Connection *)NULL) {
+    nout << "Unable to listen on port " << port << "\n";
+    return 1;
+  }
+  listener.add_connection(rendezvous);
+
+  CConnectionRepository repository;
+  URLSpec url("g://127.0.0.1:" + format_string(port));
+  if (!repository.try_connect_net(url)) {
+    nout << "Unable to connect\n";
+    return 1;
+  }
+  PT(Connection) connection = accept_connection(listener);
+  if (connection == (Connection *)NULL) {
+    return 1;
+  }
+  reader.add_connection(connection);
+
+  size_t absolute_bytes = 0;
+  size_t delta_bytes = 0;
+  bool ok = run_crowd(absolute_class, &repository, reader, absolute_bytes);
+  ok = ok && run_crowd(delta_class, &repository, reader, delta_bytes);
+
+  repository.disconnect();
+  manager.close_connection(connection);
+  manager.close_connection(rendezvous);
+
+  if (!ok) {
+    return 1;
+  }
+  if (delta_bytes >= absolute_bytes) {
+    nout << "Delta encoding used " << delta_bytes << " bytes, absolute "
+         << absolute_bytes << "\n";
+    return 1;
+  }
+
+  nout << "Absolute: " << absolute_bytes << " bytes, delta: "
+       << delta_bytes << " bytes.\n";
+  return 0;
+}
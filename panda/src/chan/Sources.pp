@@ -24,11 +24,13 @@
     animPreloadTable.I animPreloadTable.h \
     auto_bind.h  \
     bindAnimRequest.I bindAnimRequest.h \
+    compactAnimTable.I compactAnimTable.h \
     config_chan.h \
     movingPart.I movingPart.h \
     movingPartBase.I movingPartBase.h  \
     movingPartMatrix.I movingPartMatrix.h movingPartScalar.I  \
     movingPartScalar.h partBundle.I partBundle.N partBundle.h  \
+    partBundleBatch.I partBundleBatch.h \
     partBundleHandle.I partBundleHandle.h \
     partBundleNode.I partBundleNode.h \
     partGroup.I partGroup.h  \
@@ -50,8 +52,10 @@
     animPreloadTable.cxx \
     auto_bind.cxx  \
     bindAnimRequest.cxx \
+    compactAnimTable.cxx \
     config_chan.cxx movingPartBase.cxx movingPartMatrix.cxx  \
     movingPartScalar.cxx partBundle.cxx \
+    partBundleBatch.cxx \
     partBundleHandle.cxx \
     partBundleNode.cxx \
     partGroup.cxx \
@@ -74,10 +78,12 @@
     animPreloadTable.I animPreloadTable.h \
     auto_bind.h  \
     bindAnimRequest.I bindAnimRequest.h \
+    compactAnimTable.I compactAnimTable.h \
     config_chan.h \
     movingPart.I movingPart.h movingPartBase.I \
     movingPartBase.h movingPartMatrix.I movingPartMatrix.h \
     movingPartScalar.I movingPartScalar.h partBundle.I partBundle.h \
+    partBundleBatch.I partBundleBatch.h \
     partBundleHandle.I partBundleHandle.h \
     partBundleNode.I partBundleNode.h \
     partGroup.I partGroup.h \
@@ -88,3 +94,23 @@
 
 #end lib_target
 
+
+#begin test_bin_target
+  #define TARGET test_compactAnimTable
+  #define LOCAL_LIBS \
+    p3chan p3linmath
+
+  #define SOURCES \
+    test_compactAnimTable.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_partBundleBatch
+  #define LOCAL_LIBS \
+    p3chan
+
+  #define SOURCES \
+    test_partBundleBatch.cxx
+
+#end test_bin_target
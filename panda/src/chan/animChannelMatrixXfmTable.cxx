@@ -26,6 +26,13 @@
 #include "fftCompressor.h"
 #include "config_linmath.h"
 
+// The components of compact tables are decoded four at a time when
+// the compiler is generating SSE2 code.
+#if !defined(STDFLOAT_DOUBLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HAVE_DECODE_SSE2 1
+#include <emmintrin.h>
+#endif
+
 TypeHandle AnimChannelMatrixXfmTable::_type_handle;
 
 ////////////////////////////////////////////////////////////////////
@@ -34,7 +41,9 @@ TypeHandle AnimChannelMatrixXfmTable::_type_handle;
 //  Description: Used only for bam loader.
 /////////////////////////////////////////////////////////////
 AnimChannelMatrixXfmTable::
-AnimChannelMatrixXfmTable() {
+AnimChannelMatrixXfmTable() :
+  _compact(NULL)
+{
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = CPTA_stdfloat(get_class_type());
   }
@@ -50,11 +59,18 @@ AnimChannelMatrixXfmTable() {
 ////////////////////////////////////////////////////////////////////
 AnimChannelMatrixXfmTable::
 AnimChannelMatrixXfmTable(AnimGroup *parent, const AnimChannelMatrixXfmTable &copy) : 
-  AnimChannelMatrix(parent, copy)
+  AnimChannelMatrix(parent, copy),
+  _compact(NULL)
 {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = copy._tables[i];
   }
+  if (copy._compact != (CompactAnimTable *)NULL) {
+    _compact = new CompactAnimTable[num_matrix_components];
+    for (int i = 0; i < num_matrix_components; i++) {
+      _compact[i] = copy._compact[i];
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -64,7 +80,8 @@ AnimChannelMatrixXfmTable(AnimGroup *parent, const AnimChannelMatrixXfmTable &co
 ////////////////////////////////////////////////////////////////////
 AnimChannelMatrixXfmTable::
 AnimChannelMatrixXfmTable(AnimGroup *parent, const string &name)
-  : AnimChannelMatrix(parent, name) 
+  : AnimChannelMatrix(parent, name),
+    _compact(NULL)
 {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = CPTA_stdfloat(get_class_type());
@@ -78,6 +95,7 @@ AnimChannelMatrixXfmTable(AnimGroup *parent, const string &name)
 /////////////////////////////////////////////////////////////
 AnimChannelMatrixXfmTable::
 ~AnimChannelMatrixXfmTable() {
+  delete[] _compact;
 }
 
 
@@ -94,9 +112,8 @@ has_changed(int last_frame, double last_frac,
             int this_frame, double this_frac) {
   if (last_frame != this_frame) {
     for (int i = 0; i < num_matrix_components; i++) {
-      if (_tables[i].size() > 1) {
-        if (_tables[i][last_frame % _tables[i].size()] !=
-            _tables[i][this_frame % _tables[i].size()]) {
+      if (get_table_size(i) > 1) {
+        if (get_component(i, last_frame) != get_component(i, this_frame)) {
           return true;
         }
       }
@@ -107,9 +124,8 @@ has_changed(int last_frame, double last_frac,
     // If we have some fractional changes, also check the next
     // subsequent frame (since we'll be blending with that).
     for (int i = 0; i < num_matrix_components; i++) {
-      if (_tables[i].size() > 1) {
-        if (_tables[i][last_frame % _tables[i].size()] !=
-            _tables[i][(this_frame + 1) % _tables[i].size()]) {
+      if (get_table_size(i) > 1) {
+        if (get_component(i, last_frame) != get_component(i, this_frame + 1)) {
           return true;
         }
       }
@@ -127,14 +143,7 @@ has_changed(int last_frame, double last_frac,
 void AnimChannelMatrixXfmTable::
 get_value(int frame, LMatrix4 &mat) {
   PN_stdfloat components[num_matrix_components];
-
-  for (int i = 0; i < num_matrix_components; i++) {
-    if (_tables[i].empty()) {
-      components[i] = get_default_value(i);
-    } else {
-      components[i] = _tables[i][frame % _tables[i].size()];
-    }
-  }
+  get_components(frame, components, 0, num_matrix_components);
 
   compose_matrix(mat, components);
 }
@@ -154,14 +163,7 @@ get_value_no_scale_shear(int frame, LMatrix4 &mat) {
   components[3] = 0.0f;
   components[4] = 0.0f;
   components[5] = 0.0f;
-
-  for (int i = 6; i < num_matrix_components; i++) {
-    if (_tables[i].empty()) {
-      components[i] = get_default_value(i);
-    } else {
-      components[i] = _tables[i][frame % _tables[i].size()];
-    }
-  }
+  get_components(frame, components, 6, num_matrix_components);
 
   compose_matrix(mat, components);
 }
@@ -174,11 +176,7 @@ get_value_no_scale_shear(int frame, LMatrix4 &mat) {
 void AnimChannelMatrixXfmTable::
 get_scale(int frame, LVecBase3 &scale) {
   for (int i = 0; i < 3; i++) {
-    if (_tables[i].empty()) {
-      scale[i] = 1.0f;
-    } else {
-      scale[i] = _tables[i][frame % _tables[i].size()];
-    }
+    scale[i] = get_component(i, frame);
   }
 }
 
@@ -192,11 +190,7 @@ get_scale(int frame, LVecBase3 &scale) {
 void AnimChannelMatrixXfmTable::
 get_hpr(int frame, LVecBase3 &hpr) {
   for (int i = 0; i < 3; i++) {
-    if (_tables[i + 6].empty()) {
-      hpr[i] = 0.0f;
-    } else {
-      hpr[i] = _tables[i + 6][frame % _tables[i + 6].size()];
-    }
+    hpr[i] = get_component(i + 6, frame);
   }
 }
 
@@ -211,11 +205,7 @@ void AnimChannelMatrixXfmTable::
 get_quat(int frame, LQuaternion &quat) {
   LVecBase3 hpr;
   for (int i = 0; i < 3; i++) {
-    if (_tables[i + 6].empty()) {
-      hpr[i] = 0.0f;
-    } else {
-      hpr[i] = _tables[i + 6][frame % _tables[i + 6].size()];
-    }
+    hpr[i] = get_component(i + 6, frame);
   }
 
   quat.set_hpr(hpr);
@@ -231,11 +221,7 @@ get_quat(int frame, LQuaternion &quat) {
 void AnimChannelMatrixXfmTable::
 get_pos(int frame, LVecBase3 &pos) {
   for (int i = 0; i < 3; i++) {
-    if (_tables[i + 9].empty()) {
-      pos[i] = 0.0f;
-    } else {
-      pos[i] = _tables[i + 9][frame % _tables[i + 9].size()];
-    }
+    pos[i] = get_component(i + 9, frame);
   }
 }
 
@@ -249,11 +235,7 @@ get_pos(int frame, LVecBase3 &pos) {
 void AnimChannelMatrixXfmTable::
 get_shear(int frame, LVecBase3 &shear) {
   for (int i = 0; i < 3; i++) {
-    if (_tables[i + 3].empty()) {
-      shear[i] = 0.0f;
-    } else {
-      shear[i] = _tables[i + 3][frame % _tables[i + 3].size()];
-    }
+    shear[i] = get_component(i + 3, frame);
   }
 }
 
@@ -265,6 +247,9 @@ get_shear(int frame, LVecBase3 &shear) {
 //               'p', 'r', for rotation, and 'x', 'y', 'z', for
 //               translation.  The new table must have either zero,
 //               one, or get_num_frames() frames.
+//
+//               If compact-anim-channels is true, the table is
+//               immediately reduced as by compact_tables().
 ////////////////////////////////////////////////////////////////////
 void AnimChannelMatrixXfmTable::
 set_table(char table_id, const CPTA_stdfloat &table) {
@@ -283,6 +268,61 @@ set_table(char table_id, const CPTA_stdfloat &table) {
   }
 
   _tables[i] = table;
+  clear_compact(i);
+
+  if (compact_anim_channels) {
+    PN_stdfloat tolerance = (i >= 6 && i < 9) ?
+      compact_anim_hpr_tolerance : compact_anim_tolerance;
+    compact_table(i, tolerance);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixXfmTable::compact_tables
+//       Access: Published
+//  Description: Replaces each of the tables with a reduced form that
+//               stores only the key frames needed to reconstruct
+//               every frame by linear interpolation, quantized to 16
+//               bits, so that no frame's value differs from the
+//               original by more than the indicated tolerance.  The
+//               hpr_tolerance, in degrees, applies to the rotation
+//               tables.
+//
+//               Tables that would not get any smaller are left
+//               alone.  The frames are decoded on demand, so this is
+//               transparent except for the loss of precision.  This
+//               is done automatically to each channel as it is
+//               loaded if compact-anim-channels is true.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixXfmTable::
+compact_tables(PN_stdfloat tolerance, PN_stdfloat hpr_tolerance) {
+  for (int i = 0; i < num_matrix_components; i++) {
+    if (has_compact(i)) {
+      // Decode it first, so we can compact it again with the new
+      // tolerance.
+      _tables[i] = _compact[i].get_table(get_class_type());
+      _compact[i].clear();
+    }
+
+    PN_stdfloat table_tolerance = (i >= 6 && i < 9) ? hpr_tolerance : tolerance;
+    compact_table(i, table_tolerance);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixXfmTable::get_compact_saved_size
+//       Access: Published, Static
+//  Description: Returns the number of bytes of memory currently being
+//               saved by all the tables that have been reduced with
+//               compact_tables(), compared to storing them one value
+//               per frame.  The memory actually used by the reduced
+//               tables is charged to the CompactAnimTable type in
+//               the MemoryUsage reports, when track-memory-usage is
+//               enabled.
+////////////////////////////////////////////////////////////////////
+size_t AnimChannelMatrixXfmTable::
+get_compact_saved_size() {
+  return CompactAnimTable::get_total_saved_size();
 }
 
 
@@ -297,6 +337,8 @@ clear_all_tables() {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = CPTA_stdfloat(get_class_type());
   }
+  delete[] _compact;
+  _compact = NULL;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -313,8 +355,9 @@ write(ostream &out, int indent_level) const {
   // Write a list of all the sub-tables that have data.
   bool found_any = false;
   for (int i = 0; i < num_matrix_components; i++) {
-    if (!_tables[i].empty()) {
-      out << get_table_id(i) << _tables[i].size();
+    int size = get_table_size(i);
+    if (size != 0) {
+      out << get_table_id(i) << size;
       found_any = true;
     }
   }
@@ -364,6 +407,88 @@ get_table_index(char table_id) {
   return -1;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixXfmTable::get_components
+//       Access: Protected
+//  Description: Fills in components[first] through
+//               components[last - 1] with the values of the
+//               corresponding tables at the indicated frame, decoding
+//               any compact tables along the way.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixXfmTable::
+get_components(int frame, PN_stdfloat components[num_matrix_components],
+               int first, int last) const {
+  // The compact tables are gathered into these arrays first, so that
+  // they can be decoded together.
+  float offset[num_matrix_components];
+  float step[num_matrix_components];
+  float q0[num_matrix_components];
+  float dq[num_matrix_components];
+  float t[num_matrix_components];
+  int index[num_matrix_components];
+  int num_compact = 0;
+
+  for (int i = first; i < last; i++) {
+    if (has_compact(i)) {
+      const CompactAnimTable &compact = _compact[i];
+      compact.get_sample(frame, q0[num_compact], dq[num_compact], t[num_compact]);
+      offset[num_compact] = compact.get_offset();
+      step[num_compact] = compact.get_step();
+      index[num_compact] = i;
+      ++num_compact;
+
+    } else if (_tables[i].empty()) {
+      components[i] = get_default_value(i);
+
+    } else {
+      components[i] = _tables[i][frame % _tables[i].size()];
+    }
+  }
+
+  int ci = 0;
+#ifdef HAVE_DECODE_SSE2
+  float values[4];
+  for (; ci + 4 <= num_compact; ci += 4) {
+    __m128 q = _mm_add_ps(_mm_loadu_ps(q0 + ci),
+                          _mm_mul_ps(_mm_loadu_ps(dq + ci), _mm_loadu_ps(t + ci)));
+    __m128 v = _mm_add_ps(_mm_loadu_ps(offset + ci),
+                          _mm_mul_ps(_mm_loadu_ps(step + ci), q));
+    _mm_storeu_ps(values, v);
+    components[index[ci]] = values[0];
+    components[index[ci + 1]] = values[1];
+    components[index[ci + 2]] = values[2];
+    components[index[ci + 3]] = values[3];
+  }
+#endif  // HAVE_DECODE_SSE2
+
+  for (; ci < num_compact; ++ci) {
+    components[index[ci]] = offset[ci] + step[ci] * (q0[ci] + dq[ci] * t[ci]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixXfmTable::compact_table
+//       Access: Protected
+//  Description: Replaces the indicated table with its reduced form,
+//               if that is smaller, allocating the array of reduced
+//               tables if this is the first.  Returns true if the
+//               table was reduced, false if it was left alone.
+////////////////////////////////////////////////////////////////////
+bool AnimChannelMatrixXfmTable::
+compact_table(int table_index, PN_stdfloat tolerance) {
+  CompactAnimTable compact;
+  if (!compact.set_table(_tables[table_index], tolerance)) {
+    return false;
+  }
+
+  if (_compact == (CompactAnimTable *)NULL) {
+    _compact = new CompactAnimTable[num_matrix_components];
+  }
+  _compact[table_index] = compact;
+  _tables[table_index] = NULL;
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AnimChannelMatrixXfmTable::write_datagram
 //       Access: Public
@@ -383,12 +508,18 @@ write_datagram(BamWriter *manager, Datagram &me) {
   me.add_bool(compress_channels);
   me.add_bool(temp_hpr_fix);
 
+  // Compact tables are always written out in full.
+  CPTA_stdfloat tables[num_matrix_components];
+  for (int ti = 0; ti < num_matrix_components; ti++) {
+    tables[ti] = get_table_by_index(ti);
+  }
+
   if (!compress_channels) {
     // Write out everything uncompressed, as a stream of floats.
     for (int i = 0; i < num_matrix_components; i++) {
-      me.add_uint16(_tables[i].size());
-      for(int j = 0; j < (int)_tables[i].size(); j++) {
-        me.add_stdfloat(_tables[i][j]);
+      me.add_uint16(tables[i].size());
+      for(int j = 0; j < (int)tables[i].size(); j++) {
+        me.add_stdfloat(tables[i][j]);
       }
     }
 
@@ -402,18 +533,18 @@ write_datagram(BamWriter *manager, Datagram &me) {
     // First, write out the scales and shears.
     int i;
     for (i = 0; i < 6; i++) {
-      compressor.write_reals(me, _tables[i], _tables[i].size());
+      compressor.write_reals(me, tables[i], tables[i].size());
     }
 
     // Now, write out the joint angles.  For these we need to build up
     // a HPR array.
     pvector<LVecBase3> hprs;
-    int hprs_length = max(max(_tables[6].size(), _tables[7].size()), _tables[8].size());
+    int hprs_length = max(max(tables[6].size(), tables[7].size()), tables[8].size());
     hprs.reserve(hprs_length);
     for (i = 0; i < hprs_length; i++) {
-      PN_stdfloat h = _tables[6].empty() ? 0.0f : _tables[6][i % _tables[6].size()];
-      PN_stdfloat p = _tables[7].empty() ? 0.0f : _tables[7][i % _tables[7].size()];
-      PN_stdfloat r = _tables[8].empty() ? 0.0f : _tables[8][i % _tables[8].size()];
+      PN_stdfloat h = tables[6].empty() ? 0.0f : tables[6][i % tables[6].size()];
+      PN_stdfloat p = tables[7].empty() ? 0.0f : tables[7][i % tables[7].size()];
+      PN_stdfloat r = tables[8].empty() ? 0.0f : tables[8][i % tables[8].size()];
       hprs.push_back(LVecBase3(h, p, r));
     }
     const LVecBase3 *hprs_array = NULL;
@@ -424,7 +555,7 @@ write_datagram(BamWriter *manager, Datagram &me) {
 
     // And now the translations.
     for(i = 9; i < num_matrix_components; i++) {
-      compressor.write_reals(me, _tables[i], _tables[i].size());
+      compressor.write_reals(me, tables[i], tables[i].size());
     }
   }
 }
@@ -557,6 +688,10 @@ fillin(DatagramIterator &scan, BamReader *manager) {
       _tables[i] = ind_table;
     }
   }
+
+  if (compact_anim_channels) {
+    compact_tables(compact_anim_tolerance, compact_anim_hpr_tolerance);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -22,6 +22,7 @@
 #include "pointerToArray.h"
 #include "pta_stdfloat.h"
 #include "compose_matrix.h"
+#include "compactAnimTable.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : AnimChannelMatrixXfmTable
@@ -58,6 +59,10 @@ PUBLISHED:
   void set_table(char table_id, const CPTA_stdfloat &table);
   INLINE CPTA_stdfloat get_table(char table_id) const;
 
+  void compact_tables(PN_stdfloat tolerance, PN_stdfloat hpr_tolerance);
+  INLINE bool is_table_compact(char table_id) const;
+  static size_t get_compact_saved_size();
+
   void clear_all_tables();
   INLINE bool has_table(char table_id) const;
   INLINE void clear_table(char table_id);
@@ -72,8 +77,23 @@ protected:
   static int get_table_index(char table_id);
   INLINE static PN_stdfloat get_default_value(int table_index);
 
+  INLINE int get_table_size(int table_index) const;
+  INLINE PN_stdfloat get_component(int table_index, int frame) const;
+  INLINE CPTA_stdfloat get_table_by_index(int table_index) const;
+  INLINE bool has_compact(int table_index) const;
+  INLINE void clear_compact(int table_index);
+  bool compact_table(int table_index, PN_stdfloat tolerance);
+  void get_components(int frame, PN_stdfloat components[num_matrix_components],
+                      int first, int last) const;
+
   CPTA_stdfloat _tables[num_matrix_components];
 
+  // If a table has been reduced by compact_tables(), its data is
+  // stored in the corresponding entry of this array instead, and the
+  // entry in _tables is NULL.  Most channels are never compacted, so
+  // the array is not allocated until one of its tables is.
+  CompactAnimTable *_compact;
+
 public:
   static void register_with_read_factory();
   virtual void write_datagram(BamWriter* manager, Datagram &me);
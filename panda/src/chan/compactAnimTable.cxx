@@ -0,0 +1,152 @@
+// Filename: compactAnimTable.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "compactAnimTable.h"
+#include "vector_int.h"
+
+#include <math.h>
+
+TypeHandle CompactAnimTable::_type_handle;
+AtomicAdjust::Integer CompactAnimTable::_total_saved_size = 0;
+
+// We don't let a single segment between keys grow beyond this many
+// frames, to bound the cost of fitting it.
+static const int max_segment_frames = 256;
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompactAnimTable::set_table
+//       Access: Public
+//  Description: Fills the table from the indicated table of values,
+//               one per frame, keeping only enough keys that every
+//               frame decodes to within the indicated tolerance of
+//               its original value.
+//
+//               Returns true on success, or false (and leaves the
+//               table empty) if the table is too small, too large,
+//               or too irregular to benefit.
+////////////////////////////////////////////////////////////////////
+bool CompactAnimTable::
+set_table(const CPTA_stdfloat &table, PN_stdfloat tolerance) {
+  clear();
+
+  int num_frames = (int)table.size();
+  if (num_frames < 3 || num_frames > 0x10000) {
+    return false;
+  }
+
+  const PN_stdfloat *data = table.p();
+  PN_stdfloat min_value = data[0];
+  PN_stdfloat max_value = data[0];
+  for (int i = 1; i < num_frames; ++i) {
+    min_value = min(min_value, data[i]);
+    max_value = max(max_value, data[i]);
+  }
+
+  PN_stdfloat step = (max_value - min_value) / (PN_stdfloat)0xffff;
+  if (step * 0.5f > tolerance) {
+    // Even the quantization alone would be too coarse.
+    return false;
+  }
+
+  vector_int quantized;
+  quantized.reserve(num_frames);
+  for (int i = 0; i < num_frames; ++i) {
+    int q = 0;
+    if (step > 0.0f) {
+      q = (int)floor((data[i] - min_value) / step + 0.5f);
+      q = max(0, min(q, 0xffff));
+    }
+    quantized.push_back(q);
+  }
+
+  _offset = min_value;
+  _step = step;
+
+  // Now walk through the frames, extending each segment as far as it
+  // will go while the interpolated values stay within tolerance.
+  vector_int key_frames;
+  key_frames.push_back(0);
+  int begin = 0;
+  while (begin < num_frames - 1) {
+    int best = begin + 1;
+    int end = best + 1;
+    while (end < num_frames && end - begin <= max_segment_frames &&
+           fits_segment(data, &quantized[0], begin, end, tolerance)) {
+      best = end;
+      ++end;
+    }
+    key_frames.push_back(best);
+    begin = best;
+  }
+
+  int num_keys = (int)key_frames.size();
+  size_t orig_size = num_frames * sizeof(PN_stdfloat);
+  size_t new_size = num_keys * 2 * sizeof(PN_uint16);
+  if (new_size >= orig_size) {
+    _offset = 0.0f;
+    _step = 0.0f;
+    return false;
+  }
+
+  _keys.reserve(num_keys * 2);
+  for (int k = 0; k < num_keys; ++k) {
+    _keys.push_back((PN_uint16)key_frames[k]);
+  }
+  for (int k = 0; k < num_keys; ++k) {
+    _keys.push_back((PN_uint16)quantized[key_frames[k]]);
+  }
+  _num_frames = num_frames;
+  set_saved_size(orig_size - new_size);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompactAnimTable::get_table
+//       Access: Public
+//  Description: Decodes all of the frames of the table into a new
+//               array, for instance to write it to a bam file.
+////////////////////////////////////////////////////////////////////
+CPTA_stdfloat CompactAnimTable::
+get_table(TypeHandle type_handle) const {
+  PTA_stdfloat table = PTA_stdfloat::empty_array(_num_frames, type_handle);
+  for (int i = 0; i < _num_frames; ++i) {
+    table[i] = get_value(i);
+  }
+  return table;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompactAnimTable::fits_segment
+//       Access: Private
+//  Description: Returns true if all of the frames strictly between
+//               begin and end are reproduced within tolerance by
+//               interpolating between the quantized values at begin
+//               and end.
+////////////////////////////////////////////////////////////////////
+bool CompactAnimTable::
+fits_segment(const PN_stdfloat *table, const int *quantized,
+             int begin, int end, PN_stdfloat tolerance) const {
+  float q0 = (float)quantized[begin];
+  float dq = (float)quantized[end] - q0;
+  float span = (float)(end - begin);
+  for (int i = begin + 1; i < end; ++i) {
+    float t = (float)(i - begin) / span;
+    PN_stdfloat value = _offset + _step * (PN_stdfloat)(q0 + dq * t);
+    if (fabs(value - table[i]) > tolerance) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,103 @@
+// Filename: compactAnimTable.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef COMPACTANIMTABLE_H
+#define COMPACTANIMTABLE_H
+
+#include "pandabase.h"
+
+#include "pta_stdfloat.h"
+#include "pvector.h"
+#include "numeric_types.h"
+#include "atomicAdjust.h"
+#include "typeHandle.h"
+#include "register_type.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : CompactAnimTable
+// Description : A reduced in-memory representation of one component
+//               table of an animation channel, such as the h table of
+//               an AnimChannelMatrixXfmTable.
+//
+//               Instead of one floating-point value per frame, the
+//               table stores only the frames at which the curve
+//               cannot be reconstructed by linear interpolation from
+//               its neighbors within a given tolerance, and each of
+//               those key values is quantized to 16 bits within the
+//               range of the table.  Any frame may be decoded on
+//               demand, in constant memory, by interpolating between
+//               the two keys that surround it.
+//
+//               This is used internally by AnimChannelMatrixXfmTable
+//               when compact-anim-channels is in effect.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_CHAN CompactAnimTable {
+public:
+  INLINE CompactAnimTable();
+  INLINE CompactAnimTable(const CompactAnimTable &copy);
+  INLINE void operator = (const CompactAnimTable &copy);
+  INLINE ~CompactAnimTable();
+
+  bool set_table(const CPTA_stdfloat &table, PN_stdfloat tolerance);
+  CPTA_stdfloat get_table(TypeHandle type_handle) const;
+  INLINE void clear();
+
+  INLINE bool is_empty() const;
+  INLINE int get_num_frames() const;
+  INLINE int get_num_keys() const;
+  INLINE size_t get_data_size() const;
+
+  INLINE PN_stdfloat get_value(int frame) const;
+  INLINE void get_sample(int frame, float &q0, float &dq, float &t) const;
+  INLINE PN_stdfloat get_offset() const;
+  INLINE PN_stdfloat get_step() const;
+
+  INLINE static size_t get_total_saved_size();
+
+private:
+  INLINE int find_key(int frame) const;
+  INLINE void set_saved_size(size_t saved_size);
+  bool fits_segment(const PN_stdfloat *table, const int *quantized,
+                    int begin, int end, PN_stdfloat tolerance) const;
+
+  PN_stdfloat _offset;
+  PN_stdfloat _step;
+  int _num_frames;
+
+  // The frame numbers of the keys, in increasing order, followed by
+  // the quantized value at each key.  The first key is always frame
+  // 0, and the last is always the last frame.
+  typedef pvector<PN_uint16> Keys;
+  Keys _keys;
+
+  // The number of bytes saved by this table, compared to the table it
+  // replaces, and by all of the tables currently in existence.
+  size_t _saved_size;
+  static AtomicAdjust::Integer _total_saved_size;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    register_type(_type_handle, "CompactAnimTable");
+  }
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "compactAnimTable.I"
+
+#endif
@@ -26,6 +26,7 @@
 #include "animGroup.h"
 #include "animPreloadTable.h"
 #include "bindAnimRequest.h"
+#include "compactAnimTable.h"
 #include "movingPartBase.h"
 #include "movingPartMatrix.h"
 #include "movingPartScalar.h"
@@ -104,6 +105,37 @@ PRC_DESC("This specifies the priority assign to an asynchronous bind "
          "model loads).  A higher number here makes the animations "
          "load sooner."));
 
+ConfigVariableInt anim_batch_num_threads
+("anim-batch-num-threads", 0,
+PRC_DESC("This is the default number of threads a PartBundleBatch will use "
+         "to evaluate its bundles in parallel, including the calling "
+         "thread.  The bundles are shared with the \"animation\" task "
+         "chain, which will be given enough threads to make up the rest, "
+         "and the resulting changes to the scene graph are applied "
+         "afterwards on the calling thread.  Set this to 0 or "
+         "1 to update the bundles on the calling thread only, which is the "
+         "default."));
+
+ConfigVariableBool compact_anim_channels
+("compact-anim-channels", false,
+PRC_DESC("Set this true to store the tables of matrix animation channels "
+         "in a reduced form in memory as they are loaded, keeping only "
+         "the key frames needed to reproduce the animation by linear "
+         "interpolation, quantized to 16 bits.  This can substantially "
+         "reduce the memory footprint of long or densely sampled "
+         "animations, at the cost of a small error in each frame, bounded "
+         "by compact-anim-tolerance and compact-anim-hpr-tolerance."));
+
+ConfigVariableDouble compact_anim_tolerance
+("compact-anim-tolerance", 0.001,
+PRC_DESC("The largest error allowed in any frame of a scale, shear, or "
+         "translation table when compact-anim-channels is in effect."));
+
+ConfigVariableDouble compact_anim_hpr_tolerance
+("compact-anim-hpr-tolerance", 0.05,
+PRC_DESC("The largest error allowed, in degrees, in any frame of a "
+         "rotation table when compact-anim-channels is in effect."));
+
 ConfigureFn(config_chan) {
   AnimBundle::init_type();
   AnimBundleNode::init_type();
@@ -117,6 +149,7 @@ ConfigureFn(config_chan) {
   AnimGroup::init_type();
   AnimPreloadTable::init_type();
   BindAnimRequest::init_type();
+  CompactAnimTable::init_type();
   MovingPartBase::init_type();
   MovingPartMatrix::init_type();
   MovingPartScalar::init_type();
@@ -19,6 +19,7 @@
 #include "notifyCategoryProxy.h"
 #include "configVariableBool.h"
 #include "configVariableInt.h"
+#include "configVariableDouble.h"
 
 // Configure variables for chan package.
 NotifyCategoryDecl(chan, EXPCL_PANDA_CHAN, EXPTP_PANDA_CHAN);
@@ -29,5 +30,9 @@ EXPCL_PANDA_CHAN extern ConfigVariableBool read_compressed_channels;
 EXPCL_PANDA_CHAN extern ConfigVariableBool interpolate_frames;
 EXPCL_PANDA_CHAN extern ConfigVariableBool restore_initial_pose;
 EXPCL_PANDA_CHAN extern ConfigVariableInt async_bind_priority;
+EXPCL_PANDA_CHAN extern ConfigVariableInt anim_batch_num_threads;
+EXPCL_PANDA_CHAN extern ConfigVariableBool compact_anim_channels;
+EXPCL_PANDA_CHAN extern ConfigVariableDouble compact_anim_tolerance;
+EXPCL_PANDA_CHAN extern ConfigVariableDouble compact_anim_hpr_tolerance;
 
 #endif
@@ -205,6 +205,20 @@ update_internals(PartBundle *, PartGroup *, bool, bool, Thread *) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: MovingPartBase::apply_update
+//       Access: Public, Virtual
+//  Description: This is called on the bundle's owning thread for
+//               each part that called PartBundle::defer_update() from
+//               update_internals() during a PartBundleBatch
+//               evaluation.  It is a hook for derived classes to
+//               apply the results of the update to the scene graph,
+//               which must not be modified during the evaluation.
+////////////////////////////////////////////////////////////////////
+void MovingPartBase::
+apply_update(PartBundle *, bool, bool, Thread *) {
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: MovingPartBase::pick_channel_index
 //       Access: Protected
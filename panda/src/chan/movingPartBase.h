@@ -63,6 +63,8 @@ public:
   virtual bool update_internals(PartBundle *root, PartGroup *parent, 
                                 bool self_changed, bool parent_changed, 
                                 Thread *current_thread);
+  virtual void apply_update(PartBundle *root, bool self_changed,
+                            bool net_changed, Thread *current_thread);
 
 protected:
   MovingPartBase();
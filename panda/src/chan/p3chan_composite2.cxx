@@ -1,10 +1,12 @@
 #include "animPreloadTable.cxx"
 #include "bindAnimRequest.cxx"
+#include "compactAnimTable.cxx"
 #include "config_chan.cxx"
 #include "movingPartBase.cxx"
 #include "movingPartMatrix.cxx"
 #include "movingPartScalar.cxx"
 #include "partBundle.cxx"
+#include "partBundleBatch.cxx"
 #include "partBundleNode.cxx"
 #include "partGroup.cxx"
 #include "partSubset.cxx"
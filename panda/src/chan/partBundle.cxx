@@ -17,6 +17,7 @@
 #include "animBundle.h"
 #include "animBundleNode.h"
 #include "animControl.h"
+#include "movingPartBase.h"
 #include "loader.h"
 #include "animPreloadTable.h"
 #include "config_chan.h"
@@ -55,6 +56,7 @@ PartBundle(const PartBundle &copy) :
 {
   _anim_preload = copy._anim_preload;
   _update_delay = 0.0;
+  _defer_updates = false;
 
   CDWriter cdata(_cycler, true);
   CDReader cdata_from(copy._cycler);
@@ -76,6 +78,7 @@ PartBundle(const string &name) :
   PartGroup(name)
 {
   _update_delay = 0.0;
+  _defer_updates = false;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -594,6 +597,25 @@ force_update() {
 }
 
 
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundle::defer_update
+//       Access: Public
+//  Description: Called by a MovingPart's update_internals() while
+//               get_defer_updates() is true, to record that its
+//               apply_update() method should be called with the
+//               indicated parameters once the evaluation is
+//               complete.
+////////////////////////////////////////////////////////////////////
+void PartBundle::
+defer_update(MovingPartBase *part, bool self_changed, bool net_changed) {
+  nassertv(_defer_updates);
+  DeferredUpdate update;
+  update._part = part;
+  update._self_changed = self_changed;
+  update._net_changed = net_changed;
+  _deferred_updates.push_back(update);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PartBundle::control_activated
 //       Access: Public, Virtual
@@ -816,6 +838,25 @@ clear_and_stop_intersecting(AnimControl *control, CData *cdata) {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundle::apply_deferred_updates
+//       Access: Private
+//  Description: Applies all of the changes recorded by
+//               defer_update() since the last call, in the order they
+//               were recorded, which is the same order in which they
+//               would have been applied by an ordinary update().
+////////////////////////////////////////////////////////////////////
+void PartBundle::
+apply_deferred_updates(Thread *current_thread) {
+  DeferredUpdates::const_iterator di;
+  for (di = _deferred_updates.begin(); di != _deferred_updates.end(); ++di) {
+    const DeferredUpdate &update = (*di);
+    update._part->apply_update(this, update._self_changed, update._net_changed,
+                               current_thread);
+  }
+  _deferred_updates.clear();
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PartBundle::finalize
 //       Access: Public, Virtual
@@ -39,6 +39,7 @@ class PartBundleNode;
 class PartBundleNode;
 class TransformState;
 class AnimPreloadTable;
+class MovingPartBase;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : PartBundle
@@ -151,6 +152,10 @@ public:
   virtual void control_activated(AnimControl *control);
   INLINE void set_update_delay(double delay);
 
+  INLINE bool get_defer_updates() const;
+  void defer_update(MovingPartBase *part, bool self_changed,
+                    bool net_changed);
+
   bool do_bind_anim(AnimControl *control, AnimBundle *anim,
                     int hierarchy_match_flags, const PartSubset &subset);
 
@@ -165,6 +170,7 @@ private:
   PN_stdfloat do_get_control_effect(AnimControl *control, const CData *cdata) const;
   void recompute_net_blend(CData *cdata);
   void clear_and_stop_intersecting(AnimControl *control, CData *cdata);
+  void apply_deferred_updates(Thread *current_thread);
 
   COWPT(AnimPreloadTable) _anim_preload;
 
@@ -176,6 +182,20 @@ private:
 
   double _update_delay;
 
+  // While a PartBundleBatch is evaluating this bundle on a worker
+  // thread, _defer_updates is true, and the parts record the changes
+  // they would have made to the scene graph here instead, to be
+  // applied later on the calling thread.
+  class DeferredUpdate {
+  public:
+    MovingPartBase *_part;
+    bool _self_changed;
+    bool _net_changed;
+  };
+  typedef pvector<DeferredUpdate> DeferredUpdates;
+  bool _defer_updates;
+  DeferredUpdates _deferred_updates;
+
   // This is the data that must be cycled between pipeline stages.
   class CData : public CycleData {
   public:
@@ -239,6 +259,7 @@ private:
   friend class MovingPartBase;
   friend class MovingPartMatrix;
   friend class MovingPartScalar;
+  friend class PartBundleBatch;
 };
 
 inline ostream &operator <<(ostream &out, const PartBundle &bundle) {
@@ -0,0 +1,191 @@
+// Filename: partBundleBatch.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "partBundleBatch.h"
+#include "config_chan.h"
+#include "parallelFor.h"
+#include "pStatTimer.h"
+
+#include <algorithm>
+
+PStatCollector PartBundleBatch::_evaluate_pcollector("*:Animation:Joints:Batch evaluate");
+PStatCollector PartBundleBatch::_apply_pcollector("*:Animation:Joints:Batch apply");
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::Constructor
+//       Access: Published
+//  Description:
+////////////////////////////////////////////////////////////////////
+PartBundleBatch::
+PartBundleBatch() {
+  _num_threads = anim_batch_num_threads;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::Destructor
+//       Access: Published
+//  Description:
+////////////////////////////////////////////////////////////////////
+PartBundleBatch::
+~PartBundleBatch() {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::add_bundle
+//       Access: Published
+//  Description: Adds the indicated bundle to the batch, if it is not
+//               already there.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+add_bundle(PartBundle *bundle) {
+  nassertv(bundle != (PartBundle *)NULL);
+  Bundles::const_iterator bi = find(_bundles.begin(), _bundles.end(), bundle);
+  if (bi == _bundles.end()) {
+    _bundles.push_back(bundle);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::add_bundles_from
+//       Access: Published
+//  Description: Adds all of the bundles of the indicated node, for
+//               instance a Character, to the batch.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+add_bundles_from(PartBundleNode *node) {
+  nassertv(node != (PartBundleNode *)NULL);
+  int num_bundles = node->get_num_bundles();
+  for (int i = 0; i < num_bundles; ++i) {
+    add_bundle(node->get_bundle(i));
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::remove_bundle
+//       Access: Published
+//  Description: Removes the indicated bundle from the batch.
+//               Returns true if it was removed, false if it was not
+//               in the batch.
+////////////////////////////////////////////////////////////////////
+bool PartBundleBatch::
+remove_bundle(PartBundle *bundle) {
+  Bundles::iterator bi = find(_bundles.begin(), _bundles.end(), bundle);
+  if (bi == _bundles.end()) {
+    return false;
+  }
+  _bundles.erase(bi);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::update
+//       Access: Published
+//  Description: Calls PartBundle::update() on each of the bundles in
+//               the batch, possibly in parallel.  Returns true if any
+//               part of any bundle has changed as a result, or false
+//               otherwise.
+////////////////////////////////////////////////////////////////////
+bool PartBundleBatch::
+update() {
+  return do_update(false);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::force_update
+//       Access: Published
+//  Description: Calls PartBundle::force_update() on each of the
+//               bundles in the batch, possibly in parallel.
+////////////////////////////////////////////////////////////////////
+bool PartBundleBatch::
+force_update() {
+  return do_update(true);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::do_update
+//       Access: Private
+//  Description: The implementation of update() and force_update().
+//               Each bundle is evaluated with its scene graph changes
+//               deferred, on the calling thread and the threads of
+//               the "animation" task chain, and then the changes are
+//               applied here on the calling thread.
+////////////////////////////////////////////////////////////////////
+bool PartBundleBatch::
+do_update(bool force) {
+  int num_bundles = (int)_bundles.size();
+  bool any_changed = false;
+
+  ParallelFor pfor("animation", _num_threads);
+  if (pfor.get_num_workers(num_bundles) <= 1) {
+    // Nothing to parallelize; just update them in turn.
+    for (int i = 0; i < num_bundles; ++i) {
+      PartBundle *bundle = _bundles[i];
+      if (force ? bundle->force_update() : bundle->update()) {
+        any_changed = true;
+      }
+    }
+    return any_changed;
+  }
+
+  UpdateState state;
+  state._batch = this;
+  state._force = force;
+  state._changed.resize(num_bundles, 0);
+
+  // Make sure that none of the bundles is already being evaluated,
+  // for instance by another batch, before we claim any of them.
+  for (int i = 0; i < num_bundles; ++i) {
+    nassertr(!_bundles[i]->_defer_updates, false);
+  }
+  for (int i = 0; i < num_bundles; ++i) {
+    _bundles[i]->_defer_updates = true;
+  }
+
+  pfor.run(&update_bundles, &state, num_bundles);
+
+  // Now make the resulting changes to the scene graph, in the same
+  // order as a serial update.
+  Thread *current_thread = Thread::get_current_thread();
+  PStatTimer timer(_apply_pcollector, current_thread);
+  for (int i = 0; i < num_bundles; ++i) {
+    PartBundle *bundle = _bundles[i];
+    bundle->_defer_updates = false;
+    bundle->apply_deferred_updates(current_thread);
+    if (state._changed[i]) {
+      any_changed = true;
+    }
+  }
+
+  return any_changed;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::update_bundles
+//       Access: Private, Static
+//  Description: The ParallelFor function for do_update().  It
+//               evaluates the indicated range of bundles.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+update_bundles(void *user_data, int begin, int end, int worker_index) {
+  UpdateState *state = (UpdateState *)user_data;
+  const Bundles &bundles = state->_batch->_bundles;
+  Thread *current_thread = Thread::get_current_thread();
+
+  PStatTimer timer(_evaluate_pcollector, current_thread);
+  for (int i = begin; i < end; ++i) {
+    PartBundle *bundle = bundles[i];
+    bool changed = state->_force ? bundle->force_update() : bundle->update();
+    state->_changed[i] = changed ? 1 : 0;
+  }
+}
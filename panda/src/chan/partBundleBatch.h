@@ -0,0 +1,91 @@
+// Filename: partBundleBatch.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef PARTBUNDLEBATCH_H
+#define PARTBUNDLEBATCH_H
+
+#include "pandabase.h"
+
+#include "partBundle.h"
+#include "partBundleNode.h"
+#include "referenceCount.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "pStatCollector.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : PartBundleBatch
+// Description : A collection of independent PartBundles, for instance
+//               the bundles of many Characters, that may be updated
+//               together for the current frame.
+//
+//               When set_num_threads() allows it, the joint
+//               hierarchies of the bundles are evaluated concurrently
+//               by the calling thread and the threads of the
+//               "animation" task chain.  The changes to the scene
+//               graph that result (the transforms of exposed and
+//               controlled joints, and the invalidation of the
+//               animated vertices) are then applied on the calling
+//               thread, one bundle at a time, in the order the
+//               bundles were added.
+//
+//               The scene graph and the bundles' AnimControls must
+//               not be modified by other threads while update() is in
+//               progress.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_CHAN PartBundleBatch : public ReferenceCount {
+PUBLISHED:
+  PartBundleBatch();
+  ~PartBundleBatch();
+
+  void add_bundle(PartBundle *bundle);
+  void add_bundles_from(PartBundleNode *node);
+  bool remove_bundle(PartBundle *bundle);
+  INLINE void clear_bundles();
+
+  INLINE int get_num_bundles() const;
+  INLINE PartBundle *get_bundle(int n) const;
+  MAKE_SEQ(get_bundles, get_num_bundles, get_bundle);
+
+  INLINE void set_num_threads(int num_threads);
+  INLINE int get_num_threads() const;
+
+  bool update();
+  bool force_update();
+
+private:
+  bool do_update(bool force);
+  static void update_bundles(void *user_data, int begin, int end,
+                             int worker_index);
+
+  typedef pvector< PT(PartBundle) > Bundles;
+  Bundles _bundles;
+  int _num_threads;
+
+  // This is the state shared by the workers of a single parallel
+  // update.
+  class UpdateState {
+  public:
+    PartBundleBatch *_batch;
+    bool _force;
+    pvector<int> _changed;
+  };
+
+  static PStatCollector _evaluate_pcollector;
+  static PStatCollector _apply_pcollector;
+};
+
+#include "partBundleBatch.I"
+
+#endif
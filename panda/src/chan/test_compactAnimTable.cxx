@@ -0,0 +1,181 @@
+// Filename: test_compactAnimTable.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "animBundle.h"
+#include "animChannelMatrixXfmTable.h"
+#include "compactAnimTable.h"
+#include "compose_matrix.h"
+#include "pta_stdfloat.h"
+
+#include <math.h>
+
+// This program fills an AnimChannelMatrixXfmTable with some curves,
+// reduces it with compact_tables(), and checks that every frame still
+// decodes to within the requested tolerance of the original values,
+// both one component at a time and through get_value(), which decodes
+// the compact tables together.
+
+static const int num_frames = 500;
+static const PN_stdfloat tolerance = 0.001f;
+static const PN_stdfloat hpr_tolerance = 0.01f;
+
+// Allow for the rounding of the decoding arithmetic itself.
+static const PN_stdfloat epsilon = 0.0001f;
+
+static PN_stdfloat
+make_value(int table_index, int frame) {
+  PN_stdfloat t = (PN_stdfloat)frame / (PN_stdfloat)num_frames;
+  switch (table_index) {
+  case 0:
+  case 1:
+  case 2:
+    // Scale: a slow pulse.
+    return 1.0f + 0.25f * sin(t * 6.2831853f * (table_index + 1));
+
+  case 6:
+    // Heading: a full turn, wrapping around.
+    return fmod(t * 720.0f, 360.0f) - 180.0f;
+
+  case 7:
+  case 8:
+    // Pitch and roll: a wobble.
+    return 30.0f * sin(t * 25.0f + table_index);
+
+  case 9:
+    // x: a straight line, which needs only two keys.
+    return -5.0f + 10.0f * t;
+
+  case 10:
+    // y: a step.
+    return (frame < num_frames / 3) ? 0.0f : 2.0f;
+
+  case 11:
+    // z: a bounce.
+    return fabs(sin(t * 12.0f)) * 3.0f;
+  }
+
+  // The shear tables are left empty.
+  return 0.0f;
+}
+
+static bool
+check_close(const char *what, int table_index, int frame,
+            PN_stdfloat value, PN_stdfloat expected, PN_stdfloat limit) {
+  if (fabs(value - expected) > limit) {
+    nout << what << " of table " << table_index << " at frame " << frame
+         << " is " << value << ", expected " << expected << "\n";
+    return false;
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  PT(AnimBundle) bundle = new AnimBundle("bundle", 24.0f, num_frames);
+  PT(AnimChannelMatrixXfmTable) channel =
+    new AnimChannelMatrixXfmTable(bundle, "joint");
+
+  PN_stdfloat original[num_matrix_components][num_frames];
+  for (int i = 0; i < num_matrix_components; ++i) {
+    if (i >= 3 && i < 6) {
+      for (int f = 0; f < num_frames; ++f) {
+        original[i][f] = 0.0f;
+      }
+      continue;
+    }
+    PTA_stdfloat table = PTA_stdfloat::empty_array(num_frames);
+    for (int f = 0; f < num_frames; ++f) {
+      original[i][f] = make_value(i, f);
+      table[f] = original[i][f];
+    }
+    channel->set_table(matrix_component_letters[i], table);
+  }
+
+  size_t saved_before = AnimChannelMatrixXfmTable::get_compact_saved_size();
+  channel->compact_tables(tolerance, hpr_tolerance);
+
+  bool all_ok = true;
+  int num_compact = 0;
+  for (int i = 0; i < num_matrix_components; ++i) {
+    if (channel->is_table_compact(matrix_component_letters[i])) {
+      ++num_compact;
+    }
+  }
+  if (num_compact < 4) {
+    nout << "Only " << num_compact << " tables were compacted\n";
+    all_ok = false;
+  }
+  if (AnimChannelMatrixXfmTable::get_compact_saved_size() <= saved_before) {
+    nout << "No memory was saved\n";
+    all_ok = false;
+  }
+
+  for (int f = 0; f < num_frames && all_ok; ++f) {
+    LVecBase3 scale, hpr, pos;
+    channel->get_scale(f, scale);
+    channel->get_hpr(f, hpr);
+    channel->get_pos(f, pos);
+    for (int c = 0; c < 3; ++c) {
+      all_ok = check_close("scale", c, f, scale[c], original[c][f],
+                           tolerance + epsilon) && all_ok;
+      all_ok = check_close("hpr", c + 6, f, hpr[c], original[c + 6][f],
+                           hpr_tolerance + epsilon) && all_ok;
+      all_ok = check_close("pos", c + 9, f, pos[c], original[c + 9][f],
+                           tolerance + epsilon) && all_ok;
+    }
+
+    // get_value() decodes all of the compact tables together.  The
+    // result should match the matrix composed from the original
+    // components, within what the tolerances allow.
+    PN_stdfloat components[num_matrix_components];
+    for (int i = 0; i < num_matrix_components; ++i) {
+      components[i] = original[i][f];
+    }
+    LMatrix4 expected, mat;
+    compose_matrix(expected, components);
+    channel->get_value(f, mat);
+    if (!mat.almost_equal(expected, 0.01f)) {
+      nout << "Matrix at frame " << f << " is\n" << mat
+           << "expected\n" << expected;
+      all_ok = false;
+    }
+  }
+
+  // The decoded table written to a bam file matches, too.
+  for (int i = 0; i < num_matrix_components && all_ok; ++i) {
+    char table_id = matrix_component_letters[i];
+    if (!channel->is_table_compact(table_id)) {
+      continue;
+    }
+    CPTA_stdfloat table = channel->get_table(table_id);
+    PN_stdfloat limit = ((i >= 6 && i < 9) ? hpr_tolerance : tolerance) + epsilon;
+    for (int f = 0; f < num_frames; ++f) {
+      all_ok = check_close("decoded value", i, f, table[f], original[i][f],
+                           limit) && all_ok;
+    }
+  }
+
+  channel->clear_all_tables();
+  if (AnimChannelMatrixXfmTable::get_compact_saved_size() != saved_before) {
+    nout << "The compact tables were not released\n";
+    all_ok = false;
+  }
+
+  if (!all_ok) {
+    return 1;
+  }
+  nout << "All tests passed.\n";
+  return 0;
+}
@@ -0,0 +1,126 @@
+// Filename: test_partBundleBatch.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+
+#include "pandabase.h"
+#include "partBundle.h"
+#include "partBundleBatch.h"
+#include "partGroup.h"
+#include "thread.h"
+
+// This program checks that a PartBundleBatch refuses to update when
+// one of its bundles is already being evaluated by another batch,
+// and that it does so without leaving any of its other bundles
+// marked as deferred.
+//
+// To arrange this, the first bundle of the outer batch contains a
+// NestingGroup, which updates the inner batch while the outer batch
+// is evaluating it on a worker thread.  The inner batch holds a fresh
+// bundle followed by the bundle under evaluation.
+
+////////////////////////////////////////////////////////////////////
+//       Class : NestingGroup
+// Description : A PartGroup that updates another batch from within
+//               its own update, and records what it saw.
+////////////////////////////////////////////////////////////////////
+class NestingGroup : public PartGroup {
+public:
+  NestingGroup(PartGroup *parent, PartBundleBatch *inner,
+               PartBundle *fresh) :
+    PartGroup(parent, "nesting"),
+    _inner(inner),
+    _fresh(fresh),
+    _ran(false),
+    _inner_result(false),
+    _fresh_deferred(false)
+  {
+  }
+
+  virtual bool do_update(PartBundle *root, const CycleData *root_cdata,
+                         PartGroup *parent, bool parent_changed,
+                         bool anim_changed, Thread *current_thread) {
+    if (!_ran) {
+      _ran = true;
+      _inner_result = _inner->force_update();
+      _fresh_deferred = _fresh->get_defer_updates();
+    }
+    return PartGroup::do_update(root, root_cdata, parent, parent_changed,
+                                anim_changed, current_thread);
+  }
+
+  PartBundleBatch *_inner;
+  PartBundle *_fresh;
+  bool _ran;
+  bool _inner_result;
+  bool _fresh_deferred;
+};
+
+int
+main(int argc, char *argv[]) {
+  if (!Thread::is_threading_supported()) {
+    nout << "Threading is not supported; nothing to test.\n";
+    return 0;
+  }
+
+  PT(PartBundle) busy = new PartBundle("busy");
+  PT(PartBundle) other = new PartBundle("other");
+  PT(PartBundle) fresh = new PartBundle("fresh");
+
+  PartBundleBatch inner;
+  inner.set_num_threads(2);
+  inner.add_bundle(fresh);
+  inner.add_bundle(busy);
+
+  PT(NestingGroup) nesting = new NestingGroup(busy, &inner, fresh);
+
+  PartBundleBatch outer;
+  outer.set_num_threads(2);
+  outer.add_bundle(busy);
+  outer.add_bundle(other);
+
+  nout << "Expect one assertion failure here:\n";
+  outer.force_update();
+
+  bool ok = true;
+  if (!nesting->_ran) {
+    nout << "The nested update did not run.\n";
+    ok = false;
+  } else {
+    if (nesting->_inner_result) {
+      nout << "The nested update claimed to succeed.\n";
+      ok = false;
+    }
+    if (nesting->_fresh_deferred) {
+      nout << "The nested update left " << fresh->get_name()
+           << " marked as deferred.\n";
+      ok = false;
+    }
+  }
+
+  // Once the outer batch is finished, all of the bundles should be
+  // free again, and the inner batch should now update normally.
+  if (busy->get_defer_updates() || other->get_defer_updates() ||
+      fresh->get_defer_updates()) {
+    nout << "A bundle is still marked as deferred.\n";
+    ok = false;
+  }
+  inner.force_update();
+  if (fresh->get_defer_updates() || busy->get_defer_updates()) {
+    nout << "A bundle is still marked as deferred after the inner update.\n";
+    ok = false;
+  }
+
+  nout << (ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -146,6 +146,32 @@ update_internals(PartBundle *root, PartGroup *parent, bool self_changed,
     }
   }
 
+  if (root->get_defer_updates()) {
+    // We are being evaluated on a PartBundleBatch thread.  Leave the
+    // scene graph alone for now.
+    if (self_changed || net_changed) {
+      root->defer_update(this, self_changed, net_changed);
+    }
+  } else {
+    apply_update(root, self_changed, net_changed, current_thread);
+  }
+
+  return self_changed || net_changed;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterJoint::apply_update
+//       Access: Public, Virtual
+//  Description: Applies the joint's newly computed transforms to the
+//               nodes that are exposing it, and marks the vertex
+//               transforms that depend on it as stale.  This is
+//               normally called directly by update_internals(), but
+//               it is postponed when the bundle is being evaluated by
+//               a PartBundleBatch.
+////////////////////////////////////////////////////////////////////
+void CharacterJoint::
+apply_update(PartBundle *root, bool self_changed, bool net_changed,
+             Thread *current_thread) {
   if (net_changed) {
     if (!_net_transform_nodes.empty()) {
       CPT(TransformState) t = TransformState::make_mat(_net_transform);
@@ -179,8 +205,6 @@ update_internals(PartBundle *root, PartGroup *parent, bool self_changed,
       node->set_transform(t, current_thread);
     }
   }
-
-  return self_changed || net_changed;
 }
 
 ////////////////////////////////////////////////////////////////////
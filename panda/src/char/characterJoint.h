@@ -49,6 +49,8 @@ public:
   virtual bool update_internals(PartBundle *root, PartGroup *parent, 
                                 bool self_changed, bool parent_changed, 
                                 Thread *current_thread);
+  virtual void apply_update(PartBundle *root, bool self_changed,
+                            bool net_changed, Thread *current_thread);
   virtual void do_xform(const LMatrix4 &mat, const LMatrix4 &inv_mat);
 
 PUBLISHED:
@@ -84,15 +84,34 @@ make_copy() const {
 //               result of the update, or false otherwise.
 ////////////////////////////////////////////////////////////////////
 bool CharacterSlider::
-update_internals(PartBundle *, PartGroup *, bool, bool, Thread *current_thread) {
+update_internals(PartBundle *root, PartGroup *, bool self_changed, bool,
+                 Thread *current_thread) {
+  if (root->get_defer_updates()) {
+    root->defer_update(this, self_changed, false);
+  } else {
+    apply_update(root, self_changed, false, current_thread);
+  }
+  
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterSlider::apply_update
+//       Access: Public, Virtual
+//  Description: Notifies the vertex sliders that depend on this
+//               slider of its new value.  This is normally called
+//               directly by update_internals(), but it is postponed
+//               when the bundle is being evaluated by a
+//               PartBundleBatch.
+////////////////////////////////////////////////////////////////////
+void CharacterSlider::
+apply_update(PartBundle *, bool, bool, Thread *current_thread) {
   // Tell our related CharacterVertexSliders that they now need to
   // recompute themselves.
   VertexSliders::iterator vsi;
   for (vsi = _vertex_sliders.begin(); vsi != _vertex_sliders.end(); ++vsi) {
     (*vsi)->mark_modified(current_thread);
   }
-  
-  return true;
 }
 
 ////////////////////////////////////////////////////////////////////
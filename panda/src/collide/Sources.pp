@@ -4,13 +4,14 @@
 #begin lib_target
   #define TARGET p3collide
   #define LOCAL_LIBS \
-    p3tform p3gobj p3pgraph p3putil \
+    p3tform p3gobj p3pgraph p3putil p3event \
     p3pstatclient
 
   #define COMBINED_SOURCES $[TARGET]_composite1.cxx $[TARGET]_composite2.cxx
 
   #define SOURCES \
     collisionBox.I collisionBox.h \
+    collisionBVH.I collisionBVH.h \
     collisionEntry.I collisionEntry.h \
     collisionGeom.I collisionGeom.h \
     collisionHandler.I collisionHandler.h  \
@@ -43,6 +44,7 @@
 
  #define INCLUDED_SOURCES \
     collisionBox.cxx \
+    collisionBVH.cxx \
     collisionEntry.cxx \
     collisionGeom.cxx \
     collisionHandler.cxx \
@@ -75,6 +77,7 @@
 
   #define INSTALL_HEADERS \
     collisionBox.I collisionBox.h \
+    collisionBVH.I collisionBVH.h \
     collisionEntry.I collisionEntry.h \
     collisionGeom.I collisionGeom.h \
     collisionHandler.I collisionHandler.h \
@@ -120,3 +123,25 @@
     test_collide.cxx
 
 #end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_collision_bvh
+  #define LOCAL_LIBS \
+    p3collide p3mathutil
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_collision_bvh.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_sweep_and_prune
+  #define LOCAL_LIBS \
+    p3collide
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_sweep_and_prune.cxx
+
+#end test_bin_target
@@ -0,0 +1,328 @@
+// Filename: collisionBVH.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "collisionBVH.h"
+#include "geometricBoundingVolume.h"
+#include "finiteBoundingVolume.h"
+#include "boundingLine.h"
+
+#include <algorithm>
+
+// This function object class is used in r_build(), below, to order
+// the solids by the center of their boxes along one axis.
+class SortByBVHCenter {
+public:
+  SortByBVHCenter(const pvector<LPoint3> &centers, int axis) :
+    _centers(centers), _axis(axis)
+  {
+  }
+
+  inline bool operator () (int a, int b) const {
+    return _centers[a][_axis] < _centers[b][_axis];
+  }
+
+  const pvector<LPoint3> &_centers;
+  int _axis;
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::Constructor
+//       Access: Public
+//  Description: Builds a new hierarchy around the indicated bounding
+//               volumes, one per solid, in the solids' own coordinate
+//               space.
+////////////////////////////////////////////////////////////////////
+CollisionBVH::
+CollisionBVH(const CollisionBVH::Volumes &volumes) {
+  _num_solids = (int)volumes.size();
+  _solid_boxes.resize(_num_solids);
+
+  pvector<LPoint3> centers(_num_solids);
+  _solid_order.reserve(_num_solids);
+
+  for (int i = 0; i < _num_solids; ++i) {
+    const BoundingVolume *volume = volumes[i];
+    if (volume->is_empty()) {
+      // This solid can't be collided with.
+      continue;
+    }
+
+    const FiniteBoundingVolume *fbv = volume->as_finite_bounding_volume();
+    if (fbv == (FiniteBoundingVolume *)NULL) {
+      // Infinite or otherwise unbounded; we'll have to test it every
+      // time.
+      _unbounded.push_back(i);
+      continue;
+    }
+
+    Box &box = _solid_boxes[i];
+    box._min = fbv->get_min();
+    box._max = fbv->get_max();
+    centers[i] = (box._min + box._max) * 0.5f;
+    _solid_order.push_back(i);
+  }
+
+  if (!_solid_order.empty()) {
+    // This is only an estimate, since a leaf may hold fewer than
+    // max_leaf_solids solids.
+    _nodes.reserve(2 * (_solid_order.size() / max_leaf_solids + 1));
+    r_build(0, _solid_order.size(), centers);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::find_overlaps
+//       Access: Public
+//  Description: Fills result with the indices of the solids whose
+//               bounding volumes might intersect the indicated
+//               volume, which should be in the same coordinate space
+//               as the solids.  The indices are returned in
+//               increasing order, so that the solids will be tested
+//               in the same order as they appear in the node.
+//
+//               Returns true if the volume was of a kind that can be
+//               tested against the hierarchy, or false if it was not,
+//               in which case result is not filled in and every solid
+//               should be considered.
+////////////////////////////////////////////////////////////////////
+bool CollisionBVH::
+find_overlaps(const GeometricBoundingVolume *volume,
+              CollisionBVH::Indices &result) const {
+  if (volume->is_empty()) {
+    // Nothing intersects an empty volume.
+    result.clear();
+    return true;
+  }
+
+  result = _unbounded;
+
+  const FiniteBoundingVolume *fbv = volume->as_finite_bounding_volume();
+  if (fbv != (FiniteBoundingVolume *)NULL) {
+    Box box;
+    box._min = fbv->get_min();
+    box._max = fbv->get_max();
+    find_overlaps_box(box, result);
+
+  } else {
+    const BoundingLine *line = volume->as_bounding_line();
+    if (line == (BoundingLine *)NULL) {
+      return false;
+    }
+    const LPoint3 &point = line->get_point_a();
+    find_overlaps_line(point, line->get_point_b() - point, result);
+  }
+
+  sort(result.begin(), result.end());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::output
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+void CollisionBVH::
+output(ostream &out) const {
+  out << "CollisionBVH, " << _num_solids << " solids in "
+      << _nodes.size() << " nodes";
+  if (!_unbounded.empty()) {
+    out << ", " << _unbounded.size() << " unbounded";
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::r_build
+//       Access: Private
+//  Description: Recursively builds the subtree for the solids in the
+//               indicated range of _solid_order, and returns the
+//               index of its root node.  The range is split at the
+//               median along the longest axis of the box around the
+//               solids' centers.
+////////////////////////////////////////////////////////////////////
+int CollisionBVH::
+r_build(int begin, int end, const pvector<LPoint3> &centers) {
+  int node_index = _nodes.size();
+  _nodes.push_back(Node());
+
+  Box box = _solid_boxes[_solid_order[begin]];
+  Box center_box;
+  center_box._min = centers[_solid_order[begin]];
+  center_box._max = center_box._min;
+  for (int i = begin + 1; i < end; ++i) {
+    int si = _solid_order[i];
+    box.extend(_solid_boxes[si]);
+
+    Box point;
+    point._min = centers[si];
+    point._max = centers[si];
+    center_box.extend(point);
+  }
+  _nodes[node_index]._box = box;
+
+  LVector3 extent = center_box._max - center_box._min;
+  if (end - begin <= max_leaf_solids ||
+      (extent[0] == 0.0f && extent[1] == 0.0f && extent[2] == 0.0f)) {
+    // Make a leaf.  (If all of the centers coincide, there's no point
+    // in splitting further.)
+    _nodes[node_index]._index = begin;
+    _nodes[node_index]._num_solids = end - begin;
+    return node_index;
+  }
+
+  int axis = 0;
+  if (extent[1] > extent[axis]) {
+    axis = 1;
+  }
+  if (extent[2] > extent[axis]) {
+    axis = 2;
+  }
+
+  int mid = (begin + end) / 2;
+  nth_element(_solid_order.begin() + begin, _solid_order.begin() + mid,
+              _solid_order.begin() + end, SortByBVHCenter(centers, axis));
+
+  r_build(begin, mid, centers);
+  int right = r_build(mid, end, centers);
+
+  _nodes[node_index]._index = right;
+  _nodes[node_index]._num_solids = 0;
+  return node_index;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::find_overlaps_box
+//       Access: Private
+//  Description: Appends to result the solids whose boxes overlap the
+//               indicated box.
+////////////////////////////////////////////////////////////////////
+void CollisionBVH::
+find_overlaps_box(const Box &box, CollisionBVH::Indices &result) const {
+  if (_nodes.empty()) {
+    return;
+  }
+
+  // The tree is balanced, so this is far deeper than we will ever
+  // need.
+  int stack[64];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const Node &node = _nodes[stack[--stack_size]];
+    if (!node._box.overlaps(box)) {
+      continue;
+    }
+
+    if (node._num_solids != 0) {
+      int end = node._index + node._num_solids;
+      for (int i = node._index; i < end; ++i) {
+        int si = _solid_order[i];
+        if (_solid_boxes[si].overlaps(box)) {
+          result.push_back(si);
+        }
+      }
+    } else {
+      nassertv(stack_size + 2 <= 64);
+      int left = (int)(&node - &_nodes[0]) + 1;
+      stack[stack_size++] = node._index;
+      stack[stack_size++] = left;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::find_overlaps_line
+//       Access: Private
+//  Description: Appends to result the solids whose boxes are crossed
+//               by the indicated infinite line.
+////////////////////////////////////////////////////////////////////
+void CollisionBVH::
+find_overlaps_line(const LPoint3 &point, const LVector3 &direction,
+                   CollisionBVH::Indices &result) const {
+  if (_nodes.empty()) {
+    return;
+  }
+
+  int stack[64];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const Node &node = _nodes[stack[--stack_size]];
+    if (!node._box.intersects_line(point, direction)) {
+      continue;
+    }
+
+    if (node._num_solids != 0) {
+      int end = node._index + node._num_solids;
+      for (int i = node._index; i < end; ++i) {
+        int si = _solid_order[i];
+        if (_solid_boxes[si].intersects_line(point, direction)) {
+          result.push_back(si);
+        }
+      }
+    } else {
+      nassertv(stack_size + 2 <= 64);
+      int left = (int)(&node - &_nodes[0]) + 1;
+      stack[stack_size++] = node._index;
+      stack[stack_size++] = left;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::Box::intersects_line
+//       Access: Public
+//  Description: Returns true if the infinite line through the
+//               indicated point, in the indicated direction, passes
+//               through the box.  A line is used even for rays and
+//               segments, because that is what their bounding volume
+//               represents; the solid test will sort out the rest.
+////////////////////////////////////////////////////////////////////
+bool CollisionBVH::Box::
+intersects_line(const LPoint3 &point, const LVector3 &direction) const {
+  bool have_range = false;
+  PN_stdfloat t_min = 0.0f;
+  PN_stdfloat t_max = 0.0f;
+
+  for (int i = 0; i < 3; ++i) {
+    if (direction[i] == 0.0f) {
+      // The line is parallel to this slab; it must start within it.
+      if (point[i] < _min[i] || point[i] > _max[i]) {
+        return false;
+      }
+      continue;
+    }
+
+    PN_stdfloat t1 = (_min[i] - point[i]) / direction[i];
+    PN_stdfloat t2 = (_max[i] - point[i]) / direction[i];
+    if (t1 > t2) {
+      swap(t1, t2);
+    }
+
+    if (!have_range) {
+      t_min = t1;
+      t_max = t2;
+      have_range = true;
+    } else {
+      t_min = max(t_min, t1);
+      t_max = min(t_max, t2);
+      if (t_min > t_max) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,114 @@
+// Filename: collisionBVH.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef COLLISIONBVH_H
+#define COLLISIONBVH_H
+
+#include "pandabase.h"
+
+#include "referenceCount.h"
+#include "boundingVolume.h"
+#include "pointerTo.h"
+#include "luse.h"
+#include "pvector.h"
+
+class GeometricBoundingVolume;
+
+////////////////////////////////////////////////////////////////////
+//       Class : CollisionBVH
+// Description : A bounding volume hierarchy over the solids of a
+//               single CollisionNode.  Each solid is represented by
+//               the axis-aligned box around its bounding volume, and
+//               the boxes are recursively partitioned into a binary
+//               tree, so that the solids that might intersect a
+//               particular "from" volume can be found without
+//               visiting every solid in the node.
+//
+//               This is built on demand by the CollisionNode when it
+//               contains enough solids, and is thrown away whenever
+//               the set of solids changes.  Once built, it is never
+//               modified, so it may safely be queried by several
+//               threads at once.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_COLLIDE CollisionBVH : public ReferenceCount {
+public:
+  typedef pvector< CPT(BoundingVolume) > Volumes;
+  typedef pvector<int> Indices;
+
+  CollisionBVH(const Volumes &volumes);
+
+  INLINE int get_num_solids() const;
+  INLINE int get_num_nodes() const;
+
+  bool find_overlaps(const GeometricBoundingVolume *volume,
+                     Indices &result) const;
+
+  void output(ostream &out) const;
+
+private:
+  class Box {
+  public:
+    INLINE void extend(const Box &other);
+    INLINE bool overlaps(const Box &other) const;
+    bool intersects_line(const LPoint3 &point, const LVector3 &direction) const;
+
+    LPoint3 _min;
+    LPoint3 _max;
+  };
+
+  // A node of the tree.  If _num_solids is 0, this is an interior
+  // node; its left child immediately follows it in the array, and its
+  // right child is at _index.  Otherwise, it is a leaf, and it
+  // references _num_solids consecutive entries of _solid_order
+  // beginning at _index.
+  class Node {
+  public:
+    Box _box;
+    int _index;
+    int _num_solids;
+  };
+
+  int r_build(int begin, int end, const pvector<LPoint3> &centers);
+  void find_overlaps_box(const Box &box, Indices &result) const;
+  void find_overlaps_line(const LPoint3 &point, const LVector3 &direction,
+                          Indices &result) const;
+
+  typedef pvector<Node> Nodes;
+  Nodes _nodes;
+
+  // The original index of each solid, in tree order.
+  Indices _solid_order;
+
+  // The bounding box of each solid, indexed by original index.
+  typedef pvector<Box> Boxes;
+  Boxes _solid_boxes;
+
+  // The solids with an infinite bounding volume, which must always be
+  // tested.  Solids with an empty bounding volume are omitted
+  // entirely.
+  Indices _unbounded;
+
+  int _num_solids;
+
+  enum { max_leaf_solids = 4 };
+};
+
+INLINE ostream &operator << (ostream &out, const CollisionBVH &bvh) {
+  bvh.output(out);
+  return out;
+}
+
+#include "collisionBVH.I"
+
+#endif
@@ -111,6 +111,8 @@ public:
 private:
   INLINE void test_intersection(CollisionHandler *record, 
                                 const CollisionTraverser *trav) const;
+  INLINE PT(CollisionEntry) compute_intersection(CollisionHandler *record,
+                                                 const CollisionTraverser *trav) const;
   void check_clip_planes();
 
   CPT(CollisionSolid) _from;
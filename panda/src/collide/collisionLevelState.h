@@ -48,7 +48,7 @@ public:
   INLINE void clear();
   INLINE void prepare_collider(const ColliderDef &def, const NodePath &root);
 
-  bool any_in_bounds();
+  bool any_in_bounds(int &num_volume_tests);
   bool apply_transform();
 
   INLINE static bool has_max_colliders();
@@ -121,7 +121,7 @@ xform(const LMatrix4 &mat) {
     PT(CollisionSolid) solid = (*si).get_write_pointer();
     solid->xform(mat);
   }
-  mark_internal_bounds_stale();
+  mark_solids_changed();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -154,7 +154,7 @@ combine_with(PandaNode *other) {
         const COWPT(CollisionSolid) *solids_begin = &cother->_solids[0];
         const COWPT(CollisionSolid) *solids_end = solids_begin + cother->_solids.size();
         _solids.insert(_solids.end(), solids_begin, solids_end);
-        mark_internal_bounds_stale();
+        mark_solids_changed();
         return this;
       }
       
@@ -313,6 +313,45 @@ set_from_collide_mask(CollideMask mask) {
   _from_collide_mask = mask;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionNode::get_bvh
+//       Access: Public
+//  Description: Returns the bounding volume hierarchy over this
+//               node's solids, building it first if necessary.
+//               Returns NULL if the node has fewer solids than
+//               collision-bvh-min-solids, in which case it is
+//               quicker to simply test each of them in turn.
+//
+//               This is used by the CollisionTraverser to find the
+//               solids that a particular collider might intersect.
+////////////////////////////////////////////////////////////////////
+CPT(CollisionBVH) CollisionNode::
+get_bvh() const {
+  int min_solids = collision_bvh_min_solids;
+  if (min_solids <= 0 || (int)_solids.size() < min_solids) {
+    return NULL;
+  }
+
+  LightMutexHolder holder(_bvh_lock);
+  if (_bvh == (CollisionBVH *)NULL) {
+    CollisionBVH::Volumes volumes;
+    volumes.reserve(_solids.size());
+    Solids::const_iterator si;
+    for (si = _solids.begin(); si != _solids.end(); ++si) {
+      CPT(CollisionSolid) solid = (*si).get_read_pointer();
+      volumes.push_back(solid->get_bounds());
+    }
+    _bvh = new CollisionBVH(volumes);
+
+    if (collide_cat.is_debug()) {
+      collide_cat.debug()
+        << "Built " << *_bvh << " for " << *this << "\n";
+    }
+  }
+
+  return _bvh;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: CollisionNode::compute_internal_bounds
 //       Access: Protected, Virtual
@@ -18,9 +18,12 @@
 #include "pandabase.h"
 
 #include "collisionSolid.h"
+#include "collisionBVH.h"
 
 #include "collideMask.h"
 #include "pandaNode.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : CollisionNode
@@ -72,6 +75,9 @@ PUBLISHED:
 
   INLINE static CollideMask get_default_collide_mask();
 
+public:
+  CPT(CollisionBVH) get_bvh() const;
+
 protected:
   virtual void compute_internal_bounds(CPT(BoundingVolume) &internal_bounds,
                                        int &internal_vertices,
@@ -79,6 +85,7 @@ protected:
                                        Thread *current_thread) const;
 
 private:
+  INLINE void mark_solids_changed();
   CPT(RenderState) get_last_pos_state();
 
   // This data is not cycled, for now.  We assume the collision
@@ -89,6 +96,11 @@ private:
 
   typedef pvector< COWPT(CollisionSolid) > Solids;
   Solids _solids;
+
+  // The hierarchy over _solids, built on demand by get_bvh() and
+  // discarded whenever the solids change.
+  mutable CPT(CollisionBVH) _bvh;
+  mutable LightMutex _bvh_lock;
   
 public:
   static void register_with_read_factory();
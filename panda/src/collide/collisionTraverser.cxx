@@ -26,6 +26,7 @@
 #include "collisionPlane.h"
 #include "config_collide.h"
 #include "boundingSphere.h"
+#include "finiteBoundingVolume.h"
 #include "transformState.h"
 #include "geomNode.h"
 #include "geom.h"
@@ -36,6 +37,7 @@
 #include "nodePath.h"
 #include "pStatTimer.h"
 #include "indent.h"
+#include "parallelFor.h"
 
 #include <algorithm>
 
@@ -44,6 +46,7 @@ PStatCollector CollisionTraverser::_collisions_pcollector("App:Collisions");
 PStatCollector CollisionTraverser::_cnode_volume_pcollector("Collision Volumes:CollisionNode");
 PStatCollector CollisionTraverser::_gnode_volume_pcollector("Collision Volumes:GeomNode");
 PStatCollector CollisionTraverser::_geom_volume_pcollector("Collision Volumes:Geom");
+PStatCollector CollisionTraverser::_bvh_volume_pcollector("Collision Volumes:BVH");
 
 TypeHandle CollisionTraverser::_type_handle;
 
@@ -72,9 +75,13 @@ public:
 CollisionTraverser::
 CollisionTraverser(const string &name) : 
   Namable(name),
-  _this_pcollector(_collisions_pcollector, name)
+  _this_pcollector(_collisions_pcollector, name),
+  _sweep_pcollector(_this_pcollector, "Sweep")
 {
   _respect_prev_transform = respect_prev_transform;
+  _num_threads = collision_traverser_num_threads;
+  _sweep_and_prune = collision_sweep_and_prune;
+  _parallel_traversal = false;
   #ifdef DO_COLLISION_RECORDING
   _recorder = (CollisionRecorder *)NULL;
   #endif
@@ -292,13 +299,32 @@ traverse(const NodePath &root) {
     (*hi).first->begin_group();
   }
 
+  if (_sweep_and_prune) {
+    prepare_sweep(root);
+  }
+
   bool traversal_done = false;
-  if ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
-      !allow_collider_multiple) {
+  if (should_traverse_parallel()) {
+    // Divide the colliders up into enough single-word passes to keep
+    // all of the threads busy, and run the passes concurrently.
+    int max_colliders = CollisionLevelStateSingle::get_max_colliders();
+    int per_pass = ((int)_colliders.size() + _num_threads - 1) / _num_threads;
+    per_pass = max(1, min(per_pass, max_colliders));
+
+    LevelStatesSingle level_states;
+    prepare_colliders_single(level_states, root, per_pass);
+    traverse_parallel(level_states);
+    traversal_done = true;
+  }
+
+  if (!traversal_done &&
+      ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
+       !allow_collider_multiple)) {
     // Use the single-word-at-a-time traverser, which might need to make
     // lots of passes.
     LevelStatesSingle level_states;
-    prepare_colliders_single(level_states, root);
+    prepare_colliders_single(level_states, root,
+                             CollisionLevelStateSingle::get_max_colliders());
 
     if (level_states.size() == 1 || !allow_collider_multiple) {
       traversal_done = true;
@@ -347,6 +373,10 @@ traverse(const NodePath &root) {
     }
   }
 
+  if (_sweep_and_prune) {
+    sweep_and_prune();
+  }
+
   hi = _handlers.begin();
   while (hi != _handlers.end()) {
     if (!(*hi).first->end_group()) {
@@ -367,6 +397,7 @@ traverse(const NodePath &root) {
   _cnode_volume_pcollector.flush_level();
   _gnode_volume_pcollector.flush_level();
   _geom_volume_pcollector.flush_level();
+  _bvh_volume_pcollector.flush_level();
 
   CollisionSphere::flush_level();
   CollisionTube::flush_level();
@@ -511,6 +542,421 @@ write(ostream &out, int indent_level) const {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: make_sweep_bound
+//  Description: Returns a new bounding volume for the indicated
+//               collider solid, in the collider's own coordinate
+//               space, or NULL if the solid has no geometric bounding
+//               volume.  As in CollisionLevelStateBase::
+//               prepare_collider(), a sphere's volume is extended to
+//               include its position at the previous frame.
+////////////////////////////////////////////////////////////////////
+static PT(GeometricBoundingVolume)
+make_sweep_bound(const CollisionSolid *solid, const NodePath &node_path,
+                 const NodePath &root) {
+  CPT(BoundingVolume) bv = solid->get_bounds();
+  if (!bv->is_of_type(GeometricBoundingVolume::get_class_type())) {
+    return NULL;
+  }
+
+  PT(GeometricBoundingVolume) gbv;
+  gbv = DCAST(GeometricBoundingVolume, bv->make_copy());
+
+  if (bv->as_bounding_sphere()) {
+    LPoint3 pos_delta = node_path.get_pos_delta(root);
+    if (pos_delta != LVector3::zero()) {
+      PT(GeometricBoundingVolume) gbv_prev;
+      gbv_prev = DCAST(GeometricBoundingVolume, bv->make_copy());
+      gbv_prev->xform(LMatrix4::translate_mat(-pos_delta));
+      gbv->extend_by(gbv_prev);
+    }
+  }
+
+  return gbv;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: extend_sweep_box
+//  Description: Transforms the indicated volume by the indicated
+//               matrix, and enlarges the box from min to max to
+//               enclose it.  Returns false if the volume is infinite,
+//               and so cannot be enclosed by any box.
+////////////////////////////////////////////////////////////////////
+static bool
+extend_sweep_box(LPoint3 &min_point, LPoint3 &max_point, bool &have_box,
+                 const GeometricBoundingVolume *gbv, const LMatrix4 &mat) {
+  PT(GeometricBoundingVolume) xformed;
+  xformed = DCAST(GeometricBoundingVolume, gbv->make_copy());
+  xformed->xform(mat);
+
+  if (xformed->is_empty()) {
+    return true;
+  }
+  const FiniteBoundingVolume *fbv = xformed->as_finite_bounding_volume();
+  if (fbv == (FiniteBoundingVolume *)NULL) {
+    return false;
+  }
+
+  LPoint3 fmin = fbv->get_min();
+  LPoint3 fmax = fbv->get_max();
+  if (!have_box) {
+    min_point = fmin;
+    max_point = fmax;
+    have_box = true;
+  } else {
+    min_point.set(min(min_point[0], fmin[0]),
+                  min(min_point[1], fmin[1]),
+                  min(min_point[2], fmin[2]));
+    max_point.set(max(max_point[0], fmax[0]),
+                  max(max_point[1], fmax[1]),
+                  max(max_point[2], fmax[2]));
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::prepare_sweep
+//       Access: Private
+//  Description: Computes the bounding box of each collider for the
+//               sweep-and-prune pass, and records the collider nodes
+//               that the scene graph traversal should skip.  This is
+//               called at the start of traverse() when
+//               set_sweep_and_prune() is in effect.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+prepare_sweep(const NodePath &root) {
+  PStatTimer timer(_sweep_pcollector);
+
+  _sweep_colliders.clear();
+  _swept_nodes.clear();
+  _sweep_colliders.reserve(_ordered_colliders.size());
+
+  OrderedColliders::const_iterator oci;
+  for (oci = _ordered_colliders.begin();
+       oci != _ordered_colliders.end();
+       ++oci) {
+    const NodePath &cnode_path = (*oci)._node_path;
+    if (!cnode_path.is_same_graph(root)) {
+      // prepare_colliders_*() will report this one.
+      continue;
+    }
+
+    CollisionNode *cnode;
+    DCAST_INTO_V(cnode, cnode_path.node());
+
+    _sweep_colliders.push_back(SweepCollider());
+    SweepCollider &sc = _sweep_colliders.back();
+    sc._node_path = cnode_path;
+    sc._node = cnode;
+    sc._is_into = false;
+    sc._unbounded = false;
+    bool have_box = false;
+
+    CPT(TransformState) net_transform = cnode_path.get_transform(root);
+    int num_solids = cnode->get_num_solids();
+    sc._solid_bounds.reserve(num_solids);
+    for (int s = 0; s < num_solids; ++s) {
+      PT(GeometricBoundingVolume) gbv =
+        make_sweep_bound(cnode->get_solid(s), cnode_path, root);
+      sc._solid_bounds.push_back(gbv.p());
+      if (gbv == (GeometricBoundingVolume *)NULL ||
+          !extend_sweep_box(sc._min, sc._max, have_box, gbv,
+                            net_transform->get_mat())) {
+        sc._unbounded = true;
+      }
+    }
+
+    // We can only take over the "into" tests for a collider if the
+    // traversal would otherwise have reached it exactly once, along
+    // this same path.
+    if (cnode->get_into_collide_mask() != CollideMask::all_off() &&
+        cnode->get_num_parents() == 1 && cnode->get_num_children() == 0 &&
+        cnode_path != root && root.is_ancestor_of(cnode_path)) {
+      sc._is_into = true;
+      _swept_nodes.insert(cnode);
+
+      // The node's bounds are in its parent's space.
+      CPT(BoundingVolume) node_bv = cnode->get_bounds();
+      const GeometricBoundingVolume *node_gbv = node_bv->as_geometric_bounding_volume();
+      CPT(TransformState) parent_transform =
+        cnode_path.get_parent().get_transform(root);
+      if (node_gbv == (GeometricBoundingVolume *)NULL ||
+          !extend_sweep_box(sc._min, sc._max, have_box, node_gbv,
+                            parent_transform->get_mat())) {
+        sc._unbounded = true;
+      }
+    }
+
+    if (!have_box && !sc._unbounded) {
+      // Nothing to collide with or from.
+      _sweep_colliders.pop_back();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::sweep_and_prune
+//       Access: Private
+//  Description: Tests the colliders prepared by prepare_sweep()
+//               against each other.  The boxes are sorted by their
+//               minimum X coordinate, and swept from left to right,
+//               keeping a list of the boxes whose X range is still
+//               open; only the boxes that also overlap in Y and Z are
+//               passed on to the narrow phase.  Colliders with
+//               infinite bounds are paired with everything.
+//
+//               A collider is never paired with itself.  The ordinary
+//               traversal doesn't test a collider against its own
+//               node either (see CollisionLevelState::any_in_bounds()),
+//               so the solids of one node never collide with each
+//               other, with or without the sweep.
+//
+//               The candidate pairs are tested in order of collider
+//               index, regardless of where the colliders happen to
+//               be, so that the handlers see the entries in a
+//               consistent order from frame to frame.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+sweep_and_prune() {
+  PStatTimer timer(_sweep_pcollector);
+
+  int num_colliders = (int)_sweep_colliders.size();
+
+  typedef pvector< pair<PN_stdfloat, int> > SortedColliders;
+  SortedColliders sorted;
+  sorted.reserve(num_colliders);
+  pvector<int> unbounded;
+
+  int i;
+  for (i = 0; i < num_colliders; ++i) {
+    const SweepCollider &sc = _sweep_colliders[i];
+    if (sc._unbounded) {
+      unbounded.push_back(i);
+    } else {
+      sorted.push_back(pair<PN_stdfloat, int>(sc._min[0], i));
+    }
+  }
+  sort(sorted.begin(), sorted.end());
+
+  typedef pvector< pair<int, int> > Pairs;
+  Pairs pairs;
+  pvector<int> active;
+
+  SortedColliders::const_iterator si;
+  for (si = sorted.begin(); si != sorted.end(); ++si) {
+    int a = (*si).second;
+    const SweepCollider &sa = _sweep_colliders[a];
+
+    size_t j = 0;
+    while (j < active.size()) {
+      int b = active[j];
+      const SweepCollider &sb = _sweep_colliders[b];
+      if (sb._max[0] < sa._min[0]) {
+        // This one is behind the sweep line now, and can't overlap
+        // anything else.
+        active[j] = active.back();
+        active.pop_back();
+        continue;
+      }
+
+      if (sb._min[1] <= sa._max[1] && sa._min[1] <= sb._max[1] &&
+          sb._min[2] <= sa._max[2] && sa._min[2] <= sb._max[2]) {
+        pairs.push_back(pair<int, int>(min(a, b), max(a, b)));
+      }
+      ++j;
+    }
+    active.push_back(a);
+  }
+
+  pvector<int>::const_iterator ui;
+  for (ui = unbounded.begin(); ui != unbounded.end(); ++ui) {
+    int a = (*ui);
+    for (int b = 0; b < num_colliders; ++b) {
+      if (b != a && (!_sweep_colliders[b]._unbounded || b > a)) {
+        pairs.push_back(pair<int, int>(min(a, b), max(a, b)));
+      }
+    }
+  }
+
+  sort(pairs.begin(), pairs.end());
+
+  Pairs::const_iterator pi;
+  for (pi = pairs.begin(); pi != pairs.end(); ++pi) {
+    const SweepCollider &sa = _sweep_colliders[(*pi).first];
+    const SweepCollider &sb = _sweep_colliders[(*pi).second];
+    compare_sweep_pair(sa, sb);
+    compare_sweep_pair(sb, sa);
+  }
+
+  _sweep_colliders.clear();
+  _swept_nodes.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::compare_sweep_pair
+//       Access: Private
+//  Description: Tests the solids of the "from" collider against the
+//               "into" collider, which were found to be close enough
+//               by sweep_and_prune().  This sets up the same
+//               bounding volumes that r_traverse_single() would have
+//               computed on reaching the "into" node, so the entries
+//               that result are the same as well.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+compare_sweep_pair(const CollisionTraverser::SweepCollider &from,
+                   const CollisionTraverser::SweepCollider &into) {
+  if (!into._is_into ||
+      (from._node->get_from_collide_mask() &
+       into._node->get_into_collide_mask()) == 0) {
+    return;
+  }
+
+  CPT(BoundingVolume) into_bv = into._node->get_bounds();
+  const GeometricBoundingVolume *into_gbv = into_bv->as_geometric_bounding_volume();
+
+  CollisionEntry entry;
+  entry._from_node = from._node;
+  entry._from_node_path = from._node_path;
+  entry._into_node = into._node;
+  entry._into_node_path = into._node_path;
+  if (_respect_prev_transform) {
+    entry._flags |= CollisionEntry::F_respect_prev_transform;
+  }
+
+  CPT(TransformState) parent_transform =
+    from._node_path.get_transform(into._node_path.get_parent());
+  CPT(TransformState) node_transform =
+    from._node_path.get_transform(into._node_path);
+
+  int num_solids = (int)from._solid_bounds.size();
+  for (int s = 0; s < num_solids; ++s) {
+    entry._from = from._node->get_solid(s);
+
+    PT(GeometricBoundingVolume) parent_gbv;
+    PT(GeometricBoundingVolume) node_gbv;
+    const GeometricBoundingVolume *solid_gbv = from._solid_bounds[s];
+    if (solid_gbv != (GeometricBoundingVolume *)NULL) {
+      parent_gbv = DCAST(GeometricBoundingVolume, solid_gbv->make_copy());
+      parent_gbv->xform(parent_transform->get_mat());
+      node_gbv = DCAST(GeometricBoundingVolume, solid_gbv->make_copy());
+      node_gbv->xform(node_transform->get_mat());
+    }
+
+    compare_collider_to_node(entry, parent_gbv, node_gbv, into_gbv, 0);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::should_traverse_parallel
+//       Access: Private
+//  Description: Returns true if the next traversal should be split
+//               across multiple threads, according to
+//               set_num_threads() and the current state of the
+//               traverser.
+////////////////////////////////////////////////////////////////////
+bool CollisionTraverser::
+should_traverse_parallel() const {
+  if (_num_threads <= 1 || _colliders.size() <= 1 ||
+      !Thread::is_threading_supported()) {
+    return false;
+  }
+
+#ifdef DO_COLLISION_RECORDING
+  if (has_recorder()) {
+    // The recorder is not prepared to be called from multiple
+    // threads.
+    return false;
+  }
+#endif  // DO_COLLISION_RECORDING
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::traverse_parallel
+//       Access: Private
+//  Description: Runs each of the indicated passes, distributing them
+//               among this thread and the threads of the "collision"
+//               task chain, and waits for them all to finish.  The
+//               CollisionEntries detected by each pass are then
+//               handed to their handlers on the current thread, in
+//               pass order, so that the handlers see the same
+//               sequence of entries no matter how the passes were
+//               scheduled.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+traverse_parallel(CollisionTraverser::LevelStatesSingle &level_states) {
+  size_t num_passes = level_states.size();
+  if (num_passes == 0) {
+    return;
+  }
+
+  ParallelFor pfor("collision", _num_threads);
+  int num_workers = pfor.get_num_workers((int)num_passes);
+
+  // Make sure all of the collectors we will need exist before the
+  // threads start, since creating them isn't thread-safe.
+  get_pass_collector(num_passes - 1);
+  get_worker_collector(num_workers - 1);
+
+  _pass_entries.clear();
+  _pass_entries.resize(num_passes);
+  _pass_counts.clear();
+  _pass_counts.resize(num_passes);
+  _parallel_traversal = true;
+
+  ParallelTraversal traversal;
+  traversal._trav = this;
+  traversal._level_states = &level_states;
+  pfor.run(&traverse_passes, &traversal, (int)num_passes);
+  _parallel_traversal = false;
+
+  // Now deliver the results, in the order they would have been
+  // delivered by a serial traversal of the same passes.
+  PassEntries::iterator pi;
+  for (pi = _pass_entries.begin(); pi != _pass_entries.end(); ++pi) {
+    PendingEntries::iterator ei;
+    for (ei = (*pi).begin(); ei != (*pi).end(); ++ei) {
+      (*ei)._handler->add_entry((*ei)._entry);
+    }
+  }
+  _pass_entries.clear();
+
+  // And add up the statistics the passes counted.
+  PassCountsList::const_iterator pci;
+  for (pci = _pass_counts.begin(); pci != _pass_counts.end(); ++pci) {
+    PassCounts::const_iterator ci;
+    for (ci = (*pci).begin(); ci != (*pci).end(); ++ci) {
+      (*ci).first->add_level((*ci).second);
+    }
+  }
+  _pass_counts.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::traverse_passes
+//       Access: Private, Static
+//  Description: The ParallelFor function for traverse_parallel().
+//               It traverses the indicated range of passes.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+traverse_passes(void *user_data, int begin, int end, int worker_index) {
+  ParallelTraversal *traversal = (ParallelTraversal *)user_data;
+  CollisionTraverser *trav = traversal->_trav;
+  LevelStatesSingle &level_states = *traversal->_level_states;
+  Thread *current_thread = Thread::get_current_thread();
+
+  PStatTimer worker_timer(trav->_worker_collectors[worker_index],
+                          current_thread);
+
+  for (int pass = begin; pass < end; ++pass) {
+#ifdef DO_PSTATS
+    PStatTimer pass_timer(trav->_pass_collectors[pass], current_thread);
+#endif
+    trav->r_traverse_single(level_states[pass], pass);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: CollisionTraverser::prepare_colliders_single
 //       Access: Private
@@ -519,13 +965,16 @@ write(ostream &out, int indent_level) const {
 //
 //               This flavor uses a CollisionLevelStateSingle, which is
 //               limited to a certain number of colliders per pass
-//               (typically 32).
+//               (typically 32).  The max_colliders parameter may
+//               further reduce the number of colliders in each pass,
+//               to spread them across more passes.
 ////////////////////////////////////////////////////////////////////
 void CollisionTraverser::
 prepare_colliders_single(CollisionTraverser::LevelStatesSingle &level_states, 
-                         const NodePath &root) {
+                         const NodePath &root, int max_colliders) {
   int num_colliders = _colliders.size();
-  int max_colliders = CollisionLevelStateSingle::get_max_colliders();
+  nassertv(max_colliders > 0 &&
+           max_colliders <= CollisionLevelStateSingle::get_max_colliders());
 
   CollisionLevelStateSingle level_state(root);
   // This reserve() call is only correct if there is exactly one solid
@@ -599,7 +1048,15 @@ prepare_colliders_single(CollisionTraverser::LevelStatesSingle &level_states,
 ////////////////////////////////////////////////////////////////////
 void CollisionTraverser::
 r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
-  if (!level_state.any_in_bounds()) {
+  if (is_swept_node(level_state.node())) {
+    // This collider will be tested by sweep_and_prune() instead.
+    return;
+  }
+  int num_volume_tests = 0;
+  bool any_in_bounds = level_state.any_in_bounds(num_volume_tests);
+  count_tests(CollisionLevelStateBase::_node_volume_pcollector, pass,
+              num_volume_tests);
+  if (!any_in_bounds) {
     return;
   }
   if (!level_state.apply_transform()) {
@@ -640,7 +1097,7 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry, 
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -685,7 +1142,7 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry, 
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -818,7 +1275,15 @@ prepare_colliders_double(CollisionTraverser::LevelStatesDouble &level_states,
 ////////////////////////////////////////////////////////////////////
 void CollisionTraverser::
 r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
-  if (!level_state.any_in_bounds()) {
+  if (is_swept_node(level_state.node())) {
+    // This collider will be tested by sweep_and_prune() instead.
+    return;
+  }
+  int num_volume_tests = 0;
+  bool any_in_bounds = level_state.any_in_bounds(num_volume_tests);
+  count_tests(CollisionLevelStateBase::_node_volume_pcollector, pass,
+              num_volume_tests);
+  if (!any_in_bounds) {
     return;
   }
   if (!level_state.apply_transform()) {
@@ -859,7 +1324,7 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry, 
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -904,7 +1369,7 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry, 
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -1037,7 +1502,15 @@ prepare_colliders_quad(CollisionTraverser::LevelStatesQuad &level_states,
 ////////////////////////////////////////////////////////////////////
 void CollisionTraverser::
 r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
-  if (!level_state.any_in_bounds()) {
+  if (is_swept_node(level_state.node())) {
+    // This collider will be tested by sweep_and_prune() instead.
+    return;
+  }
+  int num_volume_tests = 0;
+  bool any_in_bounds = level_state.any_in_bounds(num_volume_tests);
+  count_tests(CollisionLevelStateBase::_node_volume_pcollector, pass,
+              num_volume_tests);
+  if (!any_in_bounds) {
     return;
   }
   if (!level_state.apply_transform()) {
@@ -1078,7 +1551,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry, 
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -1123,7 +1596,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry, 
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -1177,12 +1650,13 @@ void CollisionTraverser::
 compare_collider_to_node(CollisionEntry &entry,
                          const GeometricBoundingVolume *from_parent_gbv,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *into_node_gbv) {
+                         const GeometricBoundingVolume *into_node_gbv,
+                         size_t pass) {
   bool within_node_bounds = true;
   if (from_parent_gbv != (GeometricBoundingVolume *)NULL &&
       into_node_gbv != (GeometricBoundingVolume *)NULL) {
     within_node_bounds = (into_node_gbv->contains(from_parent_gbv) != 0);
-    _cnode_volume_pcollector.add_level(1);
+    count_tests(_cnode_volume_pcollector, pass);
   }
 
   if (within_node_bounds) {
@@ -1192,7 +1666,26 @@ compare_collider_to_node(CollisionEntry &entry,
     collide_cat.spam()
       << "Colliding against CollisionNode " << entry._into_node
       << " which has " << num_solids << " collision solids.\n";
-    for (int s = 0; s < num_solids; ++s) {
+
+    // If the node has enough solids to warrant a bounding volume
+    // hierarchy, use it to narrow down the solids we need to look at.
+    // The candidates come back in their original order, so the
+    // handler sees the same entries in the same order either way.
+    const int *solid_indices = NULL;
+    int num_tests = num_solids;
+    CollisionBVH::Indices candidates;
+    if (from_node_gbv != (GeometricBoundingVolume *)NULL) {
+      CPT(CollisionBVH) bvh = cnode->get_bvh();
+      if (bvh != (CollisionBVH *)NULL &&
+          bvh->find_overlaps(from_node_gbv, candidates)) {
+        count_tests(_bvh_volume_pcollector, pass);
+        num_tests = (int)candidates.size();
+        solid_indices = candidates.empty() ? NULL : &candidates[0];
+      }
+    }
+
+    for (int i = 0; i < num_tests; ++i) {
+      int s = (solid_indices != NULL) ? solid_indices[i] : i;
       entry._into = cnode->get_solid(s);
 
       // We should allow a collision test for solid into itself,
@@ -1211,7 +1704,7 @@ compare_collider_to_node(CollisionEntry &entry,
         DCAST_INTO_V(solid_gbv, solid_bv);
       }
       
-      compare_collider_to_solid(entry, from_node_gbv, solid_gbv);
+      compare_collider_to_solid(entry, from_node_gbv, solid_gbv, pass);
     }
   }
 }
@@ -1225,12 +1718,13 @@ void CollisionTraverser::
 compare_collider_to_geom_node(CollisionEntry &entry,
                               const GeometricBoundingVolume *from_parent_gbv,
                               const GeometricBoundingVolume *from_node_gbv,
-                              const GeometricBoundingVolume *into_node_gbv) {
+                              const GeometricBoundingVolume *into_node_gbv,
+                              size_t pass) {
   bool within_node_bounds = true;
   if (from_parent_gbv != (GeometricBoundingVolume *)NULL &&
       into_node_gbv != (GeometricBoundingVolume *)NULL) {
     within_node_bounds = (into_node_gbv->contains(from_parent_gbv) != 0);
-    _gnode_volume_pcollector.add_level(1);
+    count_tests(_gnode_volume_pcollector, pass);
   }
 
   if (within_node_bounds) {
@@ -1253,7 +1747,7 @@ compare_collider_to_geom_node(CollisionEntry &entry,
           DCAST_INTO_V(geom_gbv, geom_bv);
         }
 
-        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv);
+        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv, pass);
       }
     }
   }
@@ -1267,14 +1761,15 @@ compare_collider_to_geom_node(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_solid(CollisionEntry &entry,
                           const GeometricBoundingVolume *from_node_gbv,
-                          const GeometricBoundingVolume *solid_gbv) {
+                          const GeometricBoundingVolume *solid_gbv,
+                          size_t pass) {
   bool within_solid_bounds = true;
   if (from_node_gbv != (GeometricBoundingVolume *)NULL &&
       solid_gbv != (GeometricBoundingVolume *)NULL) {
     within_solid_bounds = (solid_gbv->contains(from_node_gbv) != 0);
-    #ifdef DO_PSTATS
-    ((CollisionSolid *)entry.get_into())->get_volume_pcollector().add_level(1);
-    #endif  // DO_PSTATS
+#ifdef DO_PSTATS
+    count_tests(((CollisionSolid *)entry.get_into())->get_volume_pcollector(), pass);
+#endif  // DO_PSTATS
 #ifndef NDEBUG
     if (collide_cat.is_spam()) {
       collide_cat.spam(false)
@@ -1288,7 +1783,7 @@ compare_collider_to_solid(CollisionEntry &entry,
     Colliders::const_iterator ci;
     ci = _colliders.find(entry.get_from_node_path());
     nassertv(ci != _colliders.end());
-    entry.test_intersection((*ci).second, this);
+    test_intersection(entry, (*ci).second, pass);
   }
 }
 
@@ -1300,12 +1795,13 @@ compare_collider_to_solid(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *geom_gbv) {
+                         const GeometricBoundingVolume *geom_gbv,
+                         size_t pass) {
   bool within_geom_bounds = true;
   if (from_node_gbv != (GeometricBoundingVolume *)NULL &&
       geom_gbv != (GeometricBoundingVolume *)NULL) {
     within_geom_bounds = (geom_gbv->contains(from_node_gbv) != 0);
-    _geom_volume_pcollector.add_level(1);
+    count_tests(_geom_volume_pcollector, pass);
   }
   if (within_geom_bounds) {
     Colliders::const_iterator ci;
@@ -1344,14 +1840,12 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                 PT(BoundingSphere) sphere = new BoundingSphere;
                 sphere->around(v, v + 3);
                 within_solid_bounds = (sphere->contains(from_node_gbv) != 0);
-#ifdef DO_PSTATS
-                CollisionGeom::_volume_pcollector.add_level(1);
-#endif  // DO_PSTATS
+                count_tests(CollisionGeom::_volume_pcollector, pass);
               }
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(LVecBase3(v[0]), LVecBase3(v[1]), LVecBase3(v[2]));
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                test_intersection(entry, (*ci).second, pass);
               }
             }
           }
@@ -1374,14 +1868,12 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                 PT(BoundingSphere) sphere = new BoundingSphere;
                 sphere->around(v, v + 3);
                 within_solid_bounds = (sphere->contains(from_node_gbv) != 0);
-#ifdef DO_PSTATS
-                CollisionGeom::_volume_pcollector.add_level(1);
-#endif  // DO_PSTATS
+                count_tests(CollisionGeom::_volume_pcollector, pass);
               }
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(LVecBase3(v[0]), LVecBase3(v[1]), LVecBase3(v[2]));
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                test_intersection(entry, (*ci).second, pass);
               }
             }
           }
@@ -1391,6 +1883,34 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::test_intersection
+//       Access: Private
+//  Description: Performs the intersection test described by the
+//               indicated entry.  During a serial traversal, a
+//               detected collision is passed directly to the handler;
+//               during a parallel traversal, it is queued up with the
+//               results of the indicated pass, to be delivered when
+//               all passes have completed.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+test_intersection(const CollisionEntry &entry, CollisionHandler *handler,
+                  size_t pass) {
+  if (!_parallel_traversal) {
+    entry.test_intersection(handler, this);
+    return;
+  }
+
+  PT(CollisionEntry) result = entry.compute_intersection(handler, this);
+#ifdef DO_PSTATS
+  count_tests(((CollisionSolid *)entry.get_into())->get_test_pcollector(), pass);
+#endif  // DO_PSTATS
+  if (result != (CollisionEntry *)NULL) {
+    nassertv(pass < _pass_entries.size());
+    _pass_entries[pass].push_back(PendingEntry(handler, result));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: CollisionTraverser::remove_handler
 //       Access: Private
@@ -1467,3 +1987,34 @@ get_pass_collector(int pass) {
 
   return _pass_collectors[pass];
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::get_worker_collector
+//       Access: Private
+//  Description: Returns the PStatCollector suitable for timing the
+//               nth worker task of a parallel traversal.
+////////////////////////////////////////////////////////////////////
+PStatCollector &CollisionTraverser::
+get_worker_collector(int worker) {
+  nassertr(worker >= 0, _this_pcollector);
+  while ((int)_worker_collectors.size() <= worker) {
+    ostringstream name;
+    name << "worker" << (_worker_collectors.size() + 1);
+    PStatCollector col(_this_pcollector, name.str());
+    _worker_collectors.push_back(col);
+  }
+
+  return _worker_collectors[worker];
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::PendingEntry::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+CollisionTraverser::PendingEntry::
+PendingEntry(CollisionHandler *handler, CollisionEntry *entry) :
+  _handler(handler),
+  _entry(entry)
+{
+}
@@ -54,6 +54,12 @@ PUBLISHED:
   INLINE void set_respect_prev_transform(bool flag);
   INLINE bool get_respect_prev_transform() const;
 
+  INLINE void set_num_threads(int num_threads);
+  INLINE int get_num_threads() const;
+
+  INLINE void set_sweep_and_prune(bool flag);
+  INLINE bool get_sweep_and_prune() const;
+
   void add_collider(const NodePath &collider, CollisionHandler *handler);
   bool remove_collider(const NodePath &collider);
   bool has_collider(const NodePath &collider) const;
@@ -80,7 +86,8 @@ PUBLISHED:
 
 private:
   typedef pvector<CollisionLevelStateSingle> LevelStatesSingle;
-  void prepare_colliders_single(LevelStatesSingle &level_states, const NodePath &root);
+  void prepare_colliders_single(LevelStatesSingle &level_states, const NodePath &root,
+                                int max_colliders);
   void r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass);
 
   typedef pvector<CollisionLevelStateDouble> LevelStatesDouble;
@@ -91,22 +98,43 @@ private:
   void prepare_colliders_quad(LevelStatesQuad &level_states, const NodePath &root);
   void r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass);
 
+  class SweepCollider;
+  void prepare_sweep(const NodePath &root);
+  void sweep_and_prune();
+  void compare_sweep_pair(const SweepCollider &from,
+                          const SweepCollider &into);
+  INLINE bool is_swept_node(PandaNode *node) const;
+
+  bool should_traverse_parallel() const;
+  void traverse_parallel(LevelStatesSingle &level_states);
+  static void traverse_passes(void *user_data, int begin, int end,
+                              int worker_index);
+
   void compare_collider_to_node(CollisionEntry &entry,
                                 const GeometricBoundingVolume *from_parent_gbv,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *into_node_gbv);
+                                const GeometricBoundingVolume *into_node_gbv,
+                                size_t pass);
   void compare_collider_to_geom_node(CollisionEntry &entry,
                                      const GeometricBoundingVolume *from_parent_gbv,
                                      const GeometricBoundingVolume *from_node_gbv,
-                                     const GeometricBoundingVolume *into_node_gbv);
+                                     const GeometricBoundingVolume *into_node_gbv,
+                                     size_t pass);
   void compare_collider_to_solid(CollisionEntry &entry,
                                  const GeometricBoundingVolume *from_node_gbv,
-                                 const GeometricBoundingVolume *solid_gbv);
+                                 const GeometricBoundingVolume *solid_gbv,
+                                 size_t pass);
   void compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *solid_gbv);
+                                const GeometricBoundingVolume *solid_gbv,
+                                size_t pass);
+  void test_intersection(const CollisionEntry &entry,
+                         CollisionHandler *handler, size_t pass);
 
+  INLINE void count_tests(PStatCollector &collector, size_t pass,
+                          int num_tests = 1);
   PStatCollector &get_pass_collector(int pass);
+  PStatCollector &get_worker_collector(int worker);
 
 private:
   PT(CollisionHandler) _default_handler;
@@ -129,6 +157,62 @@ private:
   Handlers::iterator remove_handler(Handlers::iterator hi);
 
   bool _respect_prev_transform;
+  int _num_threads;
+  bool _sweep_and_prune;
+
+  // When sweep-and-prune is enabled, one of these is filled in for
+  // each collider at the start of each traversal.  The box encloses
+  // both the collider's solids, as they will be tested "from", and
+  // the node itself, as it will be tested "into", in the coordinate
+  // space of the traversal root.
+  class SweepCollider {
+  public:
+    NodePath _node_path;
+    CollisionNode *_node;
+    bool _is_into;
+    bool _unbounded;
+    LPoint3 _min;
+    LPoint3 _max;
+    typedef pvector< CPT(GeometricBoundingVolume) > SolidBounds;
+    SolidBounds _solid_bounds;
+  };
+  typedef pvector<SweepCollider> SweepColliders;
+  SweepColliders _sweep_colliders;
+
+  // The collider nodes that are tested against each other by the
+  // sweep, and are therefore skipped by the ordinary traversal.
+  typedef pset<PandaNode *> SweptNodes;
+  SweptNodes _swept_nodes;
+
+  // While a parallel traversal is in progress, the entries detected
+  // by each pass are collected here, instead of being handed directly
+  // to the handlers, so that they can be delivered in pass order
+  // once all of the passes have finished.
+  class PendingEntry {
+  public:
+    PendingEntry(CollisionHandler *handler, CollisionEntry *entry);
+    CollisionHandler *_handler;
+    PT(CollisionEntry) _entry;
+  };
+  typedef pvector<PendingEntry> PendingEntries;
+  typedef pvector<PendingEntries> PassEntries;
+  PassEntries _pass_entries;
+  bool _parallel_traversal;
+
+  // The PStats levels counted by each pass of a parallel traversal,
+  // to be added to their collectors once all of the passes have
+  // completed, since the collectors are shared by all of the threads.
+  typedef pmap<PStatCollector *, int> PassCounts;
+  typedef pvector<PassCounts> PassCountsList;
+  PassCountsList _pass_counts;
+
+  // The data handed to each worker of a parallel traversal.
+  class ParallelTraversal {
+  public:
+    CollisionTraverser *_trav;
+    LevelStatesSingle *_level_states;
+  };
+
 #ifdef DO_COLLISION_RECORDING
   CollisionRecorder *_recorder;
   NodePath _collision_visualizer_np;
@@ -140,6 +224,7 @@ private:
   static PStatCollector _cnode_volume_pcollector;
   static PStatCollector _gnode_volume_pcollector;
   static PStatCollector _geom_volume_pcollector;
+  static PStatCollector _bvh_volume_pcollector;
 
   PStatCollector _this_pcollector;
   typedef pvector<PStatCollector> PassCollectors;
@@ -147,6 +232,9 @@ private:
   // pstats category for actual collision detection (vs. bounding heirarchy collision detection)
   typedef pvector<PStatCollector> SolidCollideCollectors;
   SolidCollideCollectors _solid_collide_collectors;
+  typedef pvector<PStatCollector> WorkerCollectors;
+  WorkerCollectors _worker_collectors;
+  PStatCollector _sweep_pcollector;
 
 public:
   static TypeHandle get_class_type() {
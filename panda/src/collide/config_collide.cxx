@@ -108,6 +108,36 @@ ConfigVariableBool pushers_horizontal
           "set_horizontal() flag by default, false to let the move "
           "in three dimensions by default."));
 
+ConfigVariableInt collision_traverser_num_threads
+("collision-traverser-num-threads", 0,
+ PRC_DESC("This is the default number of threads a CollisionTraverser will "
+          "use to test its colliders in parallel.  The colliders are split "
+          "into several passes, and the passes are shared between the "
+          "calling thread and the \"collision\" task chain, which will be "
+          "given enough threads to make up this many.  The results are handed to the handlers in the "
+          "same order regardless of which thread computed them.  Set this "
+          "to 0 or 1 to traverse on the calling thread only, which is the "
+          "default.  See also CollisionTraverser::set_num_threads()."));
+
+ConfigVariableInt collision_bvh_min_solids
+("collision-bvh-min-solids", 32,
+ PRC_DESC("A CollisionNode with at least this many solids will build a "
+          "bounding volume hierarchy over them the first time it is "
+          "collided with, so that the CollisionTraverser can find the "
+          "solids near a particular collider without testing each one.  "
+          "The hierarchy is rebuilt whenever the solids are changed, so "
+          "it is best suited to static geometry.  Set this to 0 to "
+          "disable the hierarchy altogether."));
+
+ConfigVariableBool collision_sweep_and_prune
+("collision-sweep-and-prune", false,
+ PRC_DESC("Set this true to make CollisionTraverser test colliders that "
+          "are also \"into\" objects against each other with a "
+          "sweep-and-prune broadphase, instead of finding them through "
+          "the scene graph.  This can be much faster when many moving "
+          "colliders push against each other.  See also "
+          "CollisionTraverser::set_sweep_and_prune()."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libcollide
 //  Description: Initializes the library.  This must be called at
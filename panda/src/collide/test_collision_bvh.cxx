@@ -0,0 +1,139 @@
+// Filename: test_collision_bvh.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "collisionTraverser.h"
+#include "collisionNode.h"
+#include "collisionPolygon.h"
+#include "collisionRay.h"
+#include "collisionSphere.h"
+#include "collisionHandlerQueue.h"
+#include "config_collide.h"
+#include "nodePath.h"
+#include "clockObject.h"
+#include "randomizer.h"
+
+// Times a number of ray and sphere queries against a single
+// CollisionNode containing a large triangle mesh, first with the
+// bounding volume hierarchy disabled and then with it enabled, and
+// checks that both find the same collisions.
+
+static const int grid_size = 159;   // 2 * 158 * 158 = 49928 triangles
+static const int num_rays = 64;
+static const int num_spheres = 64;
+static const int num_frames = 20;
+
+////////////////////////////////////////////////////////////////////
+//     Function: make_mesh
+//  Description: Builds a bumpy terrain-like grid of triangles, each
+//               a separate CollisionPolygon.
+////////////////////////////////////////////////////////////////////
+static PT(CollisionNode)
+make_mesh() {
+  PT(CollisionNode) cnode = new CollisionNode("mesh");
+
+  for (int yi = 0; yi < grid_size - 1; ++yi) {
+    for (int xi = 0; xi < grid_size - 1; ++xi) {
+      LPoint3 v[4];
+      for (int i = 0; i < 4; ++i) {
+        int x = xi + (i & 1);
+        int y = yi + (i >> 1);
+        v[i].set(x, y, csin(x * 0.3f) + ccos(y * 0.2f));
+      }
+      cnode->add_solid(new CollisionPolygon(v[0], v[1], v[3]));
+      cnode->add_solid(new CollisionPolygon(v[0], v[3], v[2]));
+    }
+  }
+
+  return cnode;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: run_frames
+//  Description: Traverses the indicated number of times, and returns
+//               the average time per traversal in seconds.  The total
+//               number of collisions detected is stored in
+//               num_entries.
+////////////////////////////////////////////////////////////////////
+static double
+run_frames(CollisionTraverser &trav, const NodePath &root,
+           CollisionHandlerQueue *queue, int &num_entries) {
+  ClockObject *clock = ClockObject::get_global_clock();
+
+  num_entries = 0;
+  double start = clock->get_real_time();
+  for (int i = 0; i < num_frames; ++i) {
+    trav.traverse(root);
+    num_entries += queue->get_num_entries();
+  }
+  double end = clock->get_real_time();
+
+  return (end - start) / (double)num_frames;
+}
+
+int
+main(int argc, char *argv[]) {
+  NodePath root("root");
+  PT(CollisionNode) mesh = make_mesh();
+  root.attach_new_node(mesh);
+
+  cerr << "Mesh has " << mesh->get_num_solids() << " solids.\n";
+
+  CollisionTraverser trav;
+  PT(CollisionHandlerQueue) queue = new CollisionHandlerQueue;
+
+  Randomizer random(1);
+  PN_stdfloat extent = (PN_stdfloat)(grid_size - 1);
+
+  for (int i = 0; i < num_rays; ++i) {
+    PT(CollisionNode) cnode = new CollisionNode("ray");
+    cnode->add_solid(new CollisionRay(0, 0, 0, 0, 0, -1));
+    cnode->set_into_collide_mask(CollideMask::all_off());
+    NodePath np = root.attach_new_node(cnode);
+    np.set_pos(random.random_real(extent), random.random_real(extent), 10);
+    trav.add_collider(np, queue);
+  }
+
+  for (int i = 0; i < num_spheres; ++i) {
+    PT(CollisionNode) cnode = new CollisionNode("sphere");
+    cnode->add_solid(new CollisionSphere(0, 0, 0, 1.5f));
+    cnode->set_into_collide_mask(CollideMask::all_off());
+    NodePath np = root.attach_new_node(cnode);
+    np.set_pos(random.random_real(extent), random.random_real(extent), 0);
+    trav.add_collider(np, queue);
+  }
+
+  int linear_entries, bvh_entries;
+
+  collision_bvh_min_solids.set_value(0);
+  double linear_time = run_frames(trav, root, queue, linear_entries);
+
+  collision_bvh_min_solids.set_value(32);
+  ClockObject *clock = ClockObject::get_global_clock();
+  double build_start = clock->get_real_time();
+  CPT(CollisionBVH) bvh = mesh->get_bvh();
+  double build_time = clock->get_real_time() - build_start;
+  double bvh_time = run_frames(trav, root, queue, bvh_entries);
+
+  cerr << *bvh << ", built in " << build_time * 1000.0 << " ms\n";
+  cerr << "Without BVH: " << linear_time * 1000.0 << " ms per traversal, "
+       << linear_entries << " entries\n";
+  cerr << "With BVH:    " << bvh_time * 1000.0 << " ms per traversal, "
+       << bvh_entries << " entries\n";
+
+  if (linear_entries != bvh_entries) {
+    cerr << "Collision results differ!\n";
+    return 1;
+  }
+  return 0;
+}
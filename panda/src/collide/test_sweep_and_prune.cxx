@@ -0,0 +1,167 @@
+// Filename: test_sweep_and_prune.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "collisionTraverser.h"
+#include "collisionNode.h"
+#include "collisionPolygon.h"
+#include "collisionRay.h"
+#include "collisionSphere.h"
+#include "collisionHandlerQueue.h"
+#include "nodePath.h"
+#include "string_utils.h"
+
+// Runs the same scene through a CollisionTraverser with
+// sweep-and-prune disabled and then enabled, and checks that both
+// report exactly the same collisions.  The scene is a grid of
+// colliders that are also "into" objects, each with two solids that
+// overlap each other, standing on a floor that is not a collider,
+// and a ray that looks down on them.
+
+static const int grid_size = 6;
+static const PN_stdfloat spacing = 1.5f;
+
+////////////////////////////////////////////////////////////////////
+//     Function: get_solid_index
+//  Description: Returns the index of the indicated solid within its
+//               node, or -1 if it is not there.
+////////////////////////////////////////////////////////////////////
+static int
+get_solid_index(const PandaNode *node, const CollisionSolid *solid) {
+  const CollisionNode *cnode = DCAST(CollisionNode, node);
+  for (int s = 0; s < cnode->get_num_solids(); ++s) {
+    if (cnode->get_solid(s) == solid) {
+      return s;
+    }
+  }
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: collect_entries
+//  Description: Traverses the scene once, and returns a sorted list
+//               of the collisions detected, each one described by
+//               the names of the two nodes and the indices of the
+//               two solids.  Returns false if a collider was tested
+//               against its own node.
+////////////////////////////////////////////////////////////////////
+static bool
+collect_entries(CollisionTraverser &trav, const NodePath &root,
+                CollisionHandlerQueue *queue, vector_string &result) {
+  trav.traverse(root);
+
+  result.clear();
+  for (int i = 0; i < queue->get_num_entries(); ++i) {
+    CollisionEntry *entry = queue->get_entry(i);
+    if (entry->get_from_node() == entry->get_into_node()) {
+      cerr << entry->get_from_node_path()
+           << " was tested against itself\n";
+      return false;
+    }
+    ostringstream strm;
+    strm << entry->get_from_node()->get_name() << ":"
+         << get_solid_index(entry->get_from_node(), entry->get_from())
+         << " into " << entry->get_into_node()->get_name() << ":"
+         << get_solid_index(entry->get_into_node(), entry->get_into());
+    result.push_back(strm.str());
+  }
+
+  sort(result.begin(), result.end());
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  NodePath root("root");
+  CollisionTraverser trav;
+  PT(CollisionHandlerQueue) queue = new CollisionHandlerQueue;
+
+  // The neighbors in each row and column overlap, but the diagonal
+  // ones do not, with a good margin either way.  Each collider's
+  // upper sphere overlaps its own lower sphere, but nothing else.
+  // The rows are placed under separately transformed parents.
+  for (int yi = 0; yi < grid_size; ++yi) {
+    NodePath row = root.attach_new_node("row" + format_string(yi));
+    row.set_pos(0, yi * spacing, 0);
+    for (int xi = 0; xi < grid_size; ++xi) {
+      PT(CollisionNode) cnode =
+        new CollisionNode("c" + format_string(xi) + "_" + format_string(yi));
+      cnode->add_solid(new CollisionSphere(0, 0, 0, 1));
+      cnode->add_solid(new CollisionSphere(0, 0, 1, 0.5f));
+      NodePath np = row.attach_new_node(cnode);
+      np.set_pos(xi * spacing, 0, 0);
+      trav.add_collider(np, queue);
+    }
+  }
+
+  // The floor is only an "into" object, and is traversed normally
+  // either way.
+  PN_stdfloat extent = grid_size * spacing;
+  PT(CollisionNode) floor = new CollisionNode("floor");
+  floor->add_solid(new CollisionPolygon(LPoint3(-1, -1, -0.5f),
+                                        LPoint3(extent, -1, -0.5f),
+                                        LPoint3(extent, extent, -0.5f)));
+  floor->add_solid(new CollisionPolygon(LPoint3(-1, -1, -0.5f),
+                                        LPoint3(extent, extent, -0.5f),
+                                        LPoint3(-1, extent, -0.5f)));
+  floor->set_from_collide_mask(CollideMask::all_off());
+  root.attach_new_node(floor);
+
+  // The ray is only a "from" object, so the sweep tests it against
+  // the colliders without taking over any "into" tests for it.
+  PT(CollisionNode) ray = new CollisionNode("ray");
+  ray->add_solid(new CollisionRay(LPoint3(0, 0, 0), LVector3(0, 0, -1)));
+  ray->set_into_collide_mask(CollideMask::all_off());
+  NodePath ray_np = root.attach_new_node(ray);
+  ray_np.set_pos(2 * spacing, 3 * spacing, 10);
+  trav.add_collider(ray_np, queue);
+
+  vector_string plain_entries, swept_entries;
+
+  trav.set_sweep_and_prune(false);
+  if (!collect_entries(trav, root, queue, plain_entries)) {
+    return 1;
+  }
+
+  trav.set_sweep_and_prune(true);
+  if (!collect_entries(trav, root, queue, swept_entries)) {
+    return 1;
+  }
+
+  // Each collider touches its neighbors in the row and column, in
+  // both directions, and the floor; the ones on the diagonal touch
+  // both of its triangles.  The ray passes through both spheres of
+  // one collider, and then hits the floor.
+  size_t num_neighbors = 4 * grid_size * (grid_size - 1);
+  size_t num_floor = grid_size * grid_size + grid_size;
+  size_t expected = num_neighbors + num_floor + 3;
+  if (plain_entries.size() != expected) {
+    cerr << "Expected " << expected << " entries, found "
+         << plain_entries.size() << "\n";
+    return 1;
+  }
+
+  if (swept_entries != plain_entries) {
+    cerr << "Collision results differ with sweep-and-prune!\n";
+    for (size_t i = 0; i < plain_entries.size(); ++i) {
+      cerr << "  without: " << plain_entries[i] << "\n";
+    }
+    for (size_t i = 0; i < swept_entries.size(); ++i) {
+      cerr << "  with:    " << swept_entries[i] << "\n";
+    }
+    return 1;
+  }
+
+  cerr << plain_entries.size() << " entries, the same either way.\n";
+  return 0;
+}
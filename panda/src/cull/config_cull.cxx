@@ -17,6 +17,7 @@
 #include "cullBinBackToFront.h"
 #include "cullBinFixed.h"
 #include "cullBinFrontToBack.h"
+#include "cullBinInstanced.h"
 #include "cullBinStateSorted.h"
 #include "cullBinUnsorted.h"
 
@@ -30,6 +31,12 @@ ConfigureFn(config_cull) {
   init_libcull();
 }
 
+ConfigVariableInt cull_bin_instanced_max_batch
+("cull-bin-instanced-max-batch", 1024,
+ PRC_DESC("The maximum number of objects that a bin of type \"instanced\" "
+          "will combine into a single instanced draw call.  Longer runs "
+          "of identical objects are split into several calls."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libcull
 //  Description: Initializes the library.  This must be called at
@@ -49,6 +56,8 @@ init_libcull() {
   CullBinBackToFront::init_type();
   CullBinFixed::init_type();
   CullBinFrontToBack::init_type();
+  CullBinInstanced::init_type();
+  CullBinInstanced::init_instance_input_name();
   CullBinStateSorted::init_type();
   CullBinUnsorted::init_type();
 
@@ -63,4 +72,6 @@ init_libcull() {
                                  CullBinFrontToBack::make_bin);
   bin_manager->register_bin_type(CullBinManager::BT_fixed,
                                  CullBinFixed::make_bin);
+  bin_manager->register_bin_type(CullBinManager::BT_instanced,
+                                 CullBinInstanced::make_bin);
 }
@@ -27,6 +27,8 @@ class DSearchPath;
 ConfigureDecl(config_cull, EXPCL_PANDA_CULL, EXPTP_PANDA_CULL);
 NotifyCategoryDecl(cull, EXPCL_PANDA_CULL, EXPTP_PANDA_CULL);
 
+extern ConfigVariableInt cull_bin_instanced_max_batch;
+
 extern EXPCL_PANDA_CULL void init_libcull();
 
 #endif
@@ -0,0 +1,328 @@
+// Filename: cullBinInstanced.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "cullBinInstanced.h"
+#include "config_cull.h"
+#include "graphicsStateGuardianBase.h"
+#include "cullableObject.h"
+#include "cullHandler.h"
+#include "shaderAttrib.h"
+#include "pStatTimer.h"
+
+#include <algorithm>
+
+TypeHandle CullBinInstanced::_type_handle;
+PT(InternalName) CullBinInstanced::_instance_input_name;
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::Destructor
+//       Access: Public, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+CullBinInstanced::
+~CullBinInstanced() {
+  Objects::iterator oi;
+  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+    CullableObject *object = (*oi)._object;
+    delete object;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::make_bin
+//       Access: Public, Static
+//  Description: Factory constructor for passing to the CullBinManager.
+////////////////////////////////////////////////////////////////////
+CullBin *CullBinInstanced::
+make_bin(const string &name, GraphicsStateGuardianBase *gsg,
+         const PStatCollector &draw_region_pcollector) {
+  return new CullBinInstanced(name, gsg, draw_region_pcollector);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::make_next
+//       Access: Public, Virtual
+//  Description: Returns a newly-allocated CullBin object that
+//               contains a copy of just the subset of the data from
+//               this CullBin object that is worth keeping around
+//               for next frame.  In this case, that's the textures
+//               used to pass the instance transforms.
+////////////////////////////////////////////////////////////////////
+PT(CullBin) CullBinInstanced::
+make_next() const {
+  return new CullBinInstanced(*this);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::add_object
+//       Access: Public, Virtual
+//  Description: Adds a geom, along with its associated state, to
+//               the bin for rendering.
+////////////////////////////////////////////////////////////////////
+void CullBinInstanced::
+add_object(CullableObject *object, Thread *current_thread) {
+  _objects.push_back(ObjectData(object));
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::finish_cull
+//       Access: Public
+//  Description: Called after all the geoms have been added, this
+//               indicates that the cull process is finished for this
+//               frame and gives the bins a chance to do any
+//               post-processing (like sorting) before moving on to
+//               draw.
+//
+//               Here we sort the objects and divide them into
+//               batches, and compute the per-instance transforms of
+//               each batch, so that as little work as possible is
+//               left for the draw thread.
+////////////////////////////////////////////////////////////////////
+void CullBinInstanced::
+finish_cull(SceneSetup *, Thread *current_thread) {
+  PStatTimer timer(_cull_this_pcollector, current_thread);
+  sort(_objects.begin(), _objects.end());
+
+  int max_batch = 1;
+  if (_gsg->get_supports_geometry_instancing()) {
+    max_batch = max((int)cull_bin_instanced_max_batch, 1);
+  }
+
+  _batches.clear();
+  _instance_mats.clear();
+
+  int num_objects = (int)_objects.size();
+  int i = 0;
+  while (i < num_objects) {
+    CullableObject *first = _objects[i]._object;
+
+    Batch batch;
+    batch._begin = i;
+    batch._num_objects = 1;
+    batch._first_mat = -1;
+    batch._instanceable = is_instanceable(first);
+
+    LMatrix4 inv_first;
+    if (batch._instanceable && max_batch > 1 &&
+        inv_first.invert_from(first->_internal_transform->get_mat())) {
+      while (i + batch._num_objects < num_objects &&
+             batch._num_objects < max_batch &&
+             is_same_batch(first, _objects[i + batch._num_objects]._object)) {
+        ++batch._num_objects;
+      }
+    }
+
+    if (batch._num_objects > 1) {
+      // The first instance is drawn with its own transform, so its
+      // relative transform is always the identity.
+      batch._first_mat = (int)_instance_mats.size();
+      _instance_mats.push_back(LMatrix4f::ident_mat());
+      for (int j = 1; j < batch._num_objects; ++j) {
+        CullableObject *object = _objects[i + j]._object;
+        LMatrix4 mat = object->_internal_transform->get_mat() * inv_first;
+        _instance_mats.push_back(LCAST(float, mat));
+      }
+    }
+
+    _batches.push_back(batch);
+    i += batch._num_objects;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::draw
+//       Access: Public, Virtual
+//  Description: Draws all the geoms in the bin, in the appropriate
+//               order.
+////////////////////////////////////////////////////////////////////
+void CullBinInstanced::
+draw(bool force, Thread *current_thread) {
+  PStatTimer timer(_draw_this_pcollector, current_thread);
+
+  // The number of textures of each size used so far this frame.
+  pvector<int> next_texture(_pools.size(), 0);
+
+  Batches::const_iterator bi;
+  for (bi = _batches.begin(); bi != _batches.end(); ++bi) {
+    const Batch &batch = (*bi);
+    CullableObject *object = _objects[batch._begin]._object;
+    if (!batch._instanceable) {
+      CullHandler::draw(object, _gsg, force, current_thread);
+      continue;
+    }
+
+    Texture *tex;
+    if (batch._first_mat == -1) {
+      tex = get_identity_texture();
+
+    } else {
+      // Copy the instance transforms into the next texture.  We do
+      // this here rather than in finish_cull(), since the textures
+      // are shared with the bins of the next and previous frames,
+      // which might be culled while we are drawing.
+      tex = get_texture(batch._num_objects, next_texture);
+      PTA_uchar image = tex->modify_ram_image();
+      float *dest = (float *)image.p();
+      for (int j = 0; j < batch._num_objects; ++j) {
+        const LMatrix4f &mat = _instance_mats[batch._first_mat + j];
+        for (int row = 0; row < 4; ++row) {
+          // Panda stores RGBA images in BGRA order.
+          dest[0] = mat(row, 2);
+          dest[1] = mat(row, 1);
+          dest[2] = mat(row, 0);
+          dest[3] = mat(row, 3);
+          dest += 4;
+        }
+      }
+    }
+
+    const ShaderAttrib *sa = DCAST(ShaderAttrib, object->_state->get_attrib(ShaderAttrib::get_class_slot()));
+    CPT(RenderAttrib) new_sa = sa->set_shader_input(get_instance_input_name(), tex);
+    if (batch._num_objects > 1) {
+      new_sa = DCAST(ShaderAttrib, new_sa)->set_instance_count(batch._num_objects);
+    }
+
+    CullableObject instanced(*object);
+    instanced._state = object->_state->set_attrib(new_sa);
+    CullHandler::draw(&instanced, _gsg, force, current_thread);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::init_instance_input_name
+//       Access: Public, Static
+//  Description: Creates the name returned by
+//               get_instance_input_name().  This is called by
+//               init_libcull(), before any bins can be created.
+////////////////////////////////////////////////////////////////////
+void CullBinInstanced::
+init_instance_input_name() {
+  if (_instance_input_name == (InternalName *)NULL) {
+    _instance_input_name = InternalName::make("instance_transforms");
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::fill_result_graph
+//       Access: Protected, Virtual
+//  Description: Called by CullBin::make_result_graph() to add all the
+//               geoms to the special cull result scene graph.
+////////////////////////////////////////////////////////////////////
+void CullBinInstanced::
+fill_result_graph(CullBin::ResultGraphBuilder &builder) {
+  Objects::const_iterator oi;
+  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+    CullableObject *object = (*oi)._object;
+    builder.add_object(object);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::is_instanceable
+//       Access: Private, Static
+//  Description: Returns true if the indicated object should be drawn
+//               with the instance transforms, or false if it should
+//               be drawn in the normal way.  Only objects with a
+//               custom shader can be instanced, since the shader has
+//               to apply the transforms; and we leave alone any
+//               object whose shader is already instanced by hand.
+////////////////////////////////////////////////////////////////////
+bool CullBinInstanced::
+is_instanceable(const CullableObject *object) {
+  if (object->is_fancy()) {
+    return false;
+  }
+
+  const ShaderAttrib *sa = DCAST(ShaderAttrib, object->_state->get_attrib(ShaderAttrib::get_class_slot()));
+  if (sa == (ShaderAttrib *)NULL) {
+    return false;
+  }
+  return (sa->get_shader() != (Shader *)NULL &&
+          !sa->auto_shader() &&
+          sa->get_instance_count() == 0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::get_texture
+//       Access: Private
+//  Description: Returns the next unused texture this frame with room
+//               for the indicated number of instances, taking it from
+//               the pool of textures of that size, or allocating a
+//               new one if the pool is exhausted.  The textures are
+//               allocated in powers of two rows, so that a batch
+//               that changes size a little from one frame to the
+//               next can still reuse the same texture.
+//
+//               next_texture records how many textures of each size
+//               have been used so far this frame.
+////////////////////////////////////////////////////////////////////
+Texture *CullBinInstanced::
+get_texture(int num_instances, pvector<int> &next_texture) {
+  int k = 0;
+  while ((1 << k) < num_instances) {
+    ++k;
+  }
+  if (k >= (int)_pools.size()) {
+    _pools.resize(k + 1);
+  }
+  if (k >= (int)next_texture.size()) {
+    next_texture.resize(k + 1, 0);
+  }
+
+  Textures &pool = _pools[k];
+  int n = next_texture[k]++;
+  if (n < (int)pool.size()) {
+    return pool[n];
+  }
+
+  PT(Texture) tex = new Texture(get_instance_input_name()->get_name());
+  tex->setup_2d_texture(4, 1 << k, Texture::T_float, Texture::F_rgba32);
+  tex->set_minfilter(Texture::FT_nearest);
+  tex->set_magfilter(Texture::FT_nearest);
+  tex->set_keep_ram_image(true);
+  pool.push_back(tex);
+  return tex;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullBinInstanced::get_identity_texture
+//       Access: Private
+//  Description: Returns the one-row texture holding the identity
+//               matrix, which is shared by every object that is
+//               drawn by itself.  Since it never changes, it is
+//               filled in only once.
+////////////////////////////////////////////////////////////////////
+Texture *CullBinInstanced::
+get_identity_texture() {
+  if (_identity_texture == (Texture *)NULL) {
+    PT(Texture) tex = new Texture(get_instance_input_name()->get_name());
+    tex->setup_2d_texture(4, 1, Texture::T_float, Texture::F_rgba32);
+    tex->set_minfilter(Texture::FT_nearest);
+    tex->set_magfilter(Texture::FT_nearest);
+    tex->set_keep_ram_image(true);
+
+    PTA_uchar image = tex->modify_ram_image();
+    float *dest = (float *)image.p();
+    for (int row = 0; row < 4; ++row) {
+      // Panda stores RGBA images in BGRA order.
+      dest[0] = (row == 2) ? 1.0f : 0.0f;
+      dest[1] = (row == 1) ? 1.0f : 0.0f;
+      dest[2] = (row == 0) ? 1.0f : 0.0f;
+      dest[3] = (row == 3) ? 1.0f : 0.0f;
+      dest += 4;
+    }
+    _identity_texture = tex;
+  }
+  return _identity_texture;
+}
@@ -0,0 +1,153 @@
+// Filename: cullBinInstanced.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef CULLBININSTANCED_H
+#define CULLBININSTANCED_H
+
+#include "pandabase.h"
+
+#include "cullBin.h"
+#include "cullableObject.h"
+#include "geom.h"
+#include "transformState.h"
+#include "renderState.h"
+#include "texture.h"
+#include "internalName.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "luse.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : CullBinInstanced
+// Description : A specific kind of CullBin that sorts geometry by
+//               state, like CullBinStateSorted, and then collapses
+//               each run of objects that share the same Geom, vertex
+//               data, and RenderState into a single hardware-instanced
+//               draw call.
+//
+//               Only objects with a custom shader are instanced; the
+//               shader is responsible for applying the per-instance
+//               transforms, which are passed to it in a 4-texel-wide
+//               floating-point texture named by
+//               get_instance_input_name().  Row i of this texture
+//               holds the four rows of the matrix that transforms
+//               instance i into the coordinate space of the first
+//               instance, whose transform is applied in the usual
+//               way.  In GLSL, for instance:
+//
+//                 mat4 m = mat4(texelFetch(instance_transforms, ivec2(0, gl_InstanceID), 0),
+//                               texelFetch(instance_transforms, ivec2(1, gl_InstanceID), 0),
+//                               texelFetch(instance_transforms, ivec2(2, gl_InstanceID), 0),
+//                               texelFetch(instance_transforms, ivec2(3, gl_InstanceID), 0));
+//                 gl_Position = p3d_ModelViewProjectionMatrix * (m * p3d_Vertex);
+//
+//               An object that is drawn by itself, including every
+//               object when the GSG does not support instancing, is
+//               given a shared one-row texture holding the identity
+//               matrix instead, so the same shader still works.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_CULL CullBinInstanced : public CullBin {
+protected:
+  INLINE CullBinInstanced(const CullBinInstanced &copy);
+public:
+  INLINE CullBinInstanced(const string &name,
+                          GraphicsStateGuardianBase *gsg,
+                          const PStatCollector &draw_region_pcollector);
+  virtual ~CullBinInstanced();
+
+  static CullBin *make_bin(const string &name,
+                           GraphicsStateGuardianBase *gsg,
+                           const PStatCollector &draw_region_pcollector);
+  virtual PT(CullBin) make_next() const;
+
+  virtual void add_object(CullableObject *object, Thread *current_thread);
+  virtual void finish_cull(SceneSetup *scene_setup, Thread *current_thread);
+  virtual void draw(bool force, Thread *current_thread);
+
+  INLINE static InternalName *get_instance_input_name();
+  static void init_instance_input_name();
+
+protected:
+  virtual void fill_result_graph(ResultGraphBuilder &builder);
+
+private:
+  static bool is_instanceable(const CullableObject *object);
+  INLINE static bool is_same_batch(const CullableObject *a,
+                                   const CullableObject *b);
+  Texture *get_texture(int num_instances, pvector<int> &next_texture);
+  Texture *get_identity_texture();
+
+private:
+  class ObjectData {
+  public:
+    INLINE ObjectData(CullableObject *object);
+    INLINE bool operator < (const ObjectData &other) const;
+
+    CullableObject *_object;
+  };
+
+  typedef pvector<ObjectData> Objects;
+  Objects _objects;
+
+  // A batch is a run of _objects, beginning at _begin, that is drawn
+  // in one call.  The relative transforms of its instances are
+  // stored in _instance_mats, beginning at _first_mat; _first_mat is
+  // -1 for a batch of just one object.  _instanceable is false for
+  // an object that is drawn in the normal way, without the shader
+  // input.
+  class Batch {
+  public:
+    int _begin;
+    int _num_objects;
+    int _first_mat;
+    bool _instanceable;
+  };
+  typedef pvector<Batch> Batches;
+  Batches _batches;
+
+  typedef pvector<LMatrix4f> Matrices;
+  Matrices _instance_mats;
+
+  // The textures are kept from frame to frame, so that they need
+  // not be reallocated, and the state that references each one is
+  // also unchanged.  _pools[k] holds the textures with 2^k rows; each
+  // frame uses them in order, as many as it needs of each size.
+  typedef pvector< PT(Texture) > Textures;
+  typedef pvector<Textures> Pools;
+  Pools _pools;
+  PT(Texture) _identity_texture;
+
+  static PT(InternalName) _instance_input_name;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CullBin::init_type();
+    register_type(_type_handle, "CullBinInstanced",
+                  CullBin::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "cullBinInstanced.I"
+
+#endif
@@ -1,4 +1,5 @@
 #include "cullBinFrontToBack.cxx"
+#include "cullBinInstanced.cxx"
 #include "cullBinStateSorted.cxx"
 #include "cullBinUnsorted.cxx"
 #include "drawCullHandler.cxx"
@@ -94,6 +94,17 @@ ConfigVariableBool sync_flip
           "variable; it will later be replaced with a more explicit control "
           "over synchronizing window flip."));
 
+ConfigVariableInt cull_num_threads
+("cull-num-threads", 0,
+ PRC_DESC("This is the initial number of threads the GraphicsEngine will "
+          "use to cull DisplayRegions in parallel.  When this is greater "
+          "than 1, the DisplayRegions handled by each cull stage are "
+          "shared between the cull thread and the threads of the \"cull\" "
+          "task chain, and their results are handed to the draw stage in "
+          "the usual order.  "
+          "Set this to 0 or 1 to cull each DisplayRegion in turn on the "
+          "cull thread.  See GraphicsEngine::set_num_cull_threads()."));
+
 ConfigVariableBool yield_timeslice
 ("yield-timeslice", false,
  PRC_DESC("Set this true to yield the timeslice at the end of the frame to be "
@@ -46,6 +46,8 @@
 #include "config_pgraph.h"
 #include "displayRegionCullCallbackData.h"
 #include "displayRegionDrawCallbackData.h"
+#include "asyncTaskManager.h"
+#include "parallelFor.h"
 
 #if defined(WIN32)
   #define WINDOWS_LEAN_AND_MEAN
@@ -147,6 +149,7 @@ GraphicsEngine(Pipeline *pipeline) :
   }
   _auto_flip = auto_flip;
   _portal_enabled = false;
+  _num_cull_threads = cull_num_threads;
   _flip_state = FS_flip;
 
   _singular_warning_last_frame = false;
@@ -1441,6 +1444,11 @@ cull_to_bins(const GraphicsEngine::Windows &wlist, Thread *current_thread) {
   _singular_warning_last_frame = _singular_warning_this_frame;
   _singular_warning_this_frame = false;
 
+  if (_num_cull_threads > 1 && Thread::is_threading_supported()) {
+    parallel_cull_to_bins(wlist, current_thread);
+    return;
+  }
+
   // Keep track of the cameras we have already used in this thread to
   // render DisplayRegions.
   typedef pmap<NodePath, DisplayRegion *> AlreadyCulled;
@@ -1498,13 +1506,36 @@ cull_to_bins(const GraphicsEngine::Windows &wlist, Thread *current_thread) {
 ////////////////////////////////////////////////////////////////////
 void GraphicsEngine::
 cull_to_bins(GraphicsOutput *win, DisplayRegion *dr, Thread *current_thread) {
+  PT(CullResult) cull_result;
+  PT(SceneSetup) scene_setup;
+  if (cull_display_region(win, dr, cull_result, scene_setup, current_thread)) {
+    // Save the results for next frame.
+    dr->set_cull_result(cull_result, scene_setup, current_thread);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsEngine::cull_display_region
+//       Access: Private
+//  Description: Culls the scene for the indicated DisplayRegion into
+//               a new CullResult, and fills in cull_result and
+//               scene_setup, which should subsequently be passed to
+//               dr->set_cull_result().  Returns false if the window
+//               has no GSG, in which case there is nothing to save.
+//
+//               This does not modify the DisplayRegion, so it may be
+//               called for several different DisplayRegions at once
+//               by different threads.
+////////////////////////////////////////////////////////////////////
+bool GraphicsEngine::
+cull_display_region(GraphicsOutput *win, DisplayRegion *dr,
+                    PT(CullResult) &cull_result, PT(SceneSetup) &scene_setup,
+                    Thread *current_thread) {
   GraphicsStateGuardian *gsg = win->get_gsg();
   if (gsg == (GraphicsStateGuardian *)NULL) {
-    return;
+    return false;
   }
 
-  PT(CullResult) cull_result;
-  PT(SceneSetup) scene_setup;
   {
     PStatTimer timer(_cull_setup_pcollector, current_thread);
     DisplayRegionPipelineReader dr_reader(dr, current_thread);
@@ -1538,9 +1569,134 @@ cull_to_bins(GraphicsOutput *win, DisplayRegion *dr, Thread *current_thread) {
     PStatTimer timer(_cull_sort_pcollector, current_thread);
     cull_result->finish_cull(scene_setup, current_thread);
   }
-  
-  // Save the results for next frame.
-  dr->set_cull_result(cull_result, scene_setup, current_thread);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsEngine::parallel_cull_to_bins
+//       Access: Private
+//  Description: The flavor of cull_to_bins() used when
+//               set_num_cull_threads() is greater than 1.  The
+//               DisplayRegions are distributed among this thread and
+//               the threads of the "cull" task chain, and this thread
+//               waits for them all to finish.  The results are then
+//               saved on the DisplayRegions from this thread, in the
+//               same order as the serial cull_to_bins() would have
+//               saved them.
+////////////////////////////////////////////////////////////////////
+void GraphicsEngine::
+parallel_cull_to_bins(const GraphicsEngine::Windows &wlist,
+                      Thread *current_thread) {
+  CullJobs jobs;
+  int num_to_cull = 0;
+
+  // First, collect the DisplayRegions to cull.  As in the serial
+  // case, a DisplayRegion that shares its camera with an earlier one
+  // reuses that one's results.
+  typedef pmap<NodePath, int> AlreadyCulled;
+  AlreadyCulled already_culled;
+
+  Windows::const_iterator wi;
+  for (wi = wlist.begin(); wi != wlist.end(); ++wi) {
+    GraphicsOutput *win = (*wi);
+    if (win->is_active() && win->get_gsg()->is_active()) {
+      int num_display_regions = win->get_num_active_display_regions();
+      for (int i = 0; i < num_display_regions; ++i) {
+        DisplayRegion *dr = win->get_active_display_region(i);
+        if (dr != (DisplayRegion *)NULL) {
+          NodePath camera;
+          {
+            DisplayRegionPipelineReader dr_reader(dr, current_thread);
+            camera = dr_reader.get_camera();
+          }
+
+          CullJob job;
+          job._win = win;
+          job._dr = dr;
+          job._alias_of = -1;
+          job._culled = false;
+
+          AlreadyCulled::iterator aci = already_culled.insert(AlreadyCulled::value_type(camera, (int)jobs.size())).first;
+          if ((*aci).second != (int)jobs.size()) {
+            job._alias_of = (*aci).second;
+          } else {
+            ++num_to_cull;
+          }
+          jobs.push_back(job);
+        }
+      }
+    }
+  }
+
+  if (num_to_cull != 0) {
+    CullWork work;
+    work._engine = this;
+    work._jobs = &jobs;
+    work._pipeline_stage = current_thread->get_pipeline_stage();
+
+    ParallelFor pfor("cull", _num_cull_threads);
+    pfor.run(&cull_jobs, &work, (int)jobs.size());
+  }
+
+  // Now save the results, in DisplayRegion order.
+  CullJobs::iterator ji;
+  for (ji = jobs.begin(); ji != jobs.end(); ++ji) {
+    CullJob &job = (*ji);
+    if (job._alias_of == -1) {
+      if (job._culled) {
+        job._dr->set_cull_result(job._cull_result, job._scene_setup,
+                                 current_thread);
+      }
+
+    } else {
+      // We have already culled a scene using this camera, so just use
+      // the result from the other DisplayRegion.
+      DisplayRegion *other_dr = jobs[job._alias_of]._dr;
+      DisplayRegionPipelineReader dr_reader(job._dr, current_thread);
+      job._dr->set_cull_result(other_dr->get_cull_result(current_thread),
+                               setup_scene(job._win->get_gsg(), &dr_reader),
+                               current_thread);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsEngine::cull_jobs
+//       Access: Private, Static
+//  Description: The ParallelFor function for
+//               parallel_cull_to_bins().  It culls the DisplayRegions
+//               of the indicated range of jobs.
+////////////////////////////////////////////////////////////////////
+void GraphicsEngine::
+cull_jobs(void *user_data, int begin, int end, int worker_index) {
+  CullWork *work = (CullWork *)user_data;
+  GraphicsEngine *engine = work->_engine;
+  CullJobs &jobs = *work->_jobs;
+
+  // This thread must see the scene graph at the same pipeline stage
+  // as the cull thread that handed us the work.  The task chain's
+  // threads are shared with other work, so put the stage back
+  // afterwards.
+  Thread *current_thread = Thread::get_current_thread();
+  int orig_pipeline_stage = current_thread->get_pipeline_stage();
+  current_thread->set_pipeline_stage(work->_pipeline_stage);
+
+  {
+    PStatTimer timer(_cull_pcollector, current_thread);
+    for (int ji = begin; ji < end; ++ji) {
+      CullJob &job = jobs[ji];
+      if (job._alias_of == -1) {
+        PStatTimer timer(job._win->get_cull_window_pcollector(), current_thread);
+        job._culled = engine->cull_display_region(job._win, job._dr,
+                                                  job._cull_result,
+                                                  job._scene_setup,
+                                                  current_thread);
+      }
+    }
+  }
+
+  current_thread->set_pipeline_stage(orig_pipeline_stage);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -39,6 +39,7 @@ class DisplayRegion;
 class GraphicsPipe;
 class FrameBufferProperties;
 class Texture;
+class CullResult;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : GraphicsEngine
@@ -71,6 +72,9 @@ PUBLISHED:
   INLINE void set_portal_cull(bool value);
   INLINE bool get_portal_cull() const;
 
+  INLINE void set_num_cull_threads(int num_threads);
+  INLINE int get_num_cull_threads() const;
+
   INLINE void set_default_loader(Loader *loader);
   INLINE Loader *get_default_loader() const;
 
@@ -146,6 +150,13 @@ private:
 
   void cull_to_bins(const Windows &wlist, Thread *current_thread);
   void cull_to_bins(GraphicsOutput *win, DisplayRegion *dr, Thread *current_thread);
+  bool cull_display_region(GraphicsOutput *win, DisplayRegion *dr,
+                           PT(CullResult) &cull_result,
+                           PT(SceneSetup) &scene_setup,
+                           Thread *current_thread);
+  void parallel_cull_to_bins(const Windows &wlist, Thread *current_thread);
+  static void cull_jobs(void *user_data, int begin, int end,
+                        int worker_index);
   void draw_bins(const Windows &wlist, Thread *current_thread);
   void draw_bins(GraphicsOutput *win, DisplayRegion *dr, Thread *current_thread);
   void make_contexts(const Windows &wlist, Thread *current_thread);
@@ -317,6 +328,31 @@ private:
   GraphicsThreadingModel _threading_model;
   bool _auto_flip;
   bool _portal_enabled; //toggle to portal culling on/off
+  int _num_cull_threads;
+
+  // Used by parallel_cull_to_bins().  There is one CullJob for each
+  // active DisplayRegion, in the order they would be culled serially.
+  // If _alias_of is not -1, the DisplayRegion shares its camera with
+  // an earlier one, and will reuse that one's results instead of
+  // being culled itself.
+  class CullJob {
+  public:
+    GraphicsOutput *_win;
+    DisplayRegion *_dr;
+    int _alias_of;
+    bool _culled;
+    PT(CullResult) _cull_result;
+    PT(SceneSetup) _scene_setup;
+  };
+  typedef pvector<CullJob> CullJobs;
+
+  // The data handed to each worker of parallel_cull_to_bins().
+  class CullWork {
+  public:
+    GraphicsEngine *_engine;
+    CullJobs *_jobs;
+    int _pipeline_stage;
+  };
   PT(Loader) _default_loader;
 
   enum FlipState {
@@ -55,6 +55,7 @@
 #include "colorScaleAttrib.h"
 #include "clipPlaneAttrib.h"
 #include "fogAttrib.h"
+#include "lightMutexHolder.h"
 
 #include <algorithm>
 #include <limits.h>
@@ -779,36 +780,48 @@ get_geom_munger(const RenderState *state, Thread *current_thread) {
   // any of its properties.
   RenderState *nc_state = ((RenderState *)state);
 
-  // Before we even look up the map, see if the _last_mi value points
-  // to this GSG.  This is likely because we tend to visit the same
-  // state multiple times during a frame.  Also, this might well be
-  // the only GSG in the world anyway.
-  if (!nc_state->_mungers.empty()) {
-    RenderState::Mungers::const_iterator mi = nc_state->_last_mi;
-    if (!(*mi).first.was_deleted() && (*mi).first == this) {
-      if ((*mi).second->is_registered()) {
-        return (*mi).second;
+  {
+    // The cull may be running in several threads at once, so the
+    // cache must be consulted with the state's munger lock held.
+    LightMutexHolder holder(nc_state->_munger_lock);
+
+    // Before we even look up the map, see if the _last_mi value
+    // points to this GSG.  This is likely because we tend to visit
+    // the same state multiple times during a frame.  Also, this might
+    // well be the only GSG in the world anyway.
+    if (!nc_state->_mungers.empty()) {
+      RenderState::Mungers::const_iterator mi = nc_state->_last_mi;
+      if (!(*mi).first.was_deleted() && (*mi).first == this) {
+        if ((*mi).second->is_registered()) {
+          return (*mi).second;
+        }
       }
     }
-  }
 
-  // Nope, we have to look it up in the map.
-  RenderState::Mungers::iterator mi = nc_state->_mungers.find(this);
-  if (mi != nc_state->_mungers.end() && !(*mi).first.was_deleted()) {
-    if ((*mi).second->is_registered()) {
-      nc_state->_last_mi = mi;
-      return (*mi).second;
+    // Nope, we have to look it up in the map.
+    RenderState::Mungers::iterator mi = nc_state->_mungers.find(this);
+    if (mi != nc_state->_mungers.end() && !(*mi).first.was_deleted()) {
+      if ((*mi).second->is_registered()) {
+        nc_state->_last_mi = mi;
+        return (*mi).second;
+      }
+      // This GeomMunger is no longer registered.  Remove it from the
+      // map.
+      nc_state->_mungers.erase(mi);
     }
-    // This GeomMunger is no longer registered.  Remove it from the
-    // map.
-    nc_state->_mungers.erase(mi);
   }
 
-  // Nothing in the map; create a new entry.
+  // Nothing in the map; create a new entry.  This is done without
+  // holding the lock, since making a munger may well examine the
+  // state.  If another thread got here first, we replace its entry
+  // with ours; either one will do.
   PT(GeomMunger) munger = make_geom_munger(nc_state, current_thread);
   nassertr(munger != (GeomMunger *)NULL && munger->is_registered(), munger);
 
-  mi = nc_state->_mungers.insert(RenderState::Mungers::value_type(this, munger)).first;
+  LightMutexHolder holder(nc_state->_munger_lock);
+  RenderState::Mungers::iterator mi =
+    nc_state->_mungers.insert(RenderState::Mungers::value_type(this, munger)).first;
+  (*mi).second = munger;
   nc_state->_last_mi = mi;
 
   return munger;
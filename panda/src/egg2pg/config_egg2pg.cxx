@@ -191,6 +191,16 @@ ConfigVariableBool egg_implicit_alpha_binary
           "will automatically be downgraded to alpha type \"binary\" instead of "
           "whatever appears in the egg file."));
 
+ConfigVariableInt egg_load_num_threads
+("egg-load-num-threads", 0,
+ PRC_DESC("Set this to a number greater than 1 to read the textures "
+          "referenced by an egg file, and to fill in its vertex data, on "
+          "that many threads: the loading thread and the threads of the "
+          "\"egg_load\" task chain.  The scene graph itself is still "
+          "assembled on the loading thread, in the usual order, so the "
+          "result is identical to a serial load.  "
+          "The default, 0, does all of the work on the loading thread."));
+
 ConfigureFn(config_egg2pg) {
   init_libegg2pg();
 }
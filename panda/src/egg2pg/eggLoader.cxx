@@ -97,6 +97,7 @@
 #include "uvScrollNode.h"
 #include "textureStagePool.h"
 #include "cmath.h"
+#include "parallelFor.h"
 
 #include <ctype.h>
 #include <algorithm>
@@ -144,6 +145,7 @@ EggLoader() {
   _error = false;
   _dynamic_override = false;
   _dynamic_override_char_maker = NULL;
+  _num_threads = egg_load_num_threads;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -159,6 +161,7 @@ EggLoader(const EggData *data) :
   _error = false;
   _dynamic_override = false;
   _dynamic_override_char_maker = NULL;
+  _num_threads = egg_load_num_threads;
 }
 
 
@@ -219,6 +222,9 @@ build_graph() {
     make_node(*ci, _root);
   }
 
+  // Now fill in any vertex data that was put off until now.
+  finish_vertex_fills();
+
   reparent_decals();
   start_sequences();
 
@@ -886,7 +892,11 @@ make_nurbs_surface(EggNurbsSurface *egg_surface, PandaNode *parent,
 ////////////////////////////////////////////////////////////////////
 //     Function: EggLoader::load_textures
 //       Access: Private
-//  Description:
+//  Description: Loads all of the textures referenced by the egg
+//               file.  If egg-load-num-threads is greater than 1, the
+//               texture images are read in parallel; everything else
+//               is still done here, in the same order as a serial
+//               load.
 ////////////////////////////////////////////////////////////////////
 void EggLoader::
 load_textures() {
@@ -894,27 +904,55 @@ load_textures() {
   EggTextureCollection tc;
   tc.find_used_textures(_data);
 
+  TextureLoads loads;
+  loads.reserve(tc.size());
+
   EggTextureCollection::iterator ti;
   for (ti = tc.begin(); ti != tc.end(); ++ti) {
-    PT_EggTexture egg_tex = (*ti);
+    loads.push_back(TextureLoad());
+    prepare_texture(loads.back(), *ti);
+  }
+
+  int num_loads = (int)loads.size();
+  ParallelFor pfor("egg_load", _num_threads);
+  pfor.run(&fetch_texture_range, &loads, num_loads);
 
+  for (int i = 0; i < num_loads; ++i) {
     TextureDef def;
-    if (load_texture(def, egg_tex)) {
+    if (finish_texture(def, loads[i])) {
       // Now associate the pointers, so we'll be able to look up the
       // Texture pointer given an EggTexture pointer, later.
-      _textures[egg_tex] = def;
+      _textures[loads[i]._egg_tex] = def;
     }
   }
 }
 
-
 ////////////////////////////////////////////////////////////////////
 //     Function: EggLoader::load_texture
 //       Access: Private
-//  Description:
+//  Description: Loads the single indicated texture, and fills in def
+//               accordingly.  Returns true on success, false if the
+//               texture could not be loaded.
 ////////////////////////////////////////////////////////////////////
 bool EggLoader::
 load_texture(TextureDef &def, EggTexture *egg_tex) {
+  TextureLoad load;
+  prepare_texture(load, egg_tex);
+  fetch_texture(load);
+  return finish_texture(def, load);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggLoader::prepare_texture
+//       Access: Private
+//  Description: The first part of loading a texture: decides how the
+//               texture image should be read, and records the texture
+//               files as dependents of the egg file.
+////////////////////////////////////////////////////////////////////
+void EggLoader::
+prepare_texture(TextureLoad &load, EggTexture *egg_tex) {
+  load._egg_tex = egg_tex;
+
   // Check to see if we should reduce the number of channels in
   // the texture.
   int wanted_channels = 0;
@@ -970,7 +1008,7 @@ load_texture(TextureDef &def, EggTexture *egg_tex) {
   }
 
   // By convention, the egg loader will preload the simple texture images.
-  LoaderOptions options;
+  LoaderOptions &options = load._options;
   if (egg_preload_simple_textures) {
     options.set_texture_flags(options.get_texture_flags() | LoaderOptions::TF_preload_simple);
   }
@@ -997,6 +1035,25 @@ load_texture(TextureDef &def, EggTexture *egg_tex) {
     }
   }
 
+  load._wanted_channels = wanted_channels;
+  load._wanted_alpha = wanted_alpha;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggLoader::fetch_texture
+//       Access: Private, Static
+//  Description: The second part of loading a texture: actually reads
+//               the texture image from the TexturePool.  This part
+//               does not touch the EggLoader, and may be called from
+//               any thread.
+////////////////////////////////////////////////////////////////////
+void EggLoader::
+fetch_texture(TextureLoad &load) {
+  const EggTexture *egg_tex = load._egg_tex;
+  int wanted_channels = load._wanted_channels;
+  bool wanted_alpha = load._wanted_alpha;
+  LoaderOptions options = load._options;
+
   PT(Texture) tex;
   switch (egg_tex->get_texture_type()) {
   case EggTexture::TT_unspecified:
@@ -1029,6 +1086,24 @@ load_texture(TextureDef &def, EggTexture *egg_tex) {
     break;
   }
 
+  load._tex = tex;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggLoader::finish_texture
+//       Access: Private
+//  Description: The last part of loading a texture: applies the
+//               egg attributes to the texture read by
+//               fetch_texture(), and fills in def accordingly.
+//               Returns true on success, false if the texture could
+//               not be loaded.
+////////////////////////////////////////////////////////////////////
+bool EggLoader::
+finish_texture(TextureDef &def, TextureLoad &load) {
+  EggTexture *egg_tex = load._egg_tex;
+  bool wanted_alpha = load._wanted_alpha;
+  Texture *tex = load._tex;
+
   if (tex == (Texture *)NULL) {
     return false;
   }
@@ -1077,6 +1152,21 @@ load_texture(TextureDef &def, EggTexture *egg_tex) {
 }
 
 
+////////////////////////////////////////////////////////////////////
+//     Function: EggLoader::fetch_texture_range
+//       Access: Private, Static
+//  Description: The ParallelFor function for load_textures().  It
+//               reads the texture images of the indicated range of
+//               loads.
+////////////////////////////////////////////////////////////////////
+void EggLoader::
+fetch_texture_range(void *user_data, int begin, int end, int worker_index) {
+  TextureLoads &loads = *(TextureLoads *)user_data;
+  for (int i = begin; i < end; ++i) {
+    fetch_texture(loads[i]);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: EggLoader::apply_texture_attributes
 //       Access: Private
@@ -2382,34 +2472,94 @@ make_vertex_data(const EggRenderState *render_state,
     vertex_data->set_slider_table(SliderTable::register_table(slider_table));
   }
 
-  // And fill in the data from the vertex pool.
+  // And fill in the data from the vertex pool.  We set the number of
+  // rows up front, so that the primitives may be validated against
+  // the vertex data even before it has been filled in.  If we have
+  // threads to share the work, it is put off until the scene graph
+  // has been built.
+  bool deferred = (_num_threads > 1 && Thread::is_threading_supported());
+  VertexFill local_fill;
+  if (deferred) {
+    _vertex_fills.push_back(VertexFill());
+  }
+  VertexFill &fill = deferred ? _vertex_fills.back() : local_fill;
+  fill._vertex_data = vertex_data;
+  fill._fill_data = vertex_data;
+  fill._bake_in_uvs = render_state->_bake_in_uvs;
+  fill._transform = transform;
+  fill._is_dynamic = is_dynamic;
+  fill._ignore_color = ignore_color;
+
+  int num_rows = 0;
+  fill._vertices.reserve(vertex_pool->size());
+  fill._rows.reserve(vertex_pool->size());
   EggVertexPool::const_iterator vi;
   for (vi = vertex_pool->begin(); vi != vertex_pool->end(); ++vi) {
-    GeomVertexWriter gvw(vertex_data);
     EggVertex *vertex = (*vi);
-    gvw.set_row(vertex->get_index());
+    fill._vertices.push_back(vertex);
+    fill._rows.push_back(vertex->get_index());
+    if (is_dynamic) {
+      fill._table_indices.push_back(vertex->get_external_index());
+    }
+    num_rows = max(num_rows, vertex->get_index() + 1);
+  }
+  vertex_data->set_num_rows(num_rows);
+
+  if (!deferred) {
+    fill_vertex_data(fill);
+
+  } else {
+    // This writes to a separate GeomVertexData that no one else can
+    // see, and the arrays are handed over to the real one in
+    // finish_vertex_fills().
+    fill._fill_data = new GeomVertexData(name, format, Geom::UH_static);
+    fill._fill_data->set_num_rows(num_rows);
+  }
+
+  bool inserted = _vertex_pool_data.insert
+    (VertexPoolData::value_type(vpt, vertex_data)).second;
+  nassertr(inserted, vertex_data);
+
+  Thread::consider_yield();
+  return vertex_data;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggLoader::fill_vertex_data
+//       Access: Private, Static
+//  Description: Copies the vertices recorded by make_vertex_data()
+//               into the fill's GeomVertexData.  This does not touch
+//               the EggLoader, and may be called from any thread.
+////////////////////////////////////////////////////////////////////
+void EggLoader::
+fill_vertex_data(const VertexFill &fill) {
+  int num_vertices = (int)fill._vertices.size();
+  for (int i = 0; i < num_vertices; ++i) {
+    GeomVertexWriter gvw(fill._fill_data);
+    EggVertex *vertex = fill._vertices[i];
+    gvw.set_row(fill._rows[i]);
 
     gvw.set_column(InternalName::get_vertex());
-    gvw.add_data4d(vertex->get_pos4() * transform);
+    gvw.add_data4d(vertex->get_pos4() * fill._transform);
 
-    if (is_dynamic) {
+    if (fill._is_dynamic) {
       EggMorphVertexList::const_iterator mvi;
       for (mvi = vertex->_dxyzs.begin(); mvi != vertex->_dxyzs.end(); ++mvi) {
         const EggMorphVertex &morph = (*mvi);
         CPT(InternalName) delta_name = 
           InternalName::get_morph(InternalName::get_vertex(), morph.get_name());
         gvw.set_column(delta_name);
-        gvw.add_data3d(morph.get_offset() * transform);
+        gvw.add_data3d(morph.get_offset() * fill._transform);
       }
     }
 
     if (vertex->has_normal()) {
       gvw.set_column(InternalName::get_normal());
       LNormald orig_normal = vertex->get_normal();
-      LNormald transformed_normal = normalize(orig_normal * transform);
+      LNormald transformed_normal = normalize(orig_normal * fill._transform);
       gvw.add_data3d(transformed_normal);
 
-      if (is_dynamic) {
+      if (fill._is_dynamic) {
         EggMorphNormalList::const_iterator mni;
         for (mni = vertex->_dnormals.begin(); mni != vertex->_dnormals.end(); ++mni) {
           const EggMorphNormal &morph = (*mni);
@@ -2417,18 +2567,18 @@ make_vertex_data(const EggRenderState *render_state,
             InternalName::get_morph(InternalName::get_normal(), morph.get_name());
           gvw.set_column(delta_name);
           LNormald morphed_normal = orig_normal + morph.get_offset();
-          LNormald transformed_morphed_normal = normalize(morphed_normal * transform);
+          LNormald transformed_morphed_normal = normalize(morphed_normal * fill._transform);
           LVector3d delta = transformed_morphed_normal - transformed_normal;
           gvw.add_data3d(delta);
         }
       }
     }
 
-    if (!ignore_color && vertex->has_color()) {
+    if (!fill._ignore_color && vertex->has_color()) {
       gvw.set_column(InternalName::get_color());
       gvw.add_data4(vertex->get_color());
 
-      if (is_dynamic) {
+      if (fill._is_dynamic) {
         EggMorphColorList::const_iterator mci;
         for (mci = vertex->_drgbas.begin(); mci != vertex->_drgbas.end(); ++mci) {
           const EggMorphColor &morph = (*mci);
@@ -2450,15 +2600,15 @@ make_vertex_data(const EggRenderState *render_state,
       PT(InternalName) iname = InternalName::get_texcoord_name(name);
       gvw.set_column(iname);
 
-      BakeInUVs::const_iterator buv = render_state->_bake_in_uvs.find(iname);
-      if (buv != render_state->_bake_in_uvs.end()) {
+      BakeInUVs::const_iterator buv = fill._bake_in_uvs.find(iname);
+      if (buv != fill._bake_in_uvs.end()) {
         // If we are to bake in a texture matrix, do so now.
         uvw = uvw * (*buv).second->get_transform3d();
       }
 
       gvw.set_data3d(uvw);
 
-      if (is_dynamic) {
+      if (fill._is_dynamic) {
         EggMorphTexCoordList::const_iterator mti;
         for (mti = egg_uv->_duvs.begin(); mti != egg_uv->_duvs.end(); ++mti) {
           const EggMorphTexCoord &morph = (*mti);
@@ -2466,7 +2616,7 @@ make_vertex_data(const EggRenderState *render_state,
             InternalName::get_morph(iname, morph.get_name());
           gvw.set_column(delta_name);
           LTexCoord3d duvw = morph.get_offset();
-          if (buv != render_state->_bake_in_uvs.end()) {
+          if (buv != fill._bake_in_uvs.end()) {
             LTexCoord3d new_uvw = orig_uvw + duvw;
             duvw = (new_uvw * (*buv).second->get_transform3d()) - uvw;
           }
@@ -2501,19 +2651,56 @@ make_vertex_data(const EggRenderState *render_state,
       gvw.set_data4d(aux);
     }
 
-    if (is_dynamic) {
-      int table_index = vertex->get_external_index();
+    if (fill._is_dynamic) {
+      int table_index = fill._table_indices[i];
       gvw.set_column(InternalName::get_transform_blend());
       gvw.set_data1i(table_index);
     }
   }
+}
 
-  bool inserted = _vertex_pool_data.insert
-    (VertexPoolData::value_type(vpt, vertex_data)).second;
-  nassertr(inserted, vertex_data);
+////////////////////////////////////////////////////////////////////
+//     Function: EggLoader::fill_vertex_range
+//       Access: Private, Static
+//  Description: The ParallelFor function for finish_vertex_fills().
+//               It fills in the indicated range of vertex fills.
+////////////////////////////////////////////////////////////////////
+void EggLoader::
+fill_vertex_range(void *user_data, int begin, int end, int worker_index) {
+  const VertexFills &fills = *(const VertexFills *)user_data;
+  for (int i = begin; i < end; ++i) {
+    fill_vertex_data(fills[i]);
+  }
+}
 
-  Thread::consider_yield();
-  return vertex_data;
+////////////////////////////////////////////////////////////////////
+//     Function: EggLoader::finish_vertex_fills
+//       Access: Private
+//  Description: Fills in the vertex data put off by
+//               make_vertex_data(), dividing the work among the
+//               threads of the "egg_load" task chain and this one,
+//               and stores it in the GeomVertexData objects returned
+//               by make_vertex_data().
+////////////////////////////////////////////////////////////////////
+void EggLoader::
+finish_vertex_fills() {
+  if (_vertex_fills.empty()) {
+    return;
+  }
+
+  ParallelFor pfor("egg_load", _num_threads);
+  pfor.run(&fill_vertex_range, &_vertex_fills, (int)_vertex_fills.size());
+
+  VertexFills::const_iterator fi;
+  for (fi = _vertex_fills.begin(); fi != _vertex_fills.end(); ++fi) {
+    const VertexFill &fill = (*fi);
+    int num_arrays = fill._fill_data->get_num_arrays();
+    nassertd(num_arrays == fill._vertex_data->get_num_arrays()) continue;
+    for (int i = 0; i < num_arrays; ++i) {
+      fill._vertex_data->set_array(i, fill._fill_data->get_array(i));
+    }
+  }
+  _vertex_fills.clear();
 }
 
 ////////////////////////////////////////////////////////////////////
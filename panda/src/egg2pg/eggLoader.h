@@ -38,6 +38,9 @@
 #include "geomVertexData.h"
 #include "geomPrimitive.h"
 #include "bamCacheRecord.h"
+#include "loaderOptions.h"
+#include "pdeque.h"
+#include "vector_int.h"
 
 class EggNode;
 class EggBin;
@@ -119,8 +122,25 @@ private:
   void make_nurbs_surface(EggNurbsSurface *egg_surface, PandaNode *parent,
                           const LMatrix4d &mat);
 
+  // These are used by load_textures() to read the texture images,
+  // possibly on several threads at once.
+  class TextureLoad {
+  public:
+    PT_EggTexture _egg_tex;
+    int _wanted_channels;
+    bool _wanted_alpha;
+    LoaderOptions _options;
+    PT(Texture) _tex;
+  };
+  typedef pvector<TextureLoad> TextureLoads;
+
   void load_textures();
   bool load_texture(TextureDef &def, EggTexture *egg_tex);
+  void prepare_texture(TextureLoad &load, EggTexture *egg_tex);
+  static void fetch_texture(TextureLoad &load);
+  bool finish_texture(TextureDef &def, TextureLoad &load);
+  static void fetch_texture_range(void *user_data, int begin, int end,
+                                  int worker_index);
   void apply_texture_attributes(Texture *tex, const EggTexture *egg_tex);
   Texture::CompressionMode convert_compression_mode(EggTexture::CompressionMode compression_mode) const;
   Texture::WrapMode convert_wrap_mode(EggTexture::WrapMode wrap_mode) const;
@@ -251,6 +271,33 @@ private:
   typedef pmap<VertexPoolTransform, PT(GeomVertexData) > VertexPoolData;
   VertexPoolData _vertex_pool_data;
 
+  // This records the work of copying the vertices of one vertex pool
+  // into a GeomVertexData, which may be put off until the scene graph
+  // has been built, and then shared among several threads.  The
+  // vertices are listed along with their row numbers and blend table
+  // indices, since the pool may be re-sorted before the work is done.
+  class VertexFill {
+  public:
+    PT(GeomVertexData) _vertex_data;
+    PT(GeomVertexData) _fill_data;
+    pvector<PT(EggVertex) > _vertices;
+    vector_int _rows;
+    vector_int _table_indices;
+    BakeInUVs _bake_in_uvs;
+    LMatrix4d _transform;
+    bool _is_dynamic;
+    bool _ignore_color;
+  };
+  typedef pdeque<VertexFill> VertexFills;
+  VertexFills _vertex_fills;
+
+  static void fill_vertex_data(const VertexFill &fill);
+  static void fill_vertex_range(void *user_data, int begin, int end,
+                                int worker_index);
+  void finish_vertex_fills();
+
+  int _num_threads;
+
   typedef pmap<LMatrix4, CPT(TransformState) > TransformStates;
   TransformStates _transform_states;
 
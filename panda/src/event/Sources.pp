@@ -24,6 +24,8 @@
     event.I event.h eventHandler.h eventHandler.I \
     eventParameter.I eventParameter.h \
     eventQueue.I eventQueue.h eventReceiver.h \
+    fileReadRequest.h fileReadRequest.I \
+    parallelFor.h parallelFor.I \
     pt_Event.h throw_event.I throw_event.h 
     
   #define INCLUDED_SOURCES \
@@ -41,6 +43,8 @@
     pythonTask.cxx \
     config_event.cxx event.cxx eventHandler.cxx \ 
     eventParameter.cxx eventQueue.cxx eventReceiver.cxx \
+    fileReadRequest.cxx \
+    parallelFor.cxx \
     pt_Event.cxx
 
   #define INSTALL_HEADERS \
@@ -59,6 +63,8 @@
     event.I event.h eventHandler.h eventHandler.I \
     eventParameter.I eventParameter.h \
     eventQueue.I eventQueue.h eventReceiver.h \
+    fileReadRequest.h fileReadRequest.I \
+    parallelFor.h parallelFor.I \
     pt_Event.h throw_event.I throw_event.h 
 
   #define IGATESCAN all
@@ -76,3 +82,14 @@
     test_task.cxx
 
 #end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_parallelFor
+  #define OTHER_LIBS \
+   p3interrogatedb:c p3dconfig:c p3dtoolbase:c p3prc:c \
+   p3dtoolutil:c p3dtool:m p3dtoolconfig:m p3pystub
+
+  #define SOURCES \
+    test_parallelFor.cxx
+
+#end test_bin_target
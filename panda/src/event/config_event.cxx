@@ -22,6 +22,7 @@
 #include "event.h"
 #include "eventHandler.h"
 #include "eventParameter.h"
+#include "fileReadRequest.h"
 #include "genericAsyncTask.h"
 #include "pointerEventList.h"
 #include "pythonTask.h"
@@ -48,6 +49,7 @@ ConfigureFn(config_event) {
   EventStoreString::init_type("EventStoreString");
   EventStoreWstring::init_type("EventStoreWstring");
   EventStoreTypedRefCount::init_type();
+  FileReadRequest::init_type();
   GenericAsyncTask::init_type();
 #ifdef HAVE_PYTHON
   PythonTask::init_type();
@@ -0,0 +1,218 @@
+// Filename: fileReadRequest.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+
+#include "fileReadRequest.h"
+#include "asyncTaskManager.h"
+#include "virtualFileSystem.h"
+#include "mutexHolder.h"
+#include "configVariableInt.h"
+#include "configVariableEnum.h"
+#include "config_event.h"
+
+TypeHandle FileReadRequest::_type_handle;
+
+////////////////////////////////////////////////////////////////////
+//     Function: FileReadRequest::Constructor
+//       Access: Published
+//  Description: Creates a new FileReadRequest to read the indicated
+//               file.  The request does nothing until it is added to
+//               an AsyncTaskManager; see also read_async().
+////////////////////////////////////////////////////////////////////
+FileReadRequest::
+FileReadRequest(const string &name, const Filename &filename,
+                bool auto_unwrap) :
+  AsyncTask(name),
+  _filename(filename),
+  _auto_unwrap(auto_unwrap),
+  _function(NULL),
+  _user_data(NULL),
+  _success(false),
+  _is_ready(false),
+  _started(false),
+  _cvar(_lock)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: FileReadRequest::Constructor
+//       Access: Published
+//  Description: Creates a new FileReadRequest to read the indicated
+//               file, which has already been located within the
+//               VirtualFileSystem.
+////////////////////////////////////////////////////////////////////
+FileReadRequest::
+FileReadRequest(const string &name, VirtualFile *file, bool auto_unwrap) :
+  AsyncTask(name),
+  _filename(file->get_filename()),
+  _file(file),
+  _auto_unwrap(auto_unwrap),
+  _function(NULL),
+  _user_data(NULL),
+  _success(false),
+  _is_ready(false),
+  _started(false),
+  _cvar(_lock)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: FileReadRequest::read_async
+//       Access: Published, Static
+//  Description: Starts reading the indicated file on the I/O threads
+//               of the global AsyncTaskManager, and returns
+//               immediately.  The returned request may be used to
+//               retrieve the contents of the file when it is ready.
+////////////////////////////////////////////////////////////////////
+PT(FileReadRequest) FileReadRequest::
+read_async(const Filename &filename, bool auto_unwrap) {
+  PT(FileReadRequest) request =
+    new FileReadRequest(string("read:") + filename.get_basename(),
+                        filename, auto_unwrap);
+  request->set_task_chain(get_io_chain()->get_name());
+  AsyncTaskManager::get_global_ptr()->add(request);
+  return request;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: FileReadRequest::wait
+//       Access: Published
+//  Description: Blocks until the request has completed.  The request
+//               must already have been added to a task manager.
+//
+//               If no threads are servicing the request's task chain,
+//               the chain is polled on the current thread instead, so
+//               that this will not wait forever.
+////////////////////////////////////////////////////////////////////
+void FileReadRequest::
+wait() {
+  AsyncTaskManager *manager = get_manager();
+  if (manager != (AsyncTaskManager *)NULL) {
+    AsyncTaskChain *chain = manager->find_task_chain(get_task_chain());
+    if (chain != (AsyncTaskChain *)NULL &&
+        (!Thread::is_threading_supported() || chain->get_num_threads() == 0)) {
+      while (!_is_ready && is_alive()) {
+        chain->poll();
+      }
+    }
+  }
+
+  MutexHolder holder(_lock);
+  nassertv(_started || _is_ready);
+  while (!_is_ready) {
+    _cvar.wait();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: FileReadRequest::get_io_chain
+//       Access: Public, Static
+//  Description: Returns the task chain on the global AsyncTaskManager
+//               whose threads service read_async(), creating it if
+//               necessary.
+////////////////////////////////////////////////////////////////////
+AsyncTaskChain *FileReadRequest::
+get_io_chain() {
+  static const string chain_name = "vfs_io";
+
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = task_mgr->find_task_chain(chain_name);
+  if (chain == (AsyncTaskChain *)NULL) {
+    chain = task_mgr->make_task_chain(chain_name);
+
+    ConfigVariableInt async_read_num_threads
+      ("async-read-num-threads", 2,
+       PRC_DESC("The number of threads that will be started to service "
+                "asynchronous file reads via FileReadRequest::read_async().  "
+                "Several threads allow reads from different files, or from "
+                "slow network filesystems, to overlap."));
+    chain->set_num_threads(async_read_num_threads);
+
+    ConfigVariableEnum<ThreadPriority> async_read_thread_priority
+      ("async-read-thread-priority", TP_normal,
+       PRC_DESC("The thread priority to assign to the threads created "
+                "for asynchronous file reads."));
+    chain->set_thread_priority(async_read_thread_priority);
+  }
+  return chain;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: FileReadRequest::do_task
+//       Access: Protected, Virtual
+//  Description: Performs the task: that is, reads the one file.
+////////////////////////////////////////////////////////////////////
+AsyncTask::DoneStatus FileReadRequest::
+do_task() {
+  if (_file == (VirtualFile *)NULL) {
+    VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+    _file = vfs->get_file(_filename);
+  }
+
+  if (_file == (VirtualFile *)NULL) {
+    event_cat.error()
+      << "Could not find " << _filename << " to read.\n";
+    _success = false;
+  } else {
+    _success = _file->read_file(_data, _auto_unwrap);
+    if (!_success) {
+      event_cat.error()
+        << "Unable to read " << _filename << "\n";
+    }
+  }
+
+  // Don't continue the task; we're done.
+  return DS_done;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: FileReadRequest::upon_birth
+//       Access: Protected, Virtual
+//  Description: Called when the request is added to the task manager.
+////////////////////////////////////////////////////////////////////
+void FileReadRequest::
+upon_birth(AsyncTaskManager *manager) {
+  {
+    MutexHolder holder(_lock);
+    _started = true;
+  }
+  AsyncTask::upon_birth(manager);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: FileReadRequest::upon_death
+//       Access: Protected, Virtual
+//  Description: Called when the request is removed from the task
+//               manager, either because it completed or because it
+//               was removed early.  Marks the request ready, wakes
+//               any threads in wait(), and calls the callback
+//               function, before throwing the done event.
+////////////////////////////////////////////////////////////////////
+void FileReadRequest::
+upon_death(AsyncTaskManager *manager, bool clean_exit) {
+  {
+    MutexHolder holder(_lock);
+    if (!clean_exit) {
+      _success = false;
+    }
+    _is_ready = true;
+    _cvar.notify_all();
+  }
+
+  if (_function != (CallbackFunc *)NULL) {
+    (*_function)(this, _user_data);
+  }
+
+  AsyncTask::upon_death(manager, clean_exit);
+}
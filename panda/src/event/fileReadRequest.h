@@ -0,0 +1,115 @@
+// Filename: fileReadRequest.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+
+#ifndef FILEREADREQUEST_H
+#define FILEREADREQUEST_H
+
+#include "pandabase.h"
+
+#include "asyncTask.h"
+#include "filename.h"
+#include "virtualFile.h"
+#include "pointerTo.h"
+#include "pmutex.h"
+#include "conditionVarFull.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : FileReadRequest
+// Description : A class object that manages a single asynchronous
+//               read of a file through the VirtualFileSystem.
+//
+//               Use read_async() to start reading a file on the
+//               threads of the "vfs_io" task chain.  The returned
+//               request may be polled with is_ready() (for instance,
+//               from another task, which returns DS_cont until it is
+//               ready), waited on with wait(), or given a done_event
+//               or a callback function to be notified when the read
+//               is complete.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_EVENT FileReadRequest : public AsyncTask {
+public:
+  ALLOC_DELETED_CHAIN(FileReadRequest);
+
+  typedef void CallbackFunc(FileReadRequest *request, void *user_data);
+
+PUBLISHED:
+  FileReadRequest(const string &name, const Filename &filename,
+                  bool auto_unwrap = true);
+  FileReadRequest(const string &name, VirtualFile *file,
+                  bool auto_unwrap = true);
+
+  static PT(FileReadRequest) read_async(const Filename &filename,
+                                        bool auto_unwrap = true);
+
+  INLINE const Filename &get_filename() const;
+  INLINE bool get_auto_unwrap() const;
+
+  INLINE bool is_ready() const;
+  BLOCKING void wait();
+
+  INLINE bool get_success() const;
+  INLINE const string &get_data() const;
+
+public:
+  INLINE void set_callback(CallbackFunc *function, void *user_data);
+  INLINE void swap_data(string &data);
+
+  static AsyncTaskChain *get_io_chain();
+
+protected:
+  virtual DoneStatus do_task();
+  virtual void upon_birth(AsyncTaskManager *manager);
+  virtual void upon_death(AsyncTaskManager *manager, bool clean_exit);
+
+private:
+  Filename _filename;
+  PT(VirtualFile) _file;
+  bool _auto_unwrap;
+
+  CallbackFunc *_function;
+  void *_user_data;
+
+  bool _success;
+  string _data;
+
+  // _started is set when the request is added to a task manager.
+  // _is_ready is set, and _cvar signaled, when it has been removed
+  // again, whether it completed or not.
+  volatile bool _is_ready;
+  bool _started;
+  Mutex _lock;
+  ConditionVarFull _cvar;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AsyncTask::init_type();
+    register_type(_type_handle, "FileReadRequest",
+                  AsyncTask::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "fileReadRequest.I"
+
+#endif
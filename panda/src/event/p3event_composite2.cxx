@@ -4,5 +4,7 @@
 #include "eventParameter.cxx"
 #include "eventQueue.cxx"
 #include "eventReceiver.cxx"
+#include "fileReadRequest.cxx"
+#include "parallelFor.cxx"
 #include "pt_Event.cxx"
 
@@ -0,0 +1,169 @@
+// Filename: parallelFor.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "parallelFor.h"
+#include "asyncTaskManager.h"
+#include "asyncTaskChain.h"
+#include "mutexHolder.h"
+#include "thread.h"
+
+////////////////////////////////////////////////////////////////////
+//     Function: ParallelFor::Constructor
+//       Access: Public
+//  Description: Prepares to divide work among up to num_threads
+//               threads, including the calling thread, of which the
+//               others belong to the named task chain.  Each thread
+//               claims chunk_size items at a time.
+////////////////////////////////////////////////////////////////////
+ParallelFor::
+ParallelFor(const string &chain_name, int num_threads, int chunk_size) :
+  _chain_name(chain_name),
+  _num_threads(max(num_threads, 1)),
+  _chunk_size(max(chunk_size, 1))
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ParallelFor::get_num_workers
+//       Access: Public
+//  Description: Returns the number of workers that run() will use
+//               for the indicated number of items.  The worker
+//               indices passed to the function will be less than
+//               this.
+////////////////////////////////////////////////////////////////////
+int ParallelFor::
+get_num_workers(int num_items) const {
+  if (_num_threads <= 1 || !Thread::is_threading_supported()) {
+    return 1;
+  }
+  int num_chunks = (num_items + _chunk_size - 1) / _chunk_size;
+  return max(min(_num_threads, num_chunks), 1);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ParallelFor::run
+//       Access: Public
+//  Description: Calls func(user_data, begin, end, worker_index) for
+//               consecutive ranges of items that together cover 0
+//               to num_items - 1, each exactly once, and returns
+//               when all of the calls have returned.
+////////////////////////////////////////////////////////////////////
+void ParallelFor::
+run(RangeFunc *func, void *user_data, int num_items) {
+  if (num_items <= 0) {
+    return;
+  }
+
+  int num_workers = get_num_workers(num_items);
+  Thread *current_thread = Thread::get_current_thread();
+  if (num_workers <= 1 || current_thread->get_sync_name() == _chain_name) {
+    // Nothing to share, or we are already running on this chain, in
+    // which case waiting for other tasks on the chain might never
+    // finish.
+    (*func)(user_data, 0, num_items, 0);
+    return;
+  }
+
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  PT(AsyncTaskChain) chain = task_mgr->make_task_chain(_chain_name);
+  if (chain->get_num_threads() < num_workers - 1) {
+    chain->set_num_threads(num_workers - 1);
+  }
+
+  RunState state;
+  state._func = func;
+  state._user_data = user_data;
+  state._num_items = num_items;
+  state._chunk_size = _chunk_size;
+  state._num_tasks = num_workers - 1;
+
+  pvector<Worker> workers(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    workers[i]._state = &state;
+    workers[i]._index = i;
+  }
+
+  for (int i = 1; i < num_workers; ++i) {
+    PT(GenericAsyncTask) task =
+      new GenericAsyncTask(_chain_name, &task_func, &workers[i]);
+    task->set_upon_death(&task_death);
+    task->set_task_chain(_chain_name);
+    task_mgr->add(task);
+  }
+
+  // The calling thread does its share too.  Since it keeps claiming
+  // items until there are none left, this also takes care of the
+  // share of any task that is removed before it can run.
+  do_work(&workers[0]);
+
+  MutexHolder holder(state._lock);
+  while (state._num_tasks > 0) {
+    state._cvar.wait();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ParallelFor::do_work
+//       Access: Private, Static
+//  Description: Processes chunks of items until there are none left
+//               to claim.
+////////////////////////////////////////////////////////////////////
+void ParallelFor::
+do_work(Worker *worker) {
+  RunState *state = worker->_state;
+
+  AtomicAdjust::Integer num_items = (AtomicAdjust::Integer)state->_num_items;
+  AtomicAdjust::Integer next = AtomicAdjust::get(state->_next);
+  while (next < num_items) {
+    // Try to claim the next chunk for ourselves.  If another thread
+    // got there first, try again with whatever it left behind.
+    AtomicAdjust::Integer end =
+      min(next + (AtomicAdjust::Integer)state->_chunk_size, num_items);
+    AtomicAdjust::Integer orig_next =
+      AtomicAdjust::compare_and_exchange(state->_next, next, end);
+    if (orig_next != next) {
+      next = orig_next;
+      continue;
+    }
+
+    (*state->_func)(state->_user_data, (int)next, (int)end, worker->_index);
+    next = AtomicAdjust::get(state->_next);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ParallelFor::task_func
+//       Access: Private, Static
+//  Description: The task function for each of the tasks started by
+//               run().
+////////////////////////////////////////////////////////////////////
+AsyncTask::DoneStatus ParallelFor::
+task_func(GenericAsyncTask *task, void *user_data) {
+  do_work((Worker *)user_data);
+  return AsyncTask::DS_done;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ParallelFor::task_death
+//       Access: Private, Static
+//  Description: Called when each of the tasks started by run()
+//               finishes, or is removed, to let run() know.
+////////////////////////////////////////////////////////////////////
+void ParallelFor::
+task_death(GenericAsyncTask *task, bool clean_exit, void *user_data) {
+  RunState *state = ((Worker *)user_data)->_state;
+  MutexHolder holder(state->_lock);
+  --(state->_num_tasks);
+  state->_cvar.notify();
+}
@@ -0,0 +1,102 @@
+// Filename: parallelFor.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include "pandabase.h"
+
+#include "asyncTask.h"
+#include "genericAsyncTask.h"
+#include "atomicAdjust.h"
+#include "pmutex.h"
+#include "conditionVar.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : ParallelFor
+// Description : Calls a function on each of a range of items,
+//               dividing the items among the threads of the named
+//               AsyncTaskChain and the calling thread, and does not
+//               return until all of them have been processed.
+//
+//               The items are handed out in chunks of
+//               get_chunk_size() items at a time, to whichever thread
+//               asks for more work next, so the order in which they
+//               are processed is unspecified.  Each call to the
+//               function is also given the index of the worker making
+//               it, from 0 to get_num_workers() - 1, so that the
+//               caller may keep per-worker results without locking;
+//               the calling thread is always worker 0.
+//
+//               The task chain is created if necessary, and given
+//               enough threads for num_threads workers.  If threading
+//               is not available, or there is not enough work to
+//               share, or run() is called from one of the threads of
+//               the same chain, the function is simply called once
+//               for the whole range, on the calling thread.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_EVENT ParallelFor {
+public:
+  typedef void RangeFunc(void *user_data, int begin, int end,
+                         int worker_index);
+
+  ParallelFor(const string &chain_name, int num_threads,
+              int chunk_size = 1);
+
+  INLINE const string &get_chain_name() const;
+  INLINE int get_num_threads() const;
+  INLINE int get_chunk_size() const;
+  int get_num_workers(int num_items) const;
+
+  BLOCKING void run(RangeFunc *func, void *user_data, int num_items);
+
+private:
+  // The state shared by all of the workers of one call to run().
+  // _num_tasks counts down the tasks as they finish, so that run()
+  // waits for just these, and not whatever else is on the chain.
+  class RunState {
+  public:
+    INLINE RunState();
+
+    RangeFunc *_func;
+    void *_user_data;
+    int _num_items;
+    int _chunk_size;
+    AtomicAdjust::Integer _next;
+
+    Mutex _lock;
+    ConditionVar _cvar;
+    int _num_tasks;
+  };
+
+  class Worker {
+  public:
+    RunState *_state;
+    int _index;
+  };
+
+  static void do_work(Worker *worker);
+  static AsyncTask::DoneStatus task_func(GenericAsyncTask *task,
+                                         void *user_data);
+  static void task_death(GenericAsyncTask *task, bool clean_exit,
+                         void *user_data);
+
+  string _chain_name;
+  int _num_threads;
+  int _chunk_size;
+};
+
+#include "parallelFor.I"
+
+#endif
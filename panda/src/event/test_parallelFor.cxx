@@ -0,0 +1,111 @@
+// Filename: test_parallelFor.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "parallelFor.h"
+#include "atomicAdjust.h"
+#include "pvector.h"
+
+// This program runs a ParallelFor over a range of items, and checks
+// that each item is visited exactly once, by a worker with a valid
+// index.  It also runs a ParallelFor from within another one on the
+// same chain, which must not deadlock.
+
+static const int num_items = 10000;
+static const int num_threads = 4;
+
+class Visits {
+public:
+  pvector<AtomicAdjust::Integer> _counts;
+  int _num_workers;
+  AtomicAdjust::Integer _bad_worker;
+  AtomicAdjust::Integer _bad_range;
+};
+
+static void
+visit_range(void *user_data, int begin, int end, int worker_index) {
+  Visits *visits = (Visits *)user_data;
+  if (worker_index < 0 || worker_index >= visits->_num_workers) {
+    AtomicAdjust::inc(visits->_bad_worker);
+  }
+  if (begin < 0 || end > (int)visits->_counts.size() || begin >= end) {
+    AtomicAdjust::inc(visits->_bad_range);
+    return;
+  }
+  for (int i = begin; i < end; ++i) {
+    AtomicAdjust::inc(visits->_counts[i]);
+  }
+}
+
+static bool
+check_visits(const string &test, const Visits &visits) {
+  bool ok = true;
+  if (visits._bad_worker != 0) {
+    nout << test << ": " << visits._bad_worker << " bad worker indices\n";
+    ok = false;
+  }
+  if (visits._bad_range != 0) {
+    nout << test << ": " << visits._bad_range << " bad ranges\n";
+    ok = false;
+  }
+  for (size_t i = 0; i < visits._counts.size(); ++i) {
+    if (visits._counts[i] != 1) {
+      nout << test << ": item " << i << " visited "
+           << visits._counts[i] << " times\n";
+      ok = false;
+      break;
+    }
+  }
+  return ok;
+}
+
+static bool
+run_visits(const string &test, int chunk_size) {
+  ParallelFor pfor("test_parallel_for", num_threads, chunk_size);
+  Visits visits;
+  visits._counts.resize(num_items, 0);
+  visits._num_workers = pfor.get_num_workers(num_items);
+  visits._bad_worker = 0;
+  visits._bad_range = 0;
+  pfor.run(&visit_range, &visits, num_items);
+  return check_visits(test, visits);
+}
+
+// Each item of the outer range runs a whole inner range.
+static AtomicAdjust::Integer nested_ok;
+
+static void
+nested_range(void *user_data, int begin, int end, int worker_index) {
+  for (int i = begin; i < end; ++i) {
+    if (!run_visits("nested", 7)) {
+      AtomicAdjust::set(nested_ok, 0);
+    }
+  }
+}
+
+int
+main(int argc, char *argv[]) {
+  bool ok = true;
+  ok = run_visits("chunk 1", 1) && ok;
+  ok = run_visits("chunk 64", 64) && ok;
+  ok = run_visits("chunk larger than range", num_items * 2) && ok;
+
+  nested_ok = 1;
+  ParallelFor outer("test_parallel_for", num_threads);
+  outer.run(&nested_range, NULL, num_threads * 2);
+  ok = (nested_ok != 0) && ok;
+
+  nout << (ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -13,7 +13,9 @@
     ca_bundle_data_src.c \
     checksumHashGenerator.I checksumHashGenerator.h circBuffer.I \
     circBuffer.h \
+    codecStream.I codecStream.h codecStreamBuf.h \
     compress_string.h \
+    compressionCodec.I compressionCodec.h \
     config_express.h \
     copy_stream.h \
     datagram.I datagram.h datagramGenerator.I \
@@ -27,7 +29,9 @@
     hashGeneratorBase.I hashGeneratorBase.h \
     hashVal.I hashVal.h \
     indirectLess.I indirectLess.h \
+    lz4Codec.h \
     memoryInfo.I memoryInfo.h \
+    memoryStream.I memoryStream.h memoryStreamBuf.h \
     memoryUsage.I memoryUsage.h \
     memoryUsagePointerCounts.I memoryUsagePointerCounts.h \
     memoryUsagePointers.I memoryUsagePointers.h \
@@ -79,11 +83,13 @@
     weakPointerToVoid.I weakPointerToVoid.h \
     weakReferenceList.I weakReferenceList.h \
     windowsRegistry.h \
+    zlibCodec.h \
     zStream.I zStream.h zStreamBuf.h
 
   #define INCLUDED_SOURCES  \
     buffer.cxx checksumHashGenerator.cxx \
-    compress_string.cxx \
+    codecStreamBuf.cxx \
+    compress_string.cxx compressionCodec.cxx \
     config_express.cxx \
     copy_stream.cxx \
     datagram.cxx datagramGenerator.cxx \
@@ -93,7 +99,9 @@
     error_utils.cxx \
     fileReference.cxx \
     hashGeneratorBase.cxx hashVal.cxx \
-    memoryInfo.cxx memoryUsage.cxx memoryUsagePointerCounts.cxx \
+    lz4Codec.cxx \
+    memoryInfo.cxx memoryStreamBuf.cxx \
+    memoryUsage.cxx memoryUsagePointerCounts.cxx \
     memoryUsagePointers_ext.cxx \
     memoryUsagePointers.cxx multifile.cxx \
     namable.cxx \
@@ -137,6 +145,7 @@
     weakPointerToVoid.cxx \
     weakReferenceList.cxx \
     windowsRegistry.cxx \
+    zlibCodec.cxx \
     zStream.cxx zStreamBuf.cxx
 
   #define INSTALL_HEADERS  \
@@ -144,7 +153,9 @@
     ca_bundle_data_src.c \
     checksumHashGenerator.I checksumHashGenerator.h circBuffer.I \
     circBuffer.h \
+    codecStream.I codecStream.h codecStreamBuf.h \
     compress_string.h \
+    compressionCodec.I compressionCodec.h \
     config_express.h \
     copy_stream.h \
     datagram.I datagram.h datagramGenerator.I \
@@ -157,7 +168,9 @@
     hashGeneratorBase.I hashGeneratorBase.h \
     hashVal.I hashVal.h \
     indirectLess.I indirectLess.h \
+    lz4Codec.h \
     memoryInfo.I memoryInfo.h \
+    memoryStream.I memoryStream.h memoryStreamBuf.h \
     memoryUsage.I memoryUsage.h \
     memoryUsagePointerCounts.I memoryUsagePointerCounts.h \
     memoryUsagePointers.I memoryUsagePointers.h \
@@ -206,6 +219,7 @@
     weakPointerToVoid.I weakPointerToVoid.h \
     weakReferenceList.I weakReferenceList.h \
     windowsRegistry.h \
+    zlibCodec.h \
     zStream.I zStream.h zStreamBuf.h
 
   #define IGATESCAN all
@@ -271,3 +285,24 @@
 
 #end test_bin_target
 #endif
+
+#begin test_bin_target
+  #define TARGET test_lz4
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3express
+  #define OTHER_LIBS p3dtoolutil:c p3dtool:m p3prc:c p3dtoolconfig:m p3pystub
+
+  #define SOURCES \
+    test_lz4.cxx
+
+#end test_bin_target
+
+
+#begin test_bin_target
+  #define TARGET test_multifile_mmap
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3express
+  #define OTHER_LIBS p3dtoolutil:c p3dtool:m p3prc:c p3dtoolconfig:m p3pystub
+
+  #define SOURCES \
+    test_multifile_mmap.cxx
+
+#end test_bin_target
@@ -0,0 +1,70 @@
+// Filename: codecStream.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef CODECSTREAM_H
+#define CODECSTREAM_H
+
+#include "pandabase.h"
+#include "codecStreamBuf.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : ICodecStream
+// Description : An input stream object that decompresses the output
+//               of an OCodecStream on-the-fly, using whichever
+//               CompressionCodec it was written with.
+//
+//               Seeking is not supported.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS ICodecStream : public istream {
+PUBLISHED:
+  INLINE ICodecStream();
+  INLINE ICodecStream(istream *source, bool owns_source);
+
+  INLINE ICodecStream &open(istream *source, bool owns_source);
+  INLINE ICodecStream &close();
+
+  INLINE static bool is_codec_stream(istream &source);
+
+private:
+  CodecStreamBuf _buf;
+};
+
+////////////////////////////////////////////////////////////////////
+//       Class : OCodecStream
+// Description : An output stream object that compresses data to
+//               another destination stream on-the-fly, in blocks,
+//               using the indicated CompressionCodec (or the one
+//               named by compression-codec, if none is given).
+//
+//               Seeking is not supported.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS OCodecStream : public ostream {
+PUBLISHED:
+  INLINE OCodecStream();
+  INLINE OCodecStream(ostream *dest, bool owns_dest,
+                      CompressionCodec *codec = NULL,
+                      int compression_level = 6);
+
+  INLINE OCodecStream &open(ostream *dest, bool owns_dest,
+                            CompressionCodec *codec = NULL,
+                            int compression_level = 6);
+  INLINE OCodecStream &close();
+
+private:
+  CodecStreamBuf _buf;
+};
+
+#include "codecStream.I"
+
+#endif
@@ -0,0 +1,433 @@
+// Filename: codecStreamBuf.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "codecStreamBuf.h"
+#include "config_express.h"
+#include "memoryHook.h"
+
+#include <string.h>
+
+// This sequence of bytes begins every codec stream.  It is followed
+// by one more byte, the codec id.
+const char CodecStreamBuf::_header[] = "pzc\001";
+
+////////////////////////////////////////////////////////////////////
+//     Function: put_uint32
+//  Description: Writes a 32-bit little-endian value to the buffer.
+////////////////////////////////////////////////////////////////////
+static void
+put_uint32(char *p, PN_uint32 value) {
+  p[0] = (char)(value & 0xff);
+  p[1] = (char)((value >> 8) & 0xff);
+  p[2] = (char)((value >> 16) & 0xff);
+  p[3] = (char)((value >> 24) & 0xff);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: get_uint32
+//  Description: Reads a 32-bit little-endian value from the buffer.
+////////////////////////////////////////////////////////////////////
+static PN_uint32
+get_uint32(const char *p) {
+  const unsigned char *u = (const unsigned char *)p;
+  return (PN_uint32)u[0] | ((PN_uint32)u[1] << 8) |
+    ((PN_uint32)u[2] << 16) | ((PN_uint32)u[3] << 24);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+CodecStreamBuf::
+CodecStreamBuf() {
+  _source = (istream *)NULL;
+  _owns_source = false;
+  _read_header = false;
+  _dest = (ostream *)NULL;
+  _owns_dest = false;
+  _compression_level = 0;
+  _block_start = 0;
+
+  _buffer = (char *)PANDA_MALLOC_ARRAY(block_size);
+  setg(_buffer, _buffer, _buffer);
+  setp(_buffer, _buffer + block_size);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::Destructor
+//       Access: Public, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+CodecStreamBuf::
+~CodecStreamBuf() {
+  close_read();
+  close_write();
+  PANDA_FREE_ARRAY(_buffer);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::open_read
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+void CodecStreamBuf::
+open_read(istream *source, bool owns_source) {
+  close_read();
+  _source = source;
+  _owns_source = owns_source;
+  _read_header = false;
+  _block_start = 0;
+  _codec.clear();
+  setg(_buffer, _buffer, _buffer);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::close_read
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+void CodecStreamBuf::
+close_read() {
+  if (_source != (istream *)NULL) {
+    if (_owns_source) {
+      delete _source;
+      _owns_source = false;
+    }
+    _source = (istream *)NULL;
+    _codec.clear();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::open_write
+//       Access: Public
+//  Description: Begins writing compressed data to the indicated
+//               stream.  If codec is NULL, the default codec is
+//               used.
+////////////////////////////////////////////////////////////////////
+void CodecStreamBuf::
+open_write(ostream *dest, bool owns_dest, CompressionCodec *codec,
+           int compression_level) {
+  close_write();
+  if (codec == (CompressionCodec *)NULL) {
+    codec = CompressionCodec::get_default_codec();
+  }
+  nassertv(codec != (CompressionCodec *)NULL);
+
+  _dest = dest;
+  _owns_dest = owns_dest;
+  _codec = codec;
+  _compression_level = compression_level;
+  _block_start = 0;
+  setp(_buffer, _buffer + block_size);
+
+  char header[header_size];
+  memcpy(header, _header, header_size - 1);
+  header[header_size - 1] = (char)codec->get_id();
+  _dest->write(header, header_size);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::close_write
+//       Access: Public
+//  Description: Writes out any pending data, and the end-of-stream
+//               marker.
+////////////////////////////////////////////////////////////////////
+void CodecStreamBuf::
+close_write() {
+  if (_dest != (ostream *)NULL) {
+    write_block();
+
+    char terminator[8];
+    put_uint32(terminator, 0);
+    put_uint32(terminator + 4, 0);
+    _dest->write(terminator, 8);
+    _dest->flush();
+
+    if (_owns_dest) {
+      delete _dest;
+      _owns_dest = false;
+    }
+    _dest = (ostream *)NULL;
+    _codec.clear();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::seekoff
+//       Access: Public, Virtual
+//  Description: Seeking is not supported, but this does report the
+//               current position within the uncompressed data, so
+//               that tellg() and tellp() work.
+////////////////////////////////////////////////////////////////////
+streampos CodecStreamBuf::
+seekoff(streamoff off, ios_seekdir dir, ios_openmode which) {
+  if (off != 0 || dir != ios::cur) {
+    return -1;
+  }
+  if ((which & ios::in) != 0 && _source != (istream *)NULL) {
+    return _block_start + (streamoff)(gptr() - eback());
+  }
+  if ((which & ios::out) != 0 && _dest != (ostream *)NULL) {
+    return _block_start + (streamoff)(pptr() - pbase());
+  }
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::seekpos
+//       Access: Public, Virtual
+//  Description: Seeking is not supported.
+////////////////////////////////////////////////////////////////////
+streampos CodecStreamBuf::
+seekpos(streampos pos, ios_openmode which) {
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::has_header
+//       Access: Public, Static
+//  Description: Returns true if the indicated stream begins, at its
+//               current position, with the header written by
+//               open_write().  The stream must support seeking, so
+//               that its position can be restored afterwards;
+//               otherwise, this returns false without reading it.
+//
+//               This works directly on the stream's streambuf, so the
+//               state of the stream itself is never changed.  In
+//               particular, a stream that is already decompressing a
+//               codec stream can't seek, and is left untouched.
+////////////////////////////////////////////////////////////////////
+bool CodecStreamBuf::
+has_header(istream &source) {
+  streambuf *buf = source.rdbuf();
+  if (buf == (streambuf *)NULL || !source.good()) {
+    return false;
+  }
+
+  // Make sure we will be able to get back here before we read
+  // anything.
+  streampos start = buf->pubseekoff(0, ios::cur, ios::in);
+  if (start == (streampos)-1 ||
+      buf->pubseekpos(start, ios::in) != start) {
+    return false;
+  }
+
+  char header[header_size - 1];
+  streamsize count = buf->sgetn(header, header_size - 1);
+  bool matches = (count == header_size - 1 &&
+                  memcmp(header, _header, header_size - 1) == 0);
+
+  if (buf->pubseekpos(start, ios::in) != start) {
+    // This shouldn't happen, since we could seek here before.
+    express_cat.error()
+      << "Unable to restore stream position after checking for codec header.\n";
+    source.setstate(ios::failbit);
+    return false;
+  }
+  return matches;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::overflow
+//       Access: Protected, Virtual
+//  Description: Called by the system ostream implementation when its
+//               internal buffer is filled, plus one character.
+////////////////////////////////////////////////////////////////////
+int CodecStreamBuf::
+overflow(int ch) {
+  if (!write_block()) {
+    return EOF;
+  }
+
+  if (ch != EOF) {
+    *pptr() = (char)ch;
+    pbump(1);
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::sync
+//       Access: Protected, Virtual
+//  Description: Called by the system iostream implementation to
+//               implement a flush operation.  This writes out the
+//               pending data as a (possibly short) block.
+////////////////////////////////////////////////////////////////////
+int CodecStreamBuf::
+sync() {
+  if (_dest != (ostream *)NULL) {
+    if (!write_block()) {
+      return EOF;
+    }
+    _dest->flush();
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::underflow
+//       Access: Protected, Virtual
+//  Description: Called by the system istream implementation when its
+//               internal buffer needs more characters.
+////////////////////////////////////////////////////////////////////
+int CodecStreamBuf::
+underflow() {
+  if (gptr() >= egptr()) {
+    if (!read_block()) {
+      return EOF;
+    }
+  }
+  return (unsigned char)*gptr();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::read_header
+//       Access: Private
+//  Description: Reads the stream header and looks up the codec it
+//               names.  Returns true on success.
+////////////////////////////////////////////////////////////////////
+bool CodecStreamBuf::
+read_header() {
+  _read_header = true;
+
+  char header[header_size];
+  _source->read(header, header_size);
+  if (_source->gcount() != header_size ||
+      memcmp(header, _header, header_size - 1) != 0) {
+    express_cat.error()
+      << "Stream is not compressed with a CompressionCodec.\n";
+    return false;
+  }
+
+  int id = (unsigned char)header[header_size - 1];
+  _codec = CompressionCodec::get_codec(id);
+  if (_codec == (CompressionCodec *)NULL) {
+    express_cat.error()
+      << "Stream is compressed with unknown codec " << id << ".\n";
+    return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::read_block
+//       Access: Private
+//  Description: Reads and decompresses the next block from the
+//               source stream into the get area.  Returns false at
+//               end of stream or on error.
+////////////////////////////////////////////////////////////////////
+bool CodecStreamBuf::
+read_block() {
+  if (_source == (istream *)NULL) {
+    return false;
+  }
+  if (!_read_header) {
+    if (!read_header()) {
+      return false;
+    }
+  } else if (_codec == (CompressionCodec *)NULL) {
+    return false;
+  }
+
+  _block_start += (streamoff)(egptr() - eback());
+  setg(_buffer, _buffer, _buffer);
+
+  char lengths[8];
+  _source->read(lengths, 8);
+  if (_source->gcount() != 8) {
+    express_cat.error()
+      << "Unexpected end of compressed stream.\n";
+    return false;
+  }
+  size_t raw_size = get_uint32(lengths);
+  size_t stored_size = get_uint32(lengths + 4);
+  if (raw_size == 0) {
+    // End of stream.
+    return false;
+  }
+  if (raw_size > block_size || stored_size > raw_size) {
+    express_cat.error()
+      << "Invalid block in compressed stream.\n";
+    _codec.clear();
+    return false;
+  }
+
+  if (stored_size == raw_size) {
+    // This block was stored uncompressed.
+    _source->read(_buffer, raw_size);
+    if ((size_t)_source->gcount() != raw_size) {
+      express_cat.error()
+        << "Unexpected end of compressed stream.\n";
+      return false;
+    }
+
+  } else {
+    _packed.resize(stored_size);
+    _source->read(&_packed[0], stored_size);
+    if ((size_t)_source->gcount() != stored_size) {
+      express_cat.error()
+        << "Unexpected end of compressed stream.\n";
+      return false;
+    }
+    if (!_codec->decompress(_packed.data(), stored_size, _buffer, raw_size)) {
+      express_cat.error()
+        << "Corrupt block in " << _codec->get_name() << " stream.\n";
+      _codec.clear();
+      return false;
+    }
+  }
+
+  setg(_buffer, _buffer, _buffer + raw_size);
+  thread_consider_yield();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CodecStreamBuf::write_block
+//       Access: Private
+//  Description: Compresses the contents of the put area, if any, and
+//               writes it to the dest stream as a block.
+////////////////////////////////////////////////////////////////////
+bool CodecStreamBuf::
+write_block() {
+  if (_dest == (ostream *)NULL || _codec == (CompressionCodec *)NULL) {
+    return false;
+  }
+
+  size_t raw_size = pptr() - pbase();
+  if (raw_size == 0) {
+    return true;
+  }
+
+  _packed.resize(8);
+  const char *data = pbase();
+  size_t stored_size = raw_size;
+  if (_codec->compress(pbase(), raw_size, _packed, _compression_level) &&
+      _packed.size() - 8 < raw_size) {
+    data = _packed.data() + 8;
+    stored_size = _packed.size() - 8;
+  }
+
+  put_uint32(&_packed[0], (PN_uint32)raw_size);
+  put_uint32(&_packed[4], (PN_uint32)stored_size);
+  _dest->write(_packed.data(), 8);
+  _dest->write(data, stored_size);
+
+  _block_start += (streamoff)raw_size;
+  setp(_buffer, _buffer + block_size);
+  thread_consider_yield();
+  return !_dest->fail();
+}
@@ -0,0 +1,86 @@
+// Filename: codecStreamBuf.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef CODECSTREAMBUF_H
+#define CODECSTREAMBUF_H
+
+#include "pandabase.h"
+#include "compressionCodec.h"
+#include "pointerTo.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : CodecStreamBuf
+// Description : The streambuf object that implements ICodecStream
+//               and OCodecStream.
+//
+//               The compressed stream begins with a short header that
+//               identifies the codec, followed by a series of blocks,
+//               each of which is compressed independently.  Each
+//               block is preceded by its uncompressed and compressed
+//               lengths; a block whose two lengths are equal is
+//               stored uncompressed, and a block with an uncompressed
+//               length of zero marks the end of the stream.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS CodecStreamBuf : public streambuf {
+public:
+  CodecStreamBuf();
+  virtual ~CodecStreamBuf();
+
+  void open_read(istream *source, bool owns_source);
+  void close_read();
+
+  void open_write(ostream *dest, bool owns_dest, CompressionCodec *codec,
+                  int compression_level);
+  void close_write();
+
+  virtual streampos seekoff(streamoff off, ios_seekdir dir, ios_openmode which);
+  virtual streampos seekpos(streampos pos, ios_openmode which);
+
+  static bool has_header(istream &source);
+
+protected:
+  virtual int overflow(int c);
+  virtual int sync();
+  virtual int underflow();
+
+private:
+  bool read_header();
+  bool read_block();
+  bool write_block();
+
+private:
+  istream *_source;
+  bool _owns_source;
+  bool _read_header;
+
+  ostream *_dest;
+  bool _owns_dest;
+  int _compression_level;
+
+  PT(CompressionCodec) _codec;
+
+  // The uncompressed stream position of the beginning of _buffer.
+  streamoff _block_start;
+
+  char *_buffer;
+  string _packed;
+
+  enum {
+    block_size = 0x10000,
+    header_size = 5,
+  };
+  static const char _header[];
+};
+
+#endif
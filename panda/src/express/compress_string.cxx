@@ -16,6 +16,7 @@
 
 #ifdef HAVE_ZLIB
 #include "zStream.h"
+#include "codecStream.h"
 #include "virtualFileSystem.h"
 #include "config_express.h"
 
@@ -25,12 +26,27 @@
 //  Description: Compress the indicated source string at the given
 //               compression level (1 through 9).  Returns the
 //               compressed string.
+//
+//               The string is compressed with the codec named by
+//               compression-codec; decompress_string() recognizes
+//               the result either way.
 ////////////////////////////////////////////////////////////////////
 string
 compress_string(const string &source, int compression_level) {
   ostringstream dest;
 
-  {
+  CompressionCodec *codec = CompressionCodec::get_default_codec();
+  if (codec != (CompressionCodec *)NULL &&
+      codec->get_id() != CompressionCodec::CI_zlib) {
+    OCodecStream compress(&dest, false, codec, compression_level);
+    compress.write(source.data(), source.length());
+    compress.close();
+
+    if (compress.fail()) {
+      return string();
+    }
+
+  } else {
     OCompressStream compress;
     compress.open(&dest, false, compression_level);
     compress.write(source.data(), source.length());
@@ -153,25 +169,36 @@ decompress_file(const Filename &source, const Filename &dest) {
 //               end-of-file, and the compressed results are written
 //               to the dest stream.  The return value is bool on
 //               success, or false on failure.
+//
+//               As with compress_string(), the stream is compressed
+//               with the codec named by compression-codec.
 ////////////////////////////////////////////////////////////////////
 bool
 compress_stream(istream &source, ostream &dest, int compression_level) {
-  OCompressStream compress;
-  compress.open(&dest, false, compression_level);
-    
+  CompressionCodec *codec = CompressionCodec::get_default_codec();
+  ostream *compress;
+  if (codec != (CompressionCodec *)NULL &&
+      codec->get_id() != CompressionCodec::CI_zlib) {
+    compress = new OCodecStream(&dest, false, codec, compression_level);
+  } else {
+    compress = new OCompressStream(&dest, false, compression_level);
+  }
+
   static const size_t buffer_size = 4096;
   char buffer[buffer_size];
 
   source.read(buffer, buffer_size);
   size_t count = source.gcount();
   while (count != 0) {
-    compress.write(buffer, count);
+    compress->write(buffer, count);
     source.read(buffer, buffer_size);
     count = source.gcount();
   }
-  compress.close();
+  compress->flush();
+  bool okflag = (!source.fail() || source.eof()) && (!compress->fail());
+  delete compress;
 
-  return (!source.fail() || source.eof()) && (!compress.fail());
+  return okflag && !dest.fail();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -187,23 +214,33 @@ compress_stream(istream &source, ostream &dest, int compression_level) {
 //               Note that a decompression error cannot easily be
 //               detected, and the output may simply be a garbage
 //               or truncated string.
+//
+//               Data written with a codec other than zlib is only
+//               recognized if the source stream supports seeking.
 ////////////////////////////////////////////////////////////////////
 bool
 decompress_stream(istream &source, ostream &dest) {
-  IDecompressStream decompress(&source, false);
+  istream *decompress;
+  if (ICodecStream::is_codec_stream(source)) {
+    decompress = new ICodecStream(&source, false);
+  } else {
+    decompress = new IDecompressStream(&source, false);
+  }
 
   static const size_t buffer_size = 4096;
   char buffer[buffer_size];
 
-  decompress.read(buffer, buffer_size);
-  size_t count = decompress.gcount();
+  decompress->read(buffer, buffer_size);
+  size_t count = decompress->gcount();
   while (count != 0) {
     dest.write(buffer, count);
-    decompress.read(buffer, buffer_size);
-    count = decompress.gcount();
+    decompress->read(buffer, buffer_size);
+    count = decompress->gcount();
   }
-  
-  return (!decompress.fail() || decompress.eof()) && (!dest.fail());
+
+  bool okflag = (!decompress->fail() || decompress->eof()) && (!dest.fail());
+  delete decompress;
+  return okflag;
 }
 
 #endif // HAVE_ZLIB
@@ -0,0 +1,135 @@
+// Filename: compressionCodec.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "compressionCodec.h"
+#include "zlibCodec.h"
+#include "lz4Codec.h"
+#include "config_express.h"
+
+CompressionCodec *CompressionCodec::_codecs[CompressionCodec::CI_max];
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompressionCodec::Constructor
+//       Access: Protected
+//  Description:
+////////////////////////////////////////////////////////////////////
+CompressionCodec::
+CompressionCodec(int id, const string &name) :
+  _id(id),
+  _name(name)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompressionCodec::Destructor
+//       Access: Public, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+CompressionCodec::
+~CompressionCodec() {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompressionCodec::get_codec
+//       Access: Published, Static
+//  Description: Returns the codec with the indicated id number, as
+//               recorded in a file, or NULL if there is no such codec
+//               available.
+////////////////////////////////////////////////////////////////////
+CompressionCodec *CompressionCodec::
+get_codec(int id) {
+  if (id <= 0 || id >= CI_max) {
+    return NULL;
+  }
+  return _codecs[id];
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompressionCodec::find_codec
+//       Access: Published, Static
+//  Description: Returns the codec with the indicated name, or NULL
+//               if there is no such codec available.
+////////////////////////////////////////////////////////////////////
+CompressionCodec *CompressionCodec::
+find_codec(const string &name) {
+  for (int i = 1; i < CI_max; ++i) {
+    if (_codecs[i] != (CompressionCodec *)NULL &&
+        _codecs[i]->get_name() == name) {
+      return _codecs[i];
+    }
+  }
+  return NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompressionCodec::get_default_codec
+//       Access: Published, Static
+//  Description: Returns the codec named by the compression-codec
+//               config variable, which is used to compress newly
+//               written data when no codec is explicitly specified.
+//               This may return NULL if no codecs are available.
+////////////////////////////////////////////////////////////////////
+CompressionCodec *CompressionCodec::
+get_default_codec() {
+  CompressionCodec *codec = find_codec(compression_codec);
+  if (codec == (CompressionCodec *)NULL) {
+    express_cat.warning()
+      << "Compression codec \"" << compression_codec.get_value()
+      << "\" is not available.\n";
+
+    codec = get_codec(CI_zlib);
+    if (codec == (CompressionCodec *)NULL) {
+      codec = get_codec(CI_lz4);
+    }
+  }
+  return codec;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompressionCodec::register_codec
+//       Access: Public, Static
+//  Description: Makes a new codec available by its id and name.
+//               This should be called at startup, before any threads
+//               have been spawned that might be reading or writing
+//               compressed data.  It is an error to register two
+//               codecs with the same id.
+////////////////////////////////////////////////////////////////////
+void CompressionCodec::
+register_codec(CompressionCodec *codec) {
+  nassertv(codec != (CompressionCodec *)NULL);
+  int id = codec->get_id();
+  nassertv(id > 0 && id < CI_max);
+  nassertv(_codecs[id] == (CompressionCodec *)NULL);
+
+  codec->ref();
+  _codecs[id] = codec;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CompressionCodec::init_codecs
+//       Access: Public, Static
+//  Description: Registers the built-in codecs.  This is called by
+//               init_libexpress().
+////////////////////////////////////////////////////////////////////
+void CompressionCodec::
+init_codecs() {
+#ifdef HAVE_ZLIB
+  if (_codecs[CI_zlib] == (CompressionCodec *)NULL) {
+    register_codec(new ZlibCodec);
+  }
+#endif
+  if (_codecs[CI_lz4] == (CompressionCodec *)NULL) {
+    register_codec(new Lz4Codec);
+  }
+}
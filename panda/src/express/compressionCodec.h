@@ -0,0 +1,94 @@
+// Filename: compressionCodec.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef COMPRESSIONCODEC_H
+#define COMPRESSIONCODEC_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : CompressionCodec
+// Description : The abstract base class for a general-purpose
+//               compression algorithm that operates on whole blocks
+//               of memory at a time.  Each codec is identified by a
+//               small integer, which is what gets recorded in files
+//               that use it, and by a name, which is what the user
+//               specifies, e.g. in the compression-codec config
+//               variable.
+//
+//               The "zlib" codec (if zlib is available) and the
+//               much faster, though less thorough, "lz4" codec are
+//               built in.  Others may be added at startup with
+//               register_codec().
+//
+//               See also ICodecStream and OCodecStream, which use a
+//               codec to compress a stream of data block by block.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS CompressionCodec : public ReferenceCount {
+protected:
+  CompressionCodec(int id, const string &name);
+
+public:
+  virtual ~CompressionCodec();
+
+PUBLISHED:
+  enum CodecId {
+    // 0 is reserved to mean "no codec".
+    CI_zlib = 1,
+    CI_lz4  = 2,
+
+    // Application-defined codecs should use numbers at least this
+    // large.
+    CI_user = 64,
+
+    CI_max = 256,
+  };
+
+  INLINE int get_id() const;
+  INLINE const string &get_name() const;
+
+  static CompressionCodec *get_codec(int id);
+  static CompressionCodec *find_codec(const string &name);
+  static CompressionCodec *get_default_codec();
+
+public:
+  // Compresses source_size bytes at source, and appends the
+  // compressed result to dest.  Returns true on success.
+  virtual bool compress(const char *source, size_t source_size,
+                        string &dest, int compression_level) const=0;
+
+  // Decompresses source_size bytes of previously compressed data at
+  // source, which must produce exactly dest_size bytes, into the
+  // buffer at dest.  Returns true on success, false if the data is
+  // corrupt.
+  virtual bool decompress(const char *source, size_t source_size,
+                          char *dest, size_t dest_size) const=0;
+
+  static void register_codec(CompressionCodec *codec);
+  static void init_codecs();
+
+private:
+  int _id;
+  string _name;
+
+  // This is a plain array, rather than a vector, so that it is safe
+  // to use during static init.  Codecs are only ever added, at
+  // startup.
+  static CompressionCodec *_codecs[CI_max];
+};
+
+#include "compressionCodec.I"
+
+#endif
@@ -13,6 +13,7 @@
 ////////////////////////////////////////////////////////////////////
 
 #include "config_express.h"
+#include "compressionCodec.h"
 #include "datagram.h"
 #include "datagramIterator.h"
 #include "nodeReferenceCount.h"
@@ -73,6 +74,29 @@ ConfigVariableBool multifile_always_binary
           "or extracted in either binary or text mode, according to the "
           "set_binary() or set_text() flag on the Filename."));
 
+ConfigVariableBool multifile_mmap
+("multifile-mmap", false,
+ PRC_DESC("Set this true to map each Multifile that is opened for reading "
+          "from disk into memory.  Uncompressed subfiles are then read "
+          "directly out of the mapping, and compressed or encrypted "
+          "subfiles are decoded by each reader independently, so that many "
+          "threads may load from the same Multifile at once without "
+          "waiting on each other.  This requires enough address space to "
+          "map the whole file, which may be a concern for very large "
+          "Multifiles in a 32-bit process."));
+
+ConfigVariableString compression_codec
+("compression-codec", "zlib",
+ PRC_DESC("The name of the CompressionCodec used to compress newly "
+          "written data: subfiles added to a Multifile, .pz files, "
+          "compress_string(), and the model cache when "
+          "model-cache-compress is set.  The choices are \"zlib\", "
+          "which compresses well, and \"lz4\", which decompresses many "
+          "times faster.  Data written with any codec can always be read "
+          "back regardless of this setting.  Note that .pz files and "
+          "Multifiles written with a codec other than zlib cannot be "
+          "read by older versions of Panda."));
+
 ConfigVariableBool collect_tcp
 ("collect-tcp", false,
  PRC_DESC("Set this true to enable accumulation of several small consecutive "
@@ -120,6 +144,7 @@ init_libexpress() {
   TemporaryFile::init_type();
 
   init_system_type_handles();
+  CompressionCodec::init_codecs();
 
 #ifdef HAVE_ZLIB
   {
@@ -24,6 +24,7 @@
 #include "configVariableDouble.h"
 #include "configVariableList.h"
 #include "configVariableFilename.h"
+#include "configVariableString.h"
 
 // Include this so interrogate can find it.
 #include "executionEnvironment.h"
@@ -55,6 +56,8 @@ extern ConfigVariableInt patchfile_zone_size;
 
 extern ConfigVariableBool keep_temporary_files;
 extern ConfigVariableBool multifile_always_binary;
+extern ConfigVariableBool multifile_mmap;
+extern EXPCL_PANDAEXPRESS ConfigVariableString compression_codec;
 
 extern EXPCL_PANDAEXPRESS ConfigVariableBool collect_tcp;
 extern EXPCL_PANDAEXPRESS ConfigVariableDouble collect_tcp_interval;
@@ -115,3 +115,21 @@ streampos DatagramGenerator::
 get_file_pos() {
   return 0;
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramGenerator::set_file_pos
+//       Access: Published, Virtual
+//  Description: Repositions the stream so that the next call to
+//               get_datagram() will return the datagram that begins
+//               at the indicated file position, as previously
+//               returned by get_file_pos() (or by the corresponding
+//               DatagramSink).
+//
+//               Returns true on success, or false if the stream
+//               cannot be repositioned, which is the case for most
+//               DatagramGenerators that are not file-based.
+////////////////////////////////////////////////////////////////////
+bool DatagramGenerator::
+set_file_pos(streampos pos) {
+  return false;
+}
@@ -45,6 +45,7 @@ PUBLISHED:
   virtual const FileReference *get_file();
   virtual VirtualFile *get_vfile();
   virtual streampos get_file_pos();
+  virtual bool set_file_pos(streampos pos);
 };
 
 #include "datagramGenerator.I"
@@ -105,3 +105,19 @@ streampos DatagramSink::
 get_file_pos() {
   return 0;
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramSink::is_seekable
+//       Access: Published, Virtual
+//  Description: Returns true if the positions returned by
+//               get_file_pos() are offsets within the file as it
+//               is stored, so that they may later be passed to
+//               DatagramGenerator::set_file_pos() to return to the
+//               same datagram when the file is read back.  This is
+//               false if the data is compressed, or if there is no
+//               file at all.
+////////////////////////////////////////////////////////////////////
+bool DatagramSink::
+is_seekable() {
+  return false;
+}
@@ -43,6 +43,7 @@ PUBLISHED:
   virtual const Filename &get_filename();
   virtual const FileReference *get_file();
   virtual streampos get_file_pos();
+  virtual bool is_seekable();
 };
 
 #include "datagramSink.I"
@@ -0,0 +1,256 @@
+// Filename: lz4Codec.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "lz4Codec.h"
+#include "numeric_types.h"
+
+#include <string.h>
+
+// These constants are defined by the LZ4 block format.  A match must
+// be at least min_match bytes long, the last last_literals bytes of
+// the block are always literals, and no match may begin within the
+// last match_limit bytes.
+static const size_t min_match = 4;
+static const size_t last_literals = 5;
+static const size_t match_limit = 12;
+static const size_t max_offset = 65535;
+
+static const int hash_log = 12;
+static const size_t hash_size = (size_t)1 << hash_log;
+
+////////////////////////////////////////////////////////////////////
+//     Function: read_uint32
+//  Description: Reads four bytes from an unaligned address.
+////////////////////////////////////////////////////////////////////
+static INLINE PN_uint32
+read_uint32(const unsigned char *p) {
+  PN_uint32 value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: hash_uint32
+//  Description: Returns the hash table index for the four bytes
+//               beginning at the indicated address.
+////////////////////////////////////////////////////////////////////
+static INLINE size_t
+hash_uint32(PN_uint32 value) {
+  return (size_t)((value * 2654435761U) >> (32 - hash_log));
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: write_length
+//  Description: Appends the extra bytes that encode a literal or
+//               match length of 15 or more.
+////////////////////////////////////////////////////////////////////
+static void
+write_length(string &dest, size_t length) {
+  length -= 15;
+  while (length >= 255) {
+    dest += (char)255;
+    length -= 255;
+  }
+  dest += (char)length;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: write_literals
+//  Description: Appends the token and literals of a sequence.  The
+//               low nibble of the token, the match length, must be
+//               filled in by the caller.
+////////////////////////////////////////////////////////////////////
+static size_t
+write_literals(string &dest, const unsigned char *literals, size_t length) {
+  size_t token_pos = dest.size();
+  dest += (char)((length >= 15 ? 15 : length) << 4);
+  if (length >= 15) {
+    write_length(dest, length);
+  }
+  dest.append((const char *)literals, length);
+  return token_pos;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Lz4Codec::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+Lz4Codec::
+Lz4Codec() : CompressionCodec(CI_lz4, "lz4") {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Lz4Codec::compress
+//       Access: Public, Virtual
+//  Description: Compresses the indicated block of data, appending
+//               the result to dest.  Returns true on success.
+//
+//               At compression levels below 6, the search skips
+//               ahead faster through data that doesn't seem to
+//               compress, in the manner of LZ4's "acceleration".
+////////////////////////////////////////////////////////////////////
+bool Lz4Codec::
+compress(const char *source, size_t source_size,
+         string &dest, int compression_level) const {
+  const unsigned char *src = (const unsigned char *)source;
+  dest.reserve(dest.size() + source_size + source_size / 255 + 16);
+
+  size_t anchor = 0;
+  if (source_size > match_limit) {
+    int skip_shift = (compression_level >= 6) ? 30 : 6;
+
+    // The hash table records the last position at which each hash of
+    // four bytes was seen.  A stale or colliding entry is harmless,
+    // since we compare the bytes before using it.
+    PN_uint32 table[hash_size];
+    memset(table, 0, sizeof(table));
+
+    size_t limit = source_size - match_limit;
+    size_t match_end_limit = source_size - last_literals;
+    size_t ip = 1;
+    while (ip < limit) {
+      PN_uint32 sequence = read_uint32(src + ip);
+      size_t h = hash_uint32(sequence);
+      size_t ref = table[h];
+      table[h] = (PN_uint32)ip;
+
+      if (ref >= ip || ip - ref > max_offset ||
+          read_uint32(src + ref) != sequence) {
+        ip += 1 + ((ip - anchor) >> skip_shift);
+        continue;
+      }
+
+      // Found a match.  Extend it backwards into the pending
+      // literals, and forwards as far as it will go.
+      while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+        --ip;
+        --ref;
+      }
+      size_t length = min_match;
+      while (ip + length < match_end_limit && src[ref + length] == src[ip + length]) {
+        ++length;
+      }
+
+      size_t token_pos = write_literals(dest, src + anchor, ip - anchor);
+      size_t offset = ip - ref;
+      dest += (char)(offset & 0xff);
+      dest += (char)(offset >> 8);
+
+      size_t match_length = length - min_match;
+      dest[token_pos] |= (char)(match_length >= 15 ? 15 : match_length);
+      if (match_length >= 15) {
+        write_length(dest, match_length);
+      }
+
+      ip += length;
+      anchor = ip;
+
+      // Also record the position just before the end of the match,
+      // which improves the ratio on repetitive data.
+      if (ip < limit) {
+        table[hash_uint32(read_uint32(src + ip - 2))] = (PN_uint32)(ip - 2);
+      }
+    }
+  }
+
+  // The remainder of the block is written as literals.
+  write_literals(dest, src + anchor, source_size - anchor);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Lz4Codec::decompress
+//       Access: Public, Virtual
+//  Description: Decompresses the indicated block of data into dest,
+//               which must be exactly large enough to hold it.
+//               Returns true on success, or false if the data is
+//               corrupt.
+////////////////////////////////////////////////////////////////////
+bool Lz4Codec::
+decompress(const char *source, size_t source_size,
+           char *dest, size_t dest_size) const {
+  const unsigned char *ip = (const unsigned char *)source;
+  const unsigned char *iend = ip + source_size;
+  unsigned char *op = (unsigned char *)dest;
+  unsigned char *oend = op + dest_size;
+
+  while (ip < iend) {
+    unsigned int token = *ip++;
+
+    // First, copy the literals.
+    size_t length = token >> 4;
+    if (length == 15) {
+      unsigned int b;
+      do {
+        if (ip >= iend) {
+          return false;
+        }
+        b = *ip++;
+        length += b;
+      } while (b == 255);
+    }
+    if ((size_t)(iend - ip) < length || (size_t)(oend - op) < length) {
+      return false;
+    }
+    memcpy(op, ip, length);
+    ip += length;
+    op += length;
+
+    if (ip == iend) {
+      // The last sequence has no match.
+      break;
+    }
+
+    // Then copy the match.
+    if (iend - ip < 2) {
+      return false;
+    }
+    size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t)(op - (unsigned char *)dest)) {
+      return false;
+    }
+
+    length = token & 0xf;
+    if (length == 15) {
+      unsigned int b;
+      do {
+        if (ip >= iend) {
+          return false;
+        }
+        b = *ip++;
+        length += b;
+      } while (b == 255);
+    }
+    length += min_match;
+    if ((size_t)(oend - op) < length) {
+      return false;
+    }
+
+    const unsigned char *match = op - offset;
+    if (offset >= length) {
+      memcpy(op, match, length);
+      op += length;
+    } else {
+      // The match overlaps the output; copy it a byte at a time.
+      unsigned char *mend = op + length;
+      while (op < mend) {
+        *op++ = *match++;
+      }
+    }
+  }
+
+  return (op == oend);
+}
@@ -0,0 +1,43 @@
+// Filename: lz4Codec.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef LZ4CODEC_H
+#define LZ4CODEC_H
+
+#include "pandabase.h"
+#include "compressionCodec.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : Lz4Codec
+// Description : A CompressionCodec that produces data in the LZ4
+//               block format.  It does not compress as well as zlib,
+//               but it decompresses many times faster, which makes it
+//               a good choice for data that is loaded often, such as
+//               models and textures in a Multifile or the model
+//               cache.
+//
+//               This is a self-contained implementation of the
+//               format, so it is always available.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS Lz4Codec : public CompressionCodec {
+public:
+  Lz4Codec();
+
+  virtual bool compress(const char *source, size_t source_size,
+                        string &dest, int compression_level) const;
+  virtual bool decompress(const char *source, size_t source_size,
+                          char *dest, size_t dest_size) const;
+};
+
+#endif
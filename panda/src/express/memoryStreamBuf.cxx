@@ -0,0 +1,131 @@
+// Filename: memoryStreamBuf.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "memoryStreamBuf.h"
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryStreamBuf::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+MemoryStreamBuf::
+MemoryStreamBuf() {
+  _data = (char *)NULL;
+  _size = 0;
+  setg(_data, _data, _data);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryStreamBuf::Destructor
+//       Access: Public, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+MemoryStreamBuf::
+~MemoryStreamBuf() {
+  close();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryStreamBuf::open
+//       Access: Public
+//  Description: Points the streambuf at the indicated block of
+//               memory, which must remain valid and unchanged for as
+//               long as the streambuf is open.  The memory is never
+//               written to.
+////////////////////////////////////////////////////////////////////
+void MemoryStreamBuf::
+open(const char *data, size_t size) {
+  // The get area is never written through, so it is safe to cast
+  // away the const.
+  _data = (char *)data;
+  _size = size;
+  setg(_data, _data, _data + _size);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryStreamBuf::close
+//       Access: Public
+//  Description: Resets the streambuf to its initial, empty state.
+//               The memory is not freed.
+////////////////////////////////////////////////////////////////////
+void MemoryStreamBuf::
+close() {
+  _data = (char *)NULL;
+  _size = 0;
+  setg(_data, _data, _data);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryStreamBuf::seekoff
+//       Access: Public, Virtual
+//  Description: Implements seeking within the stream.
+////////////////////////////////////////////////////////////////////
+streampos MemoryStreamBuf::
+seekoff(streamoff off, ios_seekdir dir, ios_openmode which) {
+  if ((which & ios::in) == 0) {
+    return -1;
+  }
+
+  streamoff new_pos;
+  switch (dir) {
+  case ios::beg:
+    new_pos = off;
+    break;
+
+  case ios::cur:
+    new_pos = (streamoff)(gptr() - eback()) + off;
+    break;
+
+  case ios::end:
+    new_pos = (streamoff)_size + off;
+    break;
+
+  default:
+    return -1;
+  }
+
+  if (new_pos < 0 || new_pos > (streamoff)_size) {
+    return -1;
+  }
+
+  setg(_data, _data + (size_t)new_pos, _data + _size);
+  return new_pos;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryStreamBuf::seekpos
+//       Access: Public, Virtual
+//  Description: A variant on seekoff() to implement seeking within a
+//               stream.  See SubStreamBuf::seekpos().
+////////////////////////////////////////////////////////////////////
+streampos MemoryStreamBuf::
+seekpos(streampos pos, ios_openmode which) {
+  return seekoff(pos, ios::beg, which);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryStreamBuf::underflow
+//       Access: Protected, Virtual
+//  Description: Called by the system istream implementation when its
+//               internal buffer needs more characters.  Since the
+//               whole block is always in the get area, this only
+//               happens at the end of the data.
+////////////////////////////////////////////////////////////////////
+int MemoryStreamBuf::
+underflow() {
+  if (gptr() < egptr()) {
+    return (unsigned char)*gptr();
+  }
+  return EOF;
+}
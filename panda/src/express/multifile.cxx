@@ -22,11 +22,24 @@
 #include "encryptStream.h"
 #include "virtualFileSystem.h"
 #include "virtualFile.h"
+#include "memoryStream.h"
+#include "codecStream.h"
+#include "subfileInfo.h"
 
 #include <algorithm>
 #include <iterator>
 #include <time.h>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 // This sequence of bytes begins each Multifile to identify it as a
 // Multifile.
 const char Multifile::_header[] = "pmf\0\n\r";
@@ -40,6 +53,13 @@ const int Multifile::_current_major_ver = 1;
 const int Multifile::_current_minor_ver = 1;
 // Bumped to version 1.1 on 6/8/06 to add timestamps.
 
+// A Multifile that contains at least one subfile compressed with a
+// codec other than zlib is written with this minor version instead,
+// since older readers can't decode such a subfile.  All other
+// Multifiles are still written with _current_minor_ver, so that they
+// remain readable by older versions of Panda.
+const int Multifile::_codec_minor_ver = 2;
+
 // To confirm that the supplied password matches, we write the
 // Mutifile magic header at the beginning of the encrypted stream.
 // I suppose this does compromise the encryption security a tiny
@@ -85,6 +105,10 @@ const size_t Multifile::_encrypt_header_size = 6;
 //               subfile, if it is compressed or encrypted.  This field
 //               is only present if one or both of the SF_compressed
 //               or SF_encrypted bits are set in _flags.
+//  [uint8]     The id of the CompressionCodec that compressed the
+//               subfile.  This field is only present if the SF_codec
+//               bit is set in _flags (which requires minor version
+//               2); otherwise, a compressed subfile uses zlib.
 //   uint32     A modification timestamp for the subfile.
 //   uint16     The length in bytes of the subfile's name.
 //   char[n]    The subfile's name.
@@ -132,6 +156,13 @@ Multifile() :
   _encryption_iteration_count = multifile_encryption_iteration_count;
   _file_major_ver = 0;
   _file_minor_ver = 0;
+  _mmap_data = (const char *)NULL;
+  _mmap_size = 0;
+  _mmap_base = NULL;
+  _mmap_base_size = 0;
+#ifdef _WIN32
+  _mmap_handle = NULL;
+#endif
 
 #ifdef HAVE_OPENSSL
   // Get these values from the config file via an EncryptStreamBuf.
@@ -185,6 +216,10 @@ operator = (const Multifile &copy) {
 //
 //               Also see the version of open_read() which accepts an
 //               istream.  Returns true on success, false on failure.
+//
+//               If multifile-mmap is true and the Multifile resides
+//               on disk, it is also mapped into memory; see
+//               is_mapped().
 ////////////////////////////////////////////////////////////////////
 bool Multifile::
 open_read(const Filename &multifile_name, const streampos &offset) {
@@ -208,7 +243,14 @@ open_read(const Filename &multifile_name, const streampos &offset) {
   _owns_stream = true;
   _multifile_name = multifile_name;
   _offset = offset;
-  return read_index();
+  if (!read_index()) {
+    return false;
+  }
+
+  if (multifile_mmap) {
+    open_mapping(vfile);
+  }
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -407,6 +449,8 @@ close() {
   _file_major_ver = 0;
   _file_minor_ver = 0;
 
+  close_mapping();
+
   _read_file.close();
   _write_file.close();
   _read_write_file.close();
@@ -1273,13 +1317,25 @@ flush() {
     }
 
   } else {
-    if (_file_minor_ver != _current_minor_ver) {
+    if (_file_minor_ver < _current_minor_ver) {
       // If we *do* have an index already, but this is an old version
       // multifile, we have to completely rewrite it anyway.
       return repack();
     }
   }
 
+  if (!new_file && _file_minor_ver < _codec_minor_ver &&
+      has_new_codec_subfiles()) {
+    // We're about to add a subfile that older readers can't decode,
+    // so bump the version number recorded in the header.  There's no
+    // need to rewrite anything else.
+    static const size_t minor_ver_pos = _header_prefix.size() + _header_size + 2;
+    _write->seekp(minor_ver_pos);
+    StreamWriter writer(*_write);
+    writer.add_int16(_codec_minor_ver);
+    _file_minor_ver = _codec_minor_ver;
+  }
+
   nassertr(_write != (ostream *)NULL, false);
 
   // First, mark out all of the removed subfiles.
@@ -1691,6 +1747,32 @@ is_subfile_compressed(int index) const {
   return (_subfiles[index]->_flags & SF_compressed) != 0;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Multifile::get_subfile_compression_codec
+//       Access: Published
+//  Description: Returns the name of the CompressionCodec with which
+//               the indicated subfile was compressed, or the empty
+//               string if it is not compressed.
+////////////////////////////////////////////////////////////////////
+string Multifile::
+get_subfile_compression_codec(int index) const {
+  nassertr(index >= 0 && index < (int)_subfiles.size(), string());
+  const Subfile *subfile = _subfiles[index];
+  if ((subfile->_flags & SF_compressed) == 0) {
+    return string();
+  }
+  if ((subfile->_flags & SF_codec) == 0) {
+    return "zlib";
+  }
+  CompressionCodec *codec = CompressionCodec::get_codec(subfile->_codec);
+  if (codec == (CompressionCodec *)NULL) {
+    ostringstream strm;
+    strm << "codec " << subfile->_codec;
+    return strm.str();
+  }
+  return codec->get_name();
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Multifile::is_subfile_encrypted
 //       Access: Published
@@ -2159,10 +2241,18 @@ read_subfile(int index, pvector<unsigned char> &result) {
     success = VirtualFile::simple_read_file(in, result);
     close_read_subfile(in);
 
+  } else if (get_mapped_data(subfile) != (const char *)NULL) {
+    // If the Multifile is mapped into memory, we can copy the data
+    // straight out of the mapping, without taking the stream lock.
+    const char *data = get_mapped_data(subfile);
+    result.insert(result.end(), (const unsigned char *)data,
+                  (const unsigned char *)data + subfile->_data_length);
+
   } else {
     // But if the subfile is just a plain file, we can just read the
     // data directly from the Multifile, without paying the cost of an
-    // ISubStream.
+    // ISubStream.  We also come here if the Multifile is mapped but
+    // the subfile lies outside the mapping.
     static const size_t buffer_size = 4096;
     char buffer[buffer_size];
 
@@ -2198,6 +2288,30 @@ read_subfile(int index, pvector<unsigned char> &result) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Multifile::get_subfile_mapped_data
+//       Access: Public
+//  Description: If the Multifile is mapped into memory (see
+//               is_mapped()) and the indicated subfile is stored
+//               neither compressed nor encrypted, returns a pointer
+//               to its get_subfile_length() bytes of data within the
+//               mapping.  This pointer remains valid until the
+//               Multifile is closed, and may be read from any thread.
+//
+//               Returns NULL if the data cannot be accessed directly
+//               in this way; in this case, use read_subfile() or
+//               open_read_subfile() instead.
+////////////////////////////////////////////////////////////////////
+const char *Multifile::
+get_subfile_mapped_data(int index) const {
+  nassertr(index >= 0 && index < (int)_subfiles.size(), NULL);
+  const Subfile *subfile = _subfiles[index];
+  if ((subfile->_flags & (SF_encrypted | SF_compressed)) != 0) {
+    return NULL;
+  }
+  return get_mapped_data(subfile);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Multifile::pad_to_streampos
 //       Access: Private
@@ -2229,14 +2343,28 @@ pad_to_streampos(streampos fpos) {
 void Multifile::
 add_new_subfile(Subfile *subfile, int compression_level) {
   if (compression_level != 0) {
-#ifndef HAVE_ZLIB
-    express_cat.warning()
-      << "zlib not compiled in; cannot generated compressed multifiles.\n";
-    compression_level = 0;
-#else  // HAVE_ZLIB
-    subfile->_flags |= SF_compressed;
-    subfile->_compression_level = compression_level;
-#endif  // HAVE_ZLIB
+    CompressionCodec *codec = _compression_codec;
+    if (codec == (CompressionCodec *)NULL) {
+      codec = CompressionCodec::get_default_codec();
+    }
+
+    if (codec == (CompressionCodec *)NULL) {
+      express_cat.warning()
+        << "No compression codec available; cannot generate compressed multifiles.\n";
+      compression_level = 0;
+
+    } else if (codec->get_id() == CompressionCodec::CI_zlib) {
+      // Subfiles compressed with zlib are written as a plain zlib
+      // stream, as they always have been, so that older versions can
+      // still read them.
+      subfile->_flags |= SF_compressed;
+      subfile->_compression_level = compression_level;
+
+    } else {
+      subfile->_flags |= (SF_compressed | SF_codec);
+      subfile->_compression_level = compression_level;
+      subfile->_codec = codec->get_id();
+    }
   }
 
 #ifdef HAVE_OPENSSL
@@ -2287,13 +2415,25 @@ open_read_subfile(Subfile *subfile) {
   nassertr(subfile->_source == (istream *)NULL &&
            subfile->_source_filename.empty(), NULL);
 
-  // Return an ISubStream object that references into the open
-  // Multifile istream.
   nassertr(subfile->_data_start != (streampos)0, NULL);
-  istream *stream = 
-    new ISubStream(_read, _offset + subfile->_data_start,
-                   _offset + subfile->_data_start + (streampos)subfile->_data_length); 
-  
+  istream *stream;
+  const char *data = get_mapped_data(subfile);
+  if (data != (const char *)NULL) {
+    // The Multifile is mapped into memory, so read the subfile
+    // directly from the mapping.  Each stream returned this way has
+    // its own read pointer (and, below, its own decryption and
+    // decompression state), so it doesn't contend with any other
+    // reader.
+    stream = new IMemoryStream(data, subfile->_data_length);
+
+  } else {
+    // Return an ISubStream object that references into the open
+    // Multifile istream.
+    stream =
+      new ISubStream(_read, _offset + subfile->_data_start,
+                     _offset + subfile->_data_start + (streampos)subfile->_data_length);
+  }
+
   if ((subfile->_flags & SF_encrypted) != 0) {
 #ifndef HAVE_OPENSSL
     express_cat.error()
@@ -2321,7 +2461,13 @@ open_read_subfile(Subfile *subfile) {
 #endif  // HAVE_OPENSSL
   }
 
-  if ((subfile->_flags & SF_compressed) != 0) {
+  if ((subfile->_flags & SF_codec) != 0) {
+    // The subfile was compressed with some other codec, which is
+    // named in the header of the compressed stream itself.
+    ICodecStream *wrapper = new ICodecStream(stream, true);
+    stream = wrapper;
+
+  } else if ((subfile->_flags & SF_compressed) != 0) {
 #ifndef HAVE_ZLIB
     express_cat.error()
       << "zlib not compiled in; cannot read compressed multifiles.\n";
@@ -2483,11 +2629,11 @@ read_index() {
 
   if (_file_major_ver != _current_major_ver ||
       (_file_major_ver == _current_major_ver && 
-       _file_minor_ver > _current_minor_ver)) {
+       _file_minor_ver > _codec_minor_ver)) {
     express_cat.info()
       << _multifile_name << " has version " << _file_major_ver << "."
       << _file_minor_ver << ", expecting version " 
-      << _current_major_ver << "." << _current_minor_ver << ".\n";
+      << _current_major_ver << "." << _codec_minor_ver << ".\n";
     _read->release();
     close();
     return false;
@@ -2587,6 +2733,142 @@ read_index() {
   return true;
 }  
 
+////////////////////////////////////////////////////////////////////
+//     Function: Multifile::open_mapping
+//       Access: Private
+//  Description: Attempts to map the physical file that contains the
+//               Multifile, just opened from the indicated VirtualFile,
+//               into memory.  This is only possible if the Multifile
+//               resides on disk (possibly as an uncompressed subfile
+//               of another Multifile).  Returns true on success.
+//
+//               The mapping is only an optimization; if it fails, the
+//               Multifile is still read through its stream.
+////////////////////////////////////////////////////////////////////
+bool Multifile::
+open_mapping(VirtualFile *vfile) {
+  nassertr(_mmap_data == (const char *)NULL, false);
+
+  SubfileInfo info;
+  if (!vfile->get_system_info(info)) {
+    return false;
+  }
+  if (info.get_size() <= 0 ||
+      (streamsize)(size_t)info.get_size() != info.get_size()) {
+    // Empty, or too big to map into our address space.
+    return false;
+  }
+
+  Filename os_filename = info.get_filename();
+  os_filename.set_binary();
+  string os_specific = os_filename.to_os_specific();
+  size_t start = (size_t)(streamoff)info.get_start();
+  size_t size = (size_t)info.get_size();
+
+#ifdef _WIN32
+  SYSTEM_INFO sysinfo;
+  GetSystemInfo(&sysinfo);
+  size_t granularity = sysinfo.dwAllocationGranularity;
+#else
+  size_t granularity = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+  size_t base_start = start - (start % granularity);
+  size_t base_size = size + (start - base_start);
+
+#ifdef _WIN32
+  HANDLE file = CreateFile(os_specific.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                           NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (mapping == NULL) {
+    return false;
+  }
+  void *base = MapViewOfFile(mapping, FILE_MAP_READ,
+                             (DWORD)((PN_uint64)base_start >> 32),
+                             (DWORD)(base_start & 0xffffffff), base_size);
+  if (base == NULL) {
+    CloseHandle(mapping);
+    return false;
+  }
+  _mmap_handle = mapping;
+
+#else
+  int fd = ::open(os_specific.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  void *base = mmap(NULL, base_size, PROT_READ, MAP_SHARED, fd, (off_t)base_start);
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+#endif
+
+  _mmap_base = base;
+  _mmap_base_size = base_size;
+  _mmap_data = (const char *)base + (start - base_start);
+  _mmap_size = size;
+
+  if (express_cat.is_debug()) {
+    express_cat.debug()
+      << "Mapped " << size << " bytes of " << os_filename
+      << " for " << _multifile_name << "\n";
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Multifile::close_mapping
+//       Access: Private
+//  Description: Releases the memory mapping created by
+//               open_mapping(), if any.
+////////////////////////////////////////////////////////////////////
+void Multifile::
+close_mapping() {
+  if (_mmap_base == NULL) {
+    return;
+  }
+
+#ifdef _WIN32
+  UnmapViewOfFile(_mmap_base);
+  CloseHandle((HANDLE)_mmap_handle);
+  _mmap_handle = NULL;
+#else
+  munmap(_mmap_base, _mmap_base_size);
+#endif
+
+  _mmap_data = (const char *)NULL;
+  _mmap_size = 0;
+  _mmap_base = NULL;
+  _mmap_base_size = 0;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Multifile::get_mapped_data
+//       Access: Private
+//  Description: Returns the address of the indicated subfile's data,
+//               as stored in the Multifile, within the memory
+//               mapping, or NULL if the Multifile is not mapped.
+////////////////////////////////////////////////////////////////////
+const char *Multifile::
+get_mapped_data(const Subfile *subfile) const {
+  if (_mmap_data == (const char *)NULL ||
+      subfile->_source != (istream *)NULL ||
+      !subfile->_source_filename.empty()) {
+    return NULL;
+  }
+
+  size_t start = (size_t)(streamoff)(_offset + subfile->_data_start);
+  if (start > _mmap_size || subfile->_data_length > _mmap_size - start) {
+    // The subfile extends past the end of the file that was mapped.
+    return NULL;
+  }
+  return _mmap_data + start;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Multifile::write_header
 //       Access: Private
@@ -2597,14 +2879,17 @@ bool Multifile::
 write_header() {
   _file_major_ver = _current_major_ver;
   _file_minor_ver = _current_minor_ver;
+  if (has_new_codec_subfiles()) {
+    _file_minor_ver = _codec_minor_ver;
+  }
 
   nassertr(_write != (ostream *)NULL, false);
   nassertr(_write->tellp() == (streampos)0, false);
   _write->write(_header_prefix.data(), _header_prefix.size());
   _write->write(_header, _header_size);
   StreamWriter writer(_write, false);
-  writer.add_int16(_current_major_ver);
-  writer.add_int16(_current_minor_ver);
+  writer.add_int16(_file_major_ver);
+  writer.add_int16(_file_minor_ver);
   writer.add_uint32(_scale_factor);
 
   if (_record_timestamp) {
@@ -2628,6 +2913,25 @@ write_header() {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Multifile::has_new_codec_subfiles
+//       Access: Private
+//  Description: Returns true if any of the subfiles waiting to be
+//               written is compressed with a codec other than zlib,
+//               and therefore requires the Multifile to be written
+//               with _codec_minor_ver.
+////////////////////////////////////////////////////////////////////
+bool Multifile::
+has_new_codec_subfiles() const {
+  PendingSubfiles::const_iterator pi;
+  for (pi = _new_subfiles.begin(); pi != _new_subfiles.end(); ++pi) {
+    if (((*pi)->_flags & SF_codec) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Multifile::check_signatures
 //       Access: Private
@@ -2784,6 +3088,9 @@ read_index(istream &read, streampos fpos, Multifile *multifile) {
   } else {
     _uncompressed_length = _data_length;
   }
+  if ((_flags & SF_codec) != 0) {
+    _codec = reader.get_uint8();
+  }
   if (multifile->_file_minor_ver < 1) {
     _timestamp = multifile->get_timestamp();
   } else {
@@ -2845,6 +3152,9 @@ write_index(ostream &write, streampos fpos, Multifile *multifile) {
   if ((_flags & (SF_compressed | SF_encrypted)) != 0) {
     dg.add_uint32(_uncompressed_length);
   }
+  if ((_flags & SF_codec) != 0) {
+    dg.add_uint8(_codec);
+  }
   dg.add_uint32(_timestamp);
   dg.add_uint16(_name.length());
 
@@ -2965,17 +3275,26 @@ write_data(ostream &write, istream *read, streampos fpos,
     }
 #endif  // HAVE_OPENSSL
 
+    if ((_flags & SF_codec) != 0) {
+      // Write it compressed with the subfile's codec.
+      CompressionCodec *codec = CompressionCodec::get_codec(_codec);
+      nassertr(codec != (CompressionCodec *)NULL, fpos);
+      putter = new OCodecStream(putter, delete_putter, codec, _compression_level);
+      delete_putter = true;
+
+    } else {
 #ifndef HAVE_ZLIB
-    // Without ZLIB, we can't support compression.  The flag had
-    // better not be set.
-    nassertr((_flags & SF_compressed) == 0, fpos);
+      // Without ZLIB, we can't support zlib compression.  The flag
+      // had better not be set.
+      nassertr((_flags & SF_compressed) == 0, fpos);
 #else  // HAVE_ZLIB
-    if ((_flags & SF_compressed) != 0) {
-      // Write it compressed.
-      putter = new OCompressStream(putter, delete_putter, _compression_level);
-      delete_putter = true;
-    }
+      if ((_flags & SF_compressed) != 0) {
+        // Write it compressed.
+        putter = new OCompressStream(putter, delete_putter, _compression_level);
+        delete_putter = true;
+      }
 #endif  // HAVE_ZLIB
+    }
 
     streampos write_start = fpos;
     _uncompressed_length = 0;
@@ -3113,6 +3432,9 @@ rewrite_index_data_start(ostream &write, Multifile *multifile) {
   if ((_flags & (SF_compressed | SF_encrypted)) != 0) {
     writer.add_uint32(_uncompressed_length);
   }
+  if ((_flags & SF_codec) != 0) {
+    writer.add_uint8(_codec);
+  }
   if (multifile->_record_timestamp) {
     writer.add_uint32(_timestamp);
   } else {
@@ -26,6 +26,10 @@
 #include "referenceCount.h"
 #include "pvector.h"
 #include "openSSLWrapper.h"
+#include "compressionCodec.h"
+#include "pointerTo.h"
+
+class VirtualFile;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : Multifile
@@ -54,6 +58,7 @@ PUBLISHED:
 
   INLINE bool is_read_valid() const;
   INLINE bool is_write_valid() const;
+  INLINE bool is_mapped() const;
   INLINE bool needs_repack() const;
 
   INLINE time_t get_timestamp() const;
@@ -64,6 +69,9 @@ PUBLISHED:
   void set_scale_factor(size_t scale_factor);
   INLINE size_t get_scale_factor() const;
 
+  INLINE void set_compression_codec(CompressionCodec *codec);
+  INLINE CompressionCodec *get_compression_codec() const;
+
   INLINE void set_encryption_flag(bool flag);
   INLINE bool get_encryption_flag() const;
   INLINE void set_encryption_password(const string &encryption_password);
@@ -129,6 +137,7 @@ PUBLISHED:
   size_t get_subfile_length(int index) const;
   time_t get_subfile_timestamp(int index) const;
   bool is_subfile_compressed(int index) const;
+  string get_subfile_compression_codec(int index) const;
   bool is_subfile_encrypted(int index) const;
   bool is_subfile_text(int index) const;
 
@@ -154,6 +163,7 @@ PUBLISHED:
 public:
   bool read_subfile(int index, string &result);
   bool read_subfile(int index, pvector<unsigned char> &result);
+  const char *get_subfile_mapped_data(int index) const;
 
 private:
   enum SubfileFlags {
@@ -164,6 +174,7 @@ private:
     SF_encrypted      = 0x0010,
     SF_signature      = 0x0020,
     SF_text           = 0x0040,
+    SF_codec          = 0x0080,
   };
 
   class Subfile {
@@ -195,6 +206,7 @@ private:
     Filename _source_filename;
     int _flags;
     int _compression_level;  // Not preserved on disk.
+    int _codec;
 #ifdef HAVE_OPENSSL
     EVP_PKEY *_pkey;         // Not preserved on disk.
 #endif
@@ -211,7 +223,11 @@ private:
 
   void clear_subfiles();
   bool read_index();
+  bool open_mapping(VirtualFile *vfile);
+  void close_mapping();
+  const char *get_mapped_data(const Subfile *subfile) const;
   bool write_header();
+  bool has_new_codec_subfiles() const;
 
   void check_signatures();
 
@@ -244,6 +260,8 @@ private:
   size_t _scale_factor;
   size_t _new_scale_factor;
 
+  PT(CompressionCodec) _compression_codec;
+
   bool _encryption_flag;
   string _encryption_password;
   string _encryption_algorithm;
@@ -258,6 +276,19 @@ private:
   Filename _multifile_name;
   string _header_prefix;
 
+  // If multifile-mmap is in effect, this is the entire Multifile
+  // mapped into memory, read-only.  _mmap_data is the address
+  // corresponding to position 0 of _read; _mmap_base and
+  // _mmap_base_size describe the actual mapping, which begins on a
+  // page boundary.
+  const char *_mmap_data;
+  size_t _mmap_size;
+  void *_mmap_base;
+  size_t _mmap_base_size;
+#ifdef _WIN32
+  void *_mmap_handle;
+#endif
+
   int _file_major_ver;
   int _file_minor_ver;
 
@@ -265,6 +296,7 @@ private:
   static const size_t _header_size;
   static const int _current_major_ver;
   static const int _current_minor_ver;
+  static const int _codec_minor_ver;
 
   static const char _encrypt_header[];
   static const size_t _encrypt_header_size;
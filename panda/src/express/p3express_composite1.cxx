@@ -1,5 +1,7 @@
 #include "buffer.cxx"
 #include "checksumHashGenerator.cxx"
+#include "codecStreamBuf.cxx"
+#include "compressionCodec.cxx"
 #include "config_express.cxx"
 #include "compress_string.cxx"
 #include "copy_stream.cxx"
@@ -13,7 +15,9 @@
 #include "fileReference.cxx"
 #include "hashGeneratorBase.cxx"
 #include "hashVal.cxx"
+#include "lz4Codec.cxx"
 #include "memoryInfo.cxx"
+#include "memoryStreamBuf.cxx"
 #include "memoryUsage.cxx"
 #include "memoryUsagePointerCounts.cxx"
 #include "memoryUsagePointers.cxx"
@@ -31,5 +31,6 @@
 #include "weakPointerToVoid.cxx"
 #include "weakReferenceList.cxx"
 #include "windowsRegistry.cxx"
+#include "zlibCodec.cxx"
 #include "zStream.cxx"
 #include "zStreamBuf.cxx"
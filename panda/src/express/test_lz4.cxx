@@ -0,0 +1,222 @@
+// Filename: test_lz4.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "compressionCodec.h"
+#include "codecStream.h"
+
+#include <stdlib.h>
+
+// This program checks that data compressed by the LZ4 codec
+// decompresses to exactly what it was, for a range of inputs chosen
+// to reach each of the compressor's paths, and that truncated or
+// corrupted data is rejected rather than overrunning the buffers.
+
+static int num_failures = 0;
+
+static void
+fail(const string &test, const string &message) {
+  nout << test << ": " << message << "\n";
+  ++num_failures;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_round_trip
+//  Description: Compresses and decompresses the indicated data, at
+//               a low and a high compression level, and checks that
+//               it comes back unchanged.  Also checks that each
+//               truncation of the compressed data is rejected.
+////////////////////////////////////////////////////////////////////
+static void
+check_round_trip(CompressionCodec *codec, const string &test,
+                 const string &data) {
+  static const int levels[] = { 1, 9 };
+  for (int li = 0; li < 2; ++li) {
+    string packed;
+    if (!codec->compress(data.data(), data.size(), packed, levels[li])) {
+      fail(test, "compress failed");
+      continue;
+    }
+
+    // Leave room on either side to catch any overrun.
+    string unpacked(data.size() + 32, '\xa5');
+    if (!codec->decompress(packed.data(), packed.size(),
+                           &unpacked[16], data.size())) {
+      fail(test, "decompress failed");
+      continue;
+    }
+    if (unpacked.substr(16, data.size()) != data) {
+      fail(test, "data does not match");
+    }
+    if (unpacked.substr(0, 16) != string(16, '\xa5') ||
+        unpacked.substr(16 + data.size()) != string(16, '\xa5')) {
+      fail(test, "decompress wrote outside its buffer");
+    }
+
+    // The wrong output size must also be rejected.
+    string wrong(data.size() + 1, '\0');
+    if (codec->decompress(packed.data(), packed.size(),
+                          &wrong[0], data.size() + 1)) {
+      fail(test, "accepted too large an output size");
+    }
+
+    // Every truncation must fail (except of empty data, which is
+    // legitimately empty when truncated).  We only try them all on
+    // short inputs, to keep the running time reasonable.
+    size_t step = (packed.size() < 4096) ? 1 : packed.size() / 1024;
+    for (size_t len = 0; !data.empty() && len < packed.size(); len += step) {
+      string out(data.size() + 1, '\0');
+      if (codec->decompress(packed.data(), len, &out[0], data.size())) {
+        fail(test, "accepted truncated data");
+        break;
+      }
+    }
+
+    nout << test << " (level " << levels[li] << "): " << data.size()
+         << " -> " << packed.size() << " bytes\n";
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_corruption
+//  Description: Decompresses many randomly damaged copies of the
+//               compressed data.  The result may or may not be
+//               accepted, but must never overrun the output buffer.
+////////////////////////////////////////////////////////////////////
+static void
+check_corruption(CompressionCodec *codec, const string &test,
+                 const string &data) {
+  string packed;
+  codec->compress(data.data(), data.size(), packed, 6);
+  if (packed.empty()) {
+    return;
+  }
+
+  srand(1);
+  for (int i = 0; i < 2000; ++i) {
+    string damaged = packed;
+    int num_changes = 1 + rand() % 4;
+    for (int c = 0; c < num_changes; ++c) {
+      damaged[rand() % damaged.size()] = (char)(rand() & 0xff);
+    }
+
+    string out(data.size() + 32, '\xa5');
+    codec->decompress(damaged.data(), damaged.size(), &out[16], data.size());
+    if (out.substr(0, 16) != string(16, '\xa5') ||
+        out.substr(16 + data.size()) != string(16, '\xa5')) {
+      fail(test, "corrupt data overran the output buffer");
+      return;
+    }
+  }
+
+  // A match offset pointing before the start of the output.
+  static const char bad_offset[] = "\x14" "a" "\x05\x00" "\x50" "bcdef";
+  char out[64];
+  if (codec->decompress(bad_offset, sizeof(bad_offset) - 1, out, 10)) {
+    fail(test, "accepted an offset before the start of the output");
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_stream
+//  Description: Writes the data through an OCodecStream and reads it
+//               back through an ICodecStream.  Also checks that
+//               asking whether the decompressing stream is itself a
+//               codec stream leaves it usable.
+////////////////////////////////////////////////////////////////////
+static void
+check_stream(CompressionCodec *codec, const string &test,
+             const string &data) {
+  ostringstream sout;
+  {
+    OCodecStream out(&sout, false, codec);
+    out.write(data.data(), data.size());
+  }
+
+  istringstream sin(sout.str());
+  if (!ICodecStream::is_codec_stream(sin) || sin.tellg() != (streampos)0) {
+    fail(test, "codec stream not recognized");
+    return;
+  }
+
+  ICodecStream in(&sin, false);
+  if (ICodecStream::is_codec_stream(in)) {
+    fail(test, "decompressed data recognized as a codec stream");
+  }
+  if (in.fail()) {
+    fail(test, "checking for a codec stream damaged the stream");
+    return;
+  }
+
+  string result;
+  char buffer[4096];
+  in.read(buffer, sizeof(buffer));
+  while (in.gcount() > 0) {
+    result.append(buffer, in.gcount());
+    in.read(buffer, sizeof(buffer));
+  }
+  if (result != data) {
+    fail(test, "stream data does not match");
+  }
+}
+
+int
+main(int argc, char *argv[]) {
+  CompressionCodec *codec = CompressionCodec::get_codec(CompressionCodec::CI_lz4);
+  if (codec == (CompressionCodec *)NULL) {
+    nout << "lz4 codec not available.\n";
+    return 1;
+  }
+
+  srand(0);
+  string random_data;
+  for (int i = 0; i < 100000; ++i) {
+    random_data += (char)(rand() & 0xff);
+  }
+
+  string text;
+  while (text.size() < 200000) {
+    text += "The quick brown fox jumps over the lazy dog.  ";
+    text += (char)('a' + text.size() % 26);
+  }
+
+  string pattern;
+  for (int i = 0; i < 1000; ++i) {
+    pattern += "abc";
+  }
+
+  check_round_trip(codec, "empty", string());
+  check_round_trip(codec, "one byte", "x");
+  check_round_trip(codec, "short", "0123456789ab");
+  check_round_trip(codec, "incompressible", random_data);
+  check_round_trip(codec, "long match", string(1000000, 'z'));
+  check_round_trip(codec, "overlapping match", pattern);
+  check_round_trip(codec, "text", text);
+  check_round_trip(codec, "long literals",
+                   random_data.substr(0, 5000) + string(5000, '\0') +
+                   random_data.substr(5000, 300));
+
+  check_corruption(codec, "corrupt text", text.substr(0, 5000));
+  check_corruption(codec, "corrupt pattern", pattern);
+
+  check_stream(codec, "stream text", text);
+  check_stream(codec, "stream empty", string());
+
+  if (num_failures != 0) {
+    nout << num_failures << " failures.\n";
+    return 1;
+  }
+  nout << "All tests passed.\n";
+  return 0;
+}
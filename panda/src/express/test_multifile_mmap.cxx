@@ -0,0 +1,208 @@
+// Filename: test_multifile_mmap.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+
+#include "pandabase.h"
+#include "multifile.h"
+#include "config_express.h"
+#include "virtualFileSystem.h"
+#include "filename.h"
+
+// This program writes a small Multifile and reads it back with and
+// without multifile-mmap, checking that read_subfile(),
+// open_read_subfile() and get_subfile_mapped_data() all return what
+// was written.  It then truncates the file, so that the last subfile
+// lies partly outside the mapping, and checks that the other
+// subfiles are still read from the mapping and that the last one
+// falls back to the stream, which reports the short read, instead of
+// being read out of bounds.
+
+static int num_failures = 0;
+
+static void
+fail(const string &test, const string &message) {
+  nout << test << ": " << message << "\n";
+  ++num_failures;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: make_data
+//  Description: Returns some distinctive data of the indicated
+//               length.
+////////////////////////////////////////////////////////////////////
+static string
+make_data(size_t length, int seed) {
+  string data(length, '\0');
+  unsigned int x = seed;
+  for (size_t i = 0; i < length; ++i) {
+    x = x * 1103515245 + 12345;
+    data[i] = (char)(x >> 16);
+  }
+  return data;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_subfile
+//  Description: Reads the named subfile each of the available ways
+//               and checks it against the expected contents.
+////////////////////////////////////////////////////////////////////
+static void
+check_subfile(Multifile *mf, const string &test, const string &name,
+              const string &expected) {
+  string label = test + " " + name;
+  int index = mf->find_subfile(name);
+  if (index < 0) {
+    fail(label, "not found");
+    return;
+  }
+
+  string data;
+  if (!mf->read_subfile(index, data)) {
+    fail(label, "read_subfile failed");
+  } else if (data != expected) {
+    fail(label, "read_subfile returned the wrong data");
+  }
+
+  istream *in = mf->open_read_subfile(index);
+  if (in == (istream *)NULL) {
+    fail(label, "open_read_subfile failed");
+  } else {
+    string streamed;
+    char buffer[1000];
+    in->read(buffer, sizeof(buffer));
+    while (in->gcount() > 0) {
+      streamed.append(buffer, (size_t)in->gcount());
+      in->read(buffer, sizeof(buffer));
+    }
+    if (streamed != expected) {
+      fail(label, "open_read_subfile returned the wrong data");
+    }
+    Multifile::close_read_subfile(in);
+  }
+
+  const char *mapped = mf->get_subfile_mapped_data(index);
+  if (!mf->is_mapped() || mf->is_subfile_compressed(index)) {
+    if (mapped != (const char *)NULL) {
+      fail(label, "get_subfile_mapped_data should have returned NULL");
+    }
+  } else if (mapped == (const char *)NULL) {
+    fail(label, "get_subfile_mapped_data returned NULL");
+  } else if (string(mapped, mf->get_subfile_length(index)) != expected) {
+    fail(label, "get_subfile_mapped_data returned the wrong data");
+  }
+}
+
+int
+main(int argc, char *argv[]) {
+  Filename filename = Filename::temporary("", "mfmmap", ".mf");
+  filename.set_binary();
+
+  static const int num_subfiles = 3;
+  static const char *const names[num_subfiles] = {
+    "small", "compressed", "large"
+  };
+  static const int compression[num_subfiles] = { 0, 6, 0 };
+  string contents[num_subfiles] = {
+    make_data(10, 1),
+    string(20000, 'x') + make_data(100, 2),
+    make_data(100000, 3),
+  };
+
+  {
+    PT(Multifile) mf = new Multifile;
+    if (!mf->open_write(filename)) {
+      nout << "Unable to write " << filename << "\n";
+      return 1;
+    }
+    istringstream *streams[num_subfiles];
+    for (int i = 0; i < num_subfiles; ++i) {
+      streams[i] = new istringstream(contents[i]);
+      mf->add_subfile(names[i], streams[i], compression[i]);
+    }
+    bool ok = mf->flush();
+    mf->close();
+    for (int i = 0; i < num_subfiles; ++i) {
+      delete streams[i];
+    }
+    if (!ok) {
+      nout << "Unable to write " << filename << "\n";
+      filename.unlink();
+      return 1;
+    }
+  }
+
+  // Read it back, first from the stream and then from the mapping.
+  for (int mapped = 0; mapped < 2; ++mapped) {
+    string test = mapped ? "mapped" : "unmapped";
+    multifile_mmap.set_value(mapped != 0);
+    PT(Multifile) mf = new Multifile;
+    if (!mf->open_read(filename)) {
+      fail(test, "open_read failed");
+      continue;
+    }
+    if (mf->is_mapped() != (mapped != 0)) {
+      fail(test, "is_mapped() is wrong");
+    }
+    for (int i = 0; i < num_subfiles; ++i) {
+      check_subfile(mf, test, names[i], contents[i]);
+    }
+  }
+
+  // Now cut a few bytes off the end of the file, which is the end of
+  // the data of the last subfile written.
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  string file_data = vfs->read_file(filename, false);
+  if (file_data.size() < 16 ||
+      !vfs->write_file(filename, file_data.substr(0, file_data.size() - 16), false)) {
+    fail("truncated", "unable to truncate the file");
+
+  } else {
+    multifile_mmap.set_value(true);
+    PT(Multifile) mf = new Multifile;
+    if (!mf->open_read(filename)) {
+      fail("truncated", "open_read failed");
+
+    } else if (!mf->is_mapped()) {
+      fail("truncated", "not mapped");
+
+    } else {
+      int last = mf->find_subfile(names[num_subfiles - 1]);
+      for (int i = 0; i < num_subfiles - 1; ++i) {
+        check_subfile(mf, "truncated", names[i], contents[i]);
+      }
+
+      if (last < 0) {
+        fail("truncated", "last subfile not found");
+      } else {
+        if (mf->get_subfile_mapped_data(last) != (const char *)NULL) {
+          fail("truncated", "the last subfile should lie outside the mapping");
+        }
+        nout << "Expect an I/O error here:\n";
+        string data;
+        if (mf->read_subfile(last, data)) {
+          fail("truncated", "read_subfile should have failed");
+        }
+      }
+    }
+  }
+
+  filename.unlink();
+
+  if (num_failures != 0) {
+    nout << num_failures << " failures.\n";
+    return 1;
+  }
+  nout << "ok\n";
+  return 0;
+}
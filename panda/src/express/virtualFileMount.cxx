@@ -15,6 +15,7 @@
 #include "virtualFileMount.h"
 #include "virtualFileSimple.h"
 #include "zStream.h"
+#include "codecStream.h"
 
 TypeHandle VirtualFileMount::_type_handle;
 
@@ -214,19 +215,23 @@ write_file(const Filename &file, bool do_compress,
 //               Returns NULL on failure.
 //
 //               If do_uncompress is true, the file is also
-//               decompressed on-the-fly using zlib.
+//               decompressed on-the-fly, using zlib or whichever
+//               CompressionCodec it was written with.
 ////////////////////////////////////////////////////////////////////
 istream *VirtualFileMount::
 open_read_file(const Filename &file, bool do_uncompress) const {
   istream *result = open_read_file(file);
 
-#ifdef HAVE_ZLIB
   if (result != (istream *)NULL && do_uncompress) {
     // We have to slip in a layer to decompress the file on the fly.
-    IDecompressStream *wrapper = new IDecompressStream(result, true);
-    result = wrapper;
-  }
+    if (ICodecStream::is_codec_stream(*result)) {
+      result = new ICodecStream(result, true);
+    } else {
+#ifdef HAVE_ZLIB
+      result = new IDecompressStream(result, true);
 #endif  // HAVE_ZLIB
+    }
+  }
 
   return result;
 }
@@ -267,19 +272,28 @@ open_write_file(const Filename &file, bool truncate) {
 //               Returns NULL on failure.
 //
 //               If do_compress is true, the file is also
-//               compressed on-the-fly using zlib.
+//               compressed on-the-fly, using the codec named by
+//               compression-codec.  Files compressed with zlib are
+//               written in the traditional .pz format.
 ////////////////////////////////////////////////////////////////////
 ostream *VirtualFileMount::
 open_write_file(const Filename &file, bool do_compress, bool truncate) {
   ostream *result = open_write_file(file, truncate);
 
-#ifdef HAVE_ZLIB
   if (result != (ostream *)NULL && do_compress) {
     // We have to slip in a layer to compress the file on the fly.
-    OCompressStream *wrapper = new OCompressStream(result, true);
-    result = wrapper;
-  }
+    CompressionCodec *codec = CompressionCodec::get_default_codec();
+#ifdef HAVE_ZLIB
+    if (codec == (CompressionCodec *)NULL ||
+        codec->get_id() == CompressionCodec::CI_zlib) {
+      result = new OCompressStream(result, true);
+    } else {
+      result = new OCodecStream(result, true, codec);
+    }
+#else
+    result = new OCodecStream(result, true, codec);
 #endif  // HAVE_ZLIB
+  }
 
   return result;
 }
@@ -81,7 +81,8 @@ read_file(const Filename &file, bool do_uncompress,
   }
 
   // But if we're just reading a straight file, let the Multifile do
-  // the reading, which avoids a few levels of buffer copies.
+  // the reading, which avoids a few levels of buffer copies (and, if
+  // the Multifile is mapped into memory, the stream lock as well).
 
   int subfile_index = _multifile->find_subfile(file);
   if (subfile_index < 0) {
@@ -115,6 +116,35 @@ open_read_file(const Filename &file) const {
   return _multifile->open_read_subfile(subfile_index);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileMountMultifile::get_mapped_data
+//       Access: Public
+//  Description: If the Multifile is mapped into memory and the
+//               indicated file is stored uncompressed and
+//               unencrypted, returns a pointer to its contents
+//               within the mapping, and fills in size with its
+//               length.  The pointer remains valid for as long as
+//               the Multifile remains open.
+//
+//               Returns NULL if the file cannot be accessed in this
+//               way, in which case it should be read via read_file()
+//               or open_read_file() instead.
+////////////////////////////////////////////////////////////////////
+const char *VirtualFileMountMultifile::
+get_mapped_data(const Filename &file, size_t &size) const {
+  size = 0;
+  int subfile_index = _multifile->find_subfile(file);
+  if (subfile_index < 0) {
+    return NULL;
+  }
+
+  const char *data = _multifile->get_subfile_mapped_data(subfile_index);
+  if (data != (const char *)NULL) {
+    size = _multifile->get_subfile_length(subfile_index);
+  }
+  return data;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: VirtualFileMountMultifile::get_file_size
 //       Access: Published, Virtual
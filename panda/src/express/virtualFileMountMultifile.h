@@ -42,6 +42,7 @@ public:
                          pvector<unsigned char> &result) const;
 
   virtual istream *open_read_file(const Filename &file) const;
+  const char *get_mapped_data(const Filename &file, size_t &size) const;
   virtual streamsize get_file_size(const Filename &file, istream *stream) const;
   virtual streamsize get_file_size(const Filename &file) const;
   virtual time_t get_timestamp(const Filename &file) const;
@@ -0,0 +1,71 @@
+// Filename: zlibCodec.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "zlibCodec.h"
+
+#ifdef HAVE_ZLIB
+
+#include <zlib.h>
+
+////////////////////////////////////////////////////////////////////
+//     Function: ZlibCodec::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+ZlibCodec::
+ZlibCodec() : CompressionCodec(CI_zlib, "zlib") {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ZlibCodec::compress
+//       Access: Public, Virtual
+//  Description: Compresses the indicated block of data, appending
+//               the result to dest.  Returns true on success.
+////////////////////////////////////////////////////////////////////
+bool ZlibCodec::
+compress(const char *source, size_t source_size,
+         string &dest, int compression_level) const {
+  uLongf dest_len = compressBound((uLong)source_size);
+  size_t orig_size = dest.size();
+  dest.resize(orig_size + dest_len);
+
+  int result = compress2((Bytef *)&dest[orig_size], &dest_len,
+                         (const Bytef *)source, (uLong)source_size,
+                         compression_level);
+  if (result != Z_OK) {
+    dest.resize(orig_size);
+    return false;
+  }
+
+  dest.resize(orig_size + dest_len);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ZlibCodec::decompress
+//       Access: Public, Virtual
+//  Description: Decompresses the indicated block of data into dest,
+//               which must be exactly large enough to hold it.
+//               Returns true on success.
+////////////////////////////////////////////////////////////////////
+bool ZlibCodec::
+decompress(const char *source, size_t source_size,
+           char *dest, size_t dest_size) const {
+  uLongf dest_len = (uLongf)dest_size;
+  int result = uncompress((Bytef *)dest, &dest_len,
+                          (const Bytef *)source, (uLong)source_size);
+  return (result == Z_OK && dest_len == (uLongf)dest_size);
+}
+
+#endif  // HAVE_ZLIB
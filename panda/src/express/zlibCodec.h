@@ -0,0 +1,43 @@
+// Filename: zlibCodec.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef ZLIBCODEC_H
+#define ZLIBCODEC_H
+
+#include "pandabase.h"
+
+// This module is not compiled if zlib is not available.
+#ifdef HAVE_ZLIB
+
+#include "compressionCodec.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : ZlibCodec
+// Description : A CompressionCodec that compresses each block with
+//               zlib.  This gives good compression, but decompresses
+//               relatively slowly.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS ZlibCodec : public CompressionCodec {
+public:
+  ZlibCodec();
+
+  virtual bool compress(const char *source, size_t source_size,
+                        string &dest, int compression_level) const;
+  virtual bool decompress(const char *source, size_t source_size,
+                          char *dest, size_t dest_size) const;
+};
+
+#endif  // HAVE_ZLIB
+
+#endif
@@ -78,6 +78,8 @@ PStatCollector CLP(GraphicsStateGuardian)::_primitive_batches_display_list_pcoll
 PStatCollector CLP(GraphicsStateGuardian)::_vertices_display_list_pcollector("Vertices:Display lists");
 PStatCollector CLP(GraphicsStateGuardian)::_vertices_immediate_pcollector("Vertices:Immediate mode");
 PStatCollector CLP(GraphicsStateGuardian)::_compute_dispatch_pcollector("Draw:Compute dispatch");
+PStatCollector CLP(GraphicsStateGuardian)::_async_upload_in_flight_pcollector("Texture upload:In flight");
+PStatCollector CLP(GraphicsStateGuardian)::_async_upload_staged_pcollector("Texture upload:Staged");
 
 #ifdef OPENGLES_2
 PT(Shader) CLP(GraphicsStateGuardian)::_default_shader = NULL;
@@ -310,6 +312,10 @@ CLP(GraphicsStateGuardian)(GraphicsEngine *engine, GraphicsPipe *pipe) :
   _check_errors = gl_check_errors;
   _force_flush = gl_force_flush;
 
+#ifndef OPENGLES
+  _async_upload_bytes_in_flight = 0;
+#endif
+
 #ifdef DO_PSTATS
   if (gl_finish) {
     GLCAT.warning()
@@ -1863,13 +1869,54 @@ reset() {
   if (is_at_least_gl_version(4, 1) || has_extension("GL_ARB_get_program_binary")) {
     _glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)
       get_extension_func("glGetProgramBinary");
+    _glProgramBinary = (PFNGLPROGRAMBINARYPROC)
+      get_extension_func("glProgramBinary");
 
-    if (_glGetProgramBinary != NULL) {
+    // glProgramParameteri is also part of this extension, but we
+    // only fetched it above if we have geometry shaders.
+    if (!_supports_geometry_shaders) {
+      _glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)
+        get_extension_func("glProgramParameteri");
+    }
+
+    if (_glGetProgramBinary != NULL && _glProgramBinary != NULL &&
+        _glProgramParameteri != NULL) {
       _supports_get_program_binary = true;
     }
   }
 #endif
 
+  // Pixel buffer objects are used to upload textures asynchronously,
+  // and sync objects to find out when such an upload has finished.
+  _supports_pixel_buffer = false;
+#ifndef OPENGLES
+  if (_supports_buffers &&
+      (is_at_least_gl_version(2, 1) || has_extension("GL_ARB_pixel_buffer_object"))) {
+    _supports_pixel_buffer = true;
+  }
+
+  _glFenceSync = NULL;
+  _glClientWaitSync = NULL;
+  _glDeleteSync = NULL;
+  if (is_at_least_gl_version(3, 2) || has_extension("GL_ARB_sync")) {
+    _glFenceSync = (PFNGLFENCESYNCPROC)
+      get_extension_func("glFenceSync");
+    _glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)
+      get_extension_func("glClientWaitSync");
+    _glDeleteSync = (PFNGLDELETESYNCPROC)
+      get_extension_func("glDeleteSync");
+
+    if (_glFenceSync == NULL || _glClientWaitSync == NULL ||
+        _glDeleteSync == NULL) {
+      GLCAT.warning()
+        << "Sync objects advertised as supported by OpenGL runtime, but could not get pointers to extension functions.\n";
+      _glFenceSync = NULL;
+      _glClientWaitSync = NULL;
+      _glDeleteSync = NULL;
+    }
+  }
+#endif
+
   report_my_gl_errors();
 
   if (support_stencil) {
@@ -1891,7 +1938,15 @@ reset() {
 
 #ifndef OPENGLES
   // Some drivers expose one, some expose the other. ARB seems to be the newer one.
-  if (has_extension("GL_ARB_draw_instanced")) {
+  // Instanced drawing is also core as of OpenGL 3.1, where core profile
+  // contexts need not list either extension.
+  if (is_at_least_gl_version(3, 1)) {
+    _glDrawArraysInstanced = (PFNGLDRAWARRAYSINSTANCEDPROC)
+      get_extension_func("glDrawArraysInstanced");
+    _glDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)
+      get_extension_func("glDrawElementsInstanced");
+    _supports_geometry_instancing = true;
+  } else if (has_extension("GL_ARB_draw_instanced")) {
     _glDrawArraysInstanced = (PFNGLDRAWARRAYSINSTANCEDPROC)
       get_extension_func("glDrawArraysInstancedARB");
     _glDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)
@@ -1907,6 +1962,13 @@ reset() {
     _glDrawElementsInstanced = 0;
     _glDrawArraysInstanced = 0;
   }
+
+  if (_supports_geometry_instancing &&
+      (_glDrawArraysInstanced == NULL || _glDrawElementsInstanced == NULL)) {
+    GLCAT.warning()
+      << "Instanced drawing advertised as supported by OpenGL runtime, but could not get pointers to extension functions.\n";
+    _supports_geometry_instancing = false;
+  }
 #endif
 
   _auto_rescale_normal = false;
@@ -2521,6 +2583,7 @@ begin_frame(Thread *current_thread) {
   _vertices_display_list_pcollector.clear_level();
   _vertices_immediate_pcollector.clear_level();
   _primitive_batches_display_list_pcollector.clear_level();
+  _async_upload_staged_pcollector.clear_level();
 #endif
 
 #ifndef NDEBUG
@@ -2558,6 +2621,15 @@ begin_frame(Thread *current_thread) {
   }
 #endif
 
+#ifndef OPENGLES
+  // Continue copying any textures that are being uploaded in the
+  // background, so that the ones that finish can be rendered this
+  // frame.
+  if (!_async_uploads_staging.empty() || !_async_uploads_fenced.empty()) {
+    process_async_uploads();
+  }
+#endif
+
   report_my_gl_errors();
   return true;
 }
@@ -2659,6 +2731,7 @@ end_frame(Thread *current_thread) {
   _primitive_batches_display_list_pcollector.flush_level();
   _vertices_display_list_pcollector.flush_level();
   _vertices_immediate_pcollector.flush_level();
+  _async_upload_staged_pcollector.flush_level();
 
   // Now is a good time to delete any pending display lists.
 #ifndef OPENGLES
@@ -3992,6 +4065,18 @@ bool CLP(GraphicsStateGuardian)::
 update_texture(TextureContext *tc, bool force) {
   CLP(TextureContext) *gtc = DCAST(CLP(TextureContext), tc);
 
+#ifndef OPENGLES
+  if (gtc->_async_pending) {
+    if (!force) {
+      // The texture is still being uploaded in the background, and
+      // can't be rendered yet.
+      return false;
+    }
+    // We need it right now; give up on the background upload.
+    cancel_async_upload(gtc);
+  }
+#endif
+
   if (gtc->was_image_modified() || !gtc->_has_storage) {
     // If the texture image was modified, reload the texture.
     apply_texture(tc);
@@ -4004,6 +4089,12 @@ update_texture(TextureContext *tc, bool force) {
         << "Could not load " << *gtc->get_texture() << "\n";
       return false;
     }
+#ifndef OPENGLES
+    if (gtc->_async_pending) {
+      // upload_texture() queued it to be uploaded in the background.
+      return false;
+    }
+#endif
 
   } else if (gtc->was_properties_modified()) {
     // If only the properties have been modified, we don't necessarily
@@ -9462,6 +9553,18 @@ upload_texture(CLP(TextureContext) *gtc, bool force) {
     }
   }
 
+#ifndef OPENGLES
+  if (gl_async_texture_upload && _supports_pixel_buffer && !force &&
+      !gtc->_has_storage && !gtc->_async_pending) {
+    // This is the first time the texture is loaded.  Rather than
+    // stall the frame to send it all at once, copy it to the GL a
+    // little at a time over the next few frames.
+    if (queue_async_upload(gtc)) {
+      return true;
+    }
+  }
+#endif
+
   CPTA_uchar image;
   if (_supports_compressed_texture) {
     image = tex->get_ram_image();
@@ -9961,6 +10064,17 @@ upload_texture_image(CLP(TextureContext) *gtc, bool needs_reload,
       }
       nassertr(image_ptr >= orig_image_ptr && image_ptr + view_size <= orig_image_ptr + tex->get_ram_mipmap_image_size(n), false);
 
+#ifndef OPENGLES
+      if (gtc->_async_pbo != 0) {
+        // The image has already been copied into the pixel buffer that
+        // is currently bound, so we pass the offset within that buffer
+        // instead of a pointer.
+        nassertr(n < (int)gtc->_async_offsets.size(), false);
+        image_ptr = (const unsigned char *)(size_t)
+          (gtc->_async_offsets[n] + (image_ptr - orig_image_ptr));
+      }
+#endif
+
       PTA_uchar bgr_image;
       if (!_supports_bgr && image_compression == Texture::CM_off) {
         // If the GL doesn't claim to support BGR, we may have to reverse
@@ -10132,6 +10246,17 @@ upload_texture_image(CLP(TextureContext) *gtc, bool needs_reload,
       }
       nassertr(image_ptr >= orig_image_ptr && image_ptr + view_size <= orig_image_ptr + tex->get_ram_mipmap_image_size(n), false);
 
+#ifndef OPENGLES
+      if (gtc->_async_pbo != 0) {
+        // The image has already been copied into the pixel buffer that
+        // is currently bound, so we pass the offset within that buffer
+        // instead of a pointer.
+        nassertr(n < (int)gtc->_async_offsets.size(), false);
+        image_ptr = (const unsigned char *)(size_t)
+          (gtc->_async_offsets[n] + (image_ptr - orig_image_ptr));
+      }
+#endif
+
       PTA_uchar bgr_image;
       if (!_supports_bgr && image_compression == Texture::CM_off) {
         // If the GL doesn't claim to support BGR, we may have to reverse
@@ -10305,6 +10430,272 @@ upload_simple_texture(CLP(TextureContext) *gtc) {
   return true;
 }
 
+#ifndef OPENGLES
+////////////////////////////////////////////////////////////////////
+//     Function: GLGraphicsStateGuardian::queue_async_upload
+//       Access: Protected
+//  Description: Arranges for the texture image to be uploaded in the
+//               background, by copying it into a pixel buffer object
+//               a little at a time in process_async_uploads().  This
+//               is only attempted for the first upload of a simple
+//               2-d texture whose image is already in RAM; for
+//               anything else, returns false, and the caller should
+//               upload the texture the usual way.
+//
+//               The texture is marked pending until the upload has
+//               completed, and update_texture() will refuse to bind
+//               it until then.
+////////////////////////////////////////////////////////////////////
+bool CLP(GraphicsStateGuardian)::
+queue_async_upload(CLP(TextureContext) *gtc) {
+  Texture *tex = gtc->get_texture();
+  if (tex->get_texture_type() != Texture::TT_2d_texture ||
+      tex->get_ram_mipmap_pointer(0) != NULL) {
+    return false;
+  }
+
+  CPTA_uchar image = tex->get_ram_image();
+  if (image.is_null()) {
+    return false;
+  }
+
+  // Rule out the cases in which upload_texture() would have to modify
+  // the image before it could be sent to the GL; it's simpler just to
+  // do those the usual way.
+  Texture::CompressionMode image_compression = tex->get_ram_image_compression();
+  if (image_compression == Texture::CM_off) {
+    if (!_supports_bgr) {
+      return false;
+    }
+  } else if (!_supports_compressed_texture ||
+             !get_supports_compressed_texture_format(image_compression)) {
+    return false;
+  }
+  if (_max_texture_dimension > 0 &&
+      (tex->get_x_size() > _max_texture_dimension ||
+       tex->get_y_size() > _max_texture_dimension)) {
+    return false;
+  }
+
+  int num_levels = 1;
+  bool uses_mipmaps = (tex->uses_mipmaps() && !gl_ignore_mipmaps) || gl_force_mipmaps;
+  if (uses_mipmaps) {
+    if (tex->get_num_ram_mipmap_images() <= 1 &&
+        (!_supports_generate_mipmap || !driver_generate_mipmaps ||
+         image_compression != Texture::CM_off)) {
+      // upload_texture() would generate these on the CPU anyway, so do
+      // it now, and they can be staged along with the base image.
+      tex->generate_ram_mipmap_images();
+    }
+    num_levels = tex->get_num_ram_mipmap_images();
+  }
+
+  // Hold a reference to each mipmap level, so that the data we are
+  // copying can't be freed out from under us.
+  gtc->_async_images.clear();
+  gtc->_async_offsets.clear();
+  size_t size = 0;
+  for (int n = 0; n < num_levels; ++n) {
+    CPTA_uchar level = tex->get_ram_mipmap_image(n);
+    if (level.is_null()) {
+      break;
+    }
+    gtc->_async_images.push_back(level);
+    gtc->_async_offsets.push_back(size);
+    size += level.size();
+  }
+
+  if (GLCAT.is_debug()) {
+    GLCAT.debug()
+      << "queueing asynchronous upload of texture " << tex->get_name()
+      << ", " << size << " bytes\n";
+  }
+
+  _glGenBuffers(1, &gtc->_async_pbo);
+  _glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gtc->_async_pbo);
+  _glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+  _glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  gtc->_async_pending = true;
+  gtc->_async_image_modified = tex->get_image_modified();
+  gtc->_async_size = size;
+  gtc->_async_staged = 0;
+  _async_uploads_staging.push_back(gtc);
+
+  _async_upload_bytes_in_flight += size;
+  _async_upload_in_flight_pcollector.set_level(_async_upload_bytes_in_flight);
+
+  report_my_gl_errors();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GLGraphicsStateGuardian::process_async_uploads
+//       Access: Protected
+//  Description: Called once per frame to make progress on the
+//               textures queued by queue_async_upload().  Copies up
+//               to gl-async-texture-upload-budget bytes into the
+//               pixel buffers, in the order the textures were
+//               queued; any texture that is now completely staged is
+//               handed to finish_async_upload().  Also checks for
+//               uploads issued in previous frames that the GL has
+//               since completed, which may now be rendered.
+////////////////////////////////////////////////////////////////////
+void CLP(GraphicsStateGuardian)::
+process_async_uploads() {
+  AsyncUploads::iterator ui = _async_uploads_fenced.begin();
+  while (ui != _async_uploads_fenced.end()) {
+    CLP(TextureContext) *gtc = (*ui);
+    GLenum result = _glClientWaitSync(gtc->_async_fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+      ++ui;
+      continue;
+    }
+
+    _glDeleteSync(gtc->_async_fence);
+    gtc->_async_fence = 0;
+    gtc->_async_pending = false;
+    _async_upload_bytes_in_flight -= gtc->_async_size;
+    ui = _async_uploads_fenced.erase(ui);
+  }
+
+  int budget = gl_async_texture_upload_budget;
+  size_t remaining = (size_t)max(budget, 0);
+
+  while (!_async_uploads_staging.empty() && (budget <= 0 || remaining > 0)) {
+    CLP(TextureContext) *gtc = _async_uploads_staging.front();
+    if (gtc->get_texture()->get_image_modified() != gtc->_async_image_modified) {
+      // The image has changed since we started.  Forget it; it will
+      // be queued again the next time it is rendered.
+      cancel_async_upload(gtc);
+      continue;
+    }
+
+    PStatTimer timer(_load_texture_pcollector);
+    _glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gtc->_async_pbo);
+
+    while (gtc->_async_staged < gtc->_async_size &&
+           (budget <= 0 || remaining > 0)) {
+      // Find the mipmap level that contains the next byte to copy.
+      int n = 0;
+      while (n + 1 < (int)gtc->_async_offsets.size() &&
+             gtc->_async_offsets[n + 1] <= gtc->_async_staged) {
+        ++n;
+      }
+
+      const CPTA_uchar &image = gtc->_async_images[n];
+      size_t begin = gtc->_async_staged - gtc->_async_offsets[n];
+      size_t count = image.size() - begin;
+      if (budget > 0) {
+        count = min(count, remaining);
+        remaining -= count;
+      }
+
+      _glBufferSubData(GL_PIXEL_UNPACK_BUFFER, (GLintptr)gtc->_async_staged,
+                       (GLsizeiptr)count, image.p() + begin);
+      gtc->_async_staged += count;
+      _async_upload_staged_pcollector.add_level(count);
+    }
+
+    _glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (gtc->_async_staged < gtc->_async_size) {
+      // Out of budget for this frame.
+      break;
+    }
+
+    _async_uploads_staging.pop_front();
+    finish_async_upload(gtc);
+  }
+
+  _async_upload_in_flight_pcollector.set_level(_async_upload_bytes_in_flight);
+  report_my_gl_errors();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GLGraphicsStateGuardian::finish_async_upload
+//       Access: Protected
+//  Description: Called when the texture image has been completely
+//               copied into its pixel buffer.  Issues the usual
+//               upload_texture() with the buffer bound, so that the
+//               GL reads the image from there, and then, if sync
+//               objects are available, fences the upload so that we
+//               can tell when it has completed.  Without sync
+//               objects, the texture may be rendered right away; the
+//               GL will wait for the transfer if it has to.
+////////////////////////////////////////////////////////////////////
+void CLP(GraphicsStateGuardian)::
+finish_async_upload(CLP(TextureContext) *gtc) {
+  Texture *tex = gtc->get_texture();
+  bool uses_mipmaps = (tex->uses_mipmaps() && !gl_ignore_mipmaps) || gl_force_mipmaps;
+  int num_levels = uses_mipmaps ? tex->get_num_ram_mipmap_images() : 1;
+
+  bool success = false;
+  if (num_levels == (int)gtc->_async_images.size()) {
+    apply_texture(gtc);
+    _glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gtc->_async_pbo);
+    success = upload_texture(gtc, true);
+    _glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (!success) {
+      GLCAT.error()
+        << "Could not load " << *tex << "\n";
+    }
+  }
+
+  _glDeleteBuffers(1, &gtc->_async_pbo);
+  gtc->_async_pbo = 0;
+  gtc->_async_images.clear();
+  gtc->_async_offsets.clear();
+
+  if (success && _glFenceSync != NULL) {
+    gtc->_async_fence = _glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _async_uploads_fenced.push_back(gtc);
+  } else {
+    gtc->_async_pending = false;
+    _async_upload_bytes_in_flight -= gtc->_async_size;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GLGraphicsStateGuardian::cancel_async_upload
+//       Access: Protected
+//  Description: Abandons the asynchronous upload of the indicated
+//               texture, if any, and frees the resources associated
+//               with it.  If the image had not yet been uploaded, the
+//               texture is left unloaded.
+////////////////////////////////////////////////////////////////////
+void CLP(GraphicsStateGuardian)::
+cancel_async_upload(CLP(TextureContext) *gtc) {
+  AsyncUploads::iterator ui;
+  ui = find(_async_uploads_staging.begin(), _async_uploads_staging.end(), gtc);
+  if (ui != _async_uploads_staging.end()) {
+    _async_uploads_staging.erase(ui);
+  }
+  ui = find(_async_uploads_fenced.begin(), _async_uploads_fenced.end(), gtc);
+  if (ui != _async_uploads_fenced.end()) {
+    _async_uploads_fenced.erase(ui);
+  }
+
+  if (gtc->_async_pbo != 0) {
+    _glDeleteBuffers(1, &gtc->_async_pbo);
+    gtc->_async_pbo = 0;
+  }
+  if (gtc->_async_fence != 0) {
+    _glDeleteSync(gtc->_async_fence);
+    gtc->_async_fence = 0;
+  }
+  gtc->_async_images.clear();
+  gtc->_async_offsets.clear();
+
+  if (gtc->_async_pending) {
+    gtc->_async_pending = false;
+    _async_upload_bytes_in_flight -= gtc->_async_size;
+    _async_upload_in_flight_pcollector.set_level(_async_upload_bytes_in_flight);
+  }
+}
+#endif  // OPENGLES
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GLGraphicsStateGuardian::get_texture_memory_size
 //       Access: Protected
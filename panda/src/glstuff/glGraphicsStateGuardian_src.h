@@ -35,6 +35,7 @@
 #include "graphicsWindow.h"
 #include "pset.h"
 #include "pmap.h"
+#include "pdeque.h"
 #include "geomVertexArrayData.h"
 #include "lightMutex.h"
 
@@ -482,6 +483,13 @@ protected:
                             Texture::CompressionMode image_compression);
   bool upload_simple_texture(CLP(TextureContext) *gtc);
 
+#ifndef OPENGLES
+  bool queue_async_upload(CLP(TextureContext) *gtc);
+  void process_async_uploads();
+  void finish_async_upload(CLP(TextureContext) *gtc);
+  void cancel_async_upload(CLP(TextureContext) *gtc);
+#endif
+
   size_t get_texture_memory_size(Texture *tex);
   void check_nonresident_texture(BufferContextChain &chain);
   bool do_extract_texture_data(CLP(TextureContext) *gtc);
@@ -569,6 +577,7 @@ protected:
   GLint _max_image_units;
   bool _supports_multi_bind;
   bool _supports_get_program_binary;
+  bool _supports_pixel_buffer;
 
 #ifdef OPENGLES
   bool _supports_depth24;
@@ -755,6 +764,7 @@ public:
   PFNGLDISPATCHCOMPUTEPROC _glDispatchCompute;
   PFNGLMEMORYBARRIERPROC _glMemoryBarrier;
   PFNGLGETPROGRAMBINARYPROC _glGetProgramBinary;
+  PFNGLPROGRAMBINARYPROC _glProgramBinary;
   PFNGLGETINTERNALFORMATIVPROC _glGetInternalformativ;
   PFNGLVIEWPORTARRAYVPROC _glViewportArrayv;
   PFNGLSCISSORARRAYVPROC _glScissorArrayv;
@@ -764,6 +774,9 @@ public:
   PFNGLMAKETEXTUREHANDLENONRESIDENTPROC _glMakeTextureHandleNonResident;
   PFNGLUNIFORMHANDLEUI64PROC _glUniformHandleui64;
   PFNGLUNIFORMHANDLEUI64VPROC _glUniformHandleui64v;
+  PFNGLFENCESYNCPROC _glFenceSync;
+  PFNGLCLIENTWAITSYNCPROC _glClientWaitSync;
+  PFNGLDELETESYNCPROC _glDeleteSync;
 #endif  // OPENGLES
 
   GLenum _edge_clamp;
@@ -788,6 +801,14 @@ public:
   TextureSet _textures_needing_image_access_barrier;
   TextureSet _textures_needing_update_barrier;
   TextureSet _textures_needing_framebuffer_barrier;
+
+  // Textures whose images are being copied into pixel buffers, a
+  // little each frame, and textures whose uploads from those buffers
+  // have been issued but may not have completed yet.
+  typedef pdeque<CLP(TextureContext) *> AsyncUploads;
+  AsyncUploads _async_uploads_staging;
+  AsyncUploads _async_uploads_fenced;
+  size_t _async_upload_bytes_in_flight;
 #endif
 
   //RenderState::SlotMask _inv_state_mask;
@@ -818,6 +839,8 @@ public:
   static PStatCollector _vertices_display_list_pcollector;
   static PStatCollector _vertices_immediate_pcollector;
   static PStatCollector _compute_dispatch_pcollector;
+  static PStatCollector _async_upload_in_flight_pcollector;
+  static PStatCollector _async_upload_staged_pcollector;
 
 public:
   virtual TypeHandle get_type() const {
@@ -839,6 +862,7 @@ public:
 private:
   static TypeHandle _type_handle;
 
+  friend class CLP(TextureContext);
   friend class CLP(VertexBufferContext);
   friend class CLP(IndexBufferContext);
   friend class CLP(ShaderContext);
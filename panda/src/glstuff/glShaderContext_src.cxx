@@ -17,6 +17,11 @@
 #ifndef OPENGLES_1
 
 #include "pStatTimer.h"
+#include "bamCache.h"
+#include "virtualFileSystem.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "hashVal.h"
 
 TypeHandle CLP(ShaderContext)::_type_handle;
 
@@ -1485,6 +1490,16 @@ glsl_compile_and_link() {
   if (!_glsl_program) {
     return false;
   }
+
+  // If we have linked this program before, we may be able to skip
+  // compiling and linking it altogether.
+  string cache_key;
+  Filename cache_filename = glsl_get_binary_cache_filename(cache_key);
+  if (!cache_filename.empty() &&
+      glsl_load_program_binary(cache_filename, cache_key)) {
+    return true;
+  }
+
   bool valid = true;
 
   if (!_shader->get_text(Shader::ST_vertex).empty()) {
@@ -1530,8 +1545,12 @@ glsl_compile_and_link() {
   }
 
   // If we requested to retrieve the shader, we should indicate that before linking.
-#if !defined(NDEBUG) && !defined(OPENGLES)
-  if (gl_dump_compiled_shaders && _glgsg->_supports_get_program_binary) {
+#ifndef OPENGLES
+  bool retrievable = !cache_filename.empty();
+#ifndef NDEBUG
+  retrievable = retrievable || gl_dump_compiled_shaders;
+#endif
+  if (retrievable && _glgsg->_supports_get_program_binary) {
     _glgsg->_glProgramParameteri(_glsl_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   }
 #endif
@@ -1574,8 +1593,219 @@ glsl_compile_and_link() {
   }
 #endif  // NDEBUG
 
+  if (!cache_filename.empty()) {
+    glsl_save_program_binary(cache_filename, cache_key);
+  }
+
+  _glgsg->report_my_gl_errors();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GLShaderContext::glsl_get_binary_cache_filename
+//       Access: Private
+//  Description: Returns the file in which the linked binary of this
+//               program is stored, in the same directory as the
+//               BamCache, or the empty filename if the program binary
+//               cache is not in use.
+//
+//               Also fills in key with a string that identifies both
+//               the program source and the driver.  This is stored
+//               in the file and compared when the file is read back,
+//               so that a binary is never loaded for the wrong
+//               program, or into a different driver.
+////////////////////////////////////////////////////////////////////
+Filename CLP(ShaderContext)::
+glsl_get_binary_cache_filename(string &key) const {
+#ifdef OPENGLES
+  return Filename();
+#else
+  if (!gl_cache_program_binaries || !_glgsg->_supports_get_program_binary) {
+    return Filename();
+  }
+
+  BamCache *cache = BamCache::get_global_ptr();
+  if (!cache->get_active() || cache->get_root().empty()) {
+    return Filename();
+  }
+
+  ostringstream strm;
+  strm << "Panda3D GLSL program binary 1\n"
+       << _glgsg->get_gl_vendor() << "\n"
+       << _glgsg->get_gl_renderer() << "\n"
+       << _glgsg->get_gl_version() << "\n";
+  for (int type = (int)Shader::ST_vertex; type <= (int)Shader::ST_compute; ++type) {
+    const string &text = _shader->get_text((Shader::ShaderType)type);
+    strm << type << " " << text.size() << "\n" << text;
+  }
+  key = strm.str();
+
+#ifdef HAVE_OPENSSL
+  HashVal hv;
+  hv.hash_string(key);
+  string hash = hv.as_hex();
+#else
+  // Without OpenSSL, use a 64-bit FNV-1a hash.  This is wide enough
+  // that two programs in the same cache are unlikely to collide; if
+  // they do, the key stored in the file still keeps either one from
+  // loading the other's binary, and they merely take turns being
+  // recompiled.
+  PN_uint64 hash_val = (PN_uint64)0xcbf29ce484222325ULL;
+  for (string::const_iterator si = key.begin(); si != key.end(); ++si) {
+    hash_val ^= (PN_uint64)(unsigned char)(*si);
+    hash_val *= (PN_uint64)0x100000001b3ULL;
+  }
+  ostringstream hash_strm;
+  hash_strm << hex << setw(16) << setfill('0') << hash_val;
+  string hash = hash_strm.str();
+#endif  // HAVE_OPENSSL
+
+  return Filename::binary_filename(Filename(cache->get_root(), "glsl_" + hash + ".bin"));
+#endif  // OPENGLES
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GLShaderContext::glsl_load_program_binary
+//       Access: Private
+//  Description: Attempts to load the linked program from the
+//               indicated cache file.  Returns true on success, or
+//               false if there is no such file, or it is stale, or
+//               the driver refuses it; in this case the program has
+//               been reset and should be compiled and linked as
+//               usual.
+////////////////////////////////////////////////////////////////////
+bool CLP(ShaderContext)::
+glsl_load_program_binary(const Filename &filename, const string &key) {
+#ifdef OPENGLES
+  return false;
+#else
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  string data;
+  if (!vfs->read_file(filename, data, false)) {
+    return false;
+  }
+
+  // The file contains the key, then the binary format, then the
+  // binary itself.
+  Datagram dg(data);
+  DatagramIterator scan(dg);
+  bool valid = false;
+  GLenum format = 0;
+  string binary;
+  if (scan.get_remaining_size() >= 4) {
+    size_t key_length = scan.get_uint32();
+    if ((size_t)scan.get_remaining_size() >= key_length + 4 &&
+        scan.extract_bytes(key_length) == key) {
+      format = (GLenum)scan.get_uint32();
+      binary = scan.get_remaining_bytes();
+      valid = !binary.empty();
+    }
+  }
+
+  if (!valid) {
+    if (GLCAT.is_debug()) {
+      GLCAT.debug()
+        << "Ignoring stale program binary " << filename << "\n";
+    }
+    return false;
+  }
+
+  _glgsg->_glProgramBinary(_glsl_program, format, binary.data(), (GLsizei)binary.size());
+
+  GLint status;
+  _glgsg->_glGetProgramiv(_glsl_program, GL_LINK_STATUS, &status);
+  if (status != GL_TRUE) {
+    // The driver didn't like it, probably because it was updated
+    // without changing its version string.  Start over with a fresh
+    // program; we'll replace the file when we link it.
+    if (GLCAT.is_debug()) {
+      GLCAT.debug()
+        << "Driver rejected program binary " << filename << "\n";
+    }
+    _glgsg->_glDeleteProgram(_glsl_program);
+    _glgsg->report_my_gl_errors();
+    _glsl_program = _glgsg->_glCreateProgram();
+    return false;
+  }
+
+  if (GLCAT.is_debug()) {
+    GLCAT.debug()
+      << "Loaded " << binary.size() << " bytes of program binary from "
+      << filename << "\n";
+  }
   _glgsg->report_my_gl_errors();
   return true;
+#endif  // OPENGLES
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GLShaderContext::glsl_save_program_binary
+//       Access: Private
+//  Description: Writes the binary of the just-linked program to the
+//               indicated cache file, for glsl_load_program_binary()
+//               to find next time.
+////////////////////////////////////////////////////////////////////
+void CLP(ShaderContext)::
+glsl_save_program_binary(const Filename &filename, const string &key) {
+#ifndef OPENGLES
+  BamCache *cache = BamCache::get_global_ptr();
+  if (cache->get_read_only()) {
+    return;
+  }
+
+  GLint length = 0;
+  _glgsg->_glGetProgramiv(_glsl_program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return;
+  }
+
+  char *binary = new char[length];
+  GLenum format;
+  GLsizei num_bytes = 0;
+  _glgsg->_glGetProgramBinary(_glsl_program, length, &num_bytes, &format, (void *)binary);
+
+  Datagram dg;
+  dg.add_uint32(key.size());
+  dg.append_data(key.data(), key.size());
+  dg.add_uint32(format);
+  dg.append_data(binary, num_bytes);
+  delete[] binary;
+
+  if (num_bytes <= 0) {
+    return;
+  }
+
+  // As in BamCache::store(), we write to a temporary filename first,
+  // and then move it into place, so that no one attempts to read the
+  // file while it is in the process of being written.
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  Thread *current_thread = Thread::get_current_thread();
+  Filename temp_filename = filename;
+  temp_filename.set_extension(current_thread->get_unique_id() + string(".tmp"));
+  temp_filename.set_binary();
+
+  if (!vfs->write_file(temp_filename, (const unsigned char *)dg.get_data(),
+                       dg.get_length(), false)) {
+    GLCAT.warning()
+      << "Could not write program binary to " << temp_filename << "\n";
+    vfs->delete_file(temp_filename);
+    return;
+  }
+
+  if (!vfs->rename_file(temp_filename, filename) && vfs->exists(temp_filename)) {
+    vfs->delete_file(filename);
+    if (!vfs->rename_file(temp_filename, filename)) {
+      vfs->delete_file(temp_filename);
+      return;
+    }
+  }
+
+  if (GLCAT.is_debug()) {
+    GLCAT.debug()
+      << "Stored " << num_bytes << " bytes of program binary in "
+      << filename << "\n";
+  }
+#endif  // OPENGLES
 }
 
 #endif  // OPENGLES_1
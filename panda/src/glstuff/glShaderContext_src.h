@@ -20,6 +20,7 @@
 #include "shader.h"
 #include "shaderContext.h"
 #include "deletedChain.h"
+#include "filename.h"
 
 class CLP(GraphicsStateGuardian);
 
@@ -77,6 +78,9 @@ private:
   void glsl_report_program_errors(GLuint program);
   bool glsl_compile_shader(Shader::ShaderType type);
   bool glsl_compile_and_link();
+  Filename glsl_get_binary_cache_filename(string &key) const;
+  bool glsl_load_program_binary(const Filename &filename, const string &key);
+  void glsl_save_program_binary(const Filename &filename, const string &key);
   bool parse_and_set_short_hand_shader_vars(Shader::ShaderArgId &arg_id, Shader *s);
   void release_resources();
 
@@ -23,6 +23,12 @@ TypeHandle CLP(TextureContext)::_type_handle;
 ////////////////////////////////////////////////////////////////////
 CLP(TextureContext)::
 ~CLP(TextureContext)() {
+#ifndef OPENGLES
+  if (_async_pending) {
+    _glgsg->cancel_async_upload(this);
+  }
+#endif
+
   if (gl_enable_memory_barriers) {
     _glgsg->_textures_needing_fetch_barrier.erase(this);
     _glgsg->_textures_needing_image_access_barrier.erase(this);
@@ -78,6 +84,12 @@ reset_data() {
     _glgsg->_glMakeTextureHandleNonResident(_handle);
   }
 
+#ifndef OPENGLES
+  if (_async_pending) {
+    _glgsg->cancel_async_upload(this);
+  }
+#endif
+
   // Free the texture resources.
   glDeleteTextures(1, &_index);
 
@@ -63,6 +63,21 @@ public:
   GLsizei _depth;
   GLenum _target;
 
+#ifndef OPENGLES
+  // These are used while the texture image is being uploaded
+  // asynchronously; see GLGraphicsStateGuardian::queue_async_upload().
+  // _async_pending remains true, and the texture may not be rendered,
+  // until the GL has finished reading the image from the pixel buffer.
+  bool _async_pending;
+  GLuint _async_pbo;
+  GLsync _async_fence;
+  UpdateSeq _async_image_modified;
+  pvector<CPTA_uchar> _async_images;
+  pvector<size_t> _async_offsets;
+  size_t _async_size;
+  size_t _async_staged;
+#endif
+
   CLP(GraphicsStateGuardian) *_glgsg;
 
 public:
@@ -208,12 +208,42 @@ ConfigVariableBool gl_dump_compiled_shaders
             "programs to disk with a filename like glsl_program0.dump "
             "into the current directory."));
 
+ConfigVariableBool gl_cache_program_binaries
+  ("gl-cache-program-binaries", false,
+   PRC_DESC("Set this true to store the binaries of linked GLSL programs "
+            "in the model-cache-dir, alongside the BamCache, so that they "
+            "need not be compiled and linked again the next time the "
+            "application runs.  A cached binary is only used for the "
+            "same shader source, by the same driver that produced it; "
+            "otherwise the program is compiled as usual.  This has no "
+            "effect if there is no model cache, or if the driver does "
+            "not support GL_ARB_get_program_binary."));
+
 ConfigVariableBool gl_immutable_texture_storage
   ("gl-immutable-texture-storage", false,
    PRC_DESC("This configures Panda to pre-allocate immutable storage "
             "for each texture.  This improves runtime performance, but "
             "changing the size or type of a texture will be slower."));
 
+ConfigVariableBool gl_async_texture_upload
+  ("gl-async-texture-upload", false,
+   PRC_DESC("Set this true to upload newly-loaded 2-d textures in the "
+            "background, rather than all at once the first time they are "
+            "rendered.  The texture image is copied into a pixel buffer "
+            "object over several frames, limited by "
+            "gl-async-texture-upload-budget, and the texture is not "
+            "rendered until the transfer has completed.  This avoids a "
+            "frame stall when many new textures come into view at once, "
+            "at the cost of a few frames' delay before they appear.  "
+            "Requires OpenGL 2.1 or GL_ARB_pixel_buffer_object."));
+
+ConfigVariableInt gl_async_texture_upload_budget
+  ("gl-async-texture-upload-budget", 4194304,
+   PRC_DESC("The maximum number of bytes of texture data that will be "
+            "copied into pixel buffers each frame when "
+            "gl-async-texture-upload is true.  Set this to 0 to copy "
+            "everything that is waiting each frame."));
+
 ConfigVariableBool gl_use_bindless_texture
   ("gl-use-bindless-texture", false,
    PRC_DESC("Set this to let Panda use OpenGL's bindless texture "
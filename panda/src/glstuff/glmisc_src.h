@@ -67,7 +67,10 @@ extern ConfigVariableBool gl_force_flush;
 extern ConfigVariableBool gl_separate_specular_color;
 extern ConfigVariableBool gl_cube_map_seamless;
 extern ConfigVariableBool gl_dump_compiled_shaders;
+extern ConfigVariableBool gl_cache_program_binaries;
 extern ConfigVariableBool gl_immutable_texture_storage;
+extern ConfigVariableBool gl_async_texture_upload;
+extern ConfigVariableInt gl_async_texture_upload_budget;
 extern ConfigVariableBool gl_use_bindless_texture;
 extern ConfigVariableBool gl_enable_memory_barriers;
 
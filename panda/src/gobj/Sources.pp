@@ -238,3 +238,25 @@
 
 #end test_bin_target
 
+
+#begin test_bin_target
+  #define TARGET test_animated_vertices
+  #define LOCAL_LIBS \
+    p3gobj p3putil
+
+  #define SOURCES \
+    test_animated_vertices.cxx
+
+#end test_bin_target
+
+
+#begin test_bin_target
+  #define BUILD_TARGET $[HAVE_SQUISH]
+  #define TARGET test_texture_compress
+  #define LOCAL_LIBS \
+    p3gobj p3putil
+
+  #define SOURCES \
+    test_texture_compress.cxx
+
+#end test_bin_target
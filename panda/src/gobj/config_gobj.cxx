@@ -128,6 +128,16 @@ ConfigVariableBool driver_compress_textures
           "and will always be handed to the graphics driver, regardless "
           "of this setting."));
 
+ConfigVariableInt texture_compress_num_threads
+("texture-compress-num-threads", 0,
+ PRC_DESC("The number of threads that Texture::compress_ram_image() will "
+          "use to compress a texture in-memory with the squish library.  "
+          "The rows of 4x4 blocks of all of the mipmap levels and pages of "
+          "the texture are shared between the calling thread and the "
+          "\"texture_compress\" task chain, which will be given enough "
+          "threads to make up the rest.  Set this to 0 or 1 to compress "
+          "on the calling thread only, which is the default."));
+
 ConfigVariableBool driver_generate_mipmaps
 ("driver-generate-mipmaps", true,
  PRC_DESC("Set this true to use the hardware to generate mipmaps "
@@ -303,6 +313,14 @@ ConfigVariableBool vertex_animation_align_16
           "impacts only vertex formats created within Panda subsystems; custom "
           "vertex formats are not affected."));
 
+ConfigVariableBool vertex_animation_simd
+("vertex-animation-simd", true,
+ PRC_DESC("Set this true to use hand-vectorized SSE2 code to transform "
+          "float32 vertices and normals when computing vertex animation on "
+          "the CPU, or false to use the generic linmath code instead.  This "
+          "has no effect if Panda was not compiled with SSE2 enabled, or "
+          "if hardware-animated-vertices is in effect."));
+
 ConfigVariableEnum<AutoTextureScale> textures_power_2
 ("textures-power-2", ATS_down,
  PRC_DESC("Specify whether textures should automatically be constrained to "
@@ -23,6 +23,13 @@
 #include "pset.h"
 #include "indent.h"
 
+// We hand-vectorize the inner loops of CPU vertex animation when the
+// compiler is generating SSE2 code anyway.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_ANIMATION_SSE2 1
+#include <emmintrin.h>
+#endif
+
 TypeHandle GeomVertexData::_type_handle;
 TypeHandle GeomVertexData::CDataCache::_type_handle;
 TypeHandle GeomVertexData::CacheEntry::_type_handle;
@@ -1944,6 +1951,90 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   }
 }
 
+#ifdef HAVE_ANIMATION_SSE2
+////////////////////////////////////////////////////////////////////
+//     Function: sse2_xform_point3f
+//  Description: An SSE2 implementation of table_xform_point3f().
+//               The four rows of the matrix are held in registers,
+//               and each point is computed as a weighted sum of the
+//               rows.  The points need not be aligned; we read and
+//               write only the three floats of each point, so we
+//               never touch memory beyond the end of the table.
+////////////////////////////////////////////////////////////////////
+static void
+sse2_xform_point3f(unsigned char *datat, size_t num_rows, size_t stride,
+                   const LMatrix4f &matf) {
+  const float *m = matf.get_data();
+  __m128 row0 = _mm_loadu_ps(m);
+  __m128 row1 = _mm_loadu_ps(m + 4);
+  __m128 row2 = _mm_loadu_ps(m + 8);
+  __m128 row3 = _mm_loadu_ps(m + 12);
+
+  for (size_t i = 0; i < num_rows; ++i) {
+    float *v = (float *)(datat + i * stride);
+    __m128 r = _mm_add_ps
+      (_mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[0]), row0),
+                  _mm_mul_ps(_mm_set1_ps(v[1]), row1)),
+       _mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[2]), row2), row3));
+    _mm_storel_pi((__m64 *)v, r);
+    _mm_store_ss(v + 2, _mm_movehl_ps(r, r));
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: sse2_xform_vector3f
+//  Description: An SSE2 implementation of table_xform_vector3f().
+//               This is the same as sse2_xform_point3f(), without
+//               the translation row.
+////////////////////////////////////////////////////////////////////
+static void
+sse2_xform_vector3f(unsigned char *datat, size_t num_rows, size_t stride,
+                    const LMatrix4f &matf) {
+  const float *m = matf.get_data();
+  __m128 row0 = _mm_loadu_ps(m);
+  __m128 row1 = _mm_loadu_ps(m + 4);
+  __m128 row2 = _mm_loadu_ps(m + 8);
+
+  for (size_t i = 0; i < num_rows; ++i) {
+    float *v = (float *)(datat + i * stride);
+    __m128 r = _mm_add_ps
+      (_mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[0]), row0),
+                  _mm_mul_ps(_mm_set1_ps(v[1]), row1)),
+       _mm_mul_ps(_mm_set1_ps(v[2]), row2));
+    _mm_storel_pi((__m64 *)v, r);
+    _mm_store_ss(v + 2, _mm_movehl_ps(r, r));
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: sse2_xform_vecbase4f
+//  Description: An SSE2 implementation of table_xform_vecbase4f().
+//               Each row is loaded whole, so this also serves the
+//               16-byte-aligned tables produced by
+//               vertex-animation-align-16, without requiring Eigen.
+////////////////////////////////////////////////////////////////////
+static void
+sse2_xform_vecbase4f(unsigned char *datat, size_t num_rows, size_t stride,
+                     const LMatrix4f &matf) {
+  const float *m = matf.get_data();
+  __m128 row0 = _mm_loadu_ps(m);
+  __m128 row1 = _mm_loadu_ps(m + 4);
+  __m128 row2 = _mm_loadu_ps(m + 8);
+  __m128 row3 = _mm_loadu_ps(m + 12);
+
+  for (size_t i = 0; i < num_rows; ++i) {
+    float *v = (float *)(datat + i * stride);
+    __m128 p = _mm_loadu_ps(v);
+    __m128 r = _mm_add_ps
+      (_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)), row0),
+                  _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)), row1)),
+       _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)), row2),
+                  _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3)), row3)));
+    _mm_storeu_ps(v, r);
+  }
+}
+#endif  // HAVE_ANIMATION_SSE2
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomVertexData::table_xform_point3f
 //       Access: Private, Static
@@ -1953,6 +2044,13 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
 void GeomVertexData::
 table_xform_point3f(unsigned char *datat, size_t num_rows, size_t stride,
                     const LMatrix4f &matf) {
+#ifdef HAVE_ANIMATION_SSE2
+  if (vertex_animation_simd) {
+    sse2_xform_point3f(datat, num_rows, stride, matf);
+    return;
+  }
+#endif  // HAVE_ANIMATION_SSE2
+
   // We don't bother checking for the unaligned case here, because in
   // practice it doesn't matter with a 3-component point.
   for (size_t i = 0; i < num_rows; ++i) {
@@ -1970,6 +2068,13 @@ table_xform_point3f(unsigned char *datat, size_t num_rows, size_t stride,
 void GeomVertexData::
 table_xform_vector3f(unsigned char *datat, size_t num_rows, size_t stride,
                      const LMatrix4f &matf) {
+#ifdef HAVE_ANIMATION_SSE2
+  if (vertex_animation_simd) {
+    sse2_xform_vector3f(datat, num_rows, stride, matf);
+    return;
+  }
+#endif  // HAVE_ANIMATION_SSE2
+
   // We don't bother checking for the unaligned case here, because in
   // practice it doesn't matter with a 3-component vector.
   for (size_t i = 0; i < num_rows; ++i) {
@@ -1987,6 +2092,13 @@ table_xform_vector3f(unsigned char *datat, size_t num_rows, size_t stride,
 void GeomVertexData::
 table_xform_vecbase4f(unsigned char *datat, size_t num_rows, size_t stride,
                       const LMatrix4f &matf) {
+#ifdef HAVE_ANIMATION_SSE2
+  if (vertex_animation_simd) {
+    sse2_xform_vecbase4f(datat, num_rows, stride, matf);
+    return;
+  }
+#endif  // HAVE_ANIMATION_SSE2
+
 #if defined(HAVE_EIGEN) && defined(LINMATH_ALIGN)
   // Check if the table is unaligned.  If it is, we can't use the
   // LVecBase4f object directly, which assumes 16-byte alignment.
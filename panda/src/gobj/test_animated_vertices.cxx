@@ -0,0 +1,195 @@
+// Filename: test_animated_vertices.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "geom.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "geomVertexArrayFormat.h"
+#include "geomVertexWriter.h"
+#include "geomVertexReader.h"
+#include "transformBlendTable.h"
+#include "userVertexTransform.h"
+#include "thread.h"
+#include "config_gobj.h"
+#include "string_utils.h"
+
+// This program skins a mesh of float32 vertices and normals on the
+// CPU, each vertex blended from four joints, with
+// vertex-animation-simd both off and on, and checks each result
+// against the same blend computed directly from the joint matrices.
+// The mesh is built with both 3- and 4-component vertices, and with
+// a number of vertices that is not a multiple of four, so that the
+// leftover rows of the SSE2 path are checked as well.
+
+static const int num_vertices = 1003;
+static const int num_joints = 12;
+static const int num_blends = 40;
+static const int num_frames = 4;
+
+static PT(UserVertexTransform) joints[num_joints];
+
+////////////////////////////////////////////////////////////////////
+//     Function: make_vertex_data
+//  Description: Builds the skinned mesh, with num_components
+//               components per vertex.
+////////////////////////////////////////////////////////////////////
+static PT(GeomVertexData)
+make_vertex_data(int num_components) {
+  PT(GeomVertexArrayFormat) array_format = new GeomVertexArrayFormat
+    (InternalName::get_vertex(), num_components, Geom::NT_float32, Geom::C_point,
+     InternalName::get_normal(), 3, Geom::NT_float32, Geom::C_vector);
+  PT(GeomVertexArrayFormat) blend_format = new GeomVertexArrayFormat
+    (InternalName::get_transform_blend(), 1, Geom::NT_uint16, Geom::C_index);
+
+  PT(GeomVertexFormat) format = new GeomVertexFormat(array_format);
+  format->add_array(blend_format);
+  GeomVertexAnimationSpec animation;
+  animation.set_panda();
+  format->set_animation(animation);
+
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("skinned", GeomVertexFormat::register_format(format), Geom::UH_static);
+
+  PT(TransformBlendTable) table = new TransformBlendTable;
+  for (int bi = 0; bi < num_blends; ++bi) {
+    TransformBlend blend;
+    for (int k = 0; k < 4; ++k) {
+      blend.add_transform(joints[(bi * 3 + k * 5) % num_joints], 0.1f + 0.2f * k);
+    }
+    blend.normalize_weights();
+    table->add_blend(blend);
+  }
+  table->set_rows(SparseArray::range(0, num_vertices));
+  vdata->set_transform_blend_table(table);
+
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+  GeomVertexWriter normal(vdata, InternalName::get_normal());
+  GeomVertexWriter blend(vdata, InternalName::get_transform_blend());
+  for (int i = 0; i < num_vertices; ++i) {
+    PN_stdfloat t = (PN_stdfloat)i / (PN_stdfloat)num_vertices;
+    if (num_components == 4) {
+      vertex.add_data4(t * 10.0f, cos(t * 20.0f), sin(t * 20.0f), 1.0f);
+    } else {
+      vertex.add_data3(t * 10.0f, cos(t * 20.0f), sin(t * 20.0f));
+    }
+    normal.add_data3(0.0f, cos(t * 20.0f), sin(t * 20.0f));
+
+    // Neighboring vertices tend to share a blend, as they do in a
+    // real character, but the runs are of odd lengths.
+    blend.add_data1i((i / 7) % num_blends);
+  }
+
+  return vdata;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: pose_joints
+//  Description: Moves the joints to the pose for the indicated
+//               frame.  Each frame's pose differs from every other.
+////////////////////////////////////////////////////////////////////
+static void
+pose_joints(int frame) {
+  for (int j = 0; j < num_joints; ++j) {
+    PN_stdfloat angle = (PN_stdfloat)(frame * num_joints + j) * 7.0f;
+    LMatrix4 mat = LMatrix4::rotate_mat(angle, LVector3(0.3f, 0.2f, 1.0f));
+    mat.set_row(3, LVecBase3(0.1f * j, -0.2f * frame, 0.05f * angle));
+    joints[j]->set_matrix(mat);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_result
+//  Description: Compares the animated vertices and normals with
+//               the blend of the joints' current matrices, applied
+//               to the original vertices.
+////////////////////////////////////////////////////////////////////
+static bool
+check_result(const GeomVertexData *orig, const GeomVertexData *animated,
+             const char *label) {
+  const TransformBlendTable *table = orig->get_transform_blend_table();
+
+  GeomVertexReader vertex(orig, InternalName::get_vertex());
+  GeomVertexReader normal(orig, InternalName::get_normal());
+  GeomVertexReader blend(orig, InternalName::get_transform_blend());
+  GeomVertexReader new_vertex(animated, InternalName::get_vertex());
+  GeomVertexReader new_normal(animated, InternalName::get_normal());
+
+  for (int i = 0; i < num_vertices; ++i) {
+    const TransformBlend &tb = table->get_blend(blend.get_data1i());
+    LPoint4 v = vertex.get_data4();
+    LVector3 n = normal.get_data3();
+
+    LPoint4 expected_v(0.0f, 0.0f, 0.0f, 0.0f);
+    LVector3 expected_n(0.0f, 0.0f, 0.0f);
+    for (int k = 0; k < tb.get_num_transforms(); ++k) {
+      LMatrix4 mat;
+      tb.get_transform(k)->get_matrix(mat);
+      expected_v += (v * mat) * tb.get_weight(k);
+      expected_n += mat.xform_vec(n) * tb.get_weight(k);
+    }
+
+    LPoint4 got_v = new_vertex.get_data4();
+    LVector3 got_n = new_normal.get_data3();
+    if (!got_v.almost_equal(expected_v, 0.001f) ||
+        !got_n.almost_equal(expected_n, 0.001f)) {
+      nout << label << ": vertex " << i << " is " << got_v << " " << got_n
+           << ", expected " << expected_v << " " << expected_n << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: run_frames
+//  Description: Animates the vertex data through each of the poses,
+//               with SIMD on or off, checking every frame.
+////////////////////////////////////////////////////////////////////
+static bool
+run_frames(const GeomVertexData *vdata, bool simd, const char *label) {
+  vertex_animation_simd.set_value(simd);
+  Thread *current_thread = Thread::get_current_thread();
+
+  for (int frame = 0; frame < num_frames; ++frame) {
+    pose_joints(frame);
+    CPT(GeomVertexData) animated = vdata->animate_vertices(true, current_thread);
+    if (animated == vdata || !check_result(vdata, animated, label)) {
+      nout << label << " failed on frame " << frame << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  for (int j = 0; j < num_joints; ++j) {
+    joints[j] = new UserVertexTransform("joint" + format_string(j));
+  }
+
+  PT(GeomVertexData) vdata3 = make_vertex_data(3);
+  PT(GeomVertexData) vdata4 = make_vertex_data(4);
+
+  bool all_ok = true;
+  all_ok = run_frames(vdata3, false, "3-component generic") && all_ok;
+  all_ok = run_frames(vdata3, true, "3-component simd") && all_ok;
+  all_ok = run_frames(vdata4, false, "4-component generic") && all_ok;
+  all_ok = run_frames(vdata4, true, "4-component simd") && all_ok;
+
+  if (!all_ok) {
+    return 1;
+  }
+  nout << "All tests passed.\n";
+  return 0;
+}
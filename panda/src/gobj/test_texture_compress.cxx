@@ -0,0 +1,189 @@
+// Filename: test_texture_compress.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "texture.h"
+#include "config_gobj.h"
+
+// This program compresses an RGBA texture, with all of its mipmap
+// levels, to DXT5 with squish, on one thread and then on several
+// with texture-compress-num-threads.  It checks that each compressed
+// level has the size of a DXT5 image, that the threaded results are
+// identical to the single-threaded one, and that the image
+// decompresses to something close to the original.
+
+static const int x_size = 128;
+static const int y_size = 96;
+
+////////////////////////////////////////////////////////////////////
+//     Function: make_texture
+//  Description: Builds a texture of smooth gradients, which DXT5
+//               can represent closely, with an alpha channel that is
+//               constant within each 4x4 block.
+////////////////////////////////////////////////////////////////////
+static PT(Texture)
+make_texture() {
+  PT(Texture) tex = new Texture("gradient");
+  tex->setup_2d_texture(x_size, y_size,
+                        Texture::T_unsigned_byte, Texture::F_rgba);
+  tex->set_minfilter(Texture::FT_linear_mipmap_linear);
+
+  PTA_uchar image = tex->modify_ram_image();
+  unsigned char *p = image.p();
+  for (int y = 0; y < y_size; ++y) {
+    for (int x = 0; x < x_size; ++x) {
+      p[0] = (unsigned char)(x * 2);
+      p[1] = (unsigned char)(y * 2);
+      p[2] = (unsigned char)(x + y);
+      p[3] = (unsigned char)((((x / 8) + (y / 8)) & 1) ? 255 : 128);
+      p += 4;
+    }
+  }
+  tex->generate_ram_mipmap_images();
+  return tex;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: compress
+//  Description: Returns a copy of the source texture, compressed
+//               with the indicated number of threads, or NULL if it
+//               could not be compressed.
+////////////////////////////////////////////////////////////////////
+static PT(Texture)
+compress(Texture *source, int num_threads) {
+  texture_compress_num_threads.set_value(num_threads);
+  PT(Texture) tex = source->make_copy();
+  if (!tex->compress_ram_image(Texture::CM_dxt5, Texture::QL_normal) ||
+      tex->get_ram_image_compression() != Texture::CM_dxt5) {
+    nout << "Unable to compress with " << num_threads << " threads\n";
+    return NULL;
+  }
+  return tex;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_sizes
+//  Description: Checks that there is a compressed image for each
+//               mipmap level, of 16 bytes per 4x4 block.
+////////////////////////////////////////////////////////////////////
+static bool
+check_sizes(const Texture *tex) {
+  int num_levels = tex->get_expected_num_mipmap_levels();
+  if (tex->get_num_ram_mipmap_images() != num_levels) {
+    nout << "Compressed texture has " << tex->get_num_ram_mipmap_images()
+         << " mipmap levels, expected " << num_levels << "\n";
+    return false;
+  }
+  for (int n = 0; n < num_levels; ++n) {
+    int x_blocks = (tex->get_expected_mipmap_x_size(n) + 3) / 4;
+    int y_blocks = (tex->get_expected_mipmap_y_size(n) + 3) / 4;
+    size_t expected = (size_t)x_blocks * (size_t)y_blocks * 16;
+    if (tex->get_ram_mipmap_image_size(n) != expected) {
+      nout << "Mipmap level " << n << " is "
+           << tex->get_ram_mipmap_image_size(n) << " bytes, expected "
+           << expected << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: same_images
+//  Description: Returns true if the two compressed textures have
+//               identical images at every mipmap level.
+////////////////////////////////////////////////////////////////////
+static bool
+same_images(const Texture *a, const Texture *b) {
+  if (a->get_num_ram_mipmap_images() != b->get_num_ram_mipmap_images()) {
+    return false;
+  }
+  for (int n = 0; n < a->get_num_ram_mipmap_images(); ++n) {
+    CPTA_uchar ia = a->get_ram_mipmap_image(n);
+    CPTA_uchar ib = b->get_ram_mipmap_image(n);
+    if (ia.size() != ib.size() ||
+        memcmp(ia.p(), ib.p(), ia.size()) != 0) {
+      nout << "Mipmap level " << n << " differs\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_decompressed
+//  Description: Decompresses the texture and compares its top level
+//               with the source image.  DXT5 is lossy, but on these
+//               gradients the colors should stay close, and the
+//               alpha, which is constant within each block, exact.
+////////////////////////////////////////////////////////////////////
+static bool
+check_decompressed(const Texture *compressed, const Texture *source) {
+  PT(Texture) tex = compressed->make_copy();
+  if (!tex->uncompress_ram_image()) {
+    nout << "Unable to decompress\n";
+    return false;
+  }
+
+  CPTA_uchar got = tex->get_ram_image();
+  CPTA_uchar expected = source->get_ram_image();
+  if (got.size() != expected.size()) {
+    nout << "Decompressed image is " << got.size() << " bytes, expected "
+         << expected.size() << "\n";
+    return false;
+  }
+
+  // Texture images are stored as BGRA, but the alpha is last either
+  // way.
+  double total_error = 0.0;
+  for (size_t i = 0; i < got.size(); ++i) {
+    int error = abs((int)got[i] - (int)expected[i]);
+    if ((i % 4) == 3 ? (error != 0) : (error > 24)) {
+      nout << "Byte " << i << " decompressed as " << (int)got[i]
+           << ", expected " << (int)expected[i] << "\n";
+      return false;
+    }
+    total_error += error;
+  }
+  double mean_error = total_error / (double)got.size();
+  if (mean_error > 4.0) {
+    nout << "Mean error after decompression is " << mean_error << "\n";
+    return false;
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  PT(Texture) source = make_texture();
+
+  PT(Texture) reference = compress(source, 1);
+  if (reference == (Texture *)NULL ||
+      !check_sizes(reference) || !check_decompressed(reference, source)) {
+    return 1;
+  }
+
+  static const int thread_counts[] = { 2, 3, 8 };
+  static const int num_counts = sizeof(thread_counts) / sizeof(int);
+  for (int i = 0; i < num_counts; ++i) {
+    PT(Texture) tex = compress(source, thread_counts[i]);
+    if (tex == (Texture *)NULL || !same_images(tex, reference)) {
+      nout << "Compressed image with " << thread_counts[i]
+           << " threads differs from single-threaded result.\n";
+      return 1;
+    }
+  }
+
+  nout << "All tests passed.\n";
+  return 0;
+}
@@ -41,6 +41,9 @@
 #include "pbitops.h"
 #include "streamReader.h"
 #include "texturePeeker.h"
+#include "parallelFor.h"
+#include "conditionVar.h"
+#include "mutexHolder.h"
 
 #ifdef HAVE_SQUISH
 #include <squish.h>
@@ -7598,6 +7601,102 @@ filter_3d_float(unsigned char *&p, const unsigned char *&q,
   q += 4;
 }
 
+#ifdef HAVE_SQUISH
+// One row of 4 x 4 cells of one page of one mipmap level, the unit
+// of work for do_squish().
+class SquishRow {
+public:
+  const unsigned char *_source_page;
+  const unsigned char *_source_page_end;
+  unsigned char *_dest;
+  int _x_size;
+  int _y;
+};
+typedef pvector<SquishRow> SquishRows;
+
+// The state shared by the workers of a parallel do_squish().
+class SquishState {
+public:
+  const SquishRows *_rows;
+  int _num_components;
+  int _squish_flags;
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: squish_row
+//  Description: Compresses one row of 4 x 4 cells with squish.
+////////////////////////////////////////////////////////////////////
+static void
+squish_row(const SquishRow &row, int num_components, int squish_flags) {
+  int cell_size = squish::GetStorageRequirements(4, 4, squish_flags);
+  unsigned const char *source_page = row._source_page;
+  unsigned const char *source_page_end = row._source_page_end;
+  int x_size = row._x_size;
+  int y = row._y;
+
+  unsigned char *d = row._dest;
+  for (int x = 0; x < x_size; x += 4) {
+    unsigned char tb[16 * 4];
+    int mask = 0;
+    unsigned char *t = tb;
+    for (int i = 0; i < 16; ++i) {
+      int xi = x + i % 4;
+      int yi = y + i / 4;
+      unsigned const char *s = source_page + (yi * x_size + xi) * num_components;
+      if (s < source_page_end) {
+        switch (num_components) {
+        case 1:
+          t[0] = s[0];   // r
+          t[1] = s[0];   // g
+          t[2] = s[0];   // b
+          t[3] = 255;    // a
+          break;
+
+        case 2:
+          t[0] = s[0];   // r
+          t[1] = s[0];   // g
+          t[2] = s[0];   // b
+          t[3] = s[1];   // a
+          break;
+
+        case 3:
+          t[0] = s[2];   // r
+          t[1] = s[1];   // g
+          t[2] = s[0];   // b
+          t[3] = 255;    // a
+          break;
+
+        case 4:
+          t[0] = s[2];   // r
+          t[1] = s[1];   // g
+          t[2] = s[0];   // b
+          t[3] = s[3];   // a
+          break;
+        }
+        mask |= (1 << i);
+      }
+      t += 4;
+    }
+    squish::CompressMasked(tb, mask, d, squish_flags);
+    d += cell_size;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: squish_rows
+//  Description: The ParallelFor function for a parallel do_squish().
+//               It compresses the indicated range of rows.
+////////////////////////////////////////////////////////////////////
+static void
+squish_rows(void *user_data, int begin, int end, int worker_index) {
+  SquishState *state = (SquishState *)user_data;
+  const SquishRows &rows = *state->_rows;
+  for (int i = begin; i < end; ++i) {
+    squish_row(rows[i], state->_num_components, state->_squish_flags);
+  }
+}
+#endif  // HAVE_SQUISH
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Texture::do_squish
 //       Access: Private
@@ -7617,75 +7716,57 @@ do_squish(CData *cdata, Texture::CompressionMode compression, int squish_flags)
     do_generate_ram_mipmap_images(cdata);
   }
 
+  // First, allocate all of the compressed images, and break them up
+  // into rows of 4 x 4 cells, each of which may be compressed
+  // independently of the others.
   RamImages compressed_ram_images;
   compressed_ram_images.reserve(cdata->_ram_images.size());
+  SquishRows rows;
+  int cell_size = squish::GetStorageRequirements(4, 4, squish_flags);
   for (size_t n = 0; n < cdata->_ram_images.size(); ++n) {
     RamImage compressed_image;
     int x_size = do_get_expected_mipmap_x_size(cdata, n);
     int y_size = do_get_expected_mipmap_y_size(cdata, n);
     int num_pages = do_get_expected_mipmap_num_pages(cdata, n);
     int page_size = squish::GetStorageRequirements(x_size, y_size, squish_flags);
-    int cell_size = squish::GetStorageRequirements(4, 4, squish_flags);
+    int row_size = ((x_size + 3) / 4) * cell_size;
 
     compressed_image._page_size = page_size;
     compressed_image._image = PTA_uchar::empty_array(page_size * num_pages);
     for (int z = 0; z < num_pages; ++z) {
-      unsigned char *dest_page = compressed_image._image.p() + z * page_size;
-      unsigned const char *source_page = cdata->_ram_images[n]._image.p() + z * cdata->_ram_images[n]._page_size;
-      unsigned const char *source_page_end = source_page + cdata->_ram_images[n]._page_size;
-      // Convert one 4 x 4 cell at a time.
-      unsigned char *d = dest_page;
-      for (int y = 0; y < y_size; y += 4) {
-        for (int x = 0; x < x_size; x += 4) {
-          unsigned char tb[16 * 4];
-          int mask = 0;
-          unsigned char *t = tb;
-          for (int i = 0; i < 16; ++i) {
-            int xi = x + i % 4;
-            int yi = y + i / 4;
-            unsigned const char *s = source_page + (yi * x_size + xi) * cdata->_num_components;
-            if (s < source_page_end) {
-              switch (cdata->_num_components) {
-              case 1:
-                t[0] = s[0];   // r
-                t[1] = s[0];   // g
-                t[2] = s[0];   // b
-                t[3] = 255;    // a
-                break;
-
-              case 2:
-                t[0] = s[0];   // r
-                t[1] = s[0];   // g
-                t[2] = s[0];   // b
-                t[3] = s[1];   // a
-                break;
-
-              case 3:
-                t[0] = s[2];   // r
-                t[1] = s[1];   // g
-                t[2] = s[0];   // b
-                t[3] = 255;    // a
-                break;
-
-              case 4:
-                t[0] = s[2];   // r
-                t[1] = s[1];   // g
-                t[2] = s[0];   // b
-                t[3] = s[3];   // a
-                break;
-              }
-              mask |= (1 << i);
-            }
-            t += 4;
-          }
-          squish::CompressMasked(tb, mask, d, squish_flags);
-          d += cell_size;
-          Thread::consider_yield();
-        }
+      SquishRow row;
+      row._source_page = cdata->_ram_images[n]._image.p() + z * cdata->_ram_images[n]._page_size;
+      row._source_page_end = row._source_page + cdata->_ram_images[n]._page_size;
+      row._dest = compressed_image._image.p() + z * page_size;
+      row._x_size = x_size;
+      for (row._y = 0; row._y < y_size; row._y += 4) {
+        rows.push_back(row);
+        row._dest += row_size;
       }
     }
     compressed_ram_images.push_back(compressed_image);
   }
+
+  int num_rows = (int)rows.size();
+  ParallelFor pfor("texture_compress", texture_compress_num_threads);
+  if (pfor.get_num_workers(num_rows) <= 1) {
+    // Compress the rows one at a time on this thread.
+    for (int i = 0; i < num_rows; ++i) {
+      squish_row(rows[i], cdata->_num_components, squish_flags);
+      Thread::consider_yield();
+    }
+
+  } else {
+    // Share the rows with the threads of the "texture_compress" task
+    // chain.  Each row writes to its own part of the compressed
+    // images, so no further synchronization is needed.
+    SquishState state;
+    state._rows = &rows;
+    state._num_components = cdata->_num_components;
+    state._squish_flags = squish_flags;
+    pfor.run(&squish_rows, &state, num_rows);
+  }
+
   cdata->_ram_images.swap(compressed_ram_images);
   cdata->_ram_image_compression = compression;
   return true;
@@ -35,6 +35,7 @@ private:
     inline bool isSetForNative(const SOCKET inid) const;
     
     friend struct Socket_Selector;
+    friend class ConnectionReader;
     SOCKET _maxid;
     mutable fd_set _the_set;
 };
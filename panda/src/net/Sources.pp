@@ -127,6 +127,16 @@
 
 #end test_bin_target
 
+#begin test_bin_target
+  #define TARGET test_net_load
+  #define LOCAL_LIBS p3net p3putil
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_net_load.cxx
+
+#end test_bin_target
+
 #begin test_bin_target
   #define TARGET fake_http_server
   #define LOCAL_LIBS p3net
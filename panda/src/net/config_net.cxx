@@ -143,6 +143,36 @@ ConfigVariableEnum<ThreadPriority> net_thread_priority
  PRC_DESC("The default thread priority when creating threaded readers "
           "or writers."));
 
+ConfigVariableBool net_batch_writes
+("net-batch-writes", false,
+ PRC_DESC("Set this true to have each threaded ConnectionWriter created "
+          "hereafter send its queued datagrams in batches, with one "
+          "writev() (or sendmmsg(), for UDP) call per connection per "
+          "batch, instead of one system call per datagram.  See also "
+          "net-batch-latency."));
+
+ConfigVariableDouble net_batch_latency
+("net-batch-latency", 0.0,
+ PRC_DESC("When net-batch-writes is in effect, this is the maximum time, "
+          "in seconds, that a writer thread will hold a datagram while "
+          "waiting for more datagrams to send along with it.  The default, "
+          "0, sends whatever is already queued without waiting."));
+
+ConfigVariableInt net_batch_max_datagrams
+("net-batch-max-datagrams", 256,
+ PRC_DESC("When net-batch-writes is in effect, this is the maximum number "
+          "of datagrams a writer thread will take from its queue at once."));
+
+ConfigVariableBool net_use_epoll
+("net-use-epoll", false,
+ PRC_DESC("Set this true to have each ConnectionReader (and "
+          "ConnectionListener) created hereafter wait for activity on its "
+          "sockets with epoll() instead of select(), where epoll() is "
+          "available (currently only on Linux).  This is not limited "
+          "by FD_SETSIZE, and the cost of each wakeup depends only on the "
+          "number of active sockets, not on the total number of sockets, "
+          "which matters for servers with thousands of connections."));
+
 
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libnet
@@ -38,6 +38,10 @@ extern ConfigVariableInt net_max_read_per_epoch;
 extern ConfigVariableInt net_max_write_per_epoch;
 
 extern ConfigVariableEnum<ThreadPriority> net_thread_priority;
+extern ConfigVariableBool net_use_epoll;
+extern ConfigVariableBool net_batch_writes;
+extern ConfigVariableDouble net_batch_latency;
+extern ConfigVariableInt net_batch_max_datagrams;
 
 extern EXPCL_PANDA_NET void init_libnet();
 
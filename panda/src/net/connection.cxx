@@ -26,6 +26,63 @@
 #include "socket_tcp.h"
 #include "socket_udp.h"
 #include "dcast.h"
+#include "pvector.h"
+
+#if !defined(WIN32_VC) && !defined(WIN64_VC)
+#include <sys/uio.h>
+#include <errno.h>
+#include <limits.h>
+#define HAVE_SCATTER_GATHER 1
+#endif
+
+#ifdef HAVE_SCATTER_GATHER
+#ifdef IOV_MAX
+static const int max_iovecs = IOV_MAX;
+#else
+static const int max_iovecs = 1024;
+#endif
+
+////////////////////////////////////////////////////////////////////
+//     Function: write_iovecs
+//  Description: Writes all of the indicated buffers to the socket,
+//               with as few calls to writev() as possible.  The
+//               iovec array is modified to track partial writes.
+//               Increments num_syscalls for each call made.  Returns
+//               true on success, false on error.
+////////////////////////////////////////////////////////////////////
+static bool
+write_iovecs(SOCKET fd, struct iovec *iov, int iov_count, int &num_syscalls) {
+  while (iov_count > 0) {
+    int count = min(iov_count, max_iovecs);
+    ssize_t sent = writev(fd, iov, count);
+    ++num_syscalls;
+    if (sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+      if (errno == LOCAL_BLOCKING_ERROR) {
+        Thread::force_yield();
+        continue;
+      }
+#endif  // SIMPLE_THREADS
+      return false;
+    }
+
+    // Skip past whatever was written.
+    while (iov_count > 0 && (size_t)sent >= iov->iov_len) {
+      sent -= iov->iov_len;
+      ++iov;
+      --iov_count;
+    }
+    if (iov_count > 0 && sent > 0) {
+      iov->iov_base = (char *)iov->iov_base + sent;
+      iov->iov_len -= sent;
+    }
+  }
+  return true;
+}
+#endif  // HAVE_SCATTER_GATHER
 
 
 ////////////////////////////////////////////////////////////////////
@@ -474,6 +531,171 @@ send_raw_datagram(const NetDatagram &datagram) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::send_datagram_batch
+//       Access: Private
+//  Description: This method is intended only to be called by
+//               ConnectionWriter.  It writes all of the indicated
+//               datagrams to the socket, in order, with as few system
+//               calls as possible.  The datagram payloads are handed
+//               to the kernel directly, rather than being copied into
+//               a single buffer first.
+//
+//               Increments num_syscalls by the number of system calls
+//               made.  Returns true on success, false on failure.
+////////////////////////////////////////////////////////////////////
+bool Connection::
+send_datagram_batch(const NetDatagram * const *datagrams, int num_datagrams,
+                    int tcp_header_size, bool raw_mode, int &num_syscalls) {
+  nassertr(_socket != (Socket_IP *)NULL, false);
+
+#ifdef HAVE_SCATTER_GATHER
+  bool is_udp = _socket->is_exact_type(Socket_UDP::get_class_type());
+
+#if defined(__linux__)
+  if (is_udp) {
+    // Each UDP datagram is its own message, but sendmmsg() can send
+    // many of them in one call.
+    pvector<char> header_data(num_datagrams * datagram_udp_header_size);
+    pvector<Socket_Address> addrs;
+    pvector<struct iovec> iovs(num_datagrams * 2);
+    pvector<struct mmsghdr> msgs(num_datagrams);
+    addrs.reserve(num_datagrams);
+
+    for (int i = 0; i < num_datagrams; ++i) {
+      const NetDatagram &datagram = *datagrams[i];
+      struct iovec *iov = &iovs[i * 2];
+      int iov_count = 0;
+      if (!raw_mode) {
+        DatagramUDPHeader header(datagram);
+        char *dest = &header_data[i * datagram_udp_header_size];
+        memcpy(dest, header.get_header().data(), datagram_udp_header_size);
+        iov[iov_count].iov_base = dest;
+        iov[iov_count].iov_len = datagram_udp_header_size;
+        ++iov_count;
+      }
+      iov[iov_count].iov_base = (void *)datagram.get_data();
+      iov[iov_count].iov_len = datagram.get_length();
+      ++iov_count;
+
+      // addrs was reserved above, so this won't move the earlier
+      // addresses that the messages point to.
+      addrs.push_back(datagram.get_address().get_addr());
+      memset(&msgs[i], 0, sizeof(msgs[i]));
+      struct msghdr &msg = msgs[i].msg_hdr;
+      msg.msg_name = (void *)&addrs.back().GetAddressInfo();
+      msg.msg_namelen = sizeof(Socket_Address::AddressType);
+      msg.msg_iov = iov;
+      msg.msg_iovlen = iov_count;
+    }
+
+    LightReMutexHolder holder(_write_mutex);
+    bool okflag = true;
+    int num_sent = 0;
+    while (okflag && num_sent < num_datagrams) {
+      int result = sendmmsg(_socket->GetSocket(), &msgs[num_sent],
+                            num_datagrams - num_sent, 0);
+      ++num_syscalls;
+      if (result > 0) {
+        num_sent += result;
+      } else if (result < 0 && errno == EINTR) {
+        continue;
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+      } else if (result < 0 && errno == LOCAL_BLOCKING_ERROR) {
+        Thread::force_yield();
+#endif  // SIMPLE_THREADS
+      } else {
+        okflag = false;
+      }
+    }
+
+    if (net_cat.is_spam()) {
+      net_cat.spam()
+        << "Sent " << num_sent << " UDP datagram(s) to " << (void *)this
+        << " with " << num_syscalls << " call(s), ok = " << okflag << "\n";
+    }
+
+    return check_send_error(okflag);
+  }
+#endif  // __linux__
+
+  if (!is_udp) {
+    // The headers are all written into one small buffer, which is
+    // allocated up front so the iovecs may point into it.
+    if (raw_mode) {
+      tcp_header_size = 0;
+    }
+    pvector<char> header_data(num_datagrams * tcp_header_size + 1);
+    pvector<struct iovec> iovs;
+    iovs.reserve(num_datagrams * 2);
+
+    for (int i = 0; i < num_datagrams; ++i) {
+      const NetDatagram &datagram = *datagrams[i];
+      if (tcp_header_size == 2 && datagram.get_length() >= 0x10000) {
+        net_cat.error()
+          << "Attempt to send TCP datagram of " << datagram.get_length()
+          << " bytes--too long!\n";
+        nassert_raise("Datagram too long");
+        continue;
+      }
+
+      if (tcp_header_size != 0) {
+        DatagramTCPHeader header(datagram, tcp_header_size);
+        char *dest = &header_data[i * tcp_header_size];
+        memcpy(dest, header.get_header().data(), tcp_header_size);
+
+        struct iovec iov;
+        iov.iov_base = dest;
+        iov.iov_len = tcp_header_size;
+        iovs.push_back(iov);
+      }
+      if (datagram.get_length() != 0) {
+        struct iovec iov;
+        iov.iov_base = (void *)datagram.get_data();
+        iov.iov_len = datagram.get_length();
+        iovs.push_back(iov);
+      }
+    }
+
+    LightReMutexHolder holder(_write_mutex);
+
+    // Anything collected by collect-tcp mode must go out first.
+    if (!_queued_data.empty()) {
+      ++num_syscalls;
+      if (!do_flush()) {
+        return false;
+      }
+    }
+
+    bool okflag = true;
+    if (!iovs.empty()) {
+      okflag = write_iovecs(_socket->GetSocket(), &iovs[0], (int)iovs.size(),
+                            num_syscalls);
+    }
+
+    if (net_cat.is_spam()) {
+      net_cat.spam()
+        << "Sent " << num_datagrams << " TCP datagram(s) to " << (void *)this
+        << " with " << num_syscalls << " call(s), ok = " << okflag << "\n";
+    }
+
+    return check_send_error(okflag);
+  }
+#endif  // HAVE_SCATTER_GATHER
+
+  // On other platforms, just send them one at a time.
+  bool okflag = true;
+  for (int i = 0; i < num_datagrams && okflag; ++i) {
+    if (raw_mode) {
+      okflag = send_raw_datagram(*datagrams[i]);
+    } else {
+      okflag = send_datagram(*datagrams[i], tcp_header_size);
+    }
+    ++num_syscalls;
+  }
+  return okflag;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Connection::do_flush
 //       Access: Private
@@ -62,6 +62,9 @@ PUBLISHED:
 private:
   bool send_datagram(const NetDatagram &datagram, int tcp_header_size);
   bool send_raw_datagram(const NetDatagram &datagram);
+  bool send_datagram_batch(const NetDatagram * const *datagrams,
+                           int num_datagrams, int tcp_header_size,
+                           bool raw_mode, int &num_syscalls);
   bool do_flush();
   bool check_send_error(bool okflag);
 
@@ -433,6 +433,7 @@ wait_for_readers(double timeout) {
     Socket_fdset fdset;
     fdset.clear();
     bool any_threaded = false;
+    bool any_ready = false;
     
     {
       LightMutexHolder holder(_set_mutex);
@@ -443,7 +444,10 @@ wait_for_readers(double timeout) {
         if (reader->is_polling()) {
           // If it's a polling reader, we can wait for its socket.
           // (If it's a threaded reader, we can't do anything here.)
-          reader->accumulate_fdset(fdset);
+          if (reader->accumulate_fdset(fdset)) {
+            // This reader already has data waiting.
+            any_ready = true;
+          }
         } else {
           any_threaded = true;
           stop = now;
@@ -458,7 +462,7 @@ wait_for_readers(double timeout) {
     }
 
     PN_uint32 wait_timeout_ms = (PN_uint32)(wait_timeout * 1000.0);
-    if (any_threaded) {
+    if (any_threaded || any_ready) {
       // If there are any threaded ConnectionReaders, we can't block
       // at all.
       wait_timeout_ms = 0;
@@ -470,7 +474,7 @@ wait_for_readers(double timeout) {
     wait_timeout_ms = 0;
 #endif
     int num_results = fdset.WaitForRead(false, wait_timeout_ms);
-    if (num_results != 0) {
+    if (num_results != 0 || any_ready) {
       // If we got an answer (or an error), return success.  The
       // caller can then figure out what happened.
       if (num_results < 0) {
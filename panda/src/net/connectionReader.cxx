@@ -27,8 +27,19 @@
 #include "atomicAdjust.h"
 #include "config_downloader.h"
 
+#if defined(__linux__) && !defined(CPPPARSER)
+#define HAVE_EPOLL 1
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 static const int read_buffer_size = maximum_udp_datagram + datagram_udp_header_size;
 
+// The maximum number of events we collect from a single call to
+// epoll_wait().
+static const int max_epoll_events = 256;
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionReader::SocketInfo::Constructor
 //       Access: Public
@@ -40,6 +51,7 @@ SocketInfo(const PT(Connection) &connection) :
 {
   _busy = false;
   _error = false;
+  _registered = false;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -124,6 +136,20 @@ ConnectionReader(ConnectionManager *manager, int num_threads,
 
   _currently_polling_thread = -1;
 
+  _epoll_fd = -1;
+  _epoll_next = 0;
+#ifdef HAVE_EPOLL
+  if (net_use_epoll) {
+    // The size parameter is only a hint, and is ignored by modern
+    // kernels.
+    _epoll_fd = epoll_create(max_epoll_events);
+    if (_epoll_fd < 0) {
+      net_cat.warning()
+        << "Unable to create epoll descriptor; using select() instead.\n";
+    }
+  }
+#endif  // HAVE_EPOLL
+
   string reader_thread_name = thread_name;
   if (thread_name.empty()) {
     reader_thread_name = "ReaderThread";
@@ -153,6 +179,13 @@ ConnectionReader::
 
   shutdown();
 
+#ifdef HAVE_EPOLL
+  if (_epoll_fd >= 0) {
+    close(_epoll_fd);
+    _epoll_fd = -1;
+  }
+#endif  // HAVE_EPOLL
+
   // Delete all of our old sockets.
   Sockets::iterator si;
   for (si = _sockets.begin(); si != _sockets.end(); ++si) {
@@ -205,7 +238,11 @@ add_connection(Connection *connection) {
     }
   }
 
-  _sockets.push_back(new SocketInfo(connection));
+  SocketInfo *sinfo = new SocketInfo(connection);
+  _sockets.push_back(sinfo);
+  if (_epoll_fd >= 0) {
+    epoll_register(sinfo);
+  }
 
   return true;
 }
@@ -235,6 +272,9 @@ remove_connection(Connection *connection) {
     return false;
   }
 
+  if ((*si)->_registered) {
+    epoll_unregister(*si);
+  }
   _removed_sockets.push_back(*si);
   _sockets.erase(si);
 
@@ -480,6 +520,18 @@ void ConnectionReader::
 finish_socket(SocketInfo *sinfo) {
   nassertv(sinfo->_busy);
 
+  if (_epoll_fd >= 0) {
+    // In the epoll case, the socket won't be reported again until we
+    // rearm it.  We hold the lock so the socket can't be removed (and
+    // its descriptor reused) while we do this.
+    LightMutexHolder holder(_sockets_mutex);
+    if (sinfo->_registered && !sinfo->_error) {
+      epoll_rearm(sinfo);
+    }
+    sinfo->_busy = false;
+    return;
+  }
+
   // By marking the SocketInfo nonbusy, we make it available for
   // future polls.
   sinfo->_busy = false;
@@ -882,6 +934,10 @@ get_next_available_socket(bool allow_block, int current_thread_index) {
   // thread is in this function at a time.
   MutexHolder holder(_select_mutex);
 
+  if (_epoll_fd >= 0) {
+    return get_next_epoll_socket(allow_block, current_thread_index);
+  }
+
   do {
     // First, check the result from the previous select call.  If
     // there are any sockets remaining there, process them first.
@@ -982,7 +1038,21 @@ rebuild_select_list() {
 
   // This is also a fine time to delete the contents of the
   // _removed_sockets list.
+  delete_removed_sockets();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::delete_removed_sockets
+//       Access: Private
+//  Description: Deletes the sockets on the _removed_sockets list that
+//               are no longer busy.  The caller must hold
+//               _sockets_mutex, and must not be holding pointers to
+//               any of these sockets.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+delete_removed_sockets() {
   if (!_removed_sockets.empty()) {
+    Sockets::const_iterator si;
     Sockets still_busy_sockets;
     for (si = _removed_sockets.begin(); si != _removed_sockets.end(); ++si) {
       SocketInfo *sinfo = (*si);
@@ -1003,9 +1073,22 @@ rebuild_select_list() {
 //               ConnectionListener) to the indicated fdset.  This is
 //               used by ConnectionManager::block() to build an fdset
 //               of all attached readers.
+//
+//               The return value is true if this reader already knows
+//               of a socket with activity on it, in which case the
+//               caller should not wait at all.
 ////////////////////////////////////////////////////////////////////
-void ConnectionReader::
+bool ConnectionReader::
 accumulate_fdset(Socket_fdset &fdset) {
+  if (_epoll_fd >= 0) {
+    // The epoll descriptor itself becomes readable when any of its
+    // sockets has activity, but that doesn't count the activity we
+    // have already collected and not yet processed.
+    fdset.setForSocketNative(_epoll_fd);
+    MutexHolder holder(_select_mutex);
+    return (_epoll_next < (int)_epoll_ready.size());
+  }
+
   LightMutexHolder holder(_sockets_mutex);
   Sockets::const_iterator si;
   for (si = _sockets.begin(); si != _sockets.end(); ++si) {
@@ -1014,4 +1097,150 @@ accumulate_fdset(Socket_fdset &fdset) {
       fdset.setForSocket(*sinfo->get_socket());
     }
   }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::get_next_epoll_socket
+//       Access: Private
+//  Description: The epoll() implementation of
+//               get_next_available_socket().  The caller must hold
+//               _select_mutex.
+////////////////////////////////////////////////////////////////////
+ConnectionReader::SocketInfo *ConnectionReader::
+get_next_epoll_socket(bool allow_block, int current_thread_index) {
+#ifdef HAVE_EPOLL
+  do {
+    // First, hand out the sockets reported by the previous call.
+    // Each one is reported only once until finish_socket() rearms
+    // it, so none of them can be busy already.
+    if (!_shutdown && _epoll_next < (int)_epoll_ready.size()) {
+      SocketInfo *sinfo = _epoll_ready[_epoll_next];
+      _epoll_next++;
+      sinfo->_busy = true;
+      return sinfo;
+    }
+
+    _epoll_ready.clear();
+    _epoll_next = 0;
+
+    // Now that we are not holding any pointers to sockets, it's a
+    // fine time to delete the ones that have been removed.
+    {
+      LightMutexHolder holder(_sockets_mutex);
+      delete_removed_sockets();
+    }
+
+    struct epoll_event events[max_epoll_events];
+    int num_results = 0;
+
+    bool interrupted;
+    do {
+      interrupted = false;
+      AtomicAdjust::set(_currently_polling_thread, current_thread_index);
+
+      num_results = 0;
+      if (!_shutdown) {
+        int timeout = (int)(get_net_max_block() * 1000.0);
+        if (!allow_block) {
+          timeout = 0;
+        }
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+        timeout = 0;
+#endif
+        num_results = epoll_wait(_epoll_fd, events, max_epoll_events, timeout);
+        if (num_results < 0 && errno == EINTR) {
+          num_results = 0;
+        }
+      }
+
+      if (num_results == 0 && allow_block) {
+        interrupted = true;
+        Thread::force_yield();
+
+      } else if (num_results < 0) {
+        Thread::force_yield();
+        return (SocketInfo *)NULL;
+      }
+    } while (!_shutdown && interrupted);
+
+    for (int i = 0; i < num_results; ++i) {
+      _epoll_ready.push_back((SocketInfo *)events[i].data.ptr);
+    }
+
+  } while (!_shutdown && !_epoll_ready.empty());
+#endif  // HAVE_EPOLL
+
+  return (SocketInfo *)NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::epoll_register
+//       Access: Private
+//  Description: Adds the indicated socket to the epoll set.  The
+//               caller must hold _sockets_mutex.
+//
+//               The socket is registered level-triggered but
+//               one-shot, so that it is reported to only one thread,
+//               once, until finish_socket() rearms it.  This keeps
+//               the same contract as the select() implementation,
+//               which reads one datagram at a time from a blocking
+//               socket, while still waking only for active sockets.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+epoll_register(SocketInfo *sinfo) {
+#ifdef HAVE_EPOLL
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLONESHOT;
+  event.data.ptr = sinfo;
+  if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, sinfo->get_socket()->GetSocket(),
+                &event) != 0) {
+    net_cat.error()
+      << "Unable to add socket to epoll set: errno " << errno << "\n";
+    sinfo->_error = true;
+    return;
+  }
+  sinfo->_registered = true;
+#endif  // HAVE_EPOLL
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::epoll_unregister
+//       Access: Private
+//  Description: Removes the indicated socket from the epoll set.  The
+//               caller must hold _sockets_mutex.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+epoll_unregister(SocketInfo *sinfo) {
+#ifdef HAVE_EPOLL
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, sinfo->get_socket()->GetSocket(),
+            &event);
+  sinfo->_registered = false;
+#endif  // HAVE_EPOLL
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::epoll_rearm
+//       Access: Private
+//  Description: Makes the indicated socket eligible to be reported by
+//               epoll again, after it has been read.  The caller must
+//               hold _sockets_mutex.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+epoll_rearm(SocketInfo *sinfo) {
+#ifdef HAVE_EPOLL
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLONESHOT;
+  event.data.ptr = sinfo;
+  if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, sinfo->get_socket()->GetSocket(),
+                &event) != 0) {
+    net_cat.error()
+      << "Unable to rearm socket in epoll set: errno " << errno << "\n";
+    sinfo->_error = true;
+  }
+#endif  // HAVE_EPOLL
 }
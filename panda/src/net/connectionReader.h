@@ -80,6 +80,7 @@ PUBLISHED:
   ConnectionManager *get_manager() const;
   INLINE bool is_polling() const;
   int get_num_threads() const;
+  INLINE bool get_use_epoll() const;
 
   void set_raw_mode(bool mode);
   bool get_raw_mode() const;
@@ -102,6 +103,7 @@ protected:
     PT(Connection) _connection;
     bool _busy;
     bool _error;
+    bool _registered;
   };
   typedef pvector<SocketInfo *> Sockets;
 
@@ -133,7 +135,14 @@ private:
                                         int current_thread_index);
 
   void rebuild_select_list();
-  void accumulate_fdset(Socket_fdset &fdset);
+  void delete_removed_sockets();
+  bool accumulate_fdset(Socket_fdset &fdset);
+
+  SocketInfo *get_next_epoll_socket(bool allow_block,
+                                    int current_thread_index);
+  void epoll_register(SocketInfo *sinfo);
+  void epoll_unregister(SocketInfo *sinfo);
+  void epoll_rearm(SocketInfo *sinfo);
 
 private:
   bool _raw_mode;
@@ -164,6 +173,14 @@ private:
   // read a socket.
   Mutex _select_mutex;
 
+  // These are used instead of the above when the reader is using
+  // epoll().  Each socket is registered once, and is rearmed in
+  // finish_socket() after its datagram has been read.  _epoll_fd is
+  // -1 if we are using select().
+  int _epoll_fd;
+  Sockets _epoll_ready;
+  int _epoll_next;
+
   // This is atomically updated with the index (in _threads) of the
   // thread that is currently waiting on the PR_Poll() call.  It
   // contains -1 if no thread is so waiting.
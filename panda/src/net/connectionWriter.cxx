@@ -20,6 +20,7 @@
 #include "socket_udp.h"
 #include "pnotify.h"
 #include "config_downloader.h"
+#include "pmap.h"
 
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionWriter::WriterThread::Constructor
@@ -78,6 +79,12 @@ ConnectionWriter(ConnectionManager *manager, int num_threads,
   _immediate = (num_threads <= 0);
   _shutdown = false;
 
+  _batch_mode = net_batch_writes;
+  _batch_latency = net_batch_latency;
+  _batch_max_datagrams = net_batch_max_datagrams;
+  _num_batched_datagrams = 0;
+  _num_batch_syscalls = 0;
+
   string writer_thread_name = thread_name;
   if (thread_name.empty()) {
     writer_thread_name = "WriterThread";
@@ -331,6 +338,98 @@ get_tcp_header_size() const {
   return _tcp_header_size;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::set_batch_mode
+//       Access: Published
+//  Description: Sets the ConnectionWriter into batch mode (or turns
+//               off batch mode).  In batch mode, each writer thread
+//               takes all of the datagrams waiting in the queue at
+//               once, and writes all of the datagrams for each
+//               connection with a single writev() call (or, for UDP
+//               on Linux, a single sendmmsg() call), without first
+//               copying them into a common buffer.
+//
+//               This only has an effect on a threaded
+//               ConnectionWriter; if num_threads is 0, all datagrams
+//               are sent immediately.  The default is taken from
+//               net-batch-writes.
+////////////////////////////////////////////////////////////////////
+void ConnectionWriter::
+set_batch_mode(bool mode) {
+  _batch_mode = mode;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::get_batch_mode
+//       Access: Published
+//  Description: Returns the current setting of the batch mode flag.
+//               See set_batch_mode().
+////////////////////////////////////////////////////////////////////
+bool ConnectionWriter::
+get_batch_mode() const {
+  return _batch_mode;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::set_batch_latency
+//       Access: Published
+//  Description: Specifies the maximum time, in seconds, that a writer
+//               thread in batch mode will hold a datagram while
+//               waiting for more datagrams to send along with it.
+//               Larger values save more system calls, at the cost of
+//               added latency.  The default is taken from
+//               net-batch-latency.
+////////////////////////////////////////////////////////////////////
+void ConnectionWriter::
+set_batch_latency(double latency) {
+  _batch_latency = latency;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::get_batch_latency
+//       Access: Published
+//  Description: Returns the current batch latency.  See
+//               set_batch_latency().
+////////////////////////////////////////////////////////////////////
+double ConnectionWriter::
+get_batch_latency() const {
+  return _batch_latency;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::get_num_batched_datagrams
+//       Access: Published
+//  Description: Returns the total number of datagrams that have been
+//               sent in batch mode by this writer.
+////////////////////////////////////////////////////////////////////
+int ConnectionWriter::
+get_num_batched_datagrams() const {
+  return (int)AtomicAdjust::get(_num_batched_datagrams);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::get_num_batch_syscalls
+//       Access: Published
+//  Description: Returns the total number of system calls made to send
+//               the datagrams counted by get_num_batched_datagrams().
+////////////////////////////////////////////////////////////////////
+int ConnectionWriter::
+get_num_batch_syscalls() const {
+  return (int)AtomicAdjust::get(_num_batch_syscalls);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::get_num_syscalls_saved
+//       Access: Published
+//  Description: Returns the number of system calls that batch mode
+//               has saved so far, compared to sending each datagram
+//               with its own call.
+////////////////////////////////////////////////////////////////////
+int ConnectionWriter::
+get_num_syscalls_saved() const {
+  return get_num_batched_datagrams() - get_num_batch_syscalls();
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionWriter::shutdown
 //       Access: Published
@@ -384,12 +483,59 @@ thread_run(int thread_index) {
   nassertv(!_immediate);
 
   NetDatagram datagram;
-  while (_queue.extract(datagram)) {
-    if (_raw_mode) {
-      datagram.get_connection()->send_raw_datagram(datagram);
+  Batch batch;
+  while (true) {
+    if (_batch_mode) {
+      if (!_queue.extract_batch(batch, _batch_max_datagrams, _batch_latency)) {
+        break;
+      }
+      send_batch(batch);
+      batch.clear();
+
     } else {
-      datagram.get_connection()->send_datagram(datagram, _tcp_header_size);
+      if (!_queue.extract(datagram)) {
+        break;
+      }
+      if (_raw_mode) {
+        datagram.get_connection()->send_raw_datagram(datagram);
+      } else {
+        datagram.get_connection()->send_datagram(datagram, _tcp_header_size);
+      }
     }
     Thread::consider_yield();
   }
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::send_batch
+//       Access: Private
+//  Description: Sends all of the datagrams in the batch, with one
+//               call to Connection::send_datagram_batch() for each
+//               different connection.  The datagrams for each
+//               connection are sent in the order they were queued.
+////////////////////////////////////////////////////////////////////
+void ConnectionWriter::
+send_batch(const Batch &batch) {
+  typedef pvector<const NetDatagram *> Datagrams;
+  typedef pmap<Connection *, Datagrams> ByConnection;
+  ByConnection by_connection;
+
+  Batch::const_iterator bi;
+  for (bi = batch.begin(); bi != batch.end(); ++bi) {
+    by_connection[(*bi).get_connection()].push_back(&(*bi));
+  }
+
+  ByConnection::iterator ci;
+  for (ci = by_connection.begin(); ci != by_connection.end(); ++ci) {
+    Connection *connection = (*ci).first;
+    const Datagrams &datagrams = (*ci).second;
+
+    int num_syscalls = 0;
+    connection->send_datagram_batch(&datagrams[0], (int)datagrams.size(),
+                                    _tcp_header_size, _raw_mode,
+                                    num_syscalls);
+
+    AtomicAdjust::add(_num_batched_datagrams, (AtomicAdjust::Integer)datagrams.size());
+    AtomicAdjust::add(_num_batch_syscalls, num_syscalls);
+  }
+}
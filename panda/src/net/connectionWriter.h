@@ -21,6 +21,7 @@
 #include "pointerTo.h"
 #include "thread.h"
 #include "pvector.h"
+#include "atomicAdjust.h"
 
 class ConnectionManager;
 class NetAddress;
@@ -66,14 +67,26 @@ PUBLISHED:
   void set_tcp_header_size(int tcp_header_size);
   int get_tcp_header_size() const;
 
+  void set_batch_mode(bool mode);
+  bool get_batch_mode() const;
+  void set_batch_latency(double latency);
+  double get_batch_latency() const;
+
+  int get_num_batched_datagrams() const;
+  int get_num_batch_syscalls() const;
+  int get_num_syscalls_saved() const;
+
   void shutdown();
 
 protected:
   void clear_manager();
 
 private:
+  typedef pvector<NetDatagram> Batch;
+
   void thread_run(int thread_index);
   bool send_datagram(const NetDatagram &datagram);
+  void send_batch(const Batch &batch);
 
 protected:
   ConnectionManager *_manager;
@@ -84,6 +97,12 @@ private:
   DatagramQueue _queue;
   bool _shutdown;
 
+  bool _batch_mode;
+  double _batch_latency;
+  int _batch_max_datagrams;
+  AtomicAdjust::Integer _num_batched_datagrams;
+  AtomicAdjust::Integer _num_batch_syscalls;
+
   class WriterThread : public Thread {
   public:
     WriterThread(ConnectionWriter *writer, const string &thread_name,
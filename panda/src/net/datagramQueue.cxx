@@ -15,6 +15,7 @@
 #include "datagramQueue.h"
 #include "config_net.h"
 #include "mutexHolder.h"
+#include "trueClock.h"
 
 ////////////////////////////////////////////////////////////////////
 //     Function: DatagramQueue::Constructor
@@ -141,6 +142,59 @@ extract(NetDatagram &result) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramQueue::extract_batch
+//       Access: Public
+//  Description: Extracts up to max_count datagrams from the head of
+//               the queue at once, appending them to result.  This
+//               blocks until at least one datagram is available, like
+//               extract(); then, if max_latency is greater than zero,
+//               it waits up to that many seconds longer for the queue
+//               to fill up to max_count, so that more datagrams may
+//               be sent together.
+//
+//               The return value is true if any datagrams were
+//               extracted, or false if the queue was destroyed while
+//               waiting.
+////////////////////////////////////////////////////////////////////
+bool DatagramQueue::
+extract_batch(pvector<NetDatagram> &result, int max_count,
+              double max_latency) {
+  MutexHolder holder(_cvlock);
+
+  while (_queue.empty() && !_shutdown) {
+    _cv.wait();
+  }
+
+  if (max_latency > 0.0) {
+    TrueClock *clock = TrueClock::get_global_ptr();
+    double stop = clock->get_short_time() + max_latency;
+    while ((int)_queue.size() < max_count && !_shutdown) {
+      double remaining = stop - clock->get_short_time();
+      if (remaining <= 0.0) {
+        break;
+      }
+      _cv.wait(remaining);
+    }
+  }
+
+  if (_shutdown) {
+    return false;
+  }
+
+  nassertr(!_queue.empty(), false);
+  int count = min((int)_queue.size(), max(max_count, 1));
+  for (int i = 0; i < count; ++i) {
+    result.push_back(_queue.front());
+    _queue.pop_front();
+  }
+
+  // Wake up any threads waiting to stuff things into the queue.
+  _cv.notify_all();
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: DatagramQueue::set_max_queue_size
 //       Access: Public
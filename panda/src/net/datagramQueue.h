@@ -21,6 +21,7 @@
 #include "pmutex.h"
 #include "conditionVarFull.h"
 #include "pdeque.h"
+#include "pvector.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : DatagramQueue
@@ -36,6 +37,8 @@ public:
 
   bool insert(const NetDatagram &data, bool block = false);
   bool extract(NetDatagram &result);
+  bool extract_batch(pvector<NetDatagram> &result, int max_count,
+                     double max_latency);
 
   void set_max_queue_size(int max_size);
   int get_max_queue_size() const;
@@ -0,0 +1,329 @@
+// Filename: test_net_load.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+
+#include "queuedConnectionManager.h"
+#include "queuedConnectionListener.h"
+#include "queuedConnectionReader.h"
+#include "connectionWriter.h"
+#include "netAddress.h"
+#include "connection.h"
+#include "netDatagram.h"
+#include "datagramIterator.h"
+#include "config_net.h"
+#include "load_prc_file.h"
+#include "trueClock.h"
+#include "thread.h"
+
+#include "pvector.h"
+
+// This program opens the indicated number of TCP connections to
+// itself over the loopback interface, or with -u, the indicated
+// number of UDP sockets all sending to one server socket.  It sends
+// the indicated number of rounds of datagrams on each one, several
+// per connection per round, measuring the rate at which a
+// QueuedConnectionReader receives them.  Every datagram is checked on
+// receipt, to make sure it arrived intact and in order.
+//
+// Run it with and without -e to compare the epoll() and select()
+// implementations, and with and without -b to compare batched and
+// unbatched writes.  With -u -b, the writes go through sendmmsg().
+
+// The number of uint32 words of filler in each datagram, after the
+// client index and the sequence number.
+static const int num_payload_words = 8;
+
+static void
+usage() {
+  nout << "test_net_load [-e] [-b] [-u] [-n per_round] [-t num_threads] port num_clients num_rounds\n\n"
+       << "  -e   Use epoll() (net-use-epoll) instead of select().\n"
+       << "  -b   Send with a threaded ConnectionWriter in batch mode.\n"
+       << "  -u   Send UDP datagrams instead of opening TCP connections.\n"
+       << "       Since UDP may drop datagrams once the server's socket\n"
+       << "       buffer is full, keep num_clients * per_round modest.\n"
+       << "  -n   Number of datagrams to send on each connection per round.\n"
+       << "       The default is 16.\n"
+       << "  -t   Number of reader threads; 0 means to poll.  The default is 1.\n";
+  exit(1);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: make_datagram
+//  Description: Fills in the datagram for the indicated client and
+//               sequence number.  The filler words depend on both, so
+//               that a corrupted or misdelivered datagram is caught.
+////////////////////////////////////////////////////////////////////
+static void
+make_datagram(NetDatagram &datagram, int client, int sequence) {
+  datagram.clear();
+  datagram.add_uint32(client);
+  datagram.add_uint32(sequence);
+  for (int i = 0; i < num_payload_words; ++i) {
+    datagram.add_uint32((PN_uint32)(client * 2654435761u) ^ (sequence + i));
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_datagram
+//  Description: Checks that the indicated datagram is intact, and is
+//               the next one expected from its client.  Returns true
+//               if so, or false after reporting the problem.
+//
+//               next_sequence holds the sequence number expected
+//               next from each client.  With TCP, sources records the
+//               connection each client's datagrams arrive on, which
+//               must not change.
+////////////////////////////////////////////////////////////////////
+static bool
+check_datagram(const NetDatagram &datagram, pvector<int> &next_sequence,
+               pvector<Connection *> &sources, bool use_udp) {
+  static const size_t expected_length = (2 + num_payload_words) * 4;
+  if (datagram.get_length() != expected_length) {
+    nout << "Received a datagram of " << datagram.get_length()
+         << " bytes, expected " << expected_length << ".\n";
+    return false;
+  }
+
+  DatagramIterator dgi(datagram);
+  PN_uint32 client = dgi.get_uint32();
+  int sequence = (int)dgi.get_uint32();
+  if (client >= next_sequence.size()) {
+    nout << "Received a datagram from unknown client " << client << ".\n";
+    return false;
+  }
+
+  if (sequence != next_sequence[client]) {
+    nout << "Received datagram " << sequence << " from client " << client
+         << ", expected " << next_sequence[client] << ".\n";
+    return false;
+  }
+  ++next_sequence[client];
+
+  for (int i = 0; i < num_payload_words; ++i) {
+    PN_uint32 expected = (PN_uint32)(client * 2654435761u) ^ (sequence + i);
+    if (dgi.get_uint32() != expected) {
+      nout << "Datagram " << sequence << " from client " << client
+           << " is corrupted.\n";
+      return false;
+    }
+  }
+
+  if (!use_udp) {
+    Connection *source = datagram.get_connection();
+    if (sources[client] == (Connection *)NULL) {
+      sources[client] = source;
+    } else if (sources[client] != source) {
+      nout << "Datagram " << sequence << " from client " << client
+           << " arrived on the wrong connection.\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: accept_connections
+//  Description: Accepts whatever new TCP connections are waiting on
+//               the listener, and adds them to the reader.
+////////////////////////////////////////////////////////////////////
+static void
+accept_connections(QueuedConnectionListener &listener,
+                   QueuedConnectionReader &reader,
+                   pvector< PT(Connection) > &servers) {
+  while (listener.new_connection_available()) {
+    PT(Connection) rv;
+    NetAddress address;
+    PT(Connection) new_connection;
+    if (listener.get_new_connection(rv, address, new_connection)) {
+      reader.add_connection(new_connection);
+      servers.push_back(new_connection);
+    }
+  }
+}
+
+int
+main(int argc, char *argv[]) {
+  bool use_epoll = false;
+  bool batch_writes = false;
+  bool use_udp = false;
+  int per_round = 16;
+  int num_threads = 1;
+
+  int ai = 1;
+  while (ai < argc && argv[ai][0] == '-') {
+    string arg = argv[ai];
+    if (arg == "-e") {
+      use_epoll = true;
+    } else if (arg == "-b") {
+      batch_writes = true;
+    } else if (arg == "-u") {
+      use_udp = true;
+    } else if (arg == "-n" && ai + 1 < argc) {
+      ++ai;
+      per_round = atoi(argv[ai]);
+    } else if (arg == "-t" && ai + 1 < argc) {
+      ++ai;
+      num_threads = atoi(argv[ai]);
+    } else {
+      usage();
+    }
+    ++ai;
+  }
+  if (argc - ai != 3 || per_round < 1) {
+    usage();
+  }
+
+  int port = atoi(argv[ai]);
+  int num_clients = atoi(argv[ai + 1]);
+  int num_rounds = atoi(argv[ai + 2]);
+
+  if (use_epoll) {
+    load_prc_file_data("test_net_load", "net-use-epoll 1");
+  }
+
+  typedef pvector< PT(Connection) > Connections;
+  Connections clients;
+  Connections servers;
+
+  QueuedConnectionManager server_cm;
+  QueuedConnectionManager client_cm;
+  QueuedConnectionReader reader(&server_cm, num_threads);
+  QueuedConnectionListener listener(&server_cm, 0);
+  ConnectionWriter writer(&client_cm, batch_writes ? 1 : 0);
+  writer.set_batch_mode(batch_writes);
+
+  nout << "Reader is using " << (reader.get_use_epoll() ? "epoll" : "select")
+       << " with " << reader.get_num_threads() << " threads.\n";
+
+  NetAddress server_address;
+  server_address.set_host("127.0.0.1", port);
+
+  if (use_udp) {
+    // All of the clients send to the same server socket.
+    PT(Connection) server = server_cm.open_UDP_connection(port);
+    if (server.is_null()) {
+      nout << "Cannot grab port " << port << ".\n";
+      exit(1);
+    }
+    reader.add_connection(server);
+    servers.push_back(server);
+
+    for (int i = 0; i < num_clients; ++i) {
+      PT(Connection) client = client_cm.open_UDP_connection();
+      if (client.is_null()) {
+        nout << "Could only open " << i << " sockets.\n";
+        break;
+      }
+      clients.push_back(client);
+    }
+
+  } else {
+    PT(Connection) rendezvous =
+      server_cm.open_TCP_server_rendezvous(port, num_clients);
+    if (rendezvous.is_null()) {
+      nout << "Cannot grab port " << port << ".\n";
+      exit(1);
+    }
+    listener.add_connection(rendezvous);
+
+    // Open all of the client connections, and accept them on the
+    // server side as they come in.
+    for (int i = 0; i < num_clients; ++i) {
+      PT(Connection) client =
+        client_cm.open_TCP_client_connection("127.0.0.1", port, 5000);
+      if (client.is_null()) {
+        nout << "Could only open " << i << " connections.\n";
+        break;
+      }
+      clients.push_back(client);
+      accept_connections(listener, reader, servers);
+    }
+
+    while (servers.size() < clients.size()) {
+      accept_connections(listener, reader, servers);
+      Thread::sleep(0.001);
+    }
+  }
+
+  nout << "Opened " << clients.size() << (use_udp ? " UDP sockets" : " connections")
+       << ", sending " << per_round << " datagrams on each per round.\n";
+
+  pvector<int> next_sequence(clients.size(), 0);
+  pvector<Connection *> sources(clients.size(), (Connection *)NULL);
+
+  // Send per_round datagrams on each connection per round, and wait
+  // for them all to arrive before starting the next round, so that
+  // we never fill up the socket buffers.
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start = clock->get_short_time();
+
+  NetDatagram datagram;
+  int num_sent = 0;
+  int num_received = 0;
+  bool ok = true;
+  for (int round = 0; round < num_rounds && ok; ++round) {
+    for (int c = 0; c < (int)clients.size(); ++c) {
+      for (int j = 0; j < per_round; ++j) {
+        make_datagram(datagram, c, round * per_round + j);
+        bool sent = use_udp ?
+          writer.send(datagram, clients[c], server_address) :
+          writer.send(datagram, clients[c]);
+        if (!sent) {
+          nout << "Unable to send datagram " << round * per_round + j
+               << " from client " << c << ".\n";
+          ok = false;
+          break;
+        }
+        ++num_sent;
+      }
+    }
+
+    double round_stop = clock->get_short_time() + 10.0;
+    while (ok && num_received < num_sent) {
+      if (reader.data_available()) {
+        NetDatagram received;
+        if (reader.get_data(received)) {
+          ++num_received;
+          ok = check_datagram(received, next_sequence, sources, use_udp);
+        }
+      } else {
+        if (clock->get_short_time() > round_stop) {
+          nout << "Timed out waiting for datagrams.\n";
+          ok = false;
+          break;
+        }
+        Thread::force_yield();
+      }
+    }
+  }
+
+  double elapsed = clock->get_short_time() - start;
+
+  nout << "Received " << num_received << " of " << num_sent
+       << " datagrams in " << elapsed << " seconds";
+  if (elapsed > 0.0) {
+    nout << ", " << (int)(num_received / elapsed) << " datagrams/sec";
+  }
+  nout << ".\n";
+
+  if (batch_writes) {
+    nout << "Writer made " << writer.get_num_batch_syscalls()
+         << " system calls for " << writer.get_num_batched_datagrams()
+         << " datagrams, saving " << writer.get_num_syscalls_saved() << ".\n";
+  }
+
+  return (ok && num_received == num_sent) ? 0 : 1;
+}
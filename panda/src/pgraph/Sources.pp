@@ -101,6 +101,7 @@
     shaderInput.I shaderInput.h \
     shaderPool.I shaderPool.h \
     showBoundsEffect.I showBoundsEffect.h \
+    stateInternTable.I stateInternTable.h \
     stateMunger.I stateMunger.h \
     stencilAttrib.I stencilAttrib.h \
     texMatrixAttrib.I texMatrixAttrib.h \
@@ -311,6 +312,7 @@
     shaderInput.I shaderInput.h \
     shaderPool.I shaderPool.h \
     showBoundsEffect.I showBoundsEffect.h \
+    stateInternTable.I stateInternTable.h \
     stateMunger.I stateMunger.h \
     stencilAttrib.I stencilAttrib.h \
     texMatrixAttrib.I texMatrixAttrib.h \
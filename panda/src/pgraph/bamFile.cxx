@@ -34,6 +34,7 @@ BamFile::
 BamFile() {
   _reader = NULL;
   _writer = NULL;
+  _file_indexed = false;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -281,6 +282,9 @@ close() {
     _reader = NULL;
   }
   if (_writer != (BamWriter *)NULL) {
+    if (_writer->get_file_indexed()) {
+      _writer->write_index();
+    }
     delete _writer;
     _writer = NULL;
   }
@@ -309,12 +313,15 @@ get_file_major_ver() {
 //     Function: BamFile::get_file_minor_ver
 //       Access: Public
 //  Description: Returns the minor version number of the file
-//               currently being read, or the system current minor
-//               version number if no file is currently open for
-//               reading.
+//               currently being read or written, or the system
+//               current minor version number if no file is currently
+//               open.
 ////////////////////////////////////////////////////////////////////
 int BamFile::
 get_file_minor_ver() {
+  if (_writer != (BamWriter *)NULL) {
+    return _writer->get_file_minor_ver();
+  }
   if (_reader == (BamReader *)NULL) {
     return _bam_minor_ver;
   }
@@ -469,6 +476,7 @@ continue_open_write(const string &bam_filename, bool report_errors) {
   }
 
   _writer = new BamWriter(&_dout);
+  _writer->set_file_indexed(_file_indexed);
 
   if (!_writer->init()) {
     close();
@@ -58,6 +58,12 @@ PUBLISHED:
 
   PT(PandaNode) read_node(bool report_errors = true);
 
+  INLINE void set_compression_codec(CompressionCodec *codec);
+  INLINE CompressionCodec *get_compression_codec() const;
+
+  INLINE void set_file_indexed(bool file_indexed);
+  INLINE bool get_file_indexed() const;
+
   bool open_write(const Filename &bam_filename, bool report_errors = true);
   bool open_write(ostream &out, const string &bam_filename = "stream",
                   bool report_errors = true);
@@ -87,6 +93,7 @@ private:
   DatagramOutputFile _dout;
   BamReader *_reader;
   BamWriter *_writer;
+  bool _file_indexed;
 };
 
 #include "bamFile.I"
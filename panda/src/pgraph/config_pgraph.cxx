@@ -209,6 +209,24 @@ ConfigVariableDouble garbage_collect_states_rate
           "performance if states accumulate faster than they can be "
           "cleaned up."));
 
+ConfigVariableInt garbage_collect_states_budget
+("garbage-collect-states-budget", 0,
+ PRC_DESC("The maximum number of TransformStates (or RenderStates) that "
+          "are examined with each garbage collection step, in addition "
+          "to the limit imposed by garbage-collect-states-rate.  Each "
+          "step resumes where the previous one left off, so a small "
+          "budget spreads the work of a large state cache evenly over "
+          "several frames.  Set this to 0 for no limit."));
+
+ConfigVariableInt garbage_collect_cycles_budget
+("garbage-collect-cycles-budget", 0,
+ PRC_DESC("The maximum number of states that are checked for "
+          "reference-count cycles (see auto-break-cycles) with each "
+          "garbage collection step.  This check walks the state's "
+          "composition cache and may be much more expensive than "
+          "simply examining the state, so it is budgeted separately.  "
+          "Set this to 0 for no limit."));
+
 ConfigVariableBool transform_cache
 ("transform-cache", true,
  PRC_DESC("Set this true to enable the cache of TransformState objects.  "
@@ -344,6 +344,9 @@ parse_bin_type(const string &bin_type) {
   } else if (cmp_nocase_uh(bin_type, "front_to_back") == 0) {
     return BT_front_to_back;
 
+  } else if (cmp_nocase_uh(bin_type, "instanced") == 0) {
+    return BT_instanced;
+
   } else {
     return BT_invalid;
   }
@@ -373,6 +376,9 @@ operator << (ostream &out, CullBinManager::BinType bin_type) {
     
   case CullBinManager::BT_fixed:
     return out << "fixed";
+
+  case CullBinManager::BT_instanced:
+    return out << "instanced";
   }
 
   return out << "**invalid BinType(" << (int)bin_type << ")**";
@@ -47,6 +47,8 @@ int RenderState::_garbage_index = 0;
 
 PStatCollector RenderState::_cache_update_pcollector("*:State Cache:Update");
 PStatCollector RenderState::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
+PStatCollector RenderState::_gc_visited_pcollector("State GC Visited:RenderState");
+PStatCollector RenderState::_gc_freed_pcollector("State GC Freed:RenderState");
 PStatCollector RenderState::_state_compose_pcollector("*:State Cache:Compose State");
 PStatCollector RenderState::_state_invert_pcollector("*:State Cache:Invert State");
 PStatCollector RenderState::_node_counter("RenderStates:On nodes");
@@ -54,6 +56,8 @@ PStatCollector RenderState::_cache_counter("RenderStates:Cached");
 PStatCollector RenderState::_state_break_cycles_pcollector("*:State Cache:Break Cycles");
 PStatCollector RenderState::_state_validate_pcollector("*:State Cache:Validate");
 
+PStatCollector RenderState::_states_lock_wait_pcollector("*:State Cache:Lock Wait:RenderState");
+
 CacheStats RenderState::_cache_stats;
 
 TypeHandle RenderState::_type_handle;
@@ -141,7 +145,7 @@ RenderState::
   nassertv(!is_destructing());
   set_destructing();
 
-  LightReMutexHolder holder(*_states_lock);
+  StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
 
   // unref() should have cleared these.
   nassertv(_saved_entry == -1);
@@ -413,66 +417,33 @@ compose(const RenderState *other) const {
     return do_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
   // Is this composition already cached?
-  int index = _composition_cache.find(other);
-  if (index != -1) {
-    Composition &comp = ((RenderState *)this)->_composition_cache.modify_data(index);
-    if (comp._result == (const RenderState *)NULL) {
-      // Well, it wasn't cached already, but we already had an entry
-      // (probably created for the reverse direction), so use the same
-      // entry to store the new result.
-      CPT(RenderState) result = do_compose(other);
-      comp._result = result;
-
-      if (result != (const RenderState *)this) {
-        // See the comments below about the need to up the reference
-        // count only when the result is not the same as this.
-        result->cache_ref();
-      }
+  CPT(RenderState) result;
+  {
+    StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
+    int index = _composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _composition_cache.get_data(index);
+      result = comp._result;
+    }
+    if (result != (RenderState *)NULL) {
+      _cache_stats.inc_hits();
     }
-    // Here's the cache!
-    _cache_stats.inc_hits();
-    return comp._result;
-  }
-  _cache_stats.inc_misses();
-
-  // We need to make a new cache entry, both in this object and in the
-  // other object.  We make both records so the other RenderState
-  // object will know to delete the entry from this object when it
-  // destructs, and vice-versa.
-
-  // The cache entry in this object is the only one that indicates the
-  // result; the other will be NULL for now.
-  CPT(RenderState) result = do_compose(other);
-
-  _cache_stats.add_total_size(1);
-  _cache_stats.inc_adds(_composition_cache.get_size() == 0);
-
-  ((RenderState *)this)->_composition_cache[other]._result = result;
-
-  if (other != this) {
-    _cache_stats.add_total_size(1);
-    _cache_stats.inc_adds(other->_composition_cache.get_size() == 0);
-    ((RenderState *)other)->_composition_cache[this]._result = NULL;
   }
 
-  if (result != (const RenderState *)this) {
-    // If the result of compose() is something other than this,
-    // explicitly increment the reference count.  We have to be sure
-    // to decrement it again later, when the composition entry is
-    // removed from the cache.
-    result->cache_ref();
-    
-    // (If the result was just this again, we still store the
-    // result, but we don't increment the reference count, since
-    // that would be a self-referential leak.)
+  if (result != (RenderState *)NULL) {
+    // Success!
+    return result;
   }
 
-  _cache_stats.maybe_report("RenderState");
+  // Not in the cache.  Compute a new result.  It's important that we
+  // don't hold the lock while we do this, or we lose the benefit of
+  // parallelization.
+  result = do_compose(other);
 
-  return result;
+  // It's OK to cast away the constness of this pointer, because the
+  // cache is a transparent property of the class.
+  return ((RenderState *)this)->store_compose(other, result);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -508,63 +479,33 @@ invert_compose(const RenderState *other) const {
     return do_invert_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
   // Is this composition already cached?
-  int index = _invert_composition_cache.find(other);
-  if (index != -1) {
-    Composition &comp = ((RenderState *)this)->_invert_composition_cache.modify_data(index);
-    if (comp._result == (const RenderState *)NULL) {
-      // Well, it wasn't cached already, but we already had an entry
-      // (probably created for the reverse direction), so use the same
-      // entry to store the new result.
-      CPT(RenderState) result = do_invert_compose(other);
-      comp._result = result;
-
-      if (result != (const RenderState *)this) {
-        // See the comments below about the need to up the reference
-        // count only when the result is not the same as this.
-        result->cache_ref();
-      }
+  CPT(RenderState) result;
+  {
+    StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
+    int index = _invert_composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _invert_composition_cache.get_data(index);
+      result = comp._result;
+    }
+    if (result != (RenderState *)NULL) {
+      _cache_stats.inc_hits();
     }
-    // Here's the cache!
-    _cache_stats.inc_hits();
-    return comp._result;
   }
-  _cache_stats.inc_misses();
 
-  // We need to make a new cache entry, both in this object and in the
-  // other object.  We make both records so the other RenderState
-  // object will know to delete the entry from this object when it
-  // destructs, and vice-versa.
-
-  // The cache entry in this object is the only one that indicates the
-  // result; the other will be NULL for now.
-  CPT(RenderState) result = do_invert_compose(other);
-
-  _cache_stats.add_total_size(1);
-  _cache_stats.inc_adds(_invert_composition_cache.get_size() == 0);
-  ((RenderState *)this)->_invert_composition_cache[other]._result = result;
-
-  if (other != this) {
-    _cache_stats.add_total_size(1);
-    _cache_stats.inc_adds(other->_invert_composition_cache.get_size() == 0);
-    ((RenderState *)other)->_invert_composition_cache[this]._result = NULL;
+  if (result != (RenderState *)NULL) {
+    // Success!
+    return result;
   }
 
-  if (result != (const RenderState *)this) {
-    // If the result of compose() is something other than this,
-    // explicitly increment the reference count.  We have to be sure
-    // to decrement it again later, when the composition entry is
-    // removed from the cache.
-    result->cache_ref();
-    
-    // (If the result was just this again, we still store the
-    // result, but we don't increment the reference count, since
-    // that would be a self-referential leak.)
-  }
+  // Not in the cache.  Compute a new result.  It's important that we
+  // don't hold the lock while we do this, or we lose the benefit of
+  // parallelization.
+  result = do_invert_compose(other);
 
-  return result;
+  // It's OK to cast away the constness of this pointer, because the
+  // cache is a transparent property of the class.
+  return ((RenderState *)this)->store_invert_compose(other, result);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -706,7 +647,7 @@ unref() const {
   // be holding it if we happen to drop the reference count to 0.
   // Having to grab the lock at every call to unref() is a big
   // limiting factor on parallelization.
-  LightReMutexHolder holder(*_states_lock);
+  StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
 
   if (auto_break_cycles && uniquify_states) {
     if (get_cache_ref_count() > 0 &&
@@ -719,15 +660,22 @@ unref() const {
     }
   }
 
-  if (ReferenceCount::unref()) {
-    // The reference count is still nonzero.
-    return true;
-  }
+  {
+    // We must also hold the lock on our stripe of the _states table
+    // while we drop the reference, so that return_unique() can't
+    // find this object and ref it again after the count reaches 0.
+    StateLockHolder stripe_holder(_states->get_stripe_lock(this),
+                                  _states_lock_wait_pcollector);
+    if (ReferenceCount::unref()) {
+      // The reference count is still nonzero.
+      return true;
+    }
 
-  // The reference count has just reached zero.  Make sure the object
-  // is removed from the global object pool, before anyone else finds
-  // it and tries to ref it.
-  ((RenderState *)this)->release_new();
+    // The reference count has just reached zero.  Make sure the
+    // object is removed from the global object pool, before anyone
+    // else finds it and tries to ref it.
+    ((RenderState *)this)->release_new();
+  }
   ((RenderState *)this)->remove_cache_pointers();
 
   return false;
@@ -838,6 +786,7 @@ get_num_states() {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
   return _states->get_num_entries();
 }
 
@@ -865,6 +814,7 @@ get_num_unused_states() {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   // First, we need to count the number of times each RenderState
   // object is recorded in the cache.
@@ -963,6 +913,7 @@ clear_cache() {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   PStatTimer timer(_cache_update_pcollector);
   int orig_size = _states->get_num_entries();
@@ -1039,6 +990,13 @@ clear_cache() {
 //               this variable is not true, but there is probably no
 //               advantage in that case.
 //
+//               Each call examines only as many states as allowed by
+//               garbage-collect-states-rate,
+//               garbage-collect-states-budget, and
+//               garbage-collect-cycles-budget, resuming from where
+//               the previous call left off.  Returns the number of
+//               states freed.
+//
 //               This automatically calls
 //               RenderAttrib::garbage_collect() as well.
 ////////////////////////////////////////////////////////////////////
@@ -1050,23 +1008,33 @@ garbage_collect() {
     return num_attribs;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   PStatTimer timer(_garbage_collect_pcollector);
   int orig_size = _states->get_num_entries();
 
-  // How many elements to process this pass?
+  // How many elements to process this pass?  The rate limits the
+  // number of slots of the table we walk through, and the budget
+  // limits the number of states we actually examine.
   int size = _states->get_size();
   int num_this_pass = int(size * garbage_collect_states_rate);
   if (num_this_pass <= 0) {
     return num_attribs;
   }
   num_this_pass = min(num_this_pass, size);
-  int stop_at_element = (_garbage_index + num_this_pass) % size;
+  int budget = garbage_collect_states_budget;
+  int cycles_budget = garbage_collect_cycles_budget;
   
   int num_elements = 0;
+  int num_cycle_checks = 0;
   int si = _garbage_index;
-  do {
+  for (int i = 0; i < num_this_pass; ++i) {
     if (_states->has_element(si)) {
+      if (budget > 0 && num_elements >= budget) {
+        // That's all we have time for this pass.  We'll pick up again
+        // with this state next time.
+        break;
+      }
       ++num_elements;
       RenderState *state = (RenderState *)_states->get_key(si);
       if (auto_break_cycles && uniquify_states) {
@@ -1076,6 +1044,15 @@ garbage_collect() {
           // the cache, leaving only references in the cache, then we
           // need to check for a cycle involving this RenderState and
           // break it if it exists.
+
+          // Walking the composition cache can be expensive, so this is
+          // budgeted separately.  If we have used up this pass's share,
+          // stop here and start with this state next time.
+          if (cycles_budget > 0 && num_cycle_checks >= cycles_budget) {
+            --num_elements;
+            break;
+          }
+          ++num_cycle_checks;
           state->detect_and_break_cycles();
         }
       }
@@ -1095,11 +1072,14 @@ garbage_collect() {
     }      
 
     si = (si + 1) % size;
-  } while (si != stop_at_element);
+  }
   _garbage_index = si;
   nassertr(_states->validate(), 0);
 
   int new_size = _states->get_num_entries();
+  _gc_visited_pcollector.set_level(num_elements);
+  _gc_freed_pcollector.set_level(orig_size - new_size);
+
   return orig_size - new_size + num_attribs;
 }
 
@@ -1113,6 +1093,7 @@ garbage_collect() {
 void RenderState::
 clear_munger_cache() {
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   int size = _states->get_size();
   for (int si = 0; si < size; ++si) {
@@ -1120,6 +1101,7 @@ clear_munger_cache() {
       continue;
     }
     RenderState *state = (RenderState *)(_states->get_key(si));
+    LightMutexHolder munger_holder(state->_munger_lock);
     state->_mungers.clear();
     state->_last_mi = state->_mungers.end();
   }
@@ -1149,6 +1131,7 @@ list_cycles(ostream &out) {
     return;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   typedef pset<const RenderState *> VisitedStates;
   VisitedStates visited;
@@ -1232,6 +1215,7 @@ list_states(ostream &out) {
     return;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   out << _states->get_num_entries() << " states:\n";
 
@@ -1264,6 +1248,7 @@ validate_states() {
   PStatTimer timer(_state_validate_pcollector);
 
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
   if (_states->is_empty()) {
     return true;
   }
@@ -1530,20 +1515,21 @@ return_unique(RenderState *state) {
   }
 #endif
 
-  LightReMutexHolder holder(*_states_lock);
-
   if (state->_saved_entry != -1) {
     // This state is already in the cache.
-    //nassertr(_states->find(state) == state->_saved_entry, state);
     return state;
   }
 
   // Save the state in a local PointerTo so that it will be freed at
-  // the end of this function if no one else uses it.
+  // the end of this function if no one else uses it.  This must be
+  // declared before the lock holder below, so that the lock has been
+  // released by the time the state is freed.
   CPT(RenderState) pt_state = state;
 
   // Ensure each of the individual attrib pointers has been uniquified
-  // before we add the state to the cache.
+  // before we add the state to the cache.  No one else can see this
+  // state yet, so we don't need to hold a lock to do this; but it
+  // does have to be done before we compute the hash.
   if (!uniquify_attribs && !state->is_empty()) {
     SlotMask mask = state->_filled_slots;
     int slot = mask.get_lowest_on_bit();
@@ -1556,10 +1542,15 @@ return_unique(RenderState *state) {
     }    
   }
 
-  int si = _states->find(state);
-  if (si != -1) {
+  // We only need to lock the one stripe of the table in which this
+  // state belongs.
+  StateLockHolder holder(_states->get_stripe_lock(state),
+                         _states_lock_wait_pcollector);
+
+  const RenderState *found = _states->find(state);
+  if (found != (const RenderState *)NULL) {
     // There's an equivalent state already in the set.  Return it.
-    return _states->get_key(si);
+    return found;
   }
   
   // Not already in the set; add it.
@@ -1569,7 +1560,7 @@ return_unique(RenderState *state) {
     // that it won't be deleted while it's in it.
     state->cache_ref();
   }
-  si = _states->store(state, Empty());
+  int si = _states->store(state);
 
   // Save the index and return the input state.
   state->_saved_entry = si;
@@ -1644,6 +1635,150 @@ do_compose(const RenderState *other) const {
   return return_new(new_state);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: RenderState::store_compose
+//       Access: Private
+//  Description: Stores the result of a composition in the cache.
+//               Returns the stored result (it may be a different
+//               object than the one passed in, due to another thread
+//               having computed the composition first).
+////////////////////////////////////////////////////////////////////
+CPT(RenderState) RenderState::
+store_compose(const RenderState *other, const RenderState *result) {
+  // Empty states should have already been screened.
+  nassertr(!is_empty(), other);
+  nassertr(!other->is_empty(), this);
+
+  StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
+
+  // Is this composition already cached?
+  int index = _composition_cache.find(other);
+  if (index != -1) {
+    Composition &comp = _composition_cache.modify_data(index);
+    if (comp._result == (const RenderState *)NULL) {
+      // Well, it wasn't cached already, but we already had an entry
+      // (probably created for the reverse direction), so use the same
+      // entry to store the new result.
+      comp._result = result;
+
+      if (result != (const RenderState *)this) {
+        // See the comments below about the need to up the reference
+        // count only when the result is not the same as this.
+        result->cache_ref();
+      }
+    }
+    // Here's the cache!
+    _cache_stats.inc_hits();
+    return comp._result;
+  }
+  _cache_stats.inc_misses();
+
+  // We need to make a new cache entry, both in this object and in the
+  // other object.  We make both records so the other RenderState
+  // object will know to delete the entry from this object when it
+  // destructs, and vice-versa.
+
+  // The cache entry in this object is the only one that indicates the
+  // result; the other will be NULL for now.
+  _cache_stats.add_total_size(1);
+  _cache_stats.inc_adds(_composition_cache.get_size() == 0);
+
+  _composition_cache[other]._result = result;
+
+  if (other != this) {
+    _cache_stats.add_total_size(1);
+    _cache_stats.inc_adds(other->_composition_cache.get_size() == 0);
+    ((RenderState *)other)->_composition_cache[this]._result = NULL;
+  }
+
+  if (result != (const RenderState *)this) {
+    // If the result of do_compose() is something other than this,
+    // explicitly increment the reference count.  We have to be sure
+    // to decrement it again later, when the composition entry is
+    // removed from the cache.
+    result->cache_ref();
+    
+    // (If the result was just this again, we still store the
+    // result, but we don't increment the reference count, since
+    // that would be a self-referential leak.)
+  }
+
+  _cache_stats.maybe_report("RenderState");
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RenderState::store_invert_compose
+//       Access: Private
+//  Description: Stores the result of an inverse composition in the
+//               cache.  Returns the stored result (it may be a
+//               different object than the one passed in, due to
+//               another thread having computed the composition
+//               first).
+////////////////////////////////////////////////////////////////////
+CPT(RenderState) RenderState::
+store_invert_compose(const RenderState *other, const RenderState *result) {
+  // Empty states should have already been screened.
+  nassertr(!is_empty(), other);
+  nassertr(other != this, make_empty());
+
+  StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
+
+  // Is this composition already cached?
+  int index = _invert_composition_cache.find(other);
+  if (index != -1) {
+    Composition &comp = _invert_composition_cache.modify_data(index);
+    if (comp._result == (const RenderState *)NULL) {
+      // Well, it wasn't cached already, but we already had an entry
+      // (probably created for the reverse direction), so use the same
+      // entry to store the new result.
+      comp._result = result;
+
+      if (result != (const RenderState *)this) {
+        // See the comments below about the need to up the reference
+        // count only when the result is not the same as this.
+        result->cache_ref();
+      }
+    }
+    // Here's the cache!
+    _cache_stats.inc_hits();
+    return comp._result;
+  }
+  _cache_stats.inc_misses();
+
+  // We need to make a new cache entry, both in this object and in the
+  // other object.  We make both records so the other RenderState
+  // object will know to delete the entry from this object when it
+  // destructs, and vice-versa.
+
+  // The cache entry in this object is the only one that indicates the
+  // result; the other will be NULL for now.
+  _cache_stats.add_total_size(1);
+  _cache_stats.inc_adds(_invert_composition_cache.get_size() == 0);
+  _invert_composition_cache[other]._result = result;
+
+  if (other != this) {
+    _cache_stats.add_total_size(1);
+    _cache_stats.inc_adds(other->_invert_composition_cache.get_size() == 0);
+    ((RenderState *)other)->_invert_composition_cache[this]._result = NULL;
+  }
+
+  if (result != (const RenderState *)this) {
+    // If the result of do_invert_compose() is something other than
+    // this, explicitly increment the reference count.  We have to be
+    // sure to decrement it again later, when the composition entry is
+    // removed from the cache.
+    result->cache_ref();
+    
+    // (If the result was just this again, we still store the
+    // result, but we don't increment the reference count, since
+    // that would be a self-referential leak.)
+  }
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: RenderState::do_invert_compose
 //       Access: Private
@@ -1884,9 +2019,8 @@ release_new() {
   nassertv(_states_lock->debug_is_locked());
 
   if (_saved_entry != -1) {
-    //nassertv(_states->find(this) == _saved_entry);
-    _saved_entry = _states->find(this);
-    _states->remove_element(_saved_entry);
+    LightReMutexHolder holder(_states->get_stripe_lock(this));
+    _states->remove(this);
     _saved_entry = -1;
   }
 }
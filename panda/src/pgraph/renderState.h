@@ -31,6 +31,7 @@
 #include "lightMutex.h"
 #include "deletedChain.h"
 #include "simpleHashMap.h"
+#include "stateInternTable.h"
 #include "cacheStats.h"
 #include "renderAttribRegistry.h"
 
@@ -184,6 +185,8 @@ private:
   static CPT(RenderState) return_unique(RenderState *state);
   CPT(RenderState) do_compose(const RenderState *other) const;
   CPT(RenderState) do_invert_compose(const RenderState *other) const;
+  CPT(RenderState) store_compose(const RenderState *other, const RenderState *result);
+  CPT(RenderState) store_invert_compose(const RenderState *other, const RenderState *result);
   void detect_and_break_cycles();
   static bool r_detect_cycles(const RenderState *start_state,
                               const RenderState *current_state,
@@ -217,13 +220,20 @@ public:
   CPT(RenderAttrib) _generated_shader;
 
 private:
-  // This mutex protects _states.  It also protects any modification
-  // to the cache, which is encoded in _composition_cache and
-  // _invert_composition_cache.
+  // This mutex protects any modification to the cache, which is
+  // encoded in _composition_cache and _invert_composition_cache, and
+  // the decision to delete a RenderState.  The table of unique states,
+  // _states, has its own locks, one per stripe; when both are needed,
+  // _states_lock must be acquired first.
+  //
+  // The composition caches are not striped.  Each entry links two
+  // states and is removed from both when either one is destructed,
+  // so removing a state would need the locks of every state it was
+  // composed with.  The cycle detection in unref() also walks the
+  // caches of any number of states.  Neither could take per-stripe
+  // locks in a fixed order, so both stay on this one lock.
   static LightReMutex *_states_lock;
-  class Empty {
-  };
-  typedef SimpleHashMap<const RenderState *, Empty, indirect_compare_to_hash<const RenderState *> > States;
+  typedef StateInternTable<const RenderState *> States;
   static States *_states;
   static CPT(RenderState) _empty_state;
   static CPT(RenderState) _full_default_state;
@@ -261,10 +271,12 @@ private:
   // to look up the GSG in the RenderState pointer than vice-versa,
   // since there are likely to be far fewer GSG's than RenderStates.
   // The code to manage this map lives in
-  // GraphicsStateGuardian::get_geom_munger().
+  // GraphicsStateGuardian::get_geom_munger().  Since the cull may run
+  // in several threads at once, it is protected by _munger_lock.
   typedef pmap<WCPT(GraphicsStateGuardianBase), PT(GeomMunger) > Mungers;
   Mungers _mungers;
   Mungers::const_iterator _last_mi;
+  LightMutex _munger_lock;
 
   // This is used to mark nodes as we visit them to detect cycles.
   UpdateSeq _cycle_detect;
@@ -276,10 +288,13 @@ private:
 
   static PStatCollector _cache_update_pcollector;
   static PStatCollector _garbage_collect_pcollector;
+  static PStatCollector _gc_visited_pcollector;
+  static PStatCollector _gc_freed_pcollector;
   static PStatCollector _state_compose_pcollector;
   static PStatCollector _state_invert_pcollector;
   static PStatCollector _state_break_cycles_pcollector;
   static PStatCollector _state_validate_pcollector;
+  static PStatCollector _states_lock_wait_pcollector;
 
   static PStatCollector _node_counter;
   static PStatCollector _cache_counter;
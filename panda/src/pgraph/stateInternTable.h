@@ -0,0 +1,109 @@
+// Filename: stateInternTable.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef STATEINTERNTABLE_H
+#define STATEINTERNTABLE_H
+
+#include "pandabase.h"
+#include "simpleHashMap.h"
+#include "lightReMutex.h"
+#include "pStatCollector.h"
+#include "pStatTimer.h"
+#include "stl_compares.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : StateInternTable
+// Description : The global table of unique TransformState or
+//               RenderState objects, used to share a common pointer
+//               among all equivalent states.
+//
+//               The table is split into a number of stripes by hash
+//               value, each with its own lock, so that threads
+//               uniquifying different states don't have to wait for
+//               each other.  A particular state is only ever stored
+//               in the stripe returned by get_stripe_lock(); only
+//               that lock need be held to find, store, or remove it.
+//
+//               The whole-table accessors, like get_size() and
+//               get_key(), treat the stripes as one long array.  They
+//               may only be used while all of the stripes are locked
+//               with an AllStripesHolder.
+////////////////////////////////////////////////////////////////////
+template<class Key>
+class StateInternTable {
+public:
+  INLINE StateInternTable();
+
+  INLINE const LightReMutex &get_stripe_lock(Key key) const;
+
+  INLINE Key find(Key key) const;
+  INLINE int store(Key key);
+  INLINE bool remove(Key key);
+
+  INLINE int get_num_entries() const;
+  INLINE bool is_empty() const;
+  INLINE int get_size() const;
+  INLINE bool has_element(int n) const;
+  INLINE Key get_key(int n) const;
+  INLINE bool validate() const;
+
+  class AllStripesHolder {
+  public:
+    INLINE AllStripesHolder(const StateInternTable<Key> &table);
+    INLINE ~AllStripesHolder();
+
+  private:
+    const StateInternTable<Key> &_table;
+  };
+
+private:
+  INLINE int get_stripe_index(Key key) const;
+  INLINE bool find_element(int n, int &stripe, int &element) const;
+
+  class Empty {
+  };
+  typedef SimpleHashMap<Key, Empty, indirect_compare_to_hash<Key> > Table;
+
+  enum { num_stripes = 16 };
+
+  class Stripe {
+  public:
+    Table _table;
+    LightReMutex _lock;
+  };
+  Stripe _stripes[num_stripes];
+};
+
+////////////////////////////////////////////////////////////////////
+//       Class : StateLockHolder
+// Description : Similar to LightReMutexHolder, but if the lock is
+//               not immediately available, the time spent waiting
+//               for it is charged to the indicated PStatCollector.
+//               This is used for the TransformState and RenderState
+//               cache locks, which may be contended by the App, Cull,
+//               and Draw threads.
+////////////////////////////////////////////////////////////////////
+class StateLockHolder {
+public:
+  INLINE StateLockHolder(const LightReMutex &lock,
+                         PStatCollector &wait_pcollector);
+  INLINE ~StateLockHolder();
+
+private:
+  const LightReMutex &_lock;
+};
+
+#include "stateInternTable.I"
+
+#endif
@@ -13,6 +13,7 @@
 ////////////////////////////////////////////////////////////////////
 
 #include "stateMunger.h"
+#include "lightMutexHolder.h"
 
 TypeHandle StateMunger::_type_handle;
 
@@ -34,15 +35,20 @@ CPT(RenderState) StateMunger::
 munge_state(const RenderState *state) {
   WCPT(RenderState) pt_state = state;
 
-  StateMap::iterator mi = _state_map.find(pt_state);
-  if (mi != _state_map.end()) {
-    if (!(*mi).first.was_deleted() &&
-        !(*mi).second.was_deleted()) {
-      return (*mi).second.p();
+  {
+    LightMutexHolder holder(_state_map_lock);
+    StateMap::iterator mi = _state_map.find(pt_state);
+    if (mi != _state_map.end()) {
+      if (!(*mi).first.was_deleted() &&
+          !(*mi).second.was_deleted()) {
+        return (*mi).second.p();
+      }
     }
   }
 
   CPT(RenderState) result = munge_state_impl(state);
+
+  LightMutexHolder holder(_state_map_lock);
   _state_map[pt_state] = result;
 
   return result;
@@ -19,6 +19,7 @@
 #include "geomMunger.h"
 #include "renderState.h"
 #include "weakPointerTo.h"
+#include "lightMutex.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : StateMunger
@@ -39,6 +40,10 @@ protected:
   typedef pmap< WCPT(RenderState), WCPT(RenderState) > StateMap;
   StateMap _state_map;
 
+  // This protects _state_map, since the cull may munge states in
+  // several threads at once.
+  LightMutex _state_map_lock;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
@@ -35,6 +35,8 @@ int TransformState::_garbage_index = 0;
 
 PStatCollector TransformState::_cache_update_pcollector("*:State Cache:Update");
 PStatCollector TransformState::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
+PStatCollector TransformState::_gc_visited_pcollector("State GC Visited:TransformState");
+PStatCollector TransformState::_gc_freed_pcollector("State GC Freed:TransformState");
 PStatCollector TransformState::_transform_compose_pcollector("*:State Cache:Compose Transform");
 PStatCollector TransformState::_transform_invert_pcollector("*:State Cache:Invert Transform");
 PStatCollector TransformState::_transform_calc_pcollector("*:State Cache:Calc Components");
@@ -45,6 +47,8 @@ PStatCollector TransformState::_transform_hash_pcollector("*:State Cache:Calc Ha
 PStatCollector TransformState::_node_counter("TransformStates:On nodes");
 PStatCollector TransformState::_cache_counter("TransformStates:Cached");
 
+PStatCollector TransformState::_states_lock_wait_pcollector("*:State Cache:Lock Wait:TransformState");
+
 CacheStats TransformState::_cache_stats;
 
 TypeHandle TransformState::_type_handle;
@@ -105,7 +109,7 @@ TransformState::
     _inv_mat = (LMatrix4 *)NULL;
   }
 
-  LightReMutexHolder holder(*_states_lock);
+  StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
 
   // unref() should have cleared these.
   nassertv(_saved_entry == -1);
@@ -608,7 +612,7 @@ compose(const TransformState *other) const {
   // Is this composition already cached?
   CPT(TransformState) result;
   {
-    LightReMutexHolder holder(*_states_lock);
+    StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
     int index = _composition_cache.find(other);
     if (index != -1) {
       const Composition &comp = _composition_cache.get_data(index);
@@ -675,11 +679,9 @@ invert_compose(const TransformState *other) const {
     return do_invert_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
   CPT(TransformState) result;
   {
-    LightReMutexHolder holder(*_states_lock);
+    StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
     int index = _invert_composition_cache.find(other);
     if (index != -1) {
       const Composition &comp = _invert_composition_cache.get_data(index);
@@ -731,7 +733,7 @@ unref() const {
   // be holding it if we happen to drop the reference count to 0.
   // Having to grab the lock at every call to unref() is a big
   // limiting factor on parallelization.
-  LightReMutexHolder holder(*_states_lock);
+  StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
 
   if (auto_break_cycles && uniquify_transforms) {
     if (get_cache_ref_count() > 0 &&
@@ -744,15 +746,22 @@ unref() const {
     }
   }
 
-  if (ReferenceCount::unref()) {
-    // The reference count is still nonzero.
-    return true;
-  }
+  {
+    // We must also hold the lock on our stripe of the _states table
+    // while we drop the reference, so that return_unique() can't
+    // find this object and ref it again after the count reaches 0.
+    StateLockHolder stripe_holder(_states->get_stripe_lock(this),
+                                  _states_lock_wait_pcollector);
+    if (ReferenceCount::unref()) {
+      // The reference count is still nonzero.
+      return true;
+    }
 
-  // The reference count has just reached zero.  Make sure the object
-  // is removed from the global object pool, before anyone else finds
-  // it and tries to ref it.
-  ((TransformState *)this)->release_new();
+    // The reference count has just reached zero.  Make sure the
+    // object is removed from the global object pool, before anyone
+    // else finds it and tries to ref it.
+    ((TransformState *)this)->release_new();
+  }
   ((TransformState *)this)->remove_cache_pointers();
   
   return false;
@@ -947,6 +956,7 @@ get_num_states() {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
   return _states->get_num_entries();
 }
 
@@ -974,6 +984,7 @@ get_num_unused_states() {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   // First, we need to count the number of times each TransformState
   // object is recorded in the cache.  We could just trust
@@ -1073,6 +1084,7 @@ clear_cache() {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   PStatTimer timer(_cache_update_pcollector);
   int orig_size = _states->get_num_entries();
@@ -1148,6 +1160,13 @@ clear_cache() {
 //               appropriately.  It does no harm to call it even if
 //               this variable is not true, but there is probably no
 //               advantage in that case.
+//
+//               Each call examines only as many states as allowed by
+//               garbage-collect-states-rate,
+//               garbage-collect-states-budget, and
+//               garbage-collect-cycles-budget, resuming from where
+//               the previous call left off.  Returns the number of
+//               states freed.
 ////////////////////////////////////////////////////////////////////
 int TransformState::
 garbage_collect() {
@@ -1155,23 +1174,33 @@ garbage_collect() {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   PStatTimer timer(_garbage_collect_pcollector);
   int orig_size = _states->get_num_entries();
 
-  // How many elements to process this pass?
+  // How many elements to process this pass?  The rate limits the
+  // number of slots of the table we walk through, and the budget
+  // limits the number of states we actually examine.
   int size = _states->get_size();
   int num_this_pass = int(size * garbage_collect_states_rate);
   if (num_this_pass <= 0) {
     return 0;
   }
   num_this_pass = min(num_this_pass, size);
-  int stop_at_element = (_garbage_index + num_this_pass) % size;
+  int budget = garbage_collect_states_budget;
+  int cycles_budget = garbage_collect_cycles_budget;
   
   int num_elements = 0;
+  int num_cycle_checks = 0;
   int si = _garbage_index;
-  do {
+  for (int i = 0; i < num_this_pass; ++i) {
     if (_states->has_element(si)) {
+      if (budget > 0 && num_elements >= budget) {
+        // That's all we have time for this pass.  We'll pick up again
+        // with this state next time.
+        break;
+      }
       ++num_elements;
       TransformState *state = (TransformState *)_states->get_key(si);
       if (auto_break_cycles && uniquify_transforms) {
@@ -1181,6 +1210,15 @@ garbage_collect() {
           // the cache, leaving only references in the cache, then we
           // need to check for a cycle involving this TransformState and
           // break it if it exists.
+
+          // Walking the composition cache can be expensive, so this is
+          // budgeted separately.  If we have used up this pass's share,
+          // stop here and start with this state next time.
+          if (cycles_budget > 0 && num_cycle_checks >= cycles_budget) {
+            --num_elements;
+            break;
+          }
+          ++num_cycle_checks;
           state->detect_and_break_cycles();
         }
       }
@@ -1198,13 +1236,16 @@ garbage_collect() {
         delete state;
       }
     }      
-    
+
     si = (si + 1) % size;
-  } while (si != stop_at_element);
+  }
   _garbage_index = si;
   nassertr(_states->validate(), 0);
 
   int new_size = _states->get_num_entries();
+  _gc_visited_pcollector.set_level(num_elements);
+  _gc_freed_pcollector.set_level(orig_size - new_size);
+
   return orig_size - new_size;
 }
 
@@ -1232,6 +1273,7 @@ list_cycles(ostream &out) {
     return;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   typedef pset<const TransformState *> VisitedStates;
   VisitedStates visited;
@@ -1315,6 +1357,7 @@ list_states(ostream &out) {
     return;
   }
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
 
   out << _states->get_num_entries() << " states:\n";
 
@@ -1347,6 +1390,7 @@ validate_states() {
   PStatTimer timer(_transform_validate_pcollector);
 
   LightReMutexHolder holder(*_states_lock);
+  States::AllStripesHolder all_stripes(*_states);
   if (_states->is_empty()) {
     return true;
   }
@@ -1473,22 +1517,26 @@ return_unique(TransformState *state) {
 
   PStatTimer timer(_transform_new_pcollector);
 
-  LightReMutexHolder holder(*_states_lock);
-
   if (state->_saved_entry != -1) {
     // This state is already in the cache.
-    //nassertr(_states->find(state) == state->_saved_entry, state);
     return state;
   }
 
   // Save the state in a local PointerTo so that it will be freed at
-  // the end of this function if no one else uses it.
+  // the end of this function if no one else uses it.  This must be
+  // declared before the lock holder below, so that the lock has been
+  // released by the time the state is freed.
   CPT(TransformState) pt_state = state;
 
-  int si = _states->find(state);
-  if (si != -1) {
+  // We only need to lock the one stripe of the table in which this
+  // state belongs.
+  StateLockHolder holder(_states->get_stripe_lock(state),
+                         _states_lock_wait_pcollector);
+
+  const TransformState *found = _states->find(state);
+  if (found != (const TransformState *)NULL) {
     // There's an equivalent state already in the set.  Return it.
-    return _states->get_key(si);
+    return found;
   }
 
   // Not already in the set; add it.
@@ -1498,7 +1546,7 @@ return_unique(TransformState *state) {
     // that it won't be deleted while it's in it.
     state->cache_ref();
   }
-  si = _states->store(state, Empty());
+  int si = _states->store(state);
 
   // Save the index and return the input state.
   state->_saved_entry = si;
@@ -1605,7 +1653,7 @@ store_compose(const TransformState *other, const TransformState *result) {
   nassertr(!is_invalid(), this);
   nassertr(!other->is_invalid(), other);
 
-  LightReMutexHolder holder(*_states_lock);
+  StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
 
   // Is this composition already cached?
   int index = _composition_cache.find(other);
@@ -1683,7 +1731,7 @@ store_invert_compose(const TransformState *other, const TransformState *result)
 
   nassertr(other != this, make_identity());
 
-  LightReMutexHolder holder(*_states_lock);
+  StateLockHolder holder(*_states_lock, _states_lock_wait_pcollector);
 
   // Is this composition already cached?
   int index = _invert_composition_cache.find(other);
@@ -2067,9 +2115,8 @@ release_new() {
   nassertv(_states_lock->debug_is_locked());
    
   if (_saved_entry != -1) {
-    //nassertv(_states->find(this) == _saved_entry);
-    _saved_entry = _states->find(this);
-    _states->remove_element(_saved_entry);
+    LightReMutexHolder holder(_states->get_stripe_lock(this));
+    _states->remove(this);
     _saved_entry = -1;
   }
 }
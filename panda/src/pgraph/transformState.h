@@ -31,6 +31,7 @@
 #include "config_pgraph.h"
 #include "deletedChain.h"
 #include "simpleHashMap.h"
+#include "stateInternTable.h"
 #include "cacheStats.h"
 #include "extension.h"
 
@@ -251,13 +252,20 @@ private:
   void remove_cache_pointers();
 
 private:
-  // This mutex protects _states.  It also protects any modification
-  // to the cache, which is encoded in _composition_cache and
-  // _invert_composition_cache.
+  // This mutex protects any modification to the cache, which is
+  // encoded in _composition_cache and _invert_composition_cache, and
+  // the decision to delete a TransformState.  The table of unique states,
+  // _states, has its own locks, one per stripe; when both are needed,
+  // _states_lock must be acquired first.
+  //
+  // The composition caches are not striped.  Each entry links two
+  // states and is removed from both when either one is destructed,
+  // so removing a state would need the locks of every state it was
+  // composed with.  The cycle detection in unref() also walks the
+  // caches of any number of states.  Neither could take per-stripe
+  // locks in a fixed order, so both stay on this one lock.
   static LightReMutex *_states_lock;
-  class Empty {
-  };
-  typedef SimpleHashMap<const TransformState *, Empty, indirect_compare_to_hash<const TransformState *> > States;
+  typedef StateInternTable<const TransformState *> States;
   static States *_states;
   static CPT(TransformState) _identity_state;
   static CPT(TransformState) _invalid_state;
@@ -301,12 +309,15 @@ private:
 
   static PStatCollector _cache_update_pcollector;
   static PStatCollector _garbage_collect_pcollector;
+  static PStatCollector _gc_visited_pcollector;
+  static PStatCollector _gc_freed_pcollector;
   static PStatCollector _transform_compose_pcollector;
   static PStatCollector _transform_invert_pcollector;
   static PStatCollector _transform_calc_pcollector;
   static PStatCollector _transform_break_cycles_pcollector;
   static PStatCollector _transform_new_pcollector;
   static PStatCollector _transform_validate_pcollector;
+  static PStatCollector _states_lock_wait_pcollector;
   static PStatCollector _transform_hash_pcollector;
 
   static PStatCollector _node_counter;
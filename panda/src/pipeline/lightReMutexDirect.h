@@ -40,6 +40,7 @@ private:
 PUBLISHED:
   BLOCKING INLINE void acquire() const;
   BLOCKING INLINE void acquire(Thread *current_thread) const;
+  INLINE bool try_acquire() const;
   INLINE void elevate_lock() const;
   INLINE void release() const;
 
@@ -5,7 +5,7 @@
 #begin lib_target
   #define TARGET p3pnmimage
   #define LOCAL_LIBS \
-    p3linmath p3putil p3express p3mathutil
+    p3linmath p3putil p3express p3mathutil p3event
 
   #define COMBINED_SOURCES $[TARGET]_composite1.cxx $[TARGET]_composite2.cxx 
 
@@ -49,3 +49,13 @@
 
 #end lib_target
 
+#begin test_bin_target
+  #define TARGET test_pnmimage_filter
+  #define LOCAL_LIBS \
+    p3pnmimage p3putil
+
+  #define SOURCES \
+    test_pnmimage_filter.cxx
+
+#end test_bin_target
+
@@ -59,6 +59,33 @@ ConfigVariableDouble pfm_resize_radius
           "always call box_filter() or gaussian_filter() explicitly with "
           "a specific radius."));
 
+ConfigVariableBool pnmimage_fast_filter
+("pnmimage-fast-filter", false,
+ PRC_DESC("Specify true to implement PNMImage::box_filter_from() and "
+          "gaussian_filter_from() by filtering all of the channels at once "
+          "in single-precision floating point, which is much faster, or "
+          "false to use the original implementation, which filters one "
+          "channel at a time in double precision.  The fast results may "
+          "differ from the original by one maxval unit per channel, and "
+          "the fast implementation needs 16 bytes per pixel of the source "
+          "image, and again for the intermediate image, for the duration "
+          "of the filter."));
+
+ConfigVariableBool pnmimage_filter_simd
+("pnmimage-filter-simd", true,
+ PRC_DESC("Set this true to use hand-vectorized SSE2 code in the inner "
+          "loop of the PNMImage filters when pnmimage-fast-filter is in "
+          "effect, or false to use the generic code.  This has no effect "
+          "if Panda was not compiled with SSE2 enabled."));
+
+ConfigVariableInt pnmimage_filter_num_threads
+("pnmimage-filter-num-threads", 0,
+ PRC_DESC("Set this to a number greater than 1 to divide the work of "
+          "PNMImage::quick_filter_from(), and of box_filter_from() and "
+          "gaussian_filter_from() when pnmimage-fast-filter is in effect, "
+          "among that many threads.  Small images are always filtered "
+          "on the calling thread.  The result is the same either way."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libpnmimage
 //  Description: Initializes the library.  This must be called at
@@ -19,6 +19,7 @@
 #include "notifyCategoryProxy.h"
 #include "configVariableBool.h"
 #include "configVariableDouble.h"
+#include "configVariableInt.h"
 
 NotifyCategoryDecl(pnmimage, EXPCL_PANDA_PNMIMAGE, EXPTP_PANDA_PNMIMAGE);
 
@@ -28,6 +29,10 @@ extern ConfigVariableBool pfm_resize_gaussian;
 extern ConfigVariableBool pfm_resize_quick;
 extern ConfigVariableDouble pfm_resize_radius;
 
+extern ConfigVariableBool pnmimage_fast_filter;
+extern ConfigVariableBool pnmimage_filter_simd;
+extern ConfigVariableInt pnmimage_filter_num_threads;
+
 extern EXPCL_PANDA_PNMIMAGE void init_libpnmimage();
 
 #endif
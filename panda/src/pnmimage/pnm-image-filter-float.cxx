@@ -0,0 +1,356 @@
+// Filename: pnm-image-filter-float.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+// This file is included by pnm-image-filter.cxx.  It defines an
+// alternate implementation of filter_image() for PNMImages, used when
+// pnmimage-fast-filter is true.
+
+// Rather than filtering one channel at a time through the generic
+// accessors, as in pnm-image-filter-core.cxx, the image is first
+// unpacked into a buffer of single-precision floats, four per pixel
+// (red, green, blue and alpha, or gray in the first of these), laid
+// out so that each line to be filtered is contiguous.  The filter
+// weights for each output pixel of a line depend only on its position
+// along the line, so they are computed and normalized just once for
+// each axis.  Each pass is then a short weighted sum of four-float
+// pixels, which maps directly onto SSE2 registers when they are
+// available, and the lines of each pass are independent of each
+// other, so they may be divided among several threads.
+
+// We hand-vectorize the inner loop when the compiler is generating
+// SSE2 code anyway.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_FILTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+static const int float_channels = 4;
+
+// Lines are handed out to threads this many at a time.
+static const int filter_lines_per_chunk = 16;
+
+// FilterWeights holds the normalized filter weights for each output
+// pixel along one axis.  Output pixel i is the sum of _count[i]
+// consecutive input pixels beginning at _first[i], weighted by the
+// values in _weights beginning at _start[i].
+class FilterWeights {
+public:
+  void compute(int dest_len, int source_len,
+               double width, FilterFunction *make_filter);
+
+  vector_int _first;
+  vector_int _start;
+  vector_int _count;
+  pvector<float> _weights;
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: FilterWeights::compute
+//       Access: Public
+//  Description: Fills in the weights for scaling a line of
+//               source_len pixels to dest_len pixels.  The choice of
+//               source pixels and their weights is exactly as in
+//               filter_row().
+////////////////////////////////////////////////////////////////////
+void FilterWeights::
+compute(int dest_len, int source_len,
+        double width, FilterFunction *make_filter) {
+  double scale = (double)dest_len / (double)source_len;
+
+  WorkType *filter;
+  double filter_width;
+  make_filter(scale, width, filter, filter_width);
+
+  double iscale;
+  if (scale < 1.0) {
+    iscale = 1.0;
+    filter_width /= scale;
+  } else {
+    iscale = scale;
+  }
+
+  _first.resize(dest_len);
+  _start.resize(dest_len);
+  _count.resize(dest_len);
+  _weights.clear();
+
+  for (int dest_x = 0; dest_x < dest_len; dest_x++) {
+    double center = (dest_x + 0.5) / scale - 0.5;
+    int left = max((int)cfloor(center - filter_width), 0);
+    int right = min((int)cceil(center + filter_width), source_len - 1);
+    int right_center = (int)cceil(center);
+
+    int start = (int)_weights.size();
+    WorkType net_weight = 0;
+    for (int source_x = left; source_x <= right; source_x++) {
+      int index;
+      if (source_x < right_center) {
+        index = (int)(iscale * (center - source_x) + 0.5);
+      } else {
+        index = (int)(iscale * (source_x - center) + 0.5);
+      }
+      _weights.push_back((float)filter[index]);
+      net_weight += filter[index];
+    }
+
+    _first[dest_x] = left;
+    _start[dest_x] = start;
+    if (net_weight > 0) {
+      _count[dest_x] = (int)_weights.size() - start;
+      float inv_weight = (float)(1.0 / net_weight);
+      for (size_t wi = start; wi < _weights.size(); ++wi) {
+        _weights[wi] *= inv_weight;
+      }
+    } else {
+      // No contributing pixels; the result is 0.
+      _count[dest_x] = 0;
+      _weights.resize(start);
+    }
+  }
+
+  PANDA_FREE_ARRAY(filter);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: filter_line_float
+//  Description: Filters a single contiguous line of four-float
+//               pixels into dest, which is written every dest_stride
+//               pixels.
+////////////////////////////////////////////////////////////////////
+static void
+filter_line_float(float *dest, int dest_stride,
+                  const float *source, const FilterWeights &weights) {
+  int dest_len = (int)weights._first.size();
+  const int *first = &weights._first[0];
+  const int *start = &weights._start[0];
+  const int *count = &weights._count[0];
+  const float *all_weights = weights._weights.empty() ? NULL : &weights._weights[0];
+  int step = dest_stride * float_channels;
+
+#ifdef HAVE_FILTER_SSE2
+  if (pnmimage_filter_simd) {
+    for (int i = 0; i < dest_len; ++i) {
+      const float *sp = source + first[i] * float_channels;
+      const float *wp = all_weights + start[i];
+      __m128 sum = _mm_setzero_ps();
+      for (int k = count[i]; k > 0; --k) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(*wp), _mm_loadu_ps(sp)));
+        ++wp;
+        sp += float_channels;
+      }
+      _mm_storeu_ps(dest, sum);
+      dest += step;
+    }
+    return;
+  }
+#endif  // HAVE_FILTER_SSE2
+
+  for (int i = 0; i < dest_len; ++i) {
+    const float *sp = source + first[i] * float_channels;
+    const float *wp = all_weights + start[i];
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for (int k = count[i]; k > 0; --k) {
+      float w = *wp;
+      s0 += w * sp[0];
+      s1 += w * sp[1];
+      s2 += w * sp[2];
+      s3 += w * sp[3];
+      ++wp;
+      sp += float_channels;
+    }
+    dest[0] = s0;
+    dest[1] = s1;
+    dest[2] = s2;
+    dest[3] = s3;
+    dest += step;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: run_filter_range
+//  Description: Calls func on all of the lines from 0 to count - 1,
+//               dividing them among pnmimage-filter-num-threads
+//               threads (including the current one, and the rest on
+//               the "pnm_filter" task chain) if that is greater than
+//               1 and there are enough lines to be worth it.  Does
+//               not return until all lines have been processed.
+////////////////////////////////////////////////////////////////////
+static void
+run_filter_range(ParallelFor::RangeFunc *func, void *data, int count) {
+  ParallelFor pfor("pnm_filter", pnmimage_filter_num_threads,
+                   filter_lines_per_chunk);
+  pfor.run(func, data, count);
+}
+
+// The data shared by the passes of filter_image_float().  The "A"
+// axis is the one filtered first, as in pnm-image-filter-core.cxx.
+class FloatFilterJob {
+public:
+  INLINE int get_x(int a, int b) const { return _xy ? a : b; }
+  INLINE int get_y(int a, int b) const { return _xy ? b : a; }
+
+  PNMImage *_dest;
+  const PNMImage *_source;
+  bool _xy;
+  bool _gray;
+  bool _alpha;
+
+  int _source_a, _source_b;
+  int _dest_a, _dest_b;
+
+  FilterWeights _a_weights;
+  FilterWeights _b_weights;
+
+  // The source image, _source_b lines of _source_a pixels.
+  pvector<float> _source_data;
+
+  // The result of the first pass, _dest_a lines of _source_b pixels.
+  pvector<float> _temp_data;
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: float_load_lines
+//  Description: Unpacks lines of the source image into
+//               _source_data.
+////////////////////////////////////////////////////////////////////
+static void
+float_load_lines(void *data, int begin, int end, int worker_index) {
+  FloatFilterJob *job = (FloatFilterJob *)data;
+  const PNMImage &source = *job->_source;
+  double scale = 1.0 / (double)source.get_maxval();
+
+  for (int b = begin; b < end; ++b) {
+    float *dp = &job->_source_data[(size_t)b * job->_source_a * float_channels];
+    for (int a = 0; a < job->_source_a; ++a) {
+      int x = job->get_x(a, b);
+      int y = job->get_y(a, b);
+      if (job->_gray) {
+        dp[0] = (float)source.get_bright(x, y);
+        dp[1] = 0.0f;
+        dp[2] = 0.0f;
+      } else {
+        dp[0] = (float)(source.get_red_val(x, y) * scale);
+        dp[1] = (float)(source.get_green_val(x, y) * scale);
+        dp[2] = (float)(source.get_blue_val(x, y) * scale);
+      }
+      dp[3] = job->_alpha ? (float)(source.get_alpha_val(x, y) * scale) : 0.0f;
+      dp += float_channels;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: float_filter_a_lines
+//  Description: The first pass: scales source lines in the A
+//               direction, storing them transposed in _temp_data.
+////////////////////////////////////////////////////////////////////
+static void
+float_filter_a_lines(void *data, int begin, int end, int worker_index) {
+  FloatFilterJob *job = (FloatFilterJob *)data;
+  for (int b = begin; b < end; ++b) {
+    filter_line_float(&job->_temp_data[(size_t)b * float_channels],
+                      job->_source_b,
+                      &job->_source_data[(size_t)b * job->_source_a * float_channels],
+                      job->_a_weights);
+  }
+  Thread::consider_yield();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: float_filter_b_lines
+//  Description: The second pass: scales the transposed lines in the B
+//               direction, and stores the results in the destination
+//               image.
+////////////////////////////////////////////////////////////////////
+static void
+float_filter_b_lines(void *data, int begin, int end, int worker_index) {
+  FloatFilterJob *job = (FloatFilterJob *)data;
+  PNMImage &dest = *job->_dest;
+  pvector<float> line((size_t)job->_dest_b * float_channels);
+
+  for (int a = begin; a < end; ++a) {
+    filter_line_float(&line[0], 1,
+                      &job->_temp_data[(size_t)a * job->_source_b * float_channels],
+                      job->_b_weights);
+
+    const float *sp = &line[0];
+    for (int b = 0; b < job->_dest_b; ++b) {
+      int x = job->get_x(a, b);
+      int y = job->get_y(a, b);
+      if (job->_gray) {
+        dest.set_xel(x, y, (double)sp[0]);
+      } else {
+        dest.set_xel(x, y, (double)sp[0], (double)sp[1], (double)sp[2]);
+      }
+      if (job->_alpha) {
+        dest.set_alpha(x, y, (double)sp[3]);
+      }
+      sp += float_channels;
+    }
+  }
+  Thread::consider_yield();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: filter_image_float
+//  Description: The implementation of filter_image() for PNMImages
+//               when pnmimage-fast-filter is true.  Produces the
+//               same result as the generic implementation, to within
+//               the precision of a float.  Both images can be the
+//               same with no ill effects.
+////////////////////////////////////////////////////////////////////
+static void
+filter_image_float(PNMImage &dest, const PNMImage &source,
+                   double width, FilterFunction *make_filter) {
+  if (!dest.is_valid() || !source.is_valid()) {
+    return;
+  }
+
+  FloatFilterJob job;
+  job._dest = &dest;
+  job._source = &source;
+
+  // We want to scale by the smallest destination axis first, for a
+  // slight performance gain.
+  job._xy = (dest.get_x_size() <= dest.get_y_size());
+  job._gray = (dest.is_grayscale() || source.is_grayscale());
+  job._alpha = (dest.has_alpha() && source.has_alpha());
+
+  if (job._xy) {
+    job._source_a = source.get_x_size();
+    job._source_b = source.get_y_size();
+    job._dest_a = dest.get_x_size();
+    job._dest_b = dest.get_y_size();
+  } else {
+    job._source_a = source.get_y_size();
+    job._source_b = source.get_x_size();
+    job._dest_a = dest.get_y_size();
+    job._dest_b = dest.get_x_size();
+  }
+
+  job._a_weights.compute(job._dest_a, job._source_a, width, make_filter);
+  job._b_weights.compute(job._dest_b, job._source_b, width, make_filter);
+
+  job._source_data.resize((size_t)job._source_a * job._source_b * float_channels);
+  job._temp_data.resize((size_t)job._dest_a * job._source_b * float_channels);
+
+  run_filter_range(&float_load_lines, &job, job._source_b);
+  run_filter_range(&float_filter_a_lines, &job, job._source_b);
+
+  // We don't need the source data any more, and since dest might be
+  // the same image as source, we must not read it again anyway.
+  pvector<float>().swap(job._source_data);
+
+  run_filter_range(&float_filter_b_lines, &job, job._dest_a);
+}
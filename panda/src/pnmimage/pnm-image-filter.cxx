@@ -38,6 +38,10 @@
 
 #include "pnmImage.h"
 #include "pfmFile.h"
+#include "config_pnmimage.h"
+#include "parallelFor.h"
+#include "pvector.h"
+#include "vector_int.h"
 
 // WorkType is an abstraction that allows the filtering process to be
 // recompiled to use either floating-point or integer arithmetic.  On SGI
@@ -522,6 +526,9 @@ filter_image(PNMImage &dest, const PNMImage &source,
   }
 }
 
+// The float, SIMD and multithreaded implementation of the above.
+#include "pnm-image-filter-float.cxx"
+
 
 
 ////////////////////////////////////////////////////////////////////
@@ -535,7 +542,11 @@ filter_image(PNMImage &dest, const PNMImage &source,
 ////////////////////////////////////////////////////////////////////
 void PNMImage::
 box_filter_from(double width, const PNMImage &copy) {
-  filter_image(*this, copy, width, &box_filter_impl);
+  if (pnmimage_fast_filter) {
+    filter_image_float(*this, copy, width, &box_filter_impl);
+  } else {
+    filter_image(*this, copy, width, &box_filter_impl);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -549,7 +560,11 @@ box_filter_from(double width, const PNMImage &copy) {
 ////////////////////////////////////////////////////////////////////
 void PNMImage::
 gaussian_filter_from(double width, const PNMImage &copy) {
-  filter_image(*this, copy, width, &gaussian_filter_impl);
+  if (pnmimage_fast_filter) {
+    filter_image_float(*this, copy, width, &gaussian_filter_impl);
+  } else {
+    filter_image(*this, copy, width, &gaussian_filter_impl);
+  }
 }
 
 // Now we do it again, this time for PfmFile.  In this case we also
@@ -774,6 +789,56 @@ box_filter_region(const PNMImage &image,
   alpha_result = (xelval)(alpha / pixel_count + 0.5);
 }
 
+// The data shared by the threads running quick_filter_from().
+class QuickFilterJob {
+public:
+  PNMImage *_to;
+  const PNMImage *_from;
+  int _to_xoff, _to_yoff;
+  int _to_x_begin, _to_x_end, _to_y_begin;
+  double _x_scale, _y_scale;
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: quick_filter_rows
+//  Description: Computes the rows of quick_filter_from() numbered
+//               _to_y_begin + begin through _to_y_begin + end - 1.
+//               Each row depends only on the source image, so the
+//               rows may be computed in any order.
+////////////////////////////////////////////////////////////////////
+static void
+quick_filter_rows(void *data, int begin, int end, int worker_index) {
+  QuickFilterJob *job = (QuickFilterJob *)data;
+  PNMImage &to = *job->_to;
+  const PNMImage &from = *job->_from;
+
+  for (int to_y = job->_to_y_begin + begin;
+       to_y < job->_to_y_begin + end;
+       to_y++) {
+    double from_y0 = to_y * job->_y_scale;
+    double from_y1 = (to_y+1) * job->_y_scale;
+
+    double from_x0 = job->_to_x_begin * job->_x_scale;
+    for (int to_x = job->_to_x_begin; to_x < job->_to_x_end; to_x++) {
+      double from_x1 = (to_x+1) * job->_x_scale;
+
+      // Now the box from (from_x0, from_y0) - (from_x1, from_y1)
+      // but not including (from_x1, from_y1) maps to the pixel (to_x, to_y).
+      xelval alpha_result;
+      box_filter_region(from,
+                        from_x0, from_y0, from_x1, from_y1,
+                        to[job->_to_yoff + to_y][job->_to_xoff + to_x],
+                        alpha_result);
+      if (to.has_alpha()) {
+        to.set_alpha_val(job->_to_xoff+to_x, job->_to_yoff+to_y, alpha_result);
+      }
+
+      from_x0 = from_x1;
+    }
+    Thread::consider_yield();
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PNMImage::quick_filter_from
 //       Access: Public
@@ -785,6 +850,10 @@ box_filter_region(const PNMImage &image,
 //               specified, they will further restrict the size of the
 //               resulting image. There's no point in using
 //               quick_box_filter() on a single image.
+//
+//               The rows are divided among
+//               pnmimage-filter-num-threads threads, if that is
+//               greater than 1.
 ////////////////////////////////////////////////////////////////////
 void PNMImage::
 quick_filter_from(const PNMImage &from, int xborder, int yborder) {
@@ -794,41 +863,21 @@ quick_filter_from(const PNMImage &from, int xborder, int yborder) {
   int to_xs = get_x_size() - xborder;
   int to_ys = get_y_size() - yborder;
 
-  int to_xoff = xborder / 2;
-  int to_yoff = yborder / 2;
-
-  double from_x0, from_x1, from_y0, from_y1;
-  int to_x, to_y;
-
-  double x_scale = (double)from_xs / (double)to_xs;
-  double y_scale = (double)from_ys / (double)to_ys;
-
-  from_y0 = max(0, -to_yoff) * y_scale;
-  for (to_y = max(0, -to_yoff);
-       to_y < min(to_ys, get_y_size()-to_yoff);
-       to_y++) {
-    from_y1 = (to_y+1) * y_scale;
+  QuickFilterJob job;
+  job._to = this;
+  job._from = &from;
+  job._to_xoff = xborder / 2;
+  job._to_yoff = yborder / 2;
 
-    from_x0 = max(0, -to_xoff) * x_scale;
-    for (to_x = max(0, -to_xoff);
-         to_x < min(to_xs, get_x_size()-to_xoff);
-         to_x++) {
-      from_x1 = (to_x+1) * x_scale;
+  job._x_scale = (double)from_xs / (double)to_xs;
+  job._y_scale = (double)from_ys / (double)to_ys;
 
-      // Now the box from (from_x0, from_y0) - (from_x1, from_y1)
-      // but not including (from_x1, from_y1) maps to the pixel (to_x, to_y).
-      xelval alpha_result;
-      box_filter_region(from,
-                        from_x0, from_y0, from_x1, from_y1,
-                        (*this)[to_yoff + to_y][to_xoff + to_x],
-                        alpha_result);
-      if (has_alpha()) {
-        set_alpha_val(to_xoff+to_x, to_yoff+to_y, alpha_result);
-      }
+  job._to_x_begin = max(0, -job._to_xoff);
+  job._to_x_end = min(to_xs, get_x_size()-job._to_xoff);
+  job._to_y_begin = max(0, -job._to_yoff);
+  int to_y_end = min(to_ys, get_y_size()-job._to_yoff);
 
-      from_x0 = from_x1;
-    }
-    from_y0 = from_y1;
-    Thread::consider_yield();
+  if (to_y_end > job._to_y_begin) {
+    run_filter_range(&quick_filter_rows, &job, to_y_end - job._to_y_begin);
   }
 }
@@ -0,0 +1,189 @@
+// Filename: test_pnmimage_filter.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pnmImage.h"
+#include "config_pnmimage.h"
+
+// This program scales images of several sizes and channel counts to
+// half their size with each of the PNMImage filters, once with the
+// original implementation and then with each of the
+// pnmimage-fast-filter variants.  It checks that a constant image
+// stays constant, that the fast variants agree with the original to
+// within one unit of the maxval, and that dividing the work among
+// threads does not change the result at all.
+
+static const int image_sizes[] = { 37, 64, 130 };
+static const int num_image_sizes = sizeof(image_sizes) / sizeof(int);
+
+enum Filter {
+  F_box,
+  F_gaussian,
+  F_quick,
+};
+static const char *const filter_names[] = { "box", "gaussian", "quick" };
+static const int num_filters = 3;
+
+class Variant {
+public:
+  const char *_name;
+  bool _fast;
+  bool _simd;
+  int _num_threads;
+};
+
+static const Variant variants[] = {
+  { "original", false, false, 0 },
+  { "float", true, false, 0 },
+  { "float+simd", true, true, 0 },
+  { "float+simd, 3 threads", true, true, 3 },
+};
+static const int num_variants = sizeof(variants) / sizeof(Variant);
+
+////////////////////////////////////////////////////////////////////
+//     Function: make_image
+//  Description: Fills the image with gradients and some
+//               high-frequency detail, or with a single constant
+//               value if constant is true.
+////////////////////////////////////////////////////////////////////
+static void
+make_image(PNMImage &image, int size, int num_channels, bool constant) {
+  image.clear(size, size, num_channels);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      if (constant) {
+        image.set_xel_val(x, y, 200, 100, 50);
+        if (image.has_alpha()) {
+          image.set_alpha_val(x, y, 150);
+        }
+      } else {
+        image.set_xel_val(x, y, (x * 3) & 0xff, (y * 5) & 0xff,
+                          ((x * 7 + y * 13) ^ (x >> 3)) & 0xff);
+        if (image.has_alpha()) {
+          image.set_alpha_val(x, y, ((x / 4) + (y / 4)) & 1 ? 255 : 64);
+        }
+      }
+    }
+  }
+}
+
+static void
+run_filter(Filter filter, const Variant &variant,
+           PNMImage &dest, const PNMImage &source) {
+  pnmimage_fast_filter.set_value(variant._fast);
+  pnmimage_filter_simd.set_value(variant._simd);
+  pnmimage_filter_num_threads.set_value(variant._num_threads);
+
+  switch (filter) {
+  case F_box:
+    dest.box_filter_from(1.0, source);
+    break;
+
+  case F_gaussian:
+    dest.gaussian_filter_from(1.0, source);
+    break;
+
+  case F_quick:
+    dest.quick_filter_from(source);
+    break;
+  }
+}
+
+static int
+max_difference(const PNMImage &a, const PNMImage &b) {
+  int result = 0;
+  for (int y = 0; y < a.get_y_size(); ++y) {
+    for (int x = 0; x < a.get_x_size(); ++x) {
+      for (int c = 0; c < a.get_num_channels(); ++c) {
+        int diff = (int)a.get_channel_val(x, y, c) - (int)b.get_channel_val(x, y, c);
+        result = max(result, abs(diff));
+      }
+    }
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_filter
+//  Description: Runs the indicated filter on the source image with
+//               each variant, and checks the results.  If the source
+//               image is constant, each result must have the same
+//               constant value as well.
+////////////////////////////////////////////////////////////////////
+static bool
+check_filter(Filter filter, const PNMImage &source, bool constant) {
+  int size = source.get_x_size();
+  int num_channels = source.get_num_channels();
+  ostringstream label;
+  label << size << "x" << size << ", " << num_channels << " channel(s), "
+        << filter_names[filter] << (constant ? ", constant" : "");
+
+  PNMImage results[num_variants];
+  for (int vi = 0; vi < num_variants; ++vi) {
+    results[vi].clear(size / 2, size / 2, num_channels);
+    run_filter(filter, variants[vi], results[vi], source);
+
+    if (constant) {
+      PNMImage expected(size / 2, size / 2, num_channels);
+      expected.copy_sub_image(source, 0, 0, 0, 0, size / 2, size / 2);
+      int diff = max_difference(expected, results[vi]);
+      if (diff > 1) {
+        nout << label.str() << ": " << variants[vi]._name
+             << " changed the constant value by " << diff << "\n";
+        return false;
+      }
+    }
+  }
+
+  for (int vi = 1; vi < num_variants; ++vi) {
+    int diff = max_difference(results[0], results[vi]);
+    if (diff > 1) {
+      nout << label.str() << ": " << variants[vi]._name
+           << " differs from the original by " << diff << "\n";
+      return false;
+    }
+  }
+
+  // The threads only divide up the lines, so the threaded result
+  // must be exactly the same as the unthreaded one.
+  if (max_difference(results[num_variants - 2], results[num_variants - 1]) != 0) {
+    nout << label.str() << ": " << variants[num_variants - 1]._name
+         << " differs from " << variants[num_variants - 2]._name << "\n";
+    return false;
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  bool all_ok = true;
+
+  for (int si = 0; si < num_image_sizes; ++si) {
+    for (int num_channels = 1; num_channels <= 4; ++num_channels) {
+      PNMImage source, constant;
+      make_image(source, image_sizes[si], num_channels, false);
+      make_image(constant, image_sizes[si], num_channels, true);
+
+      for (int fi = 0; fi < num_filters; ++fi) {
+        all_ok = check_filter((Filter)fi, source, false) && all_ok;
+        all_ok = check_filter((Filter)fi, constant, true) && all_ok;
+      }
+    }
+  }
+
+  if (!all_ok) {
+    return 1;
+  }
+  nout << "All tests passed.\n";
+  return 0;
+}
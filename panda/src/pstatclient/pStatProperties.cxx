@@ -170,6 +170,9 @@ static LevelCollectorProperties level_properties[] = {
   { 1, "Geom cache operations:erase",      { 0.4, 0.8, 0.2 } },
   { 1, "Geom cache operations:evict",      { 0.8, 0.2, 0.4 } },
   { 1, "Data transferred",                 { 0.0, 0.2, 0.4 },  "MB", 12, 1048576 },
+  { 1, "Texture upload",                   { 0.4, 0.2, 0.6 },  "MB", 12, 1048576 },
+  { 1, "Texture upload:In flight",         { 0.8, 0.5, 1.0 } },
+  { 1, "Texture upload:Staged",            { 0.5, 0.8, 0.6 } },
   { 1, "Primitive batches",                { 0.2, 0.5, 0.9 },  "", 500 },
   { 1, "Primitive batches:Other",          { 0.2, 0.2, 0.2 } },
   { 1, "Primitive batches:Triangles",      { 0.8, 0.8, 0.8 } },
@@ -222,6 +225,12 @@ static LevelCollectorProperties level_properties[] = {
   { 1, "RenderStates:On nodes",            { 0.2, 0.8, 1.0 } },
   { 1, "RenderStates:Cached",              { 1.0, 0.0, 0.2 } },
   { 1, "RenderStates:Unused",              { 0.2, 0.2, 0.2 } },
+  { 1, "State GC Visited",                 { 0.4, 0.7, 0.7 },  "", 5000 },
+  { 1, "State GC Visited:TransformState",  { 1.0, 0.5, 0.5 } },
+  { 1, "State GC Visited:RenderState",     { 0.5, 0.5, 1.0 } },
+  { 1, "State GC Freed",                   { 0.7, 0.4, 0.4 },  "", 500 },
+  { 1, "State GC Freed:TransformState",    { 1.0, 0.5, 0.5 } },
+  { 1, "State GC Freed:RenderState",       { 0.5, 0.5, 1.0 } },
   { 1, "PipelineCyclers",                  { 0.5, 0.5, 1.0 },  "", 50000 },
   { 1, "Dirty PipelineCyclers",            { 0.2, 0.2, 0.2 },  "", 5000 },
   { 1, "Collision Volumes",                { 1.0, 0.8, 0.5 },  "", 500 },
@@ -206,6 +206,16 @@
 
 #end test_bin_target
 
+#begin test_bin_target
+  #define TARGET test_bamIndex
+  #define LOCAL_LIBS \
+    p3putil p3pgraph
+
+  #define SOURCES \
+    test_bam.cxx test_bam.h test_bamIndex.cxx
+
+#end test_bin_target
+
 #begin test_bin_target
   #define TARGET test_filename
 
@@ -243,3 +253,14 @@
   #define OTHER_LIBS $[OTHER_LIBS] p3pystub
 
 #end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_datagramCodec
+
+  #define SOURCES \
+    test_datagramCodec.cxx
+
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3putil
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+#end test_bin_target
@@ -72,6 +72,12 @@ BamCache() :
               "by the GSG.  This may be set in conjunction with "
               "model-cache-textures, or it may be independent."));
 
+  ConfigVariableBool model_cache_compress
+    ("model-cache-compress", false,
+     PRC_DESC("If this is set to true, the files written to the model cache "
+              "will be compressed with the codec named by compression-codec.  "
+              "Set compression-codec to lz4 for fast loads."));
+
   ConfigVariableInt model_cache_max_kbytes
     ("model-cache-max-kbytes", 10485760,
      PRC_DESC("This is the maximum size of the model cache, in kilobytes."));
@@ -79,6 +85,7 @@ BamCache() :
   _cache_models = model_cache_models;
   _cache_textures = model_cache_textures;
   _cache_compressed_textures = model_cache_compressed_textures;
+  _compress = model_cache_compress;
 
   _flush_time = model_cache_flush;
   _max_kbytes = model_cache_max_kbytes;
@@ -222,6 +229,9 @@ store(BamCacheRecord *record) {
   temp_pathname.set_binary();
 
   DatagramOutputFile dout;
+  if (_compress) {
+    dout.set_compression_codec(CompressionCodec::get_default_codec());
+  }
   if (!dout.open(temp_pathname)) {
     util_cat.error()
       << "Could not write cache file: " << temp_pathname << "\n";
@@ -278,6 +288,14 @@ store(BamCacheRecord *record) {
   record->_record_size = dout.get_file_pos();
   dout.close();
 
+  if (_compress) {
+    // Account for the size of the file as it actually is on disk.
+    PT(VirtualFile) vfile = vfs->get_file(temp_pathname);
+    if (vfile != (VirtualFile *)NULL) {
+      record->_record_size = vfile->get_file_size();
+    }
+  }
+
   // Now move the file into place.
   if (!vfs->rename_file(temp_pathname, cache_pathname) && vfs->exists(temp_pathname)) {
     vfs->delete_file(cache_pathname);
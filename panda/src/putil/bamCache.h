@@ -61,6 +61,9 @@ PUBLISHED:
   INLINE void set_cache_compressed_textures(bool flag);
   INLINE bool get_cache_compressed_textures() const;
 
+  INLINE void set_compress(bool flag);
+  INLINE bool get_compress() const;
+
   void set_root(const Filename &root);
   INLINE Filename get_root() const;
 
@@ -115,6 +118,7 @@ private:
   bool _cache_models;
   bool _cache_textures;
   bool _cache_compressed_textures;
+  bool _compress;
   bool _read_only;
   Filename _root;
   int _flush_time;
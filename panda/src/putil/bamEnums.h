@@ -48,13 +48,20 @@ PUBLISHED:
   // level.  BOC_remove lists object ID's that have been deallocated
   // on the sender end.  BOC_file_data may appear at any level and
   // indicates the following datagram contains auxiliary file data
-  // that may be referenced by a later object.
+  // that may be referenced by a later object.  BOC_reset appears only
+  // at the top level of an indexed bam file, before each object that
+  // may be read independently of the objects before it, and clears
+  // all object, type, and array ID's.  BOC_index marks the table of
+  // the file positions of these objects at the end of the file, and
+  // the fixed-size record following it that locates the table.
   enum BamObjectCode {
     BOC_push,
     BOC_pop,
     BOC_adjunct,
     BOC_remove,
     BOC_file_data,
+    BOC_reset,
+    BOC_index,
   };
 
   // This enum is used to control how textures are written to a bam
@@ -20,6 +20,7 @@
 #include "datagramIterator.h"
 #include "config_util.h"
 #include "pipelineCyclerBase.h"
+#include "virtualFile.h"
 
 TypeHandle BamReaderAuxData::_type_handle;
 
@@ -50,6 +51,7 @@ BamReader(DatagramGenerator *source)
   _pta_id = -1;
   _long_object_id = false;
   _long_pta_id = false;
+  _has_index = false;
 }
 
 
@@ -480,6 +482,145 @@ resolve() {
   return all_completed;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::read_index
+//       Access: Published
+//  Description: Reads the table of objects from the end of an indexed
+//               Bam file, as written by a BamWriter with
+//               set_file_indexed() in effect, after which the objects
+//               may be read in any order, as they are needed, with
+//               read_indexed_object().  This requires that the source
+//               is a file that supports random access.
+//
+//               Returns true if the index was read, or false if the
+//               file has no index (in which case it may still be read
+//               from beginning to end with read_object()).
+////////////////////////////////////////////////////////////////////
+bool BamReader::
+read_index() {
+  nassertr(_source != NULL && !_needs_init, false);
+  _indexed_objects.clear();
+  _has_index = false;
+
+  VirtualFile *vfile = _source->get_vfile();
+  if (_file_minor < 35 || vfile == (VirtualFile *)NULL) {
+    return false;
+  }
+
+  // The file ends with a datagram of fixed size that gives the
+  // position of the table: a 32-bit length, followed by the
+  // BOC_index code and a 64-bit position.
+  static const streamoff tail_size = 4 + 1 + 8;
+  streamoff file_size = vfile->get_file_size();
+  if (file_size < tail_size) {
+    return false;
+  }
+
+  streampos orig_pos = _source->get_file_pos();
+
+  Datagram dg;
+  if (_source->set_file_pos(file_size - tail_size) &&
+      get_datagram(dg) && dg.get_length() == 1 + 8) {
+    DatagramIterator scan(dg);
+    if ((BamObjectCode)scan.get_uint8() == BOC_index) {
+      streampos index_pos = (streamoff)scan.get_uint64();
+      if (_source->set_file_pos(index_pos) && get_datagram(dg)) {
+        scan.assign(dg);
+        if (dg.get_length() >= 1 + 4 &&
+            (BamObjectCode)scan.get_uint8() == BOC_index) {
+          size_t num_objects = scan.get_uint32();
+          if ((size_t)scan.get_remaining_size() == num_objects * 8) {
+            _indexed_objects.reserve(num_objects);
+            for (size_t i = 0; i < num_objects; ++i) {
+              IndexedObject indexed;
+              indexed._pos = (streamoff)scan.get_uint64();
+              _indexed_objects.push_back(indexed);
+            }
+            _has_index = true;
+          }
+        }
+      }
+    }
+  }
+
+  _source->set_file_pos(orig_pos);
+
+  if (!_has_index) {
+    bam_cat.warning()
+      << "Bam file " << get_filename() << " has no valid index.\n";
+  }
+  return _has_index;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::read_indexed_object
+//       Access: Published
+//  Description: Reads the nth independent object of an indexed Bam
+//               file, along with all of the objects it references,
+//               after a successful call to read_index().  Unlike
+//               read_object(), the object is fully resolved on
+//               return.
+//
+//               The BamReader does not keep a reference to the
+//               object; once the caller (and any scene graph it is
+//               attached to) releases it, its memory is freed, and a
+//               later call will read it from the file again.  Until
+//               then, calling this again returns the same object.
+//               This allows an application to page the parts of a
+//               very large scene in and out as needed.
+//
+//               The return value is NULL if the object could not be
+//               read.
+////////////////////////////////////////////////////////////////////
+PT(TypedWritableReferenceCount) BamReader::
+read_indexed_object(int n) {
+  nassertr(n >= 0 && n < (int)_indexed_objects.size(), NULL);
+  IndexedObject &indexed = _indexed_objects[n];
+  if (indexed._object.is_valid_pointer()) {
+    return indexed._object.p();
+  }
+
+  nassertr(_nesting_level == 0, NULL);
+  if (!_source->set_file_pos(indexed._pos)) {
+    bam_cat.error()
+      << "Unable to seek to object " << n << " of " << get_filename()
+      << ".\n";
+    return NULL;
+  }
+
+  TypedWritable *ptr;
+  ReferenceCount *ref_ptr;
+  if (!read_object(ptr, ref_ptr) || ptr == (TypedWritable *)NULL) {
+    bam_cat.error()
+      << "Unable to read object " << n << " of " << get_filename()
+      << ".\n";
+    return NULL;
+  }
+
+  if (!resolve()) {
+    bam_cat.error()
+      << "Unable to resolve object " << n << " of " << get_filename()
+      << ".\n";
+    return NULL;
+  }
+
+  PT(TypedWritableReferenceCount) object;
+  if (ptr->is_of_type(TypedWritableReferenceCount::get_class_type())) {
+    object = DCAST(TypedWritableReferenceCount, ptr);
+  } else {
+    bam_cat.error()
+      << "Object " << n << " of " << get_filename() << " is a "
+      << ptr->get_type() << ", which is not reference counted.\n";
+  }
+
+  // Now drop our own references to everything we just read, so that
+  // the object goes away as soon as the caller is done with it.
+  reset_object_ids();
+
+  indexed._object = object;
+  return object;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamReader::change_pointer
 //       Access: Published
@@ -1101,6 +1242,30 @@ free_object_ids(DatagramIterator &scan) {
 }
 
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::reset_object_ids
+//       Access: Private
+//  Description: Handles a BOC_reset record, which begins a new
+//               independent object in an indexed file.  Resolves
+//               everything read so far, and then forgets all of the
+//               object, type, and array ID's, releasing the
+//               references we hold on the objects themselves.
+////////////////////////////////////////////////////////////////////
+void BamReader::
+reset_object_ids() {
+  resolve();
+
+  _created_objs.clear();
+  _now_creating = _created_objs.end();
+  _created_objs_by_pointer.clear();
+  _object_pointers.clear();
+  _index_map.clear();
+  _pta_map.clear();
+  _aux_data.clear();
+  _long_object_id = false;
+  _long_pta_id = false;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamReader::read_object_id
 //       Access: Private
@@ -1214,6 +1379,18 @@ p_read_object() {
     }
 
     return p_read_object();
+
+  case BOC_reset:
+    // This begins an independent object of an indexed file.  None of
+    // the objects that came before will be referenced again.
+    nassertr(_nesting_level == 0, 0);
+    reset_object_ids();
+    return p_read_object();
+
+  case BOC_index:
+    // This is the table at the end of an indexed file.  It is only of
+    // interest to read_index().
+    return p_read_object();
   }
 
   // An object definition in a Bam file consists of a TypeHandle
@@ -21,6 +21,7 @@
 #include "typedWritable.h"
 #include "typedWritableReferenceCount.h"
 #include "pointerTo.h"
+#include "weakPointerTo.h"
 #include "datagramGenerator.h"
 #include "datagramIterator.h"
 #include "bamReaderParam.h"
@@ -32,6 +33,7 @@
 #include "pset.h"
 #include "pmap.h"
 #include "pdeque.h"
+#include "pvector.h"
 #include "dcast.h"
 #include "pipelineCyclerBase.h"
 #include "referenceCount.h"
@@ -150,6 +152,12 @@ PUBLISHED:
   INLINE bool is_eof() const;
   bool resolve();
 
+  bool read_index();
+  INLINE bool has_index() const;
+  INLINE int get_num_indexed_objects() const;
+  INLINE bool is_indexed_object_loaded(int n) const;
+  PT(TypedWritableReferenceCount) read_indexed_object(int n);
+
   bool change_pointer(const TypedWritable *orig_pointer, const TypedWritable *new_pointer);
 
   INLINE int get_file_major_ver() const;
@@ -206,6 +214,7 @@ private:
   class PointerReference;
 
   void free_object_ids(DatagramIterator &scan);
+  void reset_object_ids();
   int read_object_id(DatagramIterator &scan);
   int read_pta_id(DatagramIterator &scan);
   int p_read_object();
@@ -329,6 +338,18 @@ private:
   typedef phash_map<TypedWritable *, AuxDataNames, pointer_hash> AuxDataTable;
   AuxDataTable _aux_data;
 
+  // This is the table read from the end of an indexed file by
+  // read_index(), with a weak pointer to each object that has been
+  // read from it, so that it can be shared until it is released.
+  class IndexedObject {
+  public:
+    streampos _pos;
+    WPT(TypedWritableReferenceCount) _object;
+  };
+  typedef pvector<IndexedObject> IndexedObjects;
+  IndexedObjects _indexed_objects;
+  bool _has_index;
+
   int _file_major, _file_minor;
   BamEndian _file_endian;
   bool _file_stdfloat_double;
@@ -44,9 +44,11 @@ BamWriter(DatagramSink *target) :
   _next_pta_id = 1;
   _long_pta_id = false;
 
+  _file_minor = _bam_unindexed_minor_ver;
   _file_endian = bam_endian;
   _file_stdfloat_double = bam_stdfloat_double;
   _file_texture_mode = bam_texture_mode;
+  _file_indexed = false;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -56,18 +58,7 @@ BamWriter(DatagramSink *target) :
 ////////////////////////////////////////////////////////////////////
 BamWriter::
 ~BamWriter() {
-  // Tell all the TypedWritables whose pointer we are still keeping to
-  // forget about us.
-  StateMap::iterator si;
-  for (si = _state_map.begin(); si != _state_map.end(); ++si) {
-    TypedWritable *object = (TypedWritable *)(*si).first;
-    LightMutexHolder holder(TypedWritable::_bam_writers_lock);
-    nassertv(object->_bam_writers != (TypedWritable::BamWriters *)NULL);
-    TypedWritable::BamWriters::iterator wi = 
-      find(object->_bam_writers->begin(), object->_bam_writers->end(), this);
-    nassertv(wi != object->_bam_writers->end());
-    object->_bam_writers->erase(wi);
-  }
+  forget_objects();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -115,11 +106,24 @@ init() {
   _file_endian = bam_endian;
   _file_texture_mode = bam_texture_mode;
 
+  if (_file_indexed && !_target->is_seekable()) {
+    // The index records positions that the reader must be able to
+    // seek to, which it cannot do within a compressed stream.
+    util_cat.warning()
+      << "Cannot write an index to " << _target->get_filename()
+      << ", since it is compressed or does not support seeking; "
+      << "writing it without an index.\n";
+    _file_indexed = false;
+  }
+
   // Write out the current major and minor BAM file version numbers.
+  // Only an indexed file needs the current minor version.
+  _file_minor = _file_indexed ? _bam_minor_ver : _bam_unindexed_minor_ver;
+
   Datagram header;
 
   header.add_uint16(_bam_major_ver);
-  header.add_uint16(_bam_minor_ver);
+  header.add_uint16(_file_minor);
   header.add_uint8(_file_endian);
   header.add_bool(_file_stdfloat_double);
 
@@ -157,6 +161,14 @@ bool BamWriter::
 write_object(const TypedWritable *object) {
   nassertr(_target != NULL, false);
 
+  if (_file_indexed) {
+    // Each object in an indexed file must stand on its own, without
+    // referencing anything written before it.
+    if (!write_reset()) {
+      return false;
+    }
+  }
+
   // Increment the _writing_seq, so we can check for newly stale
   // objects during this operation.
   ++_writing_seq;
@@ -202,6 +214,49 @@ write_object(const TypedWritable *object) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamWriter::write_index
+//       Access: Published
+//  Description: Writes the table of object positions that ends an
+//               indexed Bam file.  This should be called once, after
+//               the last call to write_object(); BamFile::close()
+//               calls it automatically.  See set_file_indexed().
+//
+//               Returns true if the index is successfully written,
+//               false otherwise.
+////////////////////////////////////////////////////////////////////
+bool BamWriter::
+write_index() {
+  nassertr(_target != NULL, false);
+  nassertr(_file_indexed, false);
+
+  streampos index_pos = _target->get_file_pos();
+
+  Datagram dg;
+  dg.add_uint8(BOC_index);
+  dg.add_uint32(_object_offsets.size());
+  ObjectOffsets::const_iterator oi;
+  for (oi = _object_offsets.begin(); oi != _object_offsets.end(); ++oi) {
+    dg.add_uint64((streamoff)(*oi));
+  }
+
+  // The table is followed by a record of fixed size that gives its
+  // position, so that the reader can find it by seeking back from
+  // the end of the file.
+  Datagram tail;
+  tail.add_uint8(BOC_index);
+  tail.add_uint64((streamoff)index_pos);
+
+  if (!_target->put_datagram(dg) || !_target->put_datagram(tail)) {
+    util_cat.error()
+      << "Unable to write data to output.\n";
+    return false;
+  }
+
+  _object_offsets.clear();
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamWriter::has_object
 //       Access: Published
@@ -755,3 +810,59 @@ flush_queue() {
 
   return true;
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamWriter::forget_objects
+//       Access: Private
+//  Description: Tells all the TypedWritables whose pointer we are
+//               still keeping to forget about us, and empties the
+//               table of objects written so far.
+////////////////////////////////////////////////////////////////////
+void BamWriter::
+forget_objects() {
+  StateMap::iterator si;
+  for (si = _state_map.begin(); si != _state_map.end(); ++si) {
+    TypedWritable *object = (TypedWritable *)(*si).first;
+    LightMutexHolder holder(TypedWritable::_bam_writers_lock);
+    nassertv(object->_bam_writers != (TypedWritable::BamWriters *)NULL);
+    TypedWritable::BamWriters::iterator wi = 
+      find(object->_bam_writers->begin(), object->_bam_writers->end(), this);
+    nassertv(wi != object->_bam_writers->end());
+    object->_bam_writers->erase(wi);
+  }
+  _state_map.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamWriter::write_reset
+//       Access: Private
+//  Description: Called at the start of each object in an indexed
+//               file.  Forgets all of the objects, types, and arrays
+//               written so far, so that they will be written again if
+//               they are referenced, and writes the BOC_reset code
+//               that tells the reader to do the same.  Also records
+//               the position of the new object for the index.
+////////////////////////////////////////////////////////////////////
+bool BamWriter::
+write_reset() {
+  forget_objects();
+  _types_written.clear();
+  _pta_map.clear();
+  _freed_object_ids.clear();
+
+  _next_object_id = 1;
+  _long_object_id = false;
+  _next_pta_id = 1;
+  _long_pta_id = false;
+
+  _object_offsets.push_back(_target->get_file_pos());
+
+  Datagram dg;
+  dg.add_uint8(BOC_reset);
+  if (!_target->put_datagram(dg)) {
+    util_cat.error()
+      << "Unable to write data to output.\n";
+    return false;
+  }
+  return true;
+}
@@ -23,6 +23,7 @@
 #include "pdeque.h"
 #include "pset.h"
 #include "pmap.h"
+#include "pvector.h"
 #include "vector_int.h"
 #include "pipelineCyclerBase.h"
 
@@ -84,12 +85,17 @@ PUBLISHED:
   bool has_object(const TypedWritable *obj) const;
   void flush();
 
+  INLINE int get_file_minor_ver() const;
   INLINE BamEndian get_file_endian() const;
   INLINE bool get_file_stdfloat_double() const;
 
   INLINE BamTextureMode get_file_texture_mode() const;
   INLINE void set_file_texture_mode(BamTextureMode file_texture_mode);
 
+  INLINE bool get_file_indexed() const;
+  INLINE void set_file_indexed(bool file_indexed);
+  bool write_index();
+
 public:
   // Functions to support classes that write themselves to the Bam.
 
@@ -113,10 +119,19 @@ private:
   void write_pta_id(Datagram &dg, int pta_id);
   int enqueue_object(const TypedWritable *object);
   bool flush_queue();
+  void forget_objects();
+  bool write_reset();
 
+  int _file_minor;
   BamEndian _file_endian;
   bool _file_stdfloat_double;
   BamTextureMode _file_texture_mode;
+  bool _file_indexed;
+
+  // The file position of each independent object written to an
+  // indexed file, in the order they were written.
+  typedef pvector<streampos> ObjectOffsets;
+  ObjectOffsets _object_offsets;
 
   // This is the set of all TypeHandles already written.
   pset<int, int_hash> _types_written;
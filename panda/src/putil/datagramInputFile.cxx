@@ -22,12 +22,17 @@
 #include "virtualFileSystem.h"
 #include "streamReader.h"
 #include "thread.h"
+#include "codecStream.h"
 
 ////////////////////////////////////////////////////////////////////
 //     Function: DatagramInputFile::open
 //       Access: Published
 //  Description: Opens the indicated filename for reading.  Returns
 //               true on success, false on failure.
+//
+//               If the file was compressed by a DatagramOutputFile
+//               with a compression codec, it is decompressed
+//               automatically as it is read.
 ////////////////////////////////////////////////////////////////////
 bool DatagramInputFile::
 open(const FileReference *file) {
@@ -48,7 +53,16 @@ open(const FileReference *file) {
   _timestamp = _vfile->get_timestamp();
   _in = _vfile->open_read_file(true);
   _owns_in = (_in != (istream *)NULL);
-  return _owns_in && !_in->fail();
+  if (!_owns_in || _in->fail()) {
+    return false;
+  }
+
+  if (ICodecStream::is_codec_stream(*_in)) {
+    _raw_in = _in;
+    _codec_in = new ICodecStream(_raw_in, false);
+    _in = _codec_in;
+  }
+  return !_in->fail();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -85,6 +99,12 @@ open(istream &in, const Filename &filename) {
 void DatagramInputFile::
 close() {
   _vfile.clear();
+  if (_codec_in != (ICodecStream *)NULL) {
+    delete _codec_in;
+    _codec_in = (ICodecStream *)NULL;
+    _in = _raw_in;
+    _raw_in = (istream *)NULL;
+  }
   if (_owns_in) {
     VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
     vfs->close_read_file(_in);
@@ -230,9 +250,9 @@ save_datagram(SubfileInfo &info) {
     num_bytes = reader.get_uint64();
   }
 
-  // If this stream is file-based, we can just point the SubfileInfo
-  // directly into this file.
-  if (_file != (FileReference *)NULL) {
+  // If this stream is file-based, and not compressed, we can just
+  // point the SubfileInfo directly into this file.
+  if (_file != (FileReference *)NULL && _codec_in == (ICodecStream *)NULL) {
     info = SubfileInfo(_file, _in->tellg(), num_bytes);
     _in->seekg(num_bytes, ios::cur);
     return true;
@@ -383,3 +403,32 @@ get_file_pos() {
   }
   return _in->tellg();
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramInputFile::set_file_pos
+//       Access: Published, Virtual
+//  Description: Repositions the file so that the next call to
+//               get_datagram() will return the datagram that begins
+//               at the indicated position, which should have been
+//               returned by a previous call to get_file_pos() (or
+//               DatagramOutputFile::get_file_pos(), when the file was
+//               written).  Returns true on success, false if the
+//               stream could not be repositioned.
+//
+//               This may also be used to return to the beginning of
+//               a datagram after reaching the end of the file.
+////////////////////////////////////////////////////////////////////
+bool DatagramInputFile::
+set_file_pos(streampos pos) {
+  nassertr(_in != (istream *)NULL, false);
+  _in->clear();
+  _in->seekg(pos);
+  if (_in->fail()) {
+    _in->clear();
+    return false;
+  }
+
+  _read_first_datagram = true;
+  _error = false;
+  return true;
+}
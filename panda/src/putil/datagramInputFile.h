@@ -22,6 +22,8 @@
 #include "fileReference.h"
 #include "virtualFile.h"
 
+class ICodecStream;
+
 ////////////////////////////////////////////////////////////////////
 //       Class : DatagramInputFile
 // Description : This class can be used to read a binary file that
@@ -51,6 +53,7 @@ PUBLISHED:
   virtual const FileReference *get_file();
   virtual VirtualFile *get_vfile();
   virtual streampos get_file_pos();
+  virtual bool set_file_pos(streampos pos);
 
 private:
   bool _read_first_datagram;
@@ -59,6 +62,8 @@ private:
   PT(VirtualFile) _vfile;
   istream *_in;
   bool _owns_in;
+  ICodecStream *_codec_in;
+  istream *_raw_in;
   Filename _filename;
   time_t _timestamp;
 };
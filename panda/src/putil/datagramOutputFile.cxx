@@ -15,6 +15,7 @@
 #include "datagramOutputFile.h"
 #include "streamWriter.h"
 #include "zStream.h"
+#include "codecStream.h"
 #include <algorithm>
 
 ////////////////////////////////////////////////////////////////////
@@ -22,6 +23,10 @@
 //       Access: Public
 //  Description: Opens the indicated filename for writing.  Returns
 //               true if successful, false on failure.
+//
+//               If a codec has been specified with
+//               set_compression_codec(), the file is compressed as it
+//               is written.
 ////////////////////////////////////////////////////////////////////
 bool DatagramOutputFile::
 open(const FileReference *file) {
@@ -41,7 +46,16 @@ open(const FileReference *file) {
   }
   _out = _vfile->open_write_file(true, true);
   _owns_out = (_out != (ostream *)NULL);
-  return _owns_out && !_out->fail();
+  if (!_owns_out || _out->fail()) {
+    return false;
+  }
+
+  if (_codec != (CompressionCodec *)NULL) {
+    _raw_out = _out;
+    _codec_out = new OCodecStream(_raw_out, false, _codec);
+    _out = _codec_out;
+  }
+  return !_out->fail();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -77,6 +91,14 @@ open(ostream &out, const Filename &filename) {
 void DatagramOutputFile::
 close() {
   _vfile.clear();
+  if (_codec_out != (OCodecStream *)NULL) {
+    // Deleting the compression stream flushes the last of the data
+    // to the underlying file.
+    delete _codec_out;
+    _codec_out = (OCodecStream *)NULL;
+    _out = _raw_out;
+    _raw_out = (ostream *)NULL;
+  }
   if (_owns_out) {
     VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
     vfs->close_write_file(_out);
@@ -208,7 +230,10 @@ copy_datagram(SubfileInfo &result, const Filename &filename) {
     return false;
   }
   
-  result = SubfileInfo(_file, start, size);
+  if (_codec_out == (OCodecStream *)NULL) {
+    // We can only refer back to the data if it was not compressed.
+    result = SubfileInfo(_file, start, size);
+  }
   return true;
 }
 
@@ -273,7 +298,9 @@ copy_datagram(SubfileInfo &result, const SubfileInfo &source) {
     return false;
   }
 
-  result = SubfileInfo(_file, start, source.get_size());
+  if (_codec_out == (OCodecStream *)NULL) {
+    result = SubfileInfo(_file, start, source.get_size());
+  }
   return true;
 }
 
@@ -352,3 +379,23 @@ get_file_pos() {
   }
   return _out->tellp();
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramOutputFile::is_seekable
+//       Access: Published, Virtual
+//  Description: Returns true if the positions returned by
+//               get_file_pos() may be used to seek within the file
+//               when it is read back.  This is not the case if the
+//               file is compressed, either with
+//               set_compression_codec() or implicitly by a .pz
+//               extension: a compression codec reports positions
+//               within the uncompressed data, which cannot be sought
+//               to, and a .pz stream reports no position at all.
+////////////////////////////////////////////////////////////////////
+bool DatagramOutputFile::
+is_seekable() {
+  if (_out == (ostream *)NULL || _codec_out != (OCodecStream *)NULL) {
+    return false;
+  }
+  return _out->tellp() != (streampos)-1;
+}
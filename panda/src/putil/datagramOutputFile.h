@@ -21,6 +21,10 @@
 #include "filename.h"
 #include "fileReference.h"
 #include "virtualFile.h"
+#include "compressionCodec.h"
+#include "pointerTo.h"
+
+class OCodecStream;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : DatagramOutputFile
@@ -40,6 +44,9 @@ public:
 
   void close();
 
+  INLINE void set_compression_codec(CompressionCodec *codec);
+  INLINE CompressionCodec *get_compression_codec() const;
+
   bool write_header(const string &header);
   virtual bool put_datagram(const Datagram &data);
   virtual bool copy_datagram(SubfileInfo &result, const Filename &filename);
@@ -50,6 +57,7 @@ public:
   virtual const Filename &get_filename();
   virtual const FileReference *get_file();
   virtual streampos get_file_pos();
+  virtual bool is_seekable();
 
 private:
   bool _wrote_first_datagram;
@@ -58,6 +66,9 @@ private:
   PT(VirtualFile) _vfile;
   ostream *_out;
   bool _owns_out;
+  PT(CompressionCodec) _codec;
+  OCodecStream *_codec_out;
+  ostream *_raw_out;
   Filename _filename;
 };
 
@@ -0,0 +1,238 @@
+// Filename: test_bamIndex.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "pnotify.h"
+
+#include "test_bam.h"
+#include "bam.h"
+#include "datagramOutputFile.h"
+#include "datagramInputFile.h"
+#include "compressionCodec.h"
+
+// This program writes the same few objects to an ordinary Bam file
+// and to an indexed one, checks the version number of each, and then
+// reads the objects of the indexed file back, both in reverse order
+// through the index and from beginning to end.  It also asks for an
+// index in a compressed file, which can't be sought within, and
+// checks that the file is written without one.
+
+static const int num_people = 4;
+static const char *const names[num_people] = {
+  "Attila", "Brunhilda", "Bob", "Mary Poppins"
+};
+
+static bool
+write_file(const Filename &filename, bool indexed,
+           CompressionCodec *codec = NULL) {
+  DatagramOutputFile stream;
+  stream.set_compression_codec(codec);
+  if (!stream.open(filename) || !stream.write_header(_bam_header)) {
+    nout << "Unable to write " << filename << "\n";
+    return false;
+  }
+
+  PT(Parent) dad = new Parent(names[0], Person::MALE);
+  PT(Parent) mom = new Parent(names[1], Person::FEMALE);
+  PT(Child) bro = new Child(names[2], Person::MALE);
+  PT(Child) sis = new Child(names[3], Person::FEMALE);
+
+  dad->setSon(bro);
+  dad->setDaughter(sis);
+  mom->setSon(bro);
+  mom->setDaughter(sis);
+  bro->setMother(mom);
+  bro->setFather(dad);
+  bro->setSister(sis);
+  sis->setFather(dad);
+  sis->setMother(mom);
+  sis->setBrother(bro);
+
+  BamWriter manager(&stream);
+  manager.set_file_indexed(indexed);
+  if (!manager.init()) {
+    return false;
+  }
+
+  // An index can't be written to a compressed file.
+  bool compressed = (codec != (CompressionCodec *)NULL ||
+                     filename.get_extension() == "pz");
+  if (indexed && compressed) {
+    if (manager.get_file_indexed()) {
+      nout << filename << " is compressed, but was written with an index\n";
+      return false;
+    }
+    indexed = false;
+  }
+
+  int expected_minor = indexed ? _bam_minor_ver : _bam_unindexed_minor_ver;
+  if (manager.get_file_minor_ver() != expected_minor) {
+    nout << filename << " written as version " << _bam_major_ver << "."
+         << manager.get_file_minor_ver() << ", expected "
+         << _bam_major_ver << "." << expected_minor << "\n";
+    return false;
+  }
+
+  if (!manager.write_object(dad) || !manager.write_object(mom) ||
+      !manager.write_object(bro) || !manager.write_object(sis)) {
+    nout << "Unable to write objects to " << filename << "\n";
+    return false;
+  }
+  if (indexed && !manager.write_index()) {
+    nout << "Unable to write index to " << filename << "\n";
+    return false;
+  }
+  return true;
+}
+
+static bool
+check_person(TypedWritable *object, int n) {
+  if (object == (TypedWritable *)NULL ||
+      !object->is_of_type(Person::get_class_type()) ||
+      DCAST(Person, object)->name() != names[n]) {
+    nout << "Object " << n << " is wrong\n";
+    return false;
+  }
+  return true;
+}
+
+static bool
+open_file(DatagramInputFile &stream, BamReader &manager,
+          const Filename &filename, int expected_minor) {
+  string header;
+  if (!stream.open(filename) ||
+      !stream.read_header(header, _bam_header.size()) ||
+      header != _bam_header || !manager.init()) {
+    nout << "Unable to read " << filename << "\n";
+    return false;
+  }
+  if (manager.get_file_minor_ver() != expected_minor) {
+    nout << filename << " has version " << manager.get_file_major_ver()
+         << "." << manager.get_file_minor_ver() << ", expected "
+         << _bam_major_ver << "." << expected_minor << "\n";
+    return false;
+  }
+  return true;
+}
+
+static bool
+read_plain_file(const Filename &filename) {
+  DatagramInputFile stream;
+  BamReader manager(&stream);
+  if (!open_file(stream, manager, filename, _bam_unindexed_minor_ver)) {
+    return false;
+  }
+  if (manager.read_index()) {
+    nout << filename << " should not have an index\n";
+    return false;
+  }
+
+  PT(TypedWritableReferenceCount) people[num_people];
+  for (int n = 0; n < num_people; ++n) {
+    people[n] = DCAST(TypedWritableReferenceCount, manager.read_object());
+  }
+  manager.resolve();
+  for (int n = 0; n < num_people; ++n) {
+    if (!check_person(people[n], n)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool
+read_indexed_file(const Filename &filename) {
+  DatagramInputFile stream;
+  BamReader manager(&stream);
+  if (!open_file(stream, manager, filename, _bam_minor_ver)) {
+    return false;
+  }
+  if (!manager.read_index() ||
+      manager.get_num_indexed_objects() != num_people) {
+    nout << filename << " has no index, or the wrong number of objects\n";
+    return false;
+  }
+
+  // Read them backwards through the index.
+  for (int n = num_people - 1; n >= 0; --n) {
+    PT(TypedWritableReferenceCount) object = manager.read_indexed_object(n);
+    if (!check_person(object, n)) {
+      return false;
+    }
+    if (!manager.is_indexed_object_loaded(n) ||
+        manager.read_indexed_object(n) != object) {
+      nout << "Object " << n << " was not kept while in use\n";
+      return false;
+    }
+    object.clear();
+    if (manager.is_indexed_object_loaded(n)) {
+      nout << "Object " << n << " was not released\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool
+read_indexed_file_in_order(const Filename &filename) {
+  DatagramInputFile stream;
+  BamReader manager(&stream);
+  if (!open_file(stream, manager, filename, _bam_minor_ver)) {
+    return false;
+  }
+
+  for (int n = 0; n < num_people; ++n) {
+    PT(TypedWritableReferenceCount) object =
+      DCAST(TypedWritableReferenceCount, manager.read_object());
+    manager.resolve();
+    if (!check_person(object, n)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  bool all_ok = true;
+
+  Filename plain = Filename::temporary("", "bam_", ".bam");
+  all_ok = write_file(plain, false) && read_plain_file(plain) && all_ok;
+  plain.unlink();
+
+  Filename indexed = Filename::temporary("", "bam_", ".bam");
+  all_ok = write_file(indexed, true) && read_indexed_file(indexed) &&
+    read_indexed_file_in_order(indexed) && all_ok;
+  indexed.unlink();
+
+  // Compressed by the DatagramOutputFile.
+  CompressionCodec *lz4 = CompressionCodec::get_codec(CompressionCodec::CI_lz4);
+  nassertr(lz4 != (CompressionCodec *)NULL, 1);
+  Filename codec = Filename::temporary("", "bam_", ".bam");
+  all_ok = write_file(codec, true, lz4) && read_plain_file(codec) && all_ok;
+  codec.unlink();
+
+#ifdef HAVE_ZLIB
+  // Compressed by the virtual file system.
+  Filename pz = Filename::temporary("", "bam_", ".bam.pz");
+  all_ok = write_file(pz, true) && read_plain_file(pz) && all_ok;
+  pz.unlink();
+#endif  // HAVE_ZLIB
+
+  if (!all_ok) {
+    return 1;
+  }
+  nout << "All tests passed.\n";
+  return 0;
+}
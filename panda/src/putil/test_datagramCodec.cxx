@@ -0,0 +1,110 @@
+// Filename: test_datagramCodec.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "datagramOutputFile.h"
+#include "datagramInputFile.h"
+#include "compressionCodec.h"
+#include "load_prc_file.h"
+#include "datagramIterator.h"
+#include "string_utils.h"
+
+// This program writes a compressed file of datagrams with
+// DatagramOutputFile and reads it back with DatagramInputFile, with
+// the compression applied both implicitly, by the .pz extension with
+// compression-codec lz4, and explicitly, by set_compression_codec().
+
+static const string header = "tst\n";
+static const int num_datagrams = 500;
+
+static bool
+write_file(const Filename &filename, CompressionCodec *codec) {
+  DatagramOutputFile out;
+  out.set_compression_codec(codec);
+  if (!out.open(filename) || !out.write_header(header)) {
+    nout << "Unable to write " << filename << "\n";
+    return false;
+  }
+  for (int i = 0; i < num_datagrams; ++i) {
+    Datagram dg;
+    dg.add_int32(i);
+    dg.add_string("datagram number " + format_string(i));
+    if (!out.put_datagram(dg)) {
+      nout << "Unable to write datagram " << i << " to " << filename << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool
+read_file(const Filename &filename) {
+  DatagramInputFile in;
+  string read_header;
+  if (!in.open(filename) || !in.read_header(read_header, header.size()) ||
+      read_header != header) {
+    nout << "Unable to read " << filename << "\n";
+    return false;
+  }
+  for (int i = 0; i < num_datagrams; ++i) {
+    Datagram dg;
+    if (!in.get_datagram(dg)) {
+      nout << "Unable to read datagram " << i << " from " << filename << "\n";
+      return false;
+    }
+    DatagramIterator di(dg);
+    if (di.get_int32() != i ||
+        di.get_string() != "datagram number " + format_string(i)) {
+      nout << "Datagram " << i << " of " << filename << " is wrong\n";
+      return false;
+    }
+  }
+
+  Datagram dg;
+  if (in.get_datagram(dg) || !in.is_eof()) {
+    nout << "Extra data at end of " << filename << "\n";
+    return false;
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  load_prc_file_data("test_datagramCodec", "compression-codec lz4");
+  CompressionCodec *lz4 = CompressionCodec::get_codec(CompressionCodec::CI_lz4);
+  nassertr(lz4 != (CompressionCodec *)NULL, 1);
+
+  bool all_ok = true;
+
+  // Compressed by the virtual file system only.
+  Filename implicit = Filename::temporary("", "dgc_", ".dat.pz");
+  all_ok = write_file(implicit, NULL) && read_file(implicit) && all_ok;
+  implicit.unlink();
+
+  // Compressed by the DatagramOutputFile only.
+  Filename explicit_name = Filename::temporary("", "dgc_", ".dat");
+  all_ok = write_file(explicit_name, lz4) && read_file(explicit_name) && all_ok;
+  explicit_name.unlink();
+
+  // Compressed by both.
+  Filename both = Filename::temporary("", "dgc_", ".dat.pz");
+  all_ok = write_file(both, lz4) && read_file(both) && all_ok;
+  both.unlink();
+
+  if (!all_ok) {
+    return 1;
+  }
+  nout << "All tests passed.\n";
+  return 0;
+}
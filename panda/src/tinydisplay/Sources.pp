@@ -26,6 +26,7 @@
     tinyGraphicsBuffer.h tinyGraphicsBuffer.I \
     tinyGraphicsStateGuardian.h tinyGraphicsStateGuardian.I \
     tinyTextureContext.I tinyTextureContext.h \
+    tinyTileRasterizer.I tinyTileRasterizer.h \
     tinyWinGraphicsPipe.I tinyWinGraphicsPipe.h \
     tinyWinGraphicsWindow.h tinyWinGraphicsWindow.I \
     tinyXGraphicsPipe.I tinyXGraphicsPipe.h \
@@ -63,6 +64,7 @@
     tinySDLGraphicsPipe.cxx \
     tinySDLGraphicsWindow.cxx \
     tinyTextureContext.cxx \
+    tinyTileRasterizer.cxx \
     tinyWinGraphicsPipe.cxx \
     tinyWinGraphicsWindow.cxx \
     tinyXGraphicsPipe.cxx \
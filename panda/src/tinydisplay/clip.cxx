@@ -1,4 +1,5 @@
 #include "zgl.h"
+#include "tinyTileRasterizer.h"
 #include <limits.h>
 
 /* fill triangle profile */
@@ -11,6 +12,15 @@
 #define CLIP_ZMIN   (1<<4)
 #define CLIP_ZMAX   (1<<5)
 
+/* lines and points are drawn immediately, so any triangles queued
+   for the tile rasterizer must be drawn first */
+static inline void gl_flush_tiles(GLContext *c)
+{
+  if (c->tile_rasterizer != NULL) {
+    c->tile_rasterizer->flush();
+  }
+}
+
 void gl_transform_to_viewport(GLContext *c,GLVertex *v)
 {
   PN_stdfloat winv;
@@ -75,6 +85,7 @@ void gl_transform_to_viewport(GLContext *c,GLVertex *v)
 void gl_draw_point(GLContext *c,GLVertex *p0)
 {
   if (p0->clip_code == 0) {
+    gl_flush_tiles(c);
     ZB_plot(c->zb,&p0->zp);
   }
 }
@@ -123,6 +134,8 @@ void gl_draw_line(GLContext *c,GLVertex *p1,GLVertex *p2)
   GLVertex q1,q2;
   int cc1,cc2;
   
+  gl_flush_tiles(c);
+
   cc1=p1->clip_code;
   cc2=p2->clip_code;
 
@@ -404,6 +417,12 @@ void gl_draw_triangle_fill(GLContext *c,
   }
 #endif
 
+  if (c->tile_rasterizer != NULL) {
+    c->tile_rasterizer->add_triangle(c->zb_fill_tri, c->zb,
+                                     &p0->zp, &p1->zp, &p2->zp);
+    return;
+  }
+
   (*c->zb_fill_tri)(c->zb,&p0->zp,&p1->zp,&p2->zp);
 }
 
@@ -412,6 +431,7 @@ void gl_draw_triangle_fill(GLContext *c,
 void gl_draw_triangle_line(GLContext *c,
                            GLVertex *p0,GLVertex *p1,GLVertex *p2)
 {
+    gl_flush_tiles(c);
     if (c->depth_test) {
         if (p0->edge_flag) ZB_line_z(c->zb,&p0->zp,&p1->zp);
         if (p1->edge_flag) ZB_line_z(c->zb,&p1->zp,&p2->zp);
@@ -429,6 +449,7 @@ void gl_draw_triangle_line(GLContext *c,
 void gl_draw_triangle_point(GLContext *c,
                             GLVertex *p0,GLVertex *p1,GLVertex *p2)
 {
+  gl_flush_tiles(c);
   if (p0->edge_flag) ZB_plot(c->zb,&p0->zp);
   if (p1->edge_flag) ZB_plot(c->zb,&p1->zp);
   if (p2->edge_flag) ZB_plot(c->zb,&p2->zp);
@@ -74,6 +74,20 @@ ConfigVariableBool td_perspective_textures
             "textures on the tinydisplay software renderer, for a small "
             "performance gain."));
 
+ConfigVariableInt td_num_threads
+  ("td-num-threads", 0,
+   PRC_DESC("Set this to a number greater than 1 to fill triangles on the "
+            "tinydisplay software renderer with that many threads.  The "
+            "frame buffer is divided into horizontal tiles of "
+            "td-tile-height rows, which are filled in parallel; the "
+            "rendered image is identical either way.  Set it to 0 or 1 "
+            "to fill each triangle immediately, on the draw thread."));
+
+ConfigVariableInt td_tile_height
+  ("td-tile-height", 32,
+   PRC_DESC("The number of rows of the frame buffer in each of the tiles "
+            "filled in parallel when td-num-threads is greater than 1."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libtinydisplay
 //  Description: Initializes the library.  This must be called at
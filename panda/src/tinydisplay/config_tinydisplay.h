@@ -34,5 +34,7 @@ extern ConfigVariableInt td_texture_ram;
 extern ConfigVariableBool td_ignore_mipmaps;
 extern ConfigVariableBool td_ignore_clamp;
 extern ConfigVariableBool td_perspective_textures;
+extern ConfigVariableInt td_num_threads;
+extern ConfigVariableInt td_tile_height;
 
 #endif
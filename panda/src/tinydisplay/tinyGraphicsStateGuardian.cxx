@@ -69,6 +69,7 @@ TinyGraphicsStateGuardian(GraphicsEngine *engine, GraphicsPipe *pipe,
   _current_frame_buffer = NULL;
   _aux_frame_buffer = NULL;
   _c = NULL;
+  _tile_rasterizer = NULL;
   _vertices = NULL;
   _vertices_size = 0;
 }
@@ -117,6 +118,11 @@ reset() {
   _c->draw_triangle_front = gl_draw_triangle_fill;
   _c->draw_triangle_back = gl_draw_triangle_fill;
 
+  if (td_num_threads > 1 && Thread::is_threading_supported()) {
+    _tile_rasterizer = new TinyTileRasterizer(td_num_threads, td_tile_height);
+    _c->tile_rasterizer = _tile_rasterizer;
+  }
+
   _supported_geom_rendering =
     Geom::GR_point | 
     Geom::GR_indexed_other |
@@ -151,6 +157,14 @@ reset() {
 ////////////////////////////////////////////////////////////////////
 void TinyGraphicsStateGuardian::
 free_pointers() {
+  if (_tile_rasterizer != (TinyTileRasterizer *)NULL) {
+    if (_c != (GLContext *)NULL) {
+      _c->tile_rasterizer = NULL;
+    }
+    delete _tile_rasterizer;
+    _tile_rasterizer = NULL;
+  }
+
   if (_aux_frame_buffer != (ZBuffer *)NULL) {
     ZB_close(_aux_frame_buffer);
     _aux_frame_buffer = NULL;
@@ -249,6 +263,7 @@ clear(DrawableRegion *clearable) {
     clear_z = true;
   }
 
+  flush_tiles();
   ZB_clear_viewport(_c->zb, clear_z, z,
                     clear_color, r, g, b, a,
                     _c->viewport.xmin, _c->viewport.ymin,
@@ -266,6 +281,9 @@ prepare_display_region(DisplayRegionPipelineReader *dr) {
   nassertv(dr != (DisplayRegionPipelineReader *)NULL);
   GraphicsStateGuardian::prepare_display_region(dr);
 
+  // The aux frame buffer might be reallocated below.
+  flush_tiles();
+
   int xmin, ymin, xsize, ysize;
   dr->get_region_pixels_i(xmin, ymin, xsize, ysize);
 
@@ -434,6 +452,8 @@ begin_scene() {
 ////////////////////////////////////////////////////////////////////
 void TinyGraphicsStateGuardian::
 end_scene() {
+  flush_tiles();
+
   if (_c->zb == _aux_frame_buffer) {
     // Copy the aux frame buffer into the main scene now, zooming it
     // up to the appropriate size.
@@ -467,6 +487,9 @@ end_scene() {
 ////////////////////////////////////////////////////////////////////
 void TinyGraphicsStateGuardian::
 end_frame(Thread *current_thread) {
+  // This must happen before the base class evicts any textures.
+  flush_tiles();
+
   GraphicsStateGuardian::end_frame(current_thread);
 
 #ifndef NDEBUG
@@ -927,17 +950,17 @@ begin_draw_primitives(const GeomPipelineReader *geom_reader,
   _c->zb_fill_tri = fill_tri_funcs[depth_write_state][color_write_state][alpha_test_state][depth_test_state][texfilter_state][shade_model_state][texturing_state];
 
 #ifdef DO_PSTATS
-  pixel_count_white_untextured = 0;
-  pixel_count_flat_untextured = 0;
-  pixel_count_smooth_untextured = 0;
-  pixel_count_white_textured = 0;
-  pixel_count_flat_textured = 0;
-  pixel_count_smooth_textured = 0;
-  pixel_count_white_perspective = 0;
-  pixel_count_flat_perspective = 0;
-  pixel_count_smooth_perspective = 0;
-  pixel_count_smooth_multitex2 = 0;
-  pixel_count_smooth_multitex3 = 0;
+  global_pixel_counts.white_untextured = 0;
+  global_pixel_counts.flat_untextured = 0;
+  global_pixel_counts.smooth_untextured = 0;
+  global_pixel_counts.white_textured = 0;
+  global_pixel_counts.flat_textured = 0;
+  global_pixel_counts.smooth_textured = 0;
+  global_pixel_counts.white_perspective = 0;
+  global_pixel_counts.flat_perspective = 0;
+  global_pixel_counts.smooth_perspective = 0;
+  global_pixel_counts.smooth_multitex2 = 0;
+  global_pixel_counts.smooth_multitex3 = 0;
 #endif  // DO_PSTATS
   
   return true;
@@ -1324,17 +1347,17 @@ void TinyGraphicsStateGuardian::
 end_draw_primitives() {
 
 #ifdef DO_PSTATS
-  _pixel_count_white_untextured_pcollector.add_level(pixel_count_white_untextured);
-  _pixel_count_flat_untextured_pcollector.add_level(pixel_count_flat_untextured);
-  _pixel_count_smooth_untextured_pcollector.add_level(pixel_count_smooth_untextured);
-  _pixel_count_white_textured_pcollector.add_level(pixel_count_white_textured);
-  _pixel_count_flat_textured_pcollector.add_level(pixel_count_flat_textured);
-  _pixel_count_smooth_textured_pcollector.add_level(pixel_count_smooth_textured);
-  _pixel_count_white_perspective_pcollector.add_level(pixel_count_white_perspective);
-  _pixel_count_flat_perspective_pcollector.add_level(pixel_count_flat_perspective);
-  _pixel_count_smooth_perspective_pcollector.add_level(pixel_count_smooth_perspective);
-  _pixel_count_smooth_multitex2_pcollector.add_level(pixel_count_smooth_multitex2);
-  _pixel_count_smooth_multitex3_pcollector.add_level(pixel_count_smooth_multitex3);
+  _pixel_count_white_untextured_pcollector.add_level(global_pixel_counts.white_untextured);
+  _pixel_count_flat_untextured_pcollector.add_level(global_pixel_counts.flat_untextured);
+  _pixel_count_smooth_untextured_pcollector.add_level(global_pixel_counts.smooth_untextured);
+  _pixel_count_white_textured_pcollector.add_level(global_pixel_counts.white_textured);
+  _pixel_count_flat_textured_pcollector.add_level(global_pixel_counts.flat_textured);
+  _pixel_count_smooth_textured_pcollector.add_level(global_pixel_counts.smooth_textured);
+  _pixel_count_white_perspective_pcollector.add_level(global_pixel_counts.white_perspective);
+  _pixel_count_flat_perspective_pcollector.add_level(global_pixel_counts.flat_perspective);
+  _pixel_count_smooth_perspective_pcollector.add_level(global_pixel_counts.smooth_perspective);
+  _pixel_count_smooth_multitex2_pcollector.add_level(global_pixel_counts.smooth_multitex2);
+  _pixel_count_smooth_multitex3_pcollector.add_level(global_pixel_counts.smooth_multitex3);
 #endif  // DO_PSTATS
 
   GraphicsStateGuardian::end_draw_primitives();
@@ -1354,6 +1377,7 @@ framebuffer_copy_to_texture(Texture *tex, int view, int z,
                             const DisplayRegion *dr,
                             const RenderBuffer &rb) {
   nassertr(tex != NULL && dr != NULL, false);
+  flush_tiles();
 
   int xo, yo, w, h;
   dr->get_region_pixels_i(xo, yo, w, h);
@@ -1404,6 +1428,7 @@ framebuffer_copy_to_ram(Texture *tex, int view, int z,
                         const DisplayRegion *dr,
                         const RenderBuffer &rb) {
   nassertr(tex != NULL && dr != NULL, false);
+  flush_tiles();
 
   int xo, yo, w, h;
   dr->get_region_pixels_i(xo, yo, w, h);
@@ -1744,6 +1769,7 @@ release_texture(TextureContext *tc) {
   TinyTextureContext *gtc = DCAST(TinyTextureContext, tc);
 
   _texturing_state = 0;  // just in case
+  flush_tiles();
 
   GLTexture *gltex = &gtc->_gltex;
   if (gltex->allocated_buffer != NULL) {
@@ -2459,6 +2485,9 @@ bool TinyGraphicsStateGuardian::
 upload_texture(TinyTextureContext *gtc, bool force) {
   Texture *tex = gtc->get_texture();
 
+  // A queued triangle might still be using the old image.
+  flush_tiles();
+
   if (_effective_incomplete_render && !force) {
     if (!tex->has_ram_image() && tex->might_have_ram_image() &&
         tex->has_simple_ram_image() &&
@@ -2585,6 +2614,8 @@ upload_texture(TinyTextureContext *gtc, bool force) {
 ////////////////////////////////////////////////////////////////////
 bool TinyGraphicsStateGuardian::
 upload_simple_texture(TinyTextureContext *gtc) {
+  flush_tiles();
+
   PStatTimer timer(_load_texture_pcollector);
   Texture *tex = gtc->get_texture();
   nassertr(tex != (Texture *)NULL, false);
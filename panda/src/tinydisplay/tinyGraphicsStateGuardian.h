@@ -23,6 +23,7 @@
 #include "zmath.h"
 #include "zbuffer.h"
 #include "zgl.h"
+#include "tinyTileRasterizer.h"
 #include "geomVertexReader.h"
 
 class TinyTextureContext;
@@ -135,6 +136,7 @@ private:
   static ZB_texWrapFunc get_tex_wrap_func(Texture::WrapMode wrap_mode);
 
   INLINE void clear_light_state();
+  INLINE void flush_tiles();
 
   // Methods used to generate texture coordinates.
   class TexCoordData {
@@ -160,6 +162,9 @@ private:
 
   GLContext *_c;
 
+  // Allocated by reset() when td-num-threads calls for it.
+  TinyTileRasterizer *_tile_rasterizer;
+
   enum ColorMaterialFlags {
     CMF_ambient   = 0x001,
     CMF_diffuse   = 0x002,
@@ -0,0 +1,219 @@
+// Filename: tinyTileRasterizer.cxx
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "tinyTileRasterizer.h"
+#include "parallelFor.h"
+#include "pStatTimer.h"
+
+#include <string.h>
+
+PStatCollector TinyTileRasterizer::_flush_pcollector("Draw:Flush tiles");
+
+// Beyond this many queued triangles, add_triangle() flushes
+// implicitly, to bound the memory used by the queue.
+static const int max_queued_triangles = 16384;
+
+////////////////////////////////////////////////////////////////////
+//     Function: add_pixel_counts
+//  Description: Adds the pixel counts of one worker of flush() into
+//               the indicated totals.
+////////////////////////////////////////////////////////////////////
+static void
+add_pixel_counts(ZPixelCounts *dest, const ZPixelCounts &source) {
+  dest->white_untextured += source.white_untextured;
+  dest->flat_untextured += source.flat_untextured;
+  dest->smooth_untextured += source.smooth_untextured;
+  dest->white_textured += source.white_textured;
+  dest->flat_textured += source.flat_textured;
+  dest->smooth_textured += source.smooth_textured;
+  dest->white_perspective += source.white_perspective;
+  dest->flat_perspective += source.flat_perspective;
+  dest->smooth_perspective += source.smooth_perspective;
+  dest->smooth_multitex2 += source.smooth_multitex2;
+  dest->smooth_multitex3 += source.smooth_multitex3;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+TinyTileRasterizer::
+TinyTileRasterizer(int num_threads, int tile_height) :
+  _num_tiles(0),
+  _num_threads(max(num_threads, 1)),
+  _tile_height(max(tile_height, 1))
+{
+  _triangles.reserve(max_queued_triangles);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::Destructor
+//       Access: Public
+//  Description: Any triangles still queued are discarded; the frame
+//               buffers they refer to might already be gone.
+////////////////////////////////////////////////////////////////////
+TinyTileRasterizer::
+~TinyTileRasterizer() {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::add_triangle
+//       Access: Public
+//  Description: Queues the indicated triangle, which has already been
+//               clipped and transformed to screen coordinates, to be
+//               filled into the indicated ZBuffer with the indicated
+//               fill function at the next flush().  The ZBuffer's
+//               current state is recorded, so it may be freely
+//               changed after this call.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+add_triangle(ZB_fillTriangleFunc fill_tri, const ZBuffer *zb,
+             const ZBufferPoint *p0, const ZBufferPoint *p1,
+             const ZBufferPoint *p2) {
+  int ymin = min(p0->y, min(p1->y, p2->y));
+  int ymax = max(p0->y, max(p1->y, p2->y));
+  ymin = max(ymin, 0);
+  ymax = min(ymax, zb->ysize - 1);
+  if (ymin > ymax) {
+    // Nothing on screen to draw.
+    return;
+  }
+
+  if ((int)_triangles.size() >= max_queued_triangles) {
+    flush();
+  }
+
+  if (_states.empty() ||
+      memcmp(&_states.back(), zb, sizeof(ZBuffer)) != 0) {
+    _states.push_back(*zb);
+  }
+
+  _triangles.push_back(Triangle());
+  Triangle &tri = _triangles.back();
+  tri._fill_tri = fill_tri;
+  tri._state = (int)_states.size() - 1;
+  tri._ymin = ymin;
+  tri._ymax = ymax;
+  tri._p0 = *p0;
+  tri._p1 = *p1;
+  tri._p2 = *p2;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::flush
+//       Access: Public
+//  Description: Draws all of the queued triangles, and does not
+//               return until they have been drawn.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+flush() {
+  if (_triangles.empty()) {
+    return;
+  }
+
+  PStatTimer timer(_flush_pcollector);
+
+  int num_triangles = (int)_triangles.size();
+  int max_y = 0;
+  for (int i = 0; i < num_triangles; ++i) {
+    max_y = max(max_y, _triangles[i]._ymax);
+  }
+
+  _num_tiles = max_y / _tile_height + 1;
+  if ((int)_tiles.size() < _num_tiles) {
+    _tiles.resize(_num_tiles);
+  }
+  for (int t = 0; t < _num_tiles; ++t) {
+    _tiles[t].clear();
+  }
+
+  for (int i = 0; i < num_triangles; ++i) {
+    const Triangle &tri = _triangles[i];
+    int last_tile = tri._ymax / _tile_height;
+    for (int t = tri._ymin / _tile_height; t <= last_tile; ++t) {
+      _tiles[t].push_back(i);
+    }
+  }
+
+  ParallelFor pfor("tinydisplay", _num_threads);
+  int num_workers = pfor.get_num_workers(_num_tiles);
+  _pixel_counts.resize(num_workers);
+  memset(&_pixel_counts[0], 0, num_workers * sizeof(ZPixelCounts));
+
+  pfor.run(&draw_tiles, this, _num_tiles);
+
+  // All of the queued triangles were issued to the same set of
+  // counts, normally global_pixel_counts.
+  ZPixelCounts *pixel_counts = _states.front().pixel_counts;
+  for (int w = 0; w < num_workers; ++w) {
+    add_pixel_counts(pixel_counts, _pixel_counts[w]);
+  }
+
+  _triangles.clear();
+  _states.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::draw_tile
+//       Access: Private
+//  Description: Fills the rows of the indicated tile with all of the
+//               triangles that touch it, in order, counting the
+//               pixels filled into the indicated counts.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+draw_tile(int tile, ZPixelCounts *pixel_counts) {
+  const vector_int &indices = _tiles[tile];
+  int num_indices = (int)indices.size();
+  if (num_indices == 0) {
+    return;
+  }
+
+  int clip_ymin = tile * _tile_height;
+  int clip_ymax = clip_ymin + _tile_height;
+
+  ZBuffer zb;
+  int state = -1;
+  for (int i = 0; i < num_indices; ++i) {
+    const Triangle &tri = _triangles[indices[i]];
+    if (tri._state != state) {
+      state = tri._state;
+      zb = _states[state];
+      zb.clip_ymin = clip_ymin;
+      zb.clip_ymax = clip_ymax;
+      zb.pixel_counts = pixel_counts;
+    }
+
+    // The fill functions use the points as scratch space, so we pass
+    // them copies.
+    ZBufferPoint p0 = tri._p0;
+    ZBufferPoint p1 = tri._p1;
+    ZBufferPoint p2 = tri._p2;
+    (*tri._fill_tri)(&zb, &p0, &p1, &p2);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::draw_tiles
+//       Access: Private, Static
+//  Description: The ParallelFor function for flush().  It draws the
+//               indicated range of tiles.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+draw_tiles(void *user_data, int begin, int end, int worker_index) {
+  TinyTileRasterizer *self = (TinyTileRasterizer *)user_data;
+  for (int t = begin; t < end; ++t) {
+    self->draw_tile(t, &self->_pixel_counts[worker_index]);
+  }
+}
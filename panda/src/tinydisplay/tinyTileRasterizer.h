@@ -0,0 +1,104 @@
+// Filename: tinyTileRasterizer.h
+// Created by:  drose (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef TINYTILERASTERIZER_H
+#define TINYTILERASTERIZER_H
+
+#include "pandabase.h"
+
+#include "zbuffer.h"
+#include "pvector.h"
+#include "vector_int.h"
+#include "pStatCollector.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : TinyTileRasterizer
+// Description : Defers the filling of triangles on behalf of a
+//               TinyGraphicsStateGuardian, so that they may be drawn
+//               by several threads at once.
+//
+//               Each triangle is queued along with a snapshot of the
+//               ZBuffer state it was issued with.  When flush() is
+//               called, the triangles are binned into horizontal
+//               bands of the frame buffer, one band per tile, and the
+//               tiles are filled in parallel by the calling thread and
+//               the threads of the "tinydisplay" task chain.  Each
+//               thread draws the triangles that touch its tile, in
+//               the order they were issued, with the ordinary fill
+//               functions clipped to the rows of the tile.
+//
+//               Since the tiles span the full width of the frame
+//               buffer, and the fill functions still step along each
+//               triangle edge from its topmost vertex, every pixel is
+//               computed exactly as it would have been without the
+//               tiles.
+//
+//               The rasterizer must be flushed before anything else
+//               reads or writes the frame buffer, or modifies a
+//               texture that a queued triangle might reference.
+////////////////////////////////////////////////////////////////////
+class EXPCL_TINYDISPLAY TinyTileRasterizer {
+public:
+  TinyTileRasterizer(int num_threads, int tile_height);
+  ~TinyTileRasterizer();
+
+  INLINE int get_num_threads() const;
+  INLINE int get_tile_height() const;
+  INLINE bool is_empty() const;
+
+  void add_triangle(ZB_fillTriangleFunc fill_tri, const ZBuffer *zb,
+                    const ZBufferPoint *p0, const ZBufferPoint *p1,
+                    const ZBufferPoint *p2);
+  void flush();
+
+private:
+  void draw_tile(int tile, ZPixelCounts *pixel_counts);
+  static void draw_tiles(void *user_data, int begin, int end,
+                         int worker_index);
+
+  class Triangle {
+  public:
+    ZB_fillTriangleFunc _fill_tri;
+    int _state;
+    int _ymin, _ymax;
+    ZBufferPoint _p0, _p1, _p2;
+  };
+  typedef pvector<Triangle> Triangles;
+  Triangles _triangles;
+
+  // The distinct ZBuffer states referenced by the queued triangles.
+  // Consecutive triangles drawn with the same state share a single
+  // entry.
+  typedef pvector<ZBuffer> States;
+  States _states;
+
+  // The indices of the triangles that touch each tile, in order.
+  typedef pvector<vector_int> Tiles;
+  Tiles _tiles;
+  int _num_tiles;
+
+  // Each worker of flush() counts the pixels it fills into its own
+  // entry, so that they may be added up afterwards without locking.
+  typedef pvector<ZPixelCounts> PixelCounts;
+  PixelCounts _pixel_counts;
+
+  int _num_threads;
+  int _tile_height;
+
+  static PStatCollector _flush_pcollector;
+};
+
+#include "tinyTileRasterizer.I"
+
+#endif
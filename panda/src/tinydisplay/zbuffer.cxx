@@ -10,19 +10,7 @@
 #include "zbuffer.h"
 #include "pnotify.h"
 
-#ifdef DO_PSTATS
-int pixel_count_white_untextured;
-int pixel_count_flat_untextured;
-int pixel_count_smooth_untextured;
-int pixel_count_white_textured;
-int pixel_count_flat_textured;
-int pixel_count_smooth_textured;
-int pixel_count_white_perspective;
-int pixel_count_flat_perspective;
-int pixel_count_smooth_perspective;
-int pixel_count_smooth_multitex2;
-int pixel_count_smooth_multitex3;
-#endif  // DO_PSTATS
+ZPixelCounts global_pixel_counts;
 
 ZBuffer *
 ZB_open(int xsize, int ysize, int mode,
@@ -45,6 +33,9 @@ ZB_open(int xsize, int ysize, int mode,
   zb->ysize = ysize;
   zb->mode = mode;
   zb->linesize = (xsize * PSZB + 3) & ~3;
+  zb->clip_ymin = 0;
+  zb->clip_ymax = 0x7fffffff;
+  zb->pixel_counts = &global_pixel_counts;
 
   switch (mode) {
 #ifdef TGL_FEATURE_8_BITS
@@ -110,6 +110,22 @@ typedef struct {
   unsigned int s_mask, s_shift, t_mask, t_shift;
 } ZTextureLevel;
 
+/* the number of pixels filled by each kind of triangle function, for
+   PStats; see COUNT_PIXELS */
+typedef struct {
+  int white_untextured;
+  int flat_untextured;
+  int smooth_untextured;
+  int white_textured;
+  int flat_textured;
+  int smooth_textured;
+  int white_perspective;
+  int flat_perspective;
+  int smooth_perspective;
+  int smooth_multitex2;
+  int smooth_multitex3;
+} ZPixelCounts;
+
 typedef struct ZBuffer ZBuffer;
 typedef struct ZBufferPoint ZBufferPoint;
 typedef struct ZTextureDef ZTextureDef;
@@ -150,6 +166,15 @@ struct ZBuffer {
   int reference_alpha;
   int blend_r, blend_g, blend_b, blend_a;
   ZB_storePixelFunc store_pix_func;
+
+  /* only rows clip_ymin <= y < clip_ymax are drawn by the triangle
+     functions; see TinyTileRasterizer */
+  int clip_ymin, clip_ymax;
+
+  /* the triangle functions count the pixels they fill here; normally
+     this is global_pixel_counts, but each thread of a
+     TinyTileRasterizer counts into its own */
+  ZPixelCounts *pixel_counts;
 };
 
 struct ZBufferPoint {
@@ -168,25 +193,15 @@ struct ZBufferPoint {
 
 /* zbuffer.c */
 
+extern ZPixelCounts global_pixel_counts;
+
 #ifdef DO_PSTATS
-extern int pixel_count_white_untextured;
-extern int pixel_count_flat_untextured;
-extern int pixel_count_smooth_untextured;
-extern int pixel_count_white_textured;
-extern int pixel_count_flat_textured;
-extern int pixel_count_smooth_textured;
-extern int pixel_count_white_perspective;
-extern int pixel_count_flat_perspective;
-extern int pixel_count_smooth_perspective;
-extern int pixel_count_smooth_multitex2;
-extern int pixel_count_smooth_multitex3;
-
-#define COUNT_PIXELS(pixel_count, p0, p1, p2) \
-  (pixel_count) += abs((p0)->x * ((p1)->y - (p2)->y) + (p1)->x * ((p2)->y - (p0)->y) + (p2)->x * ((p0)->y - (p1)->y)) / 2
+#define COUNT_PIXELS(zb, pixel_count, p0, p1, p2) \
+  (zb)->pixel_counts->pixel_count += abs((p0)->x * ((p1)->y - (p2)->y) + (p1)->x * ((p2)->y - (p0)->y) + (p2)->x * ((p0)->y - (p1)->y)) / 2
 
 #else
 
-#define COUNT_PIXELS(pixel_count, p0, p1, p2)
+#define COUNT_PIXELS(zb, pixel_count, p0, p1, p2)
 
 #endif  // DO_PSTATS
 
@@ -8,6 +8,7 @@
   ZPOINT *pz1;
   PIXEL *pp1;
   int part, update_left, update_right;
+  int y;
 
   int nb_lines, dx1, dy1, tmp, dx2, dy2;
 
@@ -53,8 +54,6 @@
 
   EARLY_OUT();
 
-  COUNT_PIXELS(PIXEL_COUNT, p0, p1, p2);
-
   /* we sort the vertex with increasing y */
   if (p1->y < p0->y) {
     t = p0;
@@ -72,6 +71,12 @@
     p2 = t;
   }
 
+  /* when drawing one band of a tiled frame, only the band containing
+     the top of the triangle counts its pixels */
+  if (p0->y >= zb->clip_ymin) {
+    COUNT_PIXELS(zb, PIXEL_COUNT, p0, p1, p2);
+  }
+
   /* we compute dXdx and dXdy for all interpolated values */
   
   fdx1 = (PN_stdfloat) (p1->x - p0->x);
@@ -213,6 +218,7 @@
 
   pp1 = (PIXEL *) ((char *) zb->pbuf + zb->linesize * p0->y);
   pz1 = zb->zbuf + p0->y * zb->xsize;
+  y = p0->y;
 
   DRAW_INIT();
 
@@ -341,6 +347,14 @@
 
     while (nb_lines>0) {
       nb_lines--;
+      if (y >= zb->clip_ymax) {
+        /* the rest of the triangle lies below the current band */
+        return;
+      }
+      /* lines above the current band are stepped over, but not drawn,
+         so that the edges are interpolated exactly as they would be
+         if the whole triangle were drawn */
+      if (y >= zb->clip_ymin) {
 #ifndef DRAW_LINE
       /* generic draw line */
       {
@@ -417,6 +431,7 @@
 #else
       DRAW_LINE();
 #endif
+      }
       
       /* left edge */
       error+=derror;
@@ -483,6 +498,7 @@
       /* screen coordinates */
       pp1=(PIXEL *)((char *)pp1 + zb->linesize);
       pz1+=zb->xsize;
+      y++;
     }
   }
 }
@@ -22,7 +22,7 @@ FNAME(white_untextured) (ZBuffer *zb,
     z+=dzdx;                                                            \
   }
 
-#define PIXEL_COUNT pixel_count_white_untextured
+#define PIXEL_COUNT white_untextured
 
 #include "ztriangle.h"
 }
@@ -62,7 +62,7 @@ FNAME(flat_untextured) (ZBuffer *zb,
     z+=dzdx;                                            \
   }
 
-#define PIXEL_COUNT pixel_count_flat_untextured
+#define PIXEL_COUNT flat_untextured
 
 #include "ztriangle.h"
 }
@@ -112,7 +112,7 @@ FNAME(smooth_untextured) (ZBuffer *zb,
     oa1+=dadx;                                                          \
   }
 
-#define PIXEL_COUNT pixel_count_smooth_untextured
+#define PIXEL_COUNT smooth_untextured
 
 #include "ztriangle.h"
 }
@@ -150,7 +150,7 @@ FNAME(white_textured) (ZBuffer *zb,
     t+=dtdx;                                                            \
   }
 
-#define PIXEL_COUNT pixel_count_white_textured
+#define PIXEL_COUNT white_textured
 
 #include "ztriangle.h"
 }
@@ -206,7 +206,7 @@ FNAME(flat_textured) (ZBuffer *zb,
     t+=dtdx;                                                            \
   }
 
-#define PIXEL_COUNT pixel_count_flat_textured
+#define PIXEL_COUNT flat_textured
 
 #include "ztriangle.h"
 }
@@ -272,7 +272,7 @@ FNAME(smooth_textured) (ZBuffer *zb,
     t+=dtdx;                                                            \
   }
 
-#define PIXEL_COUNT pixel_count_smooth_textured
+#define PIXEL_COUNT smooth_textured
 
 #include "ztriangle.h"
 }
@@ -384,7 +384,7 @@ FNAME(white_perspective) (ZBuffer *zb,
     }                                                           \
   }
   
-#define PIXEL_COUNT pixel_count_white_perspective
+#define PIXEL_COUNT white_perspective
 
 #include "ztriangle.h"
 }
@@ -515,7 +515,7 @@ FNAME(flat_perspective) (ZBuffer *zb,
     }                                                           \
   }
 
-#define PIXEL_COUNT pixel_count_flat_perspective
+#define PIXEL_COUNT flat_perspective
 
 #include "ztriangle.h"
 }
@@ -655,7 +655,7 @@ FNAME(smooth_perspective) (ZBuffer *zb,
     }                                                           \
   }
 
-#define PIXEL_COUNT pixel_count_smooth_perspective
+#define PIXEL_COUNT smooth_perspective
 
 #include "ztriangle.h"
 }
@@ -810,7 +810,7 @@ FNAME(smooth_multitex2) (ZBuffer *zb,
     }                                                                   \
   }
 
-#define PIXEL_COUNT pixel_count_smooth_multitex2
+#define PIXEL_COUNT smooth_multitex2
 
 #include "ztriangle.h"
 }
@@ -995,7 +995,7 @@ FNAME(smooth_multitex3) (ZBuffer *zb,
     }                                                                   \
   }
 
-#define PIXEL_COUNT pixel_count_smooth_multitex3
+#define PIXEL_COUNT smooth_multitex3
 
 #include "ztriangle.h"
 }